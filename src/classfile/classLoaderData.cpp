@@ -0,0 +1,63 @@
+/*
+ * my_jvm - ClassLoaderData implementation
+ */
+
+#include "classfile/classLoaderData.hpp"
+#include "memory/metaspace.hpp"
+#include "oops/klass.hpp"
+#include "runtime/atomic.hpp"
+
+ClassLoaderData* ClassLoaderData::_the_null_class_loader_data = nullptr;
+
+ClassLoaderData::ClassLoaderData(bool is_boot)
+  : _is_boot(is_boot), _metaspace(nullptr), _klasses(nullptr) {}
+
+ClassLoaderData::~ClassLoaderData() {
+  unload();
+}
+
+ClassLoaderData* ClassLoaderData::the_null_class_loader_data() {
+  ClassLoaderData* cld = (ClassLoaderData*)atomic_load((void* const*)&_the_null_class_loader_data);
+  if (cld == nullptr) {
+    ClassLoaderData* created = new ClassLoaderData(true);
+    cld = (ClassLoaderData*)atomic_cas((void**)&_the_null_class_loader_data, created, nullptr);
+    if (cld == nullptr) {
+      cld = created;
+    } else {
+      delete created;
+    }
+  }
+  return cld;
+}
+
+ClassLoaderMetaspace* ClassLoaderData::metaspace_non_null() {
+  ClassLoaderMetaspace* ms = (ClassLoaderMetaspace*)atomic_load((void* const*)&_metaspace);
+  if (ms == nullptr) {
+    ClassLoaderMetaspace* created = new ClassLoaderMetaspace(
+        _is_boot ? Metaspace::BootMetaspaceType : Metaspace::StandardMetaspaceType);
+    ms = (ClassLoaderMetaspace*)atomic_cas((void**)&_metaspace, created, nullptr);
+    if (ms == nullptr) {
+      ms = created;
+    } else {
+      delete created;
+    }
+  }
+  return ms;
+}
+
+void ClassLoaderData::add_class(Klass* k) {
+  Klass* old;
+  do {
+    old = (Klass*)atomic_load((void* const*)&_klasses);
+    k->set_next_link(old);
+  } while (atomic_cas((void**)&_klasses, k, old) != old);
+  k->set_class_loader_data(this);
+}
+
+void ClassLoaderData::unload() {
+  // Klass 本身也在 metaspace 里，链表随之失效
+  _klasses = nullptr;
+  ClassLoaderMetaspace* ms = _metaspace;
+  _metaspace = nullptr;
+  delete ms;
+}
@@ -0,0 +1,47 @@
+/*
+ * my_jvm - ClassLoaderData
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/classfile/classLoaderData.hpp
+ * 简化版本：只保留元数据的归属关系——每个 class loader 一个
+ * ClassLoaderData，持有它的 ClassLoaderMetaspace 和已加载的 Klass 链表。
+ * 卸载时删除 metaspace，所有元数据所在的 chunk 一次性归还。
+ */
+
+#ifndef MY_JVM_CLASSFILE_CLASSLOADERDATA_HPP
+#define MY_JVM_CLASSFILE_CLASSLOADERDATA_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class ClassLoaderMetaspace;
+class Klass;
+
+class ClassLoaderData : public CHeapObj<mtClass> {
+ private:
+  bool                           _is_boot;
+  ClassLoaderMetaspace* volatile _metaspace;   // 第一次分配元数据时创建
+  Klass* volatile                _klasses;     // 经 Klass::next_link() 串起来
+
+  static ClassLoaderData* _the_null_class_loader_data;
+
+ public:
+  ClassLoaderData(bool is_boot = false);
+  ~ClassLoaderData();
+
+  // 启动类加载器的 ClassLoaderData，首次调用时创建
+  static ClassLoaderData* the_null_class_loader_data();
+
+  bool is_the_null_class_loader_data() const { return _is_boot; }
+
+  ClassLoaderMetaspace* metaspace_or_null() const { return _metaspace; }
+  ClassLoaderMetaspace* metaspace_non_null();
+
+  // 记录在本 loader 中定义的类
+  void   add_class(Klass* k);
+  Klass* klasses() const { return _klasses; }
+
+  // 释放所有元数据（不运行元数据的析构函数）；之后还可以继续分配
+  void unload();
+};
+
+#endif // MY_JVM_CLASSFILE_CLASSLOADERDATA_HPP
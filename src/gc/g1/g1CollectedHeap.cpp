@@ -0,0 +1,160 @@
+/*
+ * my_jvm - G1 collected heap implementation
+ */
+
+#include "gc/g1/g1CollectedHeap.hpp"
+#include "oops/markOop.hpp"
+#include "oops/oop.hpp"
+#include "runtime/atomic.hpp"
+#include "utilities/copy.hpp"
+#include "utilities/ostream.hpp"
+
+G1CollectedHeap* G1CollectedHeap::_g1h = nullptr;
+
+// 没有 GC 时用 G1NewSizePercent（5%）的 young 大小作为 eden 容量估计
+static const size_t YoungPercent = 5;
+
+G1CollectedHeap::G1CollectedHeap(ReservedSpace rs)
+  : _reserved(rs),
+    _hrm(new HeapRegionManager((HeapWord*)rs.base(), (uint)(rs.size() / HeapRegion::GrainBytes))),
+    _mutator_alloc_region(nullptr), _alloc_lock(Mutex::leaf + 1, "G1 allocation"),
+    _humongous_threshold_words(HeapRegion::GrainWords / 2),
+    _young_regions(MAX2((size_t)_hrm->num_regions() * YoungPercent / 100, (size_t)1)),
+    _eden_regions_allocated(0), _retired_bytes_used(0) {}
+
+bool G1CollectedHeap::initialize(size_t heap_size) {
+  guarantee(_g1h == nullptr, "heap already initialized");
+  HeapRegion::setup_heap_region_size(heap_size, G1HeapRegionSize);
+  // region 对齐，这样 addr_to_region 只需要一次移位
+  ReservedHeapSpace rs(align_up(heap_size, HeapRegion::GrainBytes), HeapRegion::GrainBytes);
+  if (!rs.is_reserved()) {
+    return false;
+  }
+  _g1h = new G1CollectedHeap(rs);
+  return true;
+}
+
+void G1CollectedHeap::lock() {
+  _alloc_lock.lock();
+}
+
+void G1CollectedHeap::unlock() {
+  _alloc_lock.unlock();
+}
+
+// ========== 分配 ==========
+
+HeapWord* G1CollectedHeap::attempt_allocation(size_t min_word_size, size_t desired_word_size,
+                                              size_t* actual_word_size) {
+  // 先无锁地在当前 region 里试
+  HeapRegion* hr = (HeapRegion*)atomic_load((void* const*)&_mutator_alloc_region);
+  if (hr != nullptr) {
+    HeapWord* result = hr->par_allocate(min_word_size, desired_word_size, actual_word_size);
+    if (result != nullptr) {
+      return result;
+    }
+  }
+
+  lock();
+  HeapWord* result = nullptr;
+  // 别的线程可能已经换过了
+  hr = _mutator_alloc_region;
+  if (hr != nullptr) {
+    result = hr->par_allocate(min_word_size, desired_word_size, actual_word_size);
+  }
+  if (result == nullptr) {
+    HeapRegion* new_region = _hrm->allocate_free_region();
+    if (new_region != nullptr) {
+      new_region->set_eden();
+      result = new_region->par_allocate(min_word_size, desired_word_size, actual_word_size);
+      // 旧 region 剩下的空间不会再用了（没有 GC 回收前，和 OpenJDK 一样留给填充对象）
+      if (hr != nullptr) {
+        _retired_bytes_used += hr->used();
+      }
+      atomic_store((void**)&_mutator_alloc_region, (void*)new_region);
+      atomic_add((uintptr_t*)&_eden_regions_allocated, (uintptr_t)1);
+    }
+  }
+  unlock();
+  return result;
+}
+
+HeapWord* G1CollectedHeap::allocate_new_tlab(size_t min_word_size, size_t desired_word_size,
+                                             size_t* actual_word_size) {
+  return attempt_allocation(min_word_size, desired_word_size, actual_word_size);
+}
+
+HeapWord* G1CollectedHeap::humongous_allocate(size_t word_size) {
+  uint num = (uint)(align_up(word_size, HeapRegion::GrainWords) / HeapRegion::GrainWords);
+  HeapRegion* first = _hrm->allocate_free_regions_starting_at_lowest(num);
+  if (first == nullptr) {
+    return nullptr;
+  }
+  HeapWord* obj_top = first->bottom() + word_size;
+  first->set_starts_humongous(obj_top);
+  for (uint i = 1; i < num; i++) {
+    _hrm->at(first->hrm_index() + i)->set_continues_humongous(first, obj_top);
+  }
+  lock();
+  _retired_bytes_used += word_size * HeapWordSize;
+  unlock();
+  return first->bottom();
+}
+
+HeapWord* G1CollectedHeap::mem_allocate(size_t word_size) {
+  if (is_humongous(word_size)) {
+    return humongous_allocate(word_size);
+  }
+  size_t actual = 0;
+  return attempt_allocation(word_size, word_size, &actual);
+}
+
+oop G1CollectedHeap::obj_allocate(Klass* klass, size_t word_size) {
+  HeapWord* mem = allocate(word_size);
+  if (mem == nullptr) {
+    return nullptr;
+  }
+  // 参考：memAllocator.cpp ObjAllocator::initialize —— 先清零再写对象头
+  Copy::fill_to_aligned_words(mem, word_size);
+  oop obj = (oop)mem;
+  obj->set_mark_raw(markWord_unlocked());
+  obj->set_klass(klass);
+  return obj;
+}
+
+oop G1CollectedHeap::array_allocate(Klass* klass, size_t word_size, int length) {
+  oop obj = obj_allocate(klass, word_size);
+  if (obj != nullptr) {
+    ((arrayOop)obj)->set_length(length);
+  }
+  return obj;
+}
+
+oop G1CollectedHeap::instance_allocate(Klass* klass) {
+  jint lh = klass->layout_helper();
+  if (!Klass::layout_helper_is_instance(lh) || Klass::layout_helper_needs_slow_path(lh)) {
+    return nullptr;
+  }
+  return obj_allocate(klass, (size_t)Klass::layout_helper_to_size_helper(lh));
+}
+
+oop G1CollectedHeap::array_allocate(Klass* klass, int length) {
+  jint lh = klass->layout_helper();
+  if (!Klass::layout_helper_is_array(lh) || length < 0) {
+    return nullptr;
+  }
+  return array_allocate(klass, (size_t)arrayOopDesc::object_size(lh, length), length);
+}
+
+size_t G1CollectedHeap::used() const {
+  HeapRegion* hr = (HeapRegion*)atomic_load((void* const*)&_mutator_alloc_region);
+  return _retired_bytes_used + (hr != nullptr ? hr->used() : 0);
+}
+
+void G1CollectedHeap::print_on(outputStream* st) const {
+  st->print_cr("garbage-first heap total " SIZE_FORMAT "K, used " SIZE_FORMAT "K [" PTR_FORMAT ", "
+               PTR_FORMAT ")", capacity() / 1024, used() / 1024,
+               (void*)_reserved.base(), (void*)_reserved.end());
+  st->print_cr(" region size " SIZE_FORMAT "K, %u free regions, eden regions allocated " SIZE_FORMAT,
+               HeapRegion::GrainBytes / 1024, _hrm->num_free_regions(), (size_t)_eden_regions_allocated);
+}
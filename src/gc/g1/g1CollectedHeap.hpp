@@ -0,0 +1,122 @@
+/*
+ * my_jvm - G1 collected heap
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/gc/g1/g1CollectedHeap.hpp
+ *      hotspot/src/hotspot/share/gc/shared/memAllocator.cpp
+ * 简化版本：只有分配，没有 GC。
+ *
+ *  - 堆：ReservedHeapSpace 预留（决定压缩指针模式），切成固定大小的 region
+ *  - 普通对象：线程的 TLAB 里 bump 分配；TLAB 用完时从当前 eden region
+ *    （mutator alloc region）切一段新的，多个线程用 CAS 并发切
+ *  - 大于 humongous 阈值（半个 region）的对象独占若干连续 region
+ *
+ * 堆在进程里只初始化一次（G1CollectedHeap::initialize），之后不销毁。
+ */
+
+#ifndef MY_JVM_GC_G1_G1COLLECTEDHEAP_HPP
+#define MY_JVM_GC_G1_G1COLLECTEDHEAP_HPP
+
+#include "gc/g1/heapRegion.hpp"
+#include "gc/g1/heapRegionManager.hpp"
+#include "memory/allocation.hpp"
+#include "memory/virtualspace.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/mutex.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class Klass;
+class outputStream;
+
+class G1CollectedHeap : public CHeapObj<mtGC> {
+ private:
+  static G1CollectedHeap* _g1h;
+
+  ReservedSpace       _reserved;
+  HeapRegionManager*  _hrm;
+
+  // 当前 eden region，TLAB 和 TLAB 外的小对象都从这里切
+  HeapRegion* volatile _mutator_alloc_region;
+  Mutex                _alloc_lock;       // 更换 _mutator_alloc_region / humongous 分配
+
+  size_t   _humongous_threshold_words;
+  size_t   _young_regions;                // 一个 TLAB 采样周期的 eden region 数
+  volatile uintptr_t _eden_regions_allocated;
+  size_t   _retired_bytes_used;           // 已经换下的 eden region 和 humongous region 的用量
+
+  G1CollectedHeap(ReservedSpace rs);
+
+  void lock();
+  void unlock();
+
+  // 在 _mutator_alloc_region 里分配，不够时换一个新的 eden region
+  HeapWord* attempt_allocation(size_t min_word_size, size_t desired_word_size, size_t* actual_word_size);
+  HeapWord* humongous_allocate(size_t word_size);
+
+ public:
+  // 预留 heap_size 字节的堆；失败返回 false。只能调用一次
+  static bool initialize(size_t heap_size = MaxHeapSize);
+
+  static G1CollectedHeap* heap() { return _g1h; }
+
+  // ========== 分配 ==========
+
+  // 分配 word_size 个字，内容未初始化；堆满时返回 nullptr
+  static inline HeapWord* allocate(size_t word_size);
+
+  // TLAB 慢速路径：在 eden 里切 [min_word_size, desired_word_size] 字
+  HeapWord* allocate_new_tlab(size_t min_word_size, size_t desired_word_size, size_t* actual_word_size);
+
+  // TLAB 外分配：小对象在 eden region 里 CAS 分配，大对象走 humongous
+  HeapWord* mem_allocate(size_t word_size);
+
+  // 分配并初始化对象头（mark、klass），字段清零；堆满时返回 nullptr，
+  // 由调用方抛 OutOfMemoryError。klass 在 UseCompressedClassPointers 时必须在压缩类空间里
+  oop obj_allocate(Klass* klass, size_t word_size);
+  oop array_allocate(Klass* klass, size_t word_size, int length);
+
+  // 大小只由 klass 的 layout helper 决定：实例取 size_helper，数组按长度算。
+  // layout helper 要求走慢速路径的实例类、负数长度返回 nullptr
+  oop instance_allocate(Klass* klass);
+  oop array_allocate(Klass* klass, int length);
+
+  // ========== 查询 ==========
+
+  bool is_in(const void* p) const     { return _hrm->is_in_reserved(p); }
+  HeapRegion* heap_region_containing(const void* p) const { return _hrm->addr_to_region(p); }
+
+  HeapWord* reserved_base() const     { return (HeapWord*)_reserved.base(); }
+  size_t capacity() const             { return (size_t)_hrm->num_regions() * HeapRegion::GrainBytes; }
+  size_t used() const;
+  size_t humongous_threshold_words() const { return _humongous_threshold_words; }
+  // 参考 OpenJDK 11 G1CollectedHeap::is_humongous：超过半个 region 才是 humongous，
+  // 正好半个 region 的对象和 TLAB 的上限（max_size）一样，仍在 eden 里分配
+  bool is_humongous(size_t word_size) const { return word_size > _humongous_threshold_words; }
+  HeapRegionManager* hrm() const      { return _hrm; }
+
+  // TLAB 大小调整用：采样周期内 eden 的容量，和目前经过了几个周期
+  size_t   tlab_capacity_words() const { return _young_regions * HeapRegion::GrainWords; }
+  uint64_t allocation_epoch() const    { return _eden_regions_allocated / _young_regions; }
+
+  void print_on(outputStream* st) const;
+};
+
+// ========== 快速路径 ==========
+// 参考：memAllocator.cpp MemAllocator::mem_allocate
+
+inline HeapWord* G1CollectedHeap::allocate(size_t word_size) {
+  if (UseTLAB) {
+    ThreadLocalAllocBuffer& tlab = Thread::current()->tlab();
+    HeapWord* mem = tlab.allocate(word_size);
+    if (MY_JVM_LIKELY(mem != nullptr)) {
+      return mem;
+    }
+    mem = tlab.allocate_slow(word_size);
+    if (mem != nullptr) {
+      return mem;
+    }
+  }
+  return _g1h->mem_allocate(word_size);
+}
+
+#endif // MY_JVM_GC_G1_G1COLLECTEDHEAP_HPP
@@ -0,0 +1,41 @@
+/*
+ * my_jvm - Heap region implementation
+ */
+
+#include "gc/g1/heapRegion.hpp"
+#include "utilities/ostream.hpp"
+
+size_t HeapRegion::GrainBytes        = 0;
+size_t HeapRegion::GrainWords        = 0;
+int    HeapRegion::LogOfHRGrainBytes = 0;
+
+void HeapRegion::setup_heap_region_size(size_t heap_size, size_t region_size) {
+  if (region_size == 0) {
+    region_size = MAX2(heap_size / TARGET_REGION_NUMBER, (size_t)MIN_REGION_SIZE);
+  }
+  // 向下取 2 的幂
+  size_t pow2 = MIN_REGION_SIZE;
+  while (pow2 * 2 <= region_size && pow2 < MAX_REGION_SIZE) {
+    pow2 *= 2;
+  }
+  GrainBytes        = pow2;
+  GrainWords        = pow2 / HeapWordSize;
+  LogOfHRGrainBytes = exact_log2(pow2);
+}
+
+const char* HeapRegion::get_type_str() const {
+  switch (_type) {
+    case FreeTag:               return "FREE";
+    case EdenTag:               return "EDEN";
+    case SurvTag:               return "SURV";
+    case OldTag:                return "OLD";
+    case StartsHumongousTag:    return "HUMS";
+    case ContinuesHumongousTag: return "HUMC";
+    default:                    return "???";
+  }
+}
+
+void HeapRegion::print_on(outputStream* st) const {
+  st->print_cr("|%4u|%-4s| " PTR_FORMAT ", " PTR_FORMAT ", " PTR_FORMAT " used=" SIZE_FORMAT "K",
+               _hrm_index, get_type_str(), (void*)_bottom, (void*)_top, (void*)_end, used() / 1024);
+}
@@ -0,0 +1,128 @@
+/*
+ * my_jvm - Heap region
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/gc/g1/heapRegion.hpp
+ *      hotspot/src/hotspot/share/gc/g1/heapRegionType.hpp
+ * 简化版本：Java 堆被切成固定大小（2 的幂）的 region，
+ * 每个 region 记录 [bottom, top, end) 和类型；还没有 GC，region 只会被分配出去。
+ */
+
+#ifndef MY_JVM_GC_G1_HEAPREGION_HPP
+#define MY_JVM_GC_G1_HEAPREGION_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class outputStream;
+
+class HeapRegion : public CHeapObj<mtGC> {
+  friend class HeapRegionManager;
+
+ public:
+  enum RegionType {
+    FreeTag,
+    EdenTag,
+    SurvTag,
+    OldTag,
+    StartsHumongousTag,
+    ContinuesHumongousTag
+  };
+
+  // region 大小，setup_heap_region_size 之后不变
+  static size_t GrainBytes;
+  static size_t GrainWords;
+  static int    LogOfHRGrainBytes;
+
+  enum {
+    MIN_REGION_SIZE = 1024 * 1024,
+    MAX_REGION_SIZE = 32 * 1024 * 1024,
+    TARGET_REGION_NUMBER = 2048
+  };
+
+  // 参考：heapRegion.cpp HeapRegion::setup_heap_region_size
+  // region_size 为 0 时按 堆大小 / 2048 选择，结果取 2 的幂并限制在 [1M, 32M]
+  static void setup_heap_region_size(size_t heap_size, size_t region_size);
+
+ private:
+  HeapWord*          _bottom;
+  HeapWord* volatile _top;
+  HeapWord*          _end;
+  uint               _hrm_index;
+  RegionType         _type;
+
+  // 空闲链表（HeapRegionManager 持锁）
+  HeapRegion*        _prev;
+  HeapRegion*        _next;
+
+  // ContinuesHumongous 所属的 StartsHumongous
+  HeapRegion*        _humongous_start_region;
+
+ public:
+  HeapRegion(uint hrm_index, HeapWord* bottom)
+    : _bottom(bottom), _top(bottom), _end(bottom + GrainWords), _hrm_index(hrm_index),
+      _type(FreeTag), _prev(nullptr), _next(nullptr), _humongous_start_region(nullptr) {}
+
+  HeapWord* bottom() const { return _bottom; }
+  HeapWord* top() const    { return _top; }
+  HeapWord* end() const    { return _end; }
+  uint      hrm_index() const { return _hrm_index; }
+
+  size_t used() const      { return pointer_delta(_top, _bottom, 1); }
+  size_t free() const      { return pointer_delta(_end, _top, 1); }
+  bool   is_empty() const  { return _top == _bottom; }
+  bool   is_in(const void* p) const {
+    return (const HeapWord*)p >= _bottom && (const HeapWord*)p < _end;
+  }
+
+  // ========== 类型 ==========
+
+  RegionType type() const         { return _type; }
+  const char* get_type_str() const;
+  bool is_free() const            { return _type == FreeTag; }
+  bool is_eden() const            { return _type == EdenTag; }
+  bool is_old() const             { return _type == OldTag; }
+  bool is_humongous() const       { return _type == StartsHumongousTag || _type == ContinuesHumongousTag; }
+  bool is_starts_humongous() const    { return _type == StartsHumongousTag; }
+  bool is_continues_humongous() const { return _type == ContinuesHumongousTag; }
+  HeapRegion* humongous_start_region() const { return _humongous_start_region; }
+
+  void set_free()   { _type = FreeTag; _top = _bottom; _humongous_start_region = nullptr; }
+  void set_eden()   { _type = EdenTag; }
+  void set_old()    { _type = OldTag; }
+  void set_starts_humongous(HeapWord* obj_top) {
+    _type = StartsHumongousTag;
+    _top = MIN2(obj_top, _end);
+    _humongous_start_region = this;
+  }
+  void set_continues_humongous(HeapRegion* first, HeapWord* obj_top) {
+    _type = ContinuesHumongousTag;
+    _top = MIN2(MAX2(obj_top, _bottom), _end);
+    _humongous_start_region = first;
+  }
+
+  // ========== 分配 ==========
+  // 参考：heapRegion.inline.hpp G1ContiguousSpace::par_allocate_impl
+  // 多个线程同时从同一个 eden region 取 TLAB，用 CAS 推进 _top。
+  // 剩余空间不足 desired_word_size 但不少于 min_word_size 时给出剩余的全部
+
+  HeapWord* par_allocate(size_t min_word_size, size_t desired_word_size, size_t* actual_word_size) {
+    while (true) {
+      HeapWord* obj = _top;
+      size_t available = pointer_delta(_end, obj);
+      size_t want = MIN2(available, desired_word_size);
+      if (want < min_word_size) {
+        return nullptr;
+      }
+      HeapWord* new_top = obj + want;
+      if (atomic_cas((void**)&_top, (void*)new_top, (void*)obj) == (void*)obj) {
+        *actual_word_size = want;
+        return obj;
+      }
+    }
+  }
+
+  void print_on(outputStream* st) const;
+};
+
+#endif // MY_JVM_GC_G1_HEAPREGION_HPP
@@ -0,0 +1,119 @@
+/*
+ * my_jvm - Heap region manager implementation
+ */
+
+#include "gc/g1/heapRegionManager.hpp"
+#include "utilities/ostream.hpp"
+
+HeapRegionManager::HeapRegionManager(HeapWord* bottom, uint num_regions)
+  : _heap_bottom(bottom), _heap_end(bottom + (size_t)num_regions * HeapRegion::GrainWords),
+    _regions(NEW_C_HEAP_ARRAY(HeapRegion*, num_regions, mtGC)), _num_regions(num_regions),
+    _lock(Mutex::leaf, "HeapRegionManager"), _free_head(nullptr), _free_tail(nullptr), _num_free(0) {
+  for (uint i = 0; i < num_regions; i++) {
+    _regions[i] = new HeapRegion(i, bottom + (size_t)i * HeapRegion::GrainWords);
+    insert_into_free_list(_regions[i]);
+  }
+}
+
+HeapRegionManager::~HeapRegionManager() {
+  for (uint i = 0; i < _num_regions; i++) {
+    delete _regions[i];
+  }
+  FREE_C_HEAP_ARRAY(HeapRegion*, _regions);
+}
+
+void HeapRegionManager::lock() {
+  _lock.lock();
+}
+
+void HeapRegionManager::unlock() {
+  _lock.unlock();
+}
+
+// ========== 空闲链表 ==========
+
+void HeapRegionManager::remove_from_free_list(HeapRegion* hr) {
+  if (hr->_prev != nullptr) {
+    hr->_prev->_next = hr->_next;
+  } else {
+    _free_head = hr->_next;
+  }
+  if (hr->_next != nullptr) {
+    hr->_next->_prev = hr->_prev;
+  } else {
+    _free_tail = hr->_prev;
+  }
+  hr->_prev = hr->_next = nullptr;
+  _num_free--;
+}
+
+void HeapRegionManager::insert_into_free_list(HeapRegion* hr) {
+  assert(hr->is_free(), "only free regions");
+  lock();
+  // 多数情况是追加到尾部（初始化，或按顺序归还）
+  HeapRegion* after = _free_tail;
+  while (after != nullptr && after->_hrm_index > hr->_hrm_index) {
+    after = after->_prev;
+  }
+  hr->_prev = after;
+  hr->_next = (after != nullptr) ? after->_next : _free_head;
+  if (hr->_next != nullptr) {
+    hr->_next->_prev = hr;
+  } else {
+    _free_tail = hr;
+  }
+  if (after != nullptr) {
+    after->_next = hr;
+  } else {
+    _free_head = hr;
+  }
+  _num_free++;
+  unlock();
+}
+
+HeapRegion* HeapRegionManager::allocate_free_region() {
+  lock();
+  HeapRegion* hr = _free_head;
+  if (hr != nullptr) {
+    remove_from_free_list(hr);
+  }
+  unlock();
+  return hr;
+}
+
+HeapRegion* HeapRegionManager::allocate_free_regions_starting_at_lowest(uint num) {
+  lock();
+  // 沿有序的空闲链表找一段下标连续的 region
+  HeapRegion* first = _free_head;
+  uint run = 0;
+  for (HeapRegion* hr = _free_head; hr != nullptr; hr = hr->_next) {
+    if (run > 0 && hr->_hrm_index == first->_hrm_index + run) {
+      run++;
+    } else {
+      first = hr;
+      run = 1;
+    }
+    if (run == num) {
+      break;
+    }
+  }
+  if (run < num || first == nullptr) {
+    unlock();
+    return nullptr;
+  }
+  for (uint i = 0; i < num; i++) {
+    remove_from_free_list(_regions[first->_hrm_index + i]);
+  }
+  unlock();
+  return first;
+}
+
+void HeapRegionManager::print_on(outputStream* st) const {
+  st->print_cr("Heap regions: %u total, %u free, region size " SIZE_FORMAT "K",
+               _num_regions, _num_free, HeapRegion::GrainBytes / 1024);
+  for (uint i = 0; i < _num_regions; i++) {
+    if (!_regions[i]->is_free()) {
+      _regions[i]->print_on(st);
+    }
+  }
+}
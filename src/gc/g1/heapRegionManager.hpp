@@ -0,0 +1,67 @@
+/*
+ * my_jvm - Heap region manager
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/gc/g1/heapRegionManager.hpp
+ *      hotspot/src/hotspot/share/gc/g1/heapRegionSet.hpp（FreeRegionList）
+ * 简化版本：所有 region 在初始化时一次建好（地址空间已经预留，
+ * 物理页在首次访问时分配），空闲 region 按下标有序地串成双向链表。
+ */
+
+#ifndef MY_JVM_GC_G1_HEAPREGIONMANAGER_HPP
+#define MY_JVM_GC_G1_HEAPREGIONMANAGER_HPP
+
+#include "gc/g1/heapRegion.hpp"
+#include "memory/allocation.hpp"
+#include "runtime/mutex.hpp"
+
+class outputStream;
+
+class HeapRegionManager : public CHeapObj<mtGC> {
+ private:
+  HeapWord*     _heap_bottom;
+  HeapWord*     _heap_end;
+  HeapRegion**  _regions;
+  uint          _num_regions;
+
+  // 空闲链表，按 hrm_index 升序
+  Mutex         _lock;
+  HeapRegion*   _free_head;
+  HeapRegion*   _free_tail;
+  uint          _num_free;
+
+  void lock();
+  void unlock();
+
+  void remove_from_free_list(HeapRegion* hr);
+
+ public:
+  // [bottom, bottom + num_regions * GrainWords) 必须已经预留
+  HeapRegionManager(HeapWord* bottom, uint num_regions);
+  ~HeapRegionManager();
+
+  uint        num_regions() const      { return _num_regions; }
+  uint        num_free_regions() const { return _num_free; }
+  HeapRegion* at(uint index) const     { return _regions[index]; }
+
+  bool is_in_reserved(const void* p) const {
+    return (const HeapWord*)p >= _heap_bottom && (const HeapWord*)p < _heap_end;
+  }
+
+  // p 所在的 region（p 必须在堆内）
+  HeapRegion* addr_to_region(const void* p) const {
+    return _regions[((uintptr_t)p - (uintptr_t)_heap_bottom) >> HeapRegion::LogOfHRGrainBytes];
+  }
+
+  // 取下标最小的空闲 region；没有时返回 nullptr
+  HeapRegion* allocate_free_region();
+
+  // 取 num 个下标连续的空闲 region，返回第一个；找不到返回 nullptr
+  HeapRegion* allocate_free_regions_starting_at_lowest(uint num);
+
+  // 归还（region 已经 set_free）
+  void insert_into_free_list(HeapRegion* hr);
+
+  void print_on(outputStream* st) const;
+};
+
+#endif // MY_JVM_GC_G1_HEAPREGIONMANAGER_HPP
@@ -0,0 +1,49 @@
+/*
+ * my_jvm - GC utilities
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/gc/shared/gcUtil.hpp
+ * 只保留 AdaptiveWeightedAverage：指数加权平均，前几个样本权重更大，
+ * 让平均值尽快离开初始值。
+ */
+
+#ifndef MY_JVM_GC_SHARED_GCUTIL_HPP
+#define MY_JVM_GC_SHARED_GCUTIL_HPP
+
+#include "utilities/globalDefinitions.hpp"
+
+class AdaptiveWeightedAverage {
+ private:
+  float    _average;        // 当前平均值
+  unsigned _sample_count;   // 已有样本数（到 OLD_THRESHOLD 为止）
+  unsigned _weight;         // 新样本的权重（百分比）
+  float    _last_sample;
+
+  enum { OLD_THRESHOLD = 100 };
+
+  // 样本少时用 100 / 样本数 作为权重，不低于 _weight
+  unsigned compute_adaptive_weight() const {
+    unsigned count_weight = (_sample_count < OLD_THRESHOLD) ? 100 / _sample_count : 0;
+    return MAX2(_weight, count_weight);
+  }
+
+ public:
+  explicit AdaptiveWeightedAverage(unsigned weight, float avg = 0.0f)
+    : _average(avg), _sample_count(0), _weight(weight), _last_sample(0.0f) {}
+
+  void sample(float new_sample) {
+    if (_sample_count < OLD_THRESHOLD) {
+      _sample_count++;
+    }
+    unsigned w = compute_adaptive_weight();
+    _average = ((100.0f - w) * _average + w * new_sample) / 100.0f;
+    _last_sample = new_sample;
+  }
+
+  float    average() const      { return _average; }
+  float    last_sample() const  { return _last_sample; }
+  unsigned sample_count() const { return _sample_count; }
+  unsigned weight() const       { return _weight; }
+  void     set_weight(unsigned w) { _weight = w; }
+};
+
+#endif // MY_JVM_GC_SHARED_GCUTIL_HPP
@@ -0,0 +1,122 @@
+/*
+ * my_jvm - Thread-local allocation buffer implementation
+ */
+
+#include "gc/shared/threadLocalAllocBuffer.hpp"
+#include "gc/g1/g1CollectedHeap.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/ostream.hpp"
+
+ThreadLocalAllocBuffer::ThreadLocalAllocBuffer()
+  : _start(nullptr), _top(nullptr), _end(nullptr),
+    _desired_size(0), _refill_waste_limit(0),
+    _number_of_refills(0), _slow_allocations(0), _refill_waste(0), _retired_allocated(0),
+    _sample_epoch(0), _allocated_at_sample(0),
+    _allocation_fraction((unsigned)TLABAllocationWeight) {}
+
+size_t ThreadLocalAllocBuffer::min_size() {
+  return align_up(MinTLABSize, (size_t)HeapWordSize) / HeapWordSize;
+}
+
+size_t ThreadLocalAllocBuffer::max_size() {
+  // 不超过 humongous 阈值，TLAB 才能从普通 eden region 里切出来
+  return G1CollectedHeap::heap()->humongous_threshold_words();
+}
+
+void ThreadLocalAllocBuffer::set_desired_size(size_t words) {
+  _desired_size = MIN2(MAX2(words, min_size()), max_size());
+  _refill_waste_limit = _desired_size / TLABRefillWasteFraction;
+}
+
+// 第一次 refill 前确定初始大小。
+// 参考：threadLocalAllocBuffer.cpp initial_desired_size —— 还不知道线程的分配比例，
+// 假设 8 个线程平分 eden
+void ThreadLocalAllocBuffer::initialize() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  const float initial_fraction = 1.0f / 8;
+  size_t init_size;
+  if (TLABSize > 0) {
+    init_size = align_up(TLABSize, (size_t)HeapWordSize) / HeapWordSize;
+  } else {
+    init_size = (size_t)(initial_fraction * g1h->tlab_capacity_words() / TargetRefills);
+  }
+  _allocation_fraction = AdaptiveWeightedAverage((unsigned)TLABAllocationWeight, initial_fraction);
+  set_desired_size(init_size);
+  _sample_epoch = g1h->allocation_epoch();
+  _allocated_at_sample = allocated_words();
+}
+
+void ThreadLocalAllocBuffer::fill(HeapWord* start, size_t word_size) {
+  _number_of_refills++;
+  _start = start;
+  _top   = start;
+  _end   = start + word_size;
+}
+
+void ThreadLocalAllocBuffer::retire() {
+  if (_end != nullptr) {
+    // OpenJDK 在这里用填充对象盖住剩余空间保持堆可解析，这里还没有堆遍历，只记账
+    _refill_waste += free();
+    _retired_allocated += used();
+    _start = _top = _end = nullptr;
+  }
+}
+
+// 参考：threadLocalAllocBuffer.cpp accumulate_statistics / resize
+void ThreadLocalAllocBuffer::sample_and_resize() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  uint64_t epoch = g1h->allocation_epoch();
+  if (epoch == _sample_epoch) {
+    return;
+  }
+  // 这个线程在经过的几个周期里分配的量占 eden 的比例
+  size_t allocated = allocated_words() - _allocated_at_sample;
+  double capacity = (double)g1h->tlab_capacity_words() * (double)(epoch - _sample_epoch);
+  _allocation_fraction.sample((float)MIN2(allocated / capacity, 1.0));
+  _sample_epoch = epoch;
+  _allocated_at_sample = allocated_words();
+
+  size_t new_size = (size_t)(_allocation_fraction.average() * g1h->tlab_capacity_words() / TargetRefills);
+  set_desired_size(new_size);
+}
+
+HeapWord* ThreadLocalAllocBuffer::allocate_slow(size_t word_size) {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  if (_desired_size == 0) {
+    initialize();
+  }
+  // 比 TLAB 上限还大的对象（humongous）直接在堆里分配，不动当前 TLAB
+  if (word_size > max_size()) {
+    return nullptr;
+  }
+
+  // 剩余空间还多：保留 TLAB，这个对象在 TLAB 外分配，并稍微放宽限制，
+  // 避免一直有大对象时永远不 refill
+  if (free() > _refill_waste_limit) {
+    _refill_waste_limit += TLABWasteIncrement;
+    _slow_allocations++;
+    return nullptr;
+  }
+
+  retire();
+  if (ResizeTLAB) {
+    sample_and_resize();
+  }
+
+  size_t new_size = MIN2(_desired_size + word_size, max_size());
+  size_t actual_size = 0;
+  HeapWord* start = g1h->allocate_new_tlab(word_size, new_size, &actual_size);
+  if (start == nullptr) {
+    return nullptr;
+  }
+  fill(start, actual_size);
+  return allocate(word_size);
+}
+
+void ThreadLocalAllocBuffer::print_stats(outputStream* st, const char* tag) const {
+  st->print_cr("TLAB: %s desired=" SIZE_FORMAT "K refills=" SIZE_FORMAT " slow allocs=" SIZE_FORMAT
+               " waste=" SIZE_FORMAT "K allocated=" SIZE_FORMAT "K fraction=%.3f",
+               tag, _desired_size * HeapWordSize / 1024, _number_of_refills, _slow_allocations,
+               _refill_waste * HeapWordSize / 1024, allocated_words() * HeapWordSize / 1024,
+               (double)_allocation_fraction.average());
+}
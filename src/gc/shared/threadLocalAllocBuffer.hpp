@@ -0,0 +1,94 @@
+/*
+ * my_jvm - Thread-local allocation buffer
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/gc/shared/threadLocalAllocBuffer.hpp
+ * 每个线程从当前 eden region 取一段 [start, end)，对象在里面 bump 分配：
+ * 快速路径只有一次比较和一次加法，不需要同步。
+ *
+ * 大小调整（ResizeTLAB）：
+ *   OpenJDK 在每次 GC 时按线程占 eden 分配量的比例（allocation fraction）调整，
+ *   desired_size = fraction * eden 容量 / 目标 refill 次数。
+ *   这里还没有 GC，用 "eden 分配完一个 young 大小" 作为一个采样周期，
+ *   线程在 refill 时发现周期变了就采样一次。
+ */
+
+#ifndef MY_JVM_GC_SHARED_THREADLOCALALLOCBUFFER_HPP
+#define MY_JVM_GC_SHARED_THREADLOCALALLOCBUFFER_HPP
+
+#include "gc/shared/gcUtil.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include "utilities/macros.hpp"
+
+class outputStream;
+
+class ThreadLocalAllocBuffer {
+ private:
+  HeapWord* _start;                 // TLAB 起点
+  HeapWord* _top;                   // 下一次分配的位置
+  HeapWord* _end;                   // TLAB 终点
+
+  size_t    _desired_size;          // 下次 refill 的大小（字）
+  size_t    _refill_waste_limit;    // 剩余空间不超过它时才丢弃当前 TLAB（字）
+
+  // 统计
+  size_t    _number_of_refills;
+  size_t    _slow_allocations;      // 没有丢弃 TLAB、直接在堆里分配的次数
+  size_t    _refill_waste;          // 丢弃 TLAB 时浪费的空间（字）
+  size_t    _retired_allocated;     // 已丢弃的 TLAB 中实际分配出去的空间（字）
+
+  // 大小调整
+  uint64_t  _sample_epoch;          // 上次采样时堆的分配周期
+  size_t    _allocated_at_sample;   // 上次采样时的 allocated_words()
+  AdaptiveWeightedAverage _allocation_fraction;
+
+  enum { TargetRefills = 50 };      // 每个采样周期期望的 refill 次数
+
+  void   initialize();
+  void   fill(HeapWord* start, size_t word_size);
+  void   sample_and_resize();
+  void   set_desired_size(size_t words);
+
+ public:
+  ThreadLocalAllocBuffer();
+
+  // TLAB 大小的上下限（字）
+  static size_t min_size();
+  static size_t max_size();
+
+  HeapWord* start() const { return _start; }
+  HeapWord* top() const   { return _top; }
+  HeapWord* end() const   { return _end; }
+
+  size_t free() const     { return pointer_delta(_end, _top); }
+  size_t used() const     { return pointer_delta(_top, _start); }
+
+  // 快速路径：放不下返回 nullptr
+  HeapWord* allocate(size_t word_size) {
+    HeapWord* obj = _top;
+    if (MY_JVM_LIKELY(pointer_delta(_end, obj) >= word_size)) {
+      _top = obj + word_size;
+      return obj;
+    }
+    return nullptr;
+  }
+
+  // 慢速路径：剩余空间少时丢弃当前 TLAB 并从堆里 refill 后分配；
+  // 剩余空间还多（或对象比 TLAB 上限还大）时返回 nullptr，由调用方在 TLAB 外分配
+  HeapWord* allocate_slow(size_t word_size);
+
+  // 丢弃当前 TLAB（线程退出时）
+  void retire();
+
+  // 统计
+  size_t desired_size() const       { return _desired_size; }
+  size_t refill_waste_limit() const { return _refill_waste_limit; }
+  size_t number_of_refills() const  { return _number_of_refills; }
+  size_t slow_allocations() const   { return _slow_allocations; }
+  size_t refill_waste() const       { return _refill_waste; }
+  size_t allocated_words() const    { return _retired_allocated + used(); }
+  float  allocation_fraction() const { return _allocation_fraction.average(); }
+
+  void print_stats(outputStream* st, const char* tag) const;
+};
+
+#endif // MY_JVM_GC_SHARED_THREADLOCALALLOCBUFFER_HPP
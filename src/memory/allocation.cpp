@@ -4,6 +4,56 @@
 
 #include "memory/allocation.hpp"
 #include "memory/resourceArea.hpp"
+#include "memory/slabAllocator.hpp"
+#include "runtime/globals.hpp"
+#include "services/memTracker.hpp"
+#include "utilities/nativeCallStack.hpp"
+
+// ========== 堆分配 ==========
+// 参考 OpenJDK 11 allocation.cpp 的 AllocateHeap 与 os::malloc / os::free
+
+// 小块走 SlabAllocator，大块或 slab 空间用完时走 malloc；释放时按地址区分。
+// NMT summary 下 slab 块不带 header，只有 malloc 的块带
+
+static_assert(SlabAllocator::MaxBlockSize >= 1024 + sizeof(MallocHeader),
+              "1K requests must stay in the slab allocator with NMT detail");
+
+char* AllocateHeap(size_t size, MEMFLAGS flags, AllocFailType alloc_failmode) {
+  NMT_TrackingLevel level = MemTracker::tracking_level();
+
+  if (UseSlabAllocator) {
+    size_t total = size + MemTracker::slab_header_size(level);
+    if (total <= SlabAllocator::MaxBlockSize) {
+      void* ptr = SlabAllocator::allocate(total, flags);
+      if (ptr != nullptr) {
+        return (char*)MemTracker::record_slab_malloc(ptr, size, flags, CALLER_PC, level);
+      }
+    }
+  }
+
+  void* ptr = std::malloc(size + MemTracker::malloc_header_size(level));
+  if (ptr == nullptr) {
+    if (alloc_failmode == AllocFailStrategy::EXIT_OOM) {
+      fprintf(stderr, "Out of memory: requested %zu bytes\n", size);
+      std::abort();
+    }
+    return nullptr;
+  }
+  return (char*)MemTracker::record_malloc(ptr, size, flags, CALLER_PC, level);
+}
+
+void FreeHeap(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  NMT_TrackingLevel level = MemTracker::tracking_level();
+  // detail 模式下 p 在 header 之后，仍在同一个块里
+  if (SlabAllocator::contains(p)) {
+    SlabAllocator::free(MemTracker::record_slab_free(p, level));
+  } else {
+    std::free(MemTracker::record_free(p, level));
+  }
+}
 
 // ========== ResourceObj ==========
 
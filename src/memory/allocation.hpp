@@ -51,20 +51,12 @@ public:
 typedef AllocFailStrategy::AllocFailEnum AllocFailType;
 
 // ========== 堆分配函数 ==========
+// 实现在 allocation.cpp：经过 Native Memory Tracking 记录后再调用 malloc/free
 
-inline char* AllocateHeap(size_t size, MEMFLAGS flags, 
-                         AllocFailType alloc_failmode = AllocFailStrategy::EXIT_OOM) {
-  char* p = (char*)std::malloc(size);
-  if (p == nullptr && alloc_failmode == AllocFailStrategy::EXIT_OOM) {
-    fprintf(stderr, "Out of memory: requested %zu bytes\n", size);
-    std::abort();
-  }
-  return p;
-}
+char* AllocateHeap(size_t size, MEMFLAGS flags,
+                   AllocFailType alloc_failmode = AllocFailStrategy::EXIT_OOM);
 
-inline void FreeHeap(void* p) {
-  std::free(p);
-}
+void FreeHeap(void* p);
 
 // ========== CHeapObj - C 堆分配对象基类 ==========
 
@@ -5,7 +5,281 @@
  */
 
 #include "memory/arena.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/os.hpp"
+#include "services/memTracker.hpp"
+#include "utilities/ostream.hpp"
 #include <cstring>
+#include <ctime>
+
+// ========== ChunkPool 实现 ==========
+
+ChunkPool ChunkPool::_large_pool (Chunk::size        + ARENA_ALIGN(sizeof(Chunk)));
+ChunkPool ChunkPool::_medium_pool(Chunk::medium_size + ARENA_ALIGN(sizeof(Chunk)));
+ChunkPool ChunkPool::_small_pool (Chunk::init_size   + ARENA_ALIGN(sizeof(Chunk)));
+ChunkPool ChunkPool::_tiny_pool  (Chunk::tiny_size   + ARENA_ALIGN(sizeof(Chunk)));
+
+void ChunkPool::lock() {
+  _lock.lock();
+}
+
+void ChunkPool::unlock() {
+  _lock.unlock();
+}
+
+Chunk* ChunkPool::get_first() {
+  Chunk* c = _first;
+  if (_first != nullptr) {
+    _first = _first->next();
+    _num_chunks--;
+  }
+  return c;
+}
+
+void* ChunkPool::allocate(size_t bytes, AllocFailType alloc_failmode) {
+  assert(bytes == _size, "bad size");
+  void* p = nullptr;
+  lock();
+  _num_used++;
+  p = get_first();
+  if (p != nullptr) {
+    _hits++;
+  } else {
+    _misses++;
+  }
+  unlock();
+
+  if (p == nullptr) {
+    p = AllocateHeap(bytes, mtChunk, AllocFailStrategy::RETURN_NULL);
+  }
+  if (p == nullptr) {
+    lock();
+    _num_used--;
+    unlock();
+    if (alloc_failmode == AllocFailStrategy::EXIT_OOM) {
+      fprintf(stderr, "ChunkPool::allocate out of memory\n");
+      std::abort();
+    }
+  }
+  return p;
+}
+
+void ChunkPool::free(Chunk* chunk) {
+  assert(chunk->length() + Chunk::aligned_overhead_size() == _size, "bad size");
+  lock();
+  _num_used--;
+  chunk->set_next(_first);
+  _first = chunk;
+  _num_chunks++;
+  unlock();
+}
+
+void ChunkPool::free_all_but(size_t n) {
+  Chunk* cur = nullptr;
+  Chunk* next;
+  size_t freed = 0;
+
+  // 持锁摘下多余的链表尾，锁外再还给 OS
+  lock();
+  if (_num_chunks > n) {
+    if (n == 0) {
+      cur = _first;
+      _first = nullptr;
+    } else {
+      Chunk* last = _first;
+      for (size_t i = 0; i < n - 1; i++) {
+        last = last->next();
+      }
+      cur = last->next();
+      last->set_next(nullptr);
+    }
+    _num_chunks = n;
+  }
+  unlock();
+
+  while (cur != nullptr) {
+    next = cur->next();
+    FreeHeap(cur);
+    freed++;
+    cur = next;
+  }
+
+  if (freed > 0) {
+    lock();
+    _returned += freed;
+    unlock();
+  }
+}
+
+ChunkPool* ChunkPool::pool_for(size_t length) {
+  switch (length) {
+    case Chunk::size:        return large_pool();
+    case Chunk::medium_size: return medium_pool();
+    case Chunk::init_size:   return small_pool();
+    case Chunk::tiny_size:   return tiny_pool();
+    default:                 return nullptr;
+  }
+}
+
+void ChunkPool::clean() {
+  large_pool()->free_all_but(ChunkPoolCleaner::BlocksToKeep);
+  medium_pool()->free_all_but(ChunkPoolCleaner::BlocksToKeep);
+  small_pool()->free_all_but(ChunkPoolCleaner::BlocksToKeep);
+  tiny_pool()->free_all_but(ChunkPoolCleaner::BlocksToKeep);
+}
+
+void ChunkPool::print_statistics(outputStream* st) {
+  static const char* names[] = { "tiny", "small", "medium", "large" };
+  ChunkPool* pools[] = { tiny_pool(), small_pool(), medium_pool(), large_pool() };
+  st->print_cr("ChunkPool statistics:");
+  for (int i = 0; i < 4; i++) {
+    ChunkPool* pool = pools[i];
+    size_t total = pool->hits() + pool->misses();
+    double hit_rate = total == 0 ? 0.0 : (double)pool->hits() * 100.0 / (double)total;
+    st->print_cr("  %-6s (" SIZE_FORMAT " bytes): free=" SIZE_FORMAT " used=" SIZE_FORMAT
+                 " hits=" SIZE_FORMAT " misses=" SIZE_FORMAT " hit_rate=%.1f%% returned=" SIZE_FORMAT,
+                 names[i], pool->size(), pool->num_chunks(), pool->num_used(),
+                 pool->hits(), pool->misses(), hit_rate, pool->returned());
+  }
+}
+
+// ========== ChunkPoolCleaner 实现 ==========
+
+static jint   _cleaner_ticks = 0;
+static jlong  _cleaner_last_ms = 0;
+
+static jlong cleaner_current_ms() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (jlong)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void ChunkPoolCleaner::tick() {
+  if ((Atomic::fetch_and_add(&_cleaner_ticks, 1, memory_order_relaxed) % CheckInterval) != 0) {
+    return;
+  }
+  jlong now = cleaner_current_ms();
+  jlong last = _cleaner_last_ms;
+  if (now - last >= CleaningInterval) {
+    _cleaner_last_ms = now;
+    ChunkPool::clean();
+  }
+}
+
+// ========== Chunk 实现 ==========
+
+void* Chunk::operator new(size_t requested_size, AllocFailType alloc_failmode, size_t length) throw() {
+  // 实际分配 = 对齐后的 Chunk 头 + 数据区
+  assert(ARENA_ALIGN(requested_size) == aligned_overhead_size(), "Bad alignment");
+  size_t bytes = ARENA_ALIGN(requested_size) + length;
+  ChunkPool* pool = ChunkPool::pool_for(length);
+  if (pool != nullptr) {
+    return pool->allocate(bytes, alloc_failmode);
+  }
+  void* p = AllocateHeap(bytes, mtChunk, AllocFailStrategy::RETURN_NULL);
+  if (p == nullptr && alloc_failmode == AllocFailStrategy::EXIT_OOM) {
+    fprintf(stderr, "Chunk::new out of memory\n");
+    std::abort();
+  }
+  return p;
+}
+
+Chunk* Chunk::allocate_mapped(size_t length) {
+  size_t page_size = os::large_page_size();
+  size_t bytes = align_up(aligned_overhead_size() + length, page_size);
+  char* base = os::reserve_memory_aligned(bytes, page_size);
+  if (base == nullptr) {
+    return nullptr;
+  }
+  os::request_huge_pages(base, bytes);
+  // 类内的 operator new 会遮住全局的 placement new
+  Chunk* c = ::new (base) Chunk(bytes - aligned_overhead_size());
+  c->_next = (Chunk*)(uintptr_t)mapped_tag;
+  return c;
+}
+
+void Chunk::operator delete(void* p) {
+  Chunk* c = (Chunk*)p;
+  if (c->is_mapped()) {
+    os::release_memory((char*)c, aligned_overhead_size() + c->length());
+    return;
+  }
+  ChunkPool* pool = ChunkPool::pool_for(c->length());
+  if (pool != nullptr) {
+    pool->free(c);
+    ChunkPoolCleaner::tick();
+  } else {
+    FreeHeap(c);
+  }
+}
+
+void Chunk::chop() {
+  Chunk* k = this;
+  while (k != nullptr) {
+    Chunk* tmp = k->next();
+    delete k;
+    k = tmp;
+  }
+}
+
+void Chunk::next_chop() {
+  if (next() != nullptr) {
+    next()->chop();
+  }
+  set_next(nullptr);
+}
+
+// ========== Arena 增长策略 ==========
+
+// 默认普通扩展一律用 Chunk::size：释放后回到 ChunkPool，下一个 Arena 直接复用。
+// 翻倍出来的大 Chunk 不进池，free 后 glibc 会把内存还给 OS，反复创建销毁的
+// Arena 每次都要重新缺页（见 microbench arena_growth），所以翻倍增长只给
+// 长期存活的 Arena 按需用 set_growth_policy 打开
+#define DEFAULT_ARENA_GROWTH    { Chunk::size, Chunk::size, Chunk::medium_size, false }
+// 长期存活、可能涨到几百 M 的类元数据和编译器 Arena：
+// 打开 -XX:+UseTransparentHugePages 后 Chunk 改用 2M 大页，减少 TLB 缺失
+#define HUGE_PAGE_ARENA_GROWTH  { Chunk::size, Chunk::size, Chunk::medium_size, true  }
+
+static ArenaGrowthPolicy _growth_policies[] = {
+  DEFAULT_ARENA_GROWTH,     // mtJavaHeap
+  HUGE_PAGE_ARENA_GROWTH,   // mtClass
+  DEFAULT_ARENA_GROWTH,     // mtThread
+  DEFAULT_ARENA_GROWTH,     // mtThreadStack
+  DEFAULT_ARENA_GROWTH,     // mtCode
+  DEFAULT_ARENA_GROWTH,     // mtGC
+  HUGE_PAGE_ARENA_GROWTH,   // mtCompiler
+  DEFAULT_ARENA_GROWTH,     // mtInternal
+  DEFAULT_ARENA_GROWTH,     // mtOther
+  DEFAULT_ARENA_GROWTH,     // mtSymbol
+  DEFAULT_ARENA_GROWTH,     // mtNMT
+  DEFAULT_ARENA_GROWTH,     // mtClassShared
+  DEFAULT_ARENA_GROWTH,     // mtChunk
+  DEFAULT_ARENA_GROWTH,     // mtTest
+  DEFAULT_ARENA_GROWTH,     // mtTracing
+  DEFAULT_ARENA_GROWTH,     // mtLogging
+  DEFAULT_ARENA_GROWTH,     // mtArguments
+  DEFAULT_ARENA_GROWTH,     // mtModule
+  DEFAULT_ARENA_GROWTH,     // mtSynchronizer
+  DEFAULT_ARENA_GROWTH,     // mtSafepoint
+  DEFAULT_ARENA_GROWTH,     // mtNone
+};
+
+#undef DEFAULT_ARENA_GROWTH
+#undef HUGE_PAGE_ARENA_GROWTH
+
+static_assert(sizeof(_growth_policies) / sizeof(_growth_policies[0]) == mt_number_of_types,
+              "arena growth policies out of sync with MemoryType");
+
+const ArenaGrowthPolicy& Arena::growth_policy(MEMFLAGS flags) {
+  return _growth_policies[flags];
+}
+
+void Arena::set_growth_policy(MEMFLAGS flags, const ArenaGrowthPolicy& policy) {
+  guarantee(policy.initial_chunk_size >= Chunk::tiny_size &&
+            policy.initial_chunk_size <= policy.max_chunk_size, "bad arena growth policy");
+  _growth_policies[flags] = policy;
+}
 
 // ========== Arena 实现 ==========
 
@@ -13,68 +287,102 @@ Arena::Arena(MEMFLAGS memflag)
   : _flags(memflag), 
     _first(nullptr), 
     _chunk(nullptr),
+    _last(nullptr),
     _hwm(nullptr), 
     _max(nullptr),
-    _size_in_bytes(0) {
+    _size_in_bytes(0),
+    _prior_used(0),
+    _next_chunk_len(growth_policy(memflag).initial_chunk_size),
+    _index(nullptr),
+    _index_len(0),
+    _index_max(0) {
+  MemTracker::record_new_arena(memflag);
 }
 
 Arena::Arena(MEMFLAGS memflag, size_t init_size)
   : _flags(memflag),
     _first(nullptr),
     _chunk(nullptr),
+    _last(nullptr),
     _hwm(nullptr),
     _max(nullptr),
-    _size_in_bytes(0) {
+    _size_in_bytes(0),
+    _prior_used(0),
+    _next_chunk_len(growth_policy(memflag).initial_chunk_size),
+    _index(nullptr),
+    _index_len(0),
+    _index_max(0) {
+  MemTracker::record_new_arena(memflag);
   // 预分配初始 Chunk
   if (init_size > 0) {
-    Chunk* k = new(init_size) Chunk(init_size);
-    _first = _chunk = k;
+    Chunk* k = new(AllocFailStrategy::EXIT_OOM, init_size) Chunk(init_size);
+    _first = _chunk = _last = k;
     _hwm = k->bottom();
     _max = k->top();
-    _size_in_bytes = init_size + Chunk::aligned_overhead_size();
+    set_size_in_bytes(init_size + Chunk::aligned_overhead_size());
   }
 }
 
 Arena::~Arena() {
   destruct_contents();
+  MemTracker::record_arena_free(_flags);
 }
 
 void Arena::destruct_contents() {
-  // 释放所有 Chunk
-  Chunk* k = _first;
-  while (k != nullptr) {
-    Chunk* next = k->next();
-    delete k;
-    k = next;
-  }
+  // 释放所有 Chunk（标准大小的回到 ChunkPool）
+  free_chunks_after(nullptr);
+  index_free();
   reset();
 }
 
-void* Arena::grow(size_t x, AllocFailType alloc_failmode) {
-  // 计算新 Chunk 大小：至少是请求大小的两倍，或者默认大小
-  size_t len = x * 2;
-  if (len < Chunk::size) {
-    len = Chunk::size;
-  }
-  
-  // 分配新 Chunk
-  Chunk* k = new(len) Chunk(len);
-  if (k == nullptr) {
-    if (alloc_failmode == AllocFailStrategy::RETURN_NULL) {
-      return nullptr;
+Chunk* Arena::allocate_chunk(size_t len, bool try_mapped, AllocFailType alloc_failmode) {
+  if (try_mapped && UseTransparentHugePages && os::can_use_transparent_huge_pages()) {
+    Chunk* k = Chunk::allocate_mapped(len);
+    if (k != nullptr) {
+      return k;
     }
+  }
+  Chunk* k = new(alloc_failmode, len) Chunk(len);
+  if (k == nullptr && alloc_failmode == AllocFailStrategy::EXIT_OOM) {
     fprintf(stderr, "Arena::grow out of memory\n");
     std::abort();
   }
-  
-  _size_in_bytes += len + Chunk::aligned_overhead_size();
-  
-  // 链接到 Chunk 链表
-  if (_first == nullptr) {
-    _first = k;
-  } else {
-    _chunk->set_next(k);
+  return k;
+}
+
+void* Arena::grow(size_t x, AllocFailType alloc_failmode) {
+  const ArenaGrowthPolicy& policy = growth_policy(_flags);
+
+  // 大请求：独立 Chunk 挂到链表尾部，当前 Chunk 和 _hwm 不变，
+  // 之后的小分配继续用当前 Chunk 剩余的空间
+  if (_chunk != nullptr && policy.large_threshold != 0 && x >= policy.large_threshold) {
+    bool try_mapped = policy.use_huge_pages && x >= os::large_page_size();
+    Chunk* k = allocate_chunk(x, try_mapped, alloc_failmode);
+    if (k == nullptr) {
+      return nullptr;
+    }
+    link_chunk(k);
+    _prior_used += x;
+    return k->bottom();
+  }
+
+  // 计算新 Chunk 大小：至少是请求大小的两倍，或者按策略增长的大小
+  size_t len = MAX2(x * 2, _next_chunk_len);
+  Chunk* k = allocate_chunk(len, policy.use_huge_pages, alloc_failmode);
+  if (k == nullptr) {
+    return nullptr;
+  }
+  if (_next_chunk_len < policy.max_chunk_size) {
+    // 保持 2 的幂减 slack，让 malloc 的总大小不越过 2 的幂
+    _next_chunk_len = MIN2((_next_chunk_len + Chunk::slack) * 2 - Chunk::slack,
+                           policy.max_chunk_size);
+  }
+
+  // 旧的当前 Chunk 只计入实际用到的部分，剩余空间从此不再使用
+  if (_chunk != nullptr) {
+    _prior_used += (size_t)(_hwm - _chunk->bottom());
   }
+  link_chunk(k);
   _chunk = k;
   _hwm = k->bottom();
   _max = k->top();
@@ -85,6 +393,23 @@ void* Arena::grow(size_t x, AllocFailType alloc_failmode) {
   return old;
 }
 
+void Arena::link_chunk(Chunk* k) {
+  set_size_in_bytes(size_in_bytes() + k->length() + Chunk::aligned_overhead_size());
+  if (_first == nullptr) {
+    _first = k;
+    if (_index != nullptr) {
+      // 整个链表被释放过（空 Arena 上的 ResourceMark），保留的索引从头登记
+      assert(_index_len == 0, "index must be empty");
+      _index[0] = k;
+      _index_len = 1;
+    }
+  } else {
+    _last->set_next(k);
+    index_add(k);
+  }
+  _last = k;
+}
+
 void* Arena::Arealloc(void* old_ptr, size_t old_size, size_t new_size,
                       AllocFailType alloc_failmode) {
   if (old_ptr == nullptr) {
@@ -100,9 +425,7 @@ void* Arena::Arealloc(void* old_ptr, size_t old_size, size_t new_size,
   }
   
   // 检查是否可以原地扩展（是最后分配的块）
-  if (((char*)old_ptr) + old_size == _hwm && 
-      _hwm + (new_size - old_size) <= _max) {
-    _hwm += (new_size - old_size);
+  if (Agrow(old_ptr, old_size, new_size)) {
     return old_ptr;
   }
   
@@ -121,23 +444,150 @@ void* Arena::Arealloc(void* old_ptr, size_t old_size, size_t new_size,
   return new_ptr;
 }
 
-size_t Arena::used() const {
-  size_t sum = 0;
-  for (Chunk* k = _first; k != nullptr; k = k->next()) {
-    if (k == _chunk) {
-      sum += _hwm - k->bottom();
+void Arena::set_size_in_bytes(size_t size) {
+  if (_size_in_bytes != size) {
+    long delta = (long)(size - _size_in_bytes);
+    _size_in_bytes = size;
+    MemTracker::record_arena_size_change(delta, _flags);
+  }
+}
+
+// ========== Chunk 地址索引 ==========
+
+// 返回第一个 bottom() > p 的位置
+static int index_upper_bound(Chunk** index, int len, const char* p) {
+  int lo = 0;
+  int hi = len;
+  while (lo < hi) {
+    int mid = (lo + hi) >> 1;
+    if (index[mid]->bottom() <= p) {
+      lo = mid + 1;
     } else {
-      sum += k->length();
+      hi = mid;
     }
   }
-  return sum;
+  return lo;
 }
 
-bool Arena::contains(const void* ptr) const {
-  for (Chunk* k = _first; k != nullptr; k = k->next()) {
-    if (k->contains((char*)ptr)) {
-      return true;
+void Arena::index_add(Chunk* k) {
+  if (_index == nullptr) {
+    // 第二个 Chunk 加入时才建立索引，先登记第一个
+    _index_max = 8;
+    _index = (Chunk**)AllocateHeap(_index_max * sizeof(Chunk*), _flags);
+    _index[0] = _first;
+    _index_len = 1;
+  }
+  if (_index_len == _index_max) {
+    int new_max = _index_max * 2;
+    Chunk** new_index = (Chunk**)AllocateHeap(new_max * sizeof(Chunk*), _flags);
+    memcpy(new_index, _index, _index_len * sizeof(Chunk*));
+    FreeHeap(_index);
+    _index = new_index;
+    _index_max = new_max;
+  }
+  int pos = index_upper_bound(_index, _index_len, k->bottom());
+  memmove(&_index[pos + 1], &_index[pos], (_index_len - pos) * sizeof(Chunk*));
+  _index[pos] = k;
+  _index_len++;
+}
+
+void Arena::index_remove(Chunk* k) {
+  int pos = index_upper_bound(_index, _index_len, k->bottom()) - 1;
+  assert(pos >= 0 && _index[pos] == k, "chunk not in index");
+  memmove(&_index[pos], &_index[pos + 1], (_index_len - pos - 1) * sizeof(Chunk*));
+  _index_len--;
+}
+
+void Arena::index_free() {
+  if (_index != nullptr) {
+    FreeHeap(_index);
+    _index = nullptr;
+  }
+  _index_len = _index_max = 0;
+}
+
+void Arena::free_chunks_after(Chunk* k) {
+  Chunk* victims = (k == nullptr) ? _first : k->next();
+  if (victims == nullptr) {
+    return;
+  }
+
+  if (_index != nullptr) {
+    if (k == nullptr) {
+      _index_len = 0;
+    } else {
+      // 释放得少时逐个删除；释放得多时用幸存的 Chunk 重建索引
+      enum { RemoveOneByOneLimit = 8 };
+      int nvictims = 0;
+      for (Chunk* c = victims; c != nullptr && nvictims <= RemoveOneByOneLimit; c = c->next()) {
+        nvictims++;
+      }
+      if (nvictims <= RemoveOneByOneLimit) {
+        for (Chunk* c = victims; c != nullptr; c = c->next()) {
+          index_remove(c);
+        }
+      } else {
+        _index_len = 0;
+        for (Chunk* c = _first; c != victims; c = c->next()) {
+          int pos = index_upper_bound(_index, _index_len, c->bottom());
+          memmove(&_index[pos + 1], &_index[pos], (_index_len - pos) * sizeof(Chunk*));
+          _index[pos] = c;
+          _index_len++;
+        }
+      }
+    }
+  }
+
+  if (k == nullptr) {
+    _first->chop();
+    _first = nullptr;
+  } else {
+    k->next_chop();
+  }
+  _last = k;
+}
+
+void Arena::statistics(ArenaStatistics* st) const {
+  st->chunks = 0;
+  st->largest_chunk = 0;
+  st->mapped_chunks = 0;
+  st->mapped_bytes = 0;
+  st->huge_page_bytes = 0;
+  for (Chunk* c = _first; c != nullptr; c = c->next()) {
+    st->chunks++;
+    st->largest_chunk = MAX2(st->largest_chunk, c->length());
+    if (c->is_mapped()) {
+      size_t bytes = Chunk::aligned_overhead_size() + c->length();
+      st->mapped_chunks++;
+      st->mapped_bytes += bytes;
+      st->huge_page_bytes += os::anon_huge_page_bytes((char*)c, bytes);
     }
   }
-  return false;
+  st->size_in_bytes = _size_in_bytes;
+  st->used = used();
+}
+
+void ArenaStatistics::print_on(outputStream* st) const {
+  st->print_cr("chunks=" SIZE_FORMAT " largest=" SIZE_FORMAT " size=" SIZE_FORMAT
+               " used=" SIZE_FORMAT " wasted=" SIZE_FORMAT " (%.1f%%)",
+               chunks, largest_chunk, size_in_bytes, used, wasted(),
+               size_in_bytes == 0 ? 0.0 : 100.0 * wasted() / size_in_bytes);
+  if (mapped_chunks > 0) {
+    st->print_cr("mapped_chunks=" SIZE_FORMAT " mapped=" SIZE_FORMAT " huge_pages=" SIZE_FORMAT
+                 " coverage=%.1f%%",
+                 mapped_chunks, mapped_bytes, huge_page_bytes, 100.0 * huge_page_coverage());
+  }
+}
+
+bool Arena::contains(const void* ptr) const {
+  const char* p = (const char*)ptr;
+  // 快速路径：当前 Chunk
+  if (_chunk != nullptr && _chunk->contains((char*)p)) {
+    return true;
+  }
+  if (_index == nullptr) {
+    return _first != nullptr && _first->contains((char*)p);
+  }
+  int pos = index_upper_bound(_index, _index_len, p) - 1;
+  return pos >= 0 && _index[pos]->contains((char*)p);
 }
@@ -9,10 +9,13 @@
 #define MY_JVM_MEMORY_ARENA_HPP
 
 #include "memory/allocation.hpp"
-#include "utilities/globalDefinitions.hpp"
+#include "runtime/mutex.hpp"
 #include "utilities/debug.hpp"
+#include "utilities/globalDefinitions.hpp"
 #include <new>
 
+class outputStream;
+
 // ========== 对齐常量 ==========
 
 #define ARENA_AMALLOC_ALIGNMENT (2 * sizeof(void*))
@@ -24,9 +27,12 @@
 
 class Chunk : public CHeapObj<mtChunk> {
  private:
-  Chunk*       _next;     // 链表下一个 Chunk
+  Chunk*       _next;     // 链表下一个 Chunk，最低位标记本 Chunk 是否来自 mmap
   const size_t _len;      // 本 Chunk 数据区大小
 
+  // Chunk 至少 16 字节对齐，借 _next 的最低位做标记，不增加 Chunk 头的大小
+  enum { mapped_tag = 1 };
+
  public:
   // Chunk 大小常量
   enum {
@@ -42,12 +48,18 @@ class Chunk : public CHeapObj<mtChunk> {
   };
 
   Chunk(size_t length) : _next(nullptr), _len(length) {}
-  
-  void* operator new(size_t size, size_t length) {
-    return AllocateHeap(ARENA_ALIGN(sizeof(Chunk)) + length, mtChunk);
-  }
-  
-  void operator delete(void* p) { FreeHeap(p); }
+
+  // 标准大小（tiny/init/medium/size）的 Chunk 走 ChunkPool，其余直接 malloc
+  void* operator new(size_t size, AllocFailType alloc_failmode, size_t length) throw();
+  void  operator delete(void* p);
+
+  // 用大页对齐的 mmap 分配至少 length 字节数据区的 Chunk（整块映射向上取整到大页），
+  // 并请求透明大页。映射失败返回 nullptr，由调用方回退到 operator new
+  static Chunk* allocate_mapped(size_t length);
+
+  // 释放从本 Chunk 开始的整条链表 / 释放本 Chunk 之后的链表
+  void chop();
+  void next_chop();
 
   // 边界
   char* bottom() const { return ((char*)this) + ARENA_ALIGN(sizeof(Chunk)); }
@@ -55,12 +67,131 @@ class Chunk : public CHeapObj<mtChunk> {
   bool contains(char* p) const { return bottom() <= p && p <= top(); }
 
   size_t length() const   { return _len; }
-  Chunk* next() const     { return _next; }
-  void set_next(Chunk* n) { _next = n; }
+  Chunk* next() const     { return (Chunk*)((uintptr_t)_next & ~(uintptr_t)mapped_tag); }
+  void set_next(Chunk* n) { _next = (Chunk*)((uintptr_t)n | ((uintptr_t)_next & mapped_tag)); }
+  bool is_mapped() const  { return ((uintptr_t)_next & mapped_tag) != 0; }
 
   static size_t aligned_overhead_size() { return ARENA_ALIGN(sizeof(Chunk)); }
 };
 
+// ========== ChunkPool - Chunk 缓存池 ==========
+// 参考 OpenJDK 11 arena.cpp 中的 ChunkPool / ChunkPoolCleaner
+// 每种标准 Chunk 大小一个池，释放的 Chunk 挂到空闲链表上复用，
+// 避免 ResourceMark 作用域反复 malloc/free 32K 的 Chunk
+
+class ChunkPool {
+ private:
+  Chunk*        _first;        // 空闲链表头
+  size_t        _num_chunks;   // 池中空闲 Chunk 数
+  size_t        _num_used;     // 已借出的 Chunk 数
+  const size_t  _size;         // 每个 Chunk 的总字节数（含 Chunk 头）
+  SpinLock      _lock;         // 保护空闲链表
+
+  // 统计
+  size_t        _hits;         // 从池中取到 Chunk 的次数
+  size_t        _misses;       // 池空、回退到 malloc 的次数
+  size_t        _returned;     // 修剪时还给 OS 的 Chunk 数
+
+  // 四个静态池
+  static ChunkPool _large_pool;
+  static ChunkPool _medium_pool;
+  static ChunkPool _small_pool;
+  static ChunkPool _tiny_pool;
+
+  void lock();
+  void unlock();
+
+  // 取出空闲链表头（调用方持锁）
+  Chunk* get_first();
+
+ public:
+  constexpr ChunkPool(size_t size)
+    : _first(nullptr), _num_chunks(0), _num_used(0), _size(size), _lock(LockBase::leaf, "ChunkPool"),
+      _hits(0), _misses(0), _returned(0) {}
+
+  // 分配/归还一个 Chunk（bytes 必须等于池的大小）
+  void* allocate(size_t bytes, AllocFailType alloc_failmode);
+  void  free(Chunk* chunk);
+
+  // 只保留 n 个空闲 Chunk，其余还给 OS
+  void free_all_but(size_t n);
+
+  size_t size() const       { return _size; }
+  size_t num_chunks() const { return _num_chunks; }
+  size_t num_used() const   { return _num_used; }
+  size_t hits() const       { return _hits; }
+  size_t misses() const     { return _misses; }
+  size_t returned() const   { return _returned; }
+
+  static ChunkPool* large_pool()  { return &_large_pool; }
+  static ChunkPool* medium_pool() { return &_medium_pool; }
+  static ChunkPool* small_pool()  { return &_small_pool; }
+  static ChunkPool* tiny_pool()   { return &_tiny_pool; }
+
+  // 按 Chunk 数据区长度找对应的池，不是标准大小时返回 nullptr
+  static ChunkPool* pool_for(size_t length);
+
+  // 修剪所有池（对应 ChunkPoolCleaner::task）
+  static void clean();
+
+  static void print_statistics(outputStream* st);
+};
+
+// ========== ChunkPoolCleaner - 周期性修剪 ==========
+// OpenJDK 中是每 5 秒运行一次的 PeriodicTask。
+// 这里还没有 WatcherThread，改为在归还 Chunk 时按时间间隔顺带触发
+
+class ChunkPoolCleaner : AllStatic {
+ public:
+  enum {
+    CleaningInterval = 5000,   // 修剪间隔（毫秒）
+    BlocksToKeep     = 5,      // 每个池保留的空闲 Chunk 数
+    CheckInterval    = 64      // 每归还多少次 Chunk 检查一次时间
+  };
+
+  // 归还 Chunk 后调用，到期则执行 ChunkPool::clean()
+  static void tick();
+};
+
+// ========== ArenaGrowthPolicy - Chunk 增长策略 ==========
+// 每种 MEMFLAGS 一份，Arena 按自己的 _flags 查表：
+//  - 普通扩展时新 Chunk 从 initial_chunk_size 开始按 2 倍增长，直到 max_chunk_size。
+//    两者相等时就是固定大小（默认 Chunk::size，能命中 ChunkPool）
+//  - 不小于 large_threshold 的请求单独分配一个恰好大小的 Chunk 挂到链表尾部，
+//    当前 Chunk 不变，避免一次大请求丢掉当前 Chunk 剩余的空间。0 表示关闭
+//  - use_huge_pages：打开 -XX:+UseTransparentHugePages 且内核支持 THP 时，
+//    普通扩展的 Chunk 改用大页对齐的 mmap（大小向上取整到大页），
+//    独立 Chunk 只有不小于一个大页时才这样分配。THP 不可用或映射失败时照常 malloc
+
+struct ArenaGrowthPolicy {
+  size_t initial_chunk_size;
+  size_t max_chunk_size;
+  size_t large_threshold;
+  bool   use_huge_pages;
+};
+
+// ========== ArenaStatistics - Arena 统计 ==========
+
+struct ArenaStatistics {
+  size_t chunks;          // Chunk 数
+  size_t largest_chunk;   // 最大 Chunk 的数据区大小
+  size_t size_in_bytes;   // 总大小（含 Chunk 头）
+  size_t used;            // 已分配字节
+  size_t mapped_chunks;   // 来自 mmap 的 Chunk 数
+  size_t mapped_bytes;    // 来自 mmap 的 Chunk 总大小
+  size_t huge_page_bytes; // 其中实际由透明大页支撑的字节
+
+  // 大页覆盖率：Arena 总大小中由大页支撑的比例
+  double huge_page_coverage() const {
+    return size_in_bytes == 0 ? 0.0 : (double)huge_page_bytes / (double)size_in_bytes;
+  }
+
+  // 没有用来分配的字节：Chunk 头、换 Chunk 时丢下的尾部、当前 Chunk 的剩余空间
+  size_t wasted() const { return size_in_bytes - used; }
+
+  void print_on(outputStream* st) const;
+};
+
 // ========== Arena - 快速内存分配区 ==========
 
 class Arena : public CHeapObj<mtNone> {
@@ -68,13 +199,38 @@ class Arena : public CHeapObj<mtNone> {
   MEMFLAGS _flags;         // 内存类型标志
   Chunk*   _first;         // 第一个 Chunk
   Chunk*   _chunk;         // 当前 Chunk
+  Chunk*   _last;          // 链表尾。链表按分配先后排列，大请求的独立 Chunk 可能在 _chunk 之后
   char*    _hwm;           // 当前 Chunk 高水位（分配指针）
   char*    _max;           // 当前 Chunk 最大边界
   size_t   _size_in_bytes; // 总大小
+  size_t   _prior_used;    // 当前 Chunk 之外所有 Chunk 的已用字节
+  size_t   _next_chunk_len; // 下次普通扩展的 Chunk 大小（按增长策略翻倍）
+
+  // Chunk 地址索引：按 bottom() 升序排列，供 contains() 二分查找。
+  // 只有一个 Chunk 时不建索引，第二个 Chunk 加入时才分配。
+  // 释放全部 Chunk 后保留索引数组（长度为 0），下一个 Chunk 加入时重新登记
+  Chunk**  _index;
+  int      _index_len;
+  int      _index_max;
 
   // 扩展分配
   void* grow(size_t x, AllocFailType alloc_failmode = AllocFailStrategy::EXIT_OOM);
 
+  // 按增长策略分配一个 Chunk：try_mapped 时先尝试大页 mmap
+  Chunk* allocate_chunk(size_t len, bool try_mapped, AllocFailType alloc_failmode);
+
+  // 新 Chunk 挂到链表尾部，登记索引并计入总大小
+  void link_chunk(Chunk* k);
+
+  // 新 Chunk 加入链表时登记到索引
+  void index_add(Chunk* k);
+  // 从索引中删除一个 Chunk
+  void index_remove(Chunk* k);
+  void index_free();
+
+  // 释放 k 之后的所有 Chunk（k 为 nullptr 时释放全部），同步维护索引和 _last
+  void free_chunks_after(Chunk* k);
+
  public:
   Arena(MEMFLAGS memflag);
   Arena(MEMFLAGS memflag, size_t init_size);
@@ -102,6 +258,7 @@ class Arena : public CHeapObj<mtNone> {
   }
 
   // 快速释放（仅当是最后分配的块时有效）
+  // used() 由 _hwm 推算，回退 _hwm 即同步了已用字节数
   void Afree(void* ptr, size_t size) {
     if (ptr == nullptr) return;
     if (((char*)ptr) + ARENA_ALIGN(size) == _hwm) {
@@ -109,21 +266,51 @@ class Arena : public CHeapObj<mtNone> {
     }
   }
 
+  // 原地扩展：ptr 是最后分配的块且当前 Chunk 放得下时把 _hwm 往后推，
+  // 返回是否成功（失败时什么都不做）
+  bool Agrow(void* ptr, size_t old_size, size_t new_size) {
+    old_size = ARENA_ALIGN(old_size);
+    new_size = ARENA_ALIGN(new_size);
+    if (((char*)ptr) + old_size == _hwm && new_size - old_size <= (size_t)(_max - _hwm)) {
+      _hwm += new_size - old_size;
+      return true;
+    }
+    return false;
+  }
+
   // 重分配
   void* Arealloc(void* old_ptr, size_t old_size, size_t new_size,
                  AllocFailType alloc_failmode = AllocFailStrategy::EXIT_OOM);
 
   // 查询
   char* hwm() const { return _hwm; }
-  size_t used() const;
   size_t size_in_bytes() const { return _size_in_bytes; }
+
+  // 已用字节数：O(1)
+  size_t used() const {
+    return _chunk == nullptr ? 0 : _prior_used + (size_t)(_hwm - _chunk->bottom());
+  }
+
+  // ptr 是否落在本 Arena 的某个 Chunk 内：O(log n)
   bool contains(const void* ptr) const;
 
+  // 修改总大小并同步到 Native Memory Tracking
+  void set_size_in_bytes(size_t size);
+
+  // 遍历 Chunk 链表收集统计：O(n)，有 mmap 的 Chunk 时还要读 /proc/self/smaps
+  void statistics(ArenaStatistics* st) const;
+
+  // 增长策略。不加锁，应在启动阶段设置；已有的 Arena 下次扩展时生效
+  static const ArenaGrowthPolicy& growth_policy(MEMFLAGS flags);
+  static void set_growth_policy(MEMFLAGS flags, const ArenaGrowthPolicy& policy);
+
  private:
   void reset() {
-    _first = _chunk = nullptr;
+    _first = _chunk = _last = nullptr;
     _hwm = _max = nullptr;
-    _size_in_bytes = 0;
+    _prior_used = 0;
+    _next_chunk_len = growth_policy(_flags).initial_chunk_size;
+    set_size_in_bytes(0);
   }
 };
 
@@ -0,0 +1,58 @@
+/*
+ * my_jvm - Metadata factory
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metadataFactory.hpp
+ * 在 ClassLoaderData 的 Metaspace 中创建/提前释放 Array<T> 和 Metadata。
+ */
+
+#ifndef MY_JVM_MEMORY_METADATAFACTORY_HPP
+#define MY_JVM_MEMORY_METADATAFACTORY_HPP
+
+#include "classfile/classLoaderData.hpp"
+#include "memory/metaspace.hpp"
+#include "oops/array.hpp"
+#include "oops/metadata.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class MetadataFactory : AllStatic {
+ public:
+  // 元素已清零
+  template <typename T>
+  static Array<T>* new_array(ClassLoaderData* loader_data, int length) {
+    return new (loader_data, Array<T>::size(length)) Array<T>(length);
+  }
+
+  template <typename T>
+  static Array<T>* new_array(ClassLoaderData* loader_data, int length, T value) {
+    Array<T>* array = new_array<T>(loader_data, length);
+    for (int i = 0; i < length; i++) {
+      array->at_put(i, value);
+    }
+    return array;
+  }
+
+  // 空间留在 loader 的 freelist 里给之后的分配复用
+  template <typename T>
+  static void free_array(ClassLoaderData* loader_data, Array<T>* data) {
+    if (data != nullptr) {
+      int size = data->size();
+      data->~Array<T>();
+      loader_data->metaspace_non_null()->deallocate((MetaWord*)data, (size_t)size);
+    }
+  }
+
+  // 运行析构函数后归还空间；size() 返回 0 的类型按 sizeof 计算
+  template <class T>
+  static void free_metadata(ClassLoaderData* loader_data, T* md) {
+    if (md != nullptr) {
+      int size = md->size();
+      size_t word_size = size > 0 ? (size_t)size
+                                  : align_up(sizeof(T), (size_t)BytesPerWord) / BytesPerWord;
+      bool is_klass = md->is_klass();
+      md->~T();
+      loader_data->metaspace_non_null()->deallocate((MetaWord*)md, word_size, is_klass);
+    }
+  }
+};
+
+#endif // MY_JVM_MEMORY_METADATAFACTORY_HPP
@@ -0,0 +1,225 @@
+/*
+ * my_jvm - Metaspace implementation
+ */
+
+#include "memory/metaspace.hpp"
+#include "classfile/classLoaderData.hpp"
+#include "memory/metaspace/chunkManager.hpp"
+#include "memory/metaspace/spaceManager.hpp"
+#include "memory/metaspace/virtualSpaceNode.hpp"
+#include "oops/compressedOops.hpp"
+#include "oops/klass.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/copy.hpp"
+#include "utilities/ostream.hpp"
+#include <cstdio>
+
+using metaspace::ChunkManager;
+using metaspace::SpaceManager;
+using metaspace::VirtualSpaceList;
+using metaspace::VirtualSpaceNode;
+
+// ========== Metaspace ==========
+
+static ChunkManager*     _chunk_manager = nullptr;
+static ChunkManager*     _class_chunk_manager = nullptr;
+static VirtualSpaceNode* _class_space_node = nullptr;
+// 持有 ClassLoaderMetaspace 的锁时会第一次创建压缩类空间，所以 rank 在两者之间
+static Mutex             _class_space_lock(Mutex::leaf + 1, "Metaspace class space");
+
+bool Metaspace::using_class_space() {
+  return UseCompressedClassPointers;
+}
+
+ChunkManager* Metaspace::chunk_manager() {
+  ChunkManager* cm = (ChunkManager*)atomic_load((void* const*)&_chunk_manager);
+  if (cm == nullptr) {
+    ChunkManager* created = new ChunkManager(VirtualSpaceNodeWordSize);
+    cm = (ChunkManager*)atomic_cas((void**)&_chunk_manager, created, nullptr);
+    if (cm == nullptr) {
+      cm = created;
+    } else {
+      delete created;   // 别的线程先建好了
+    }
+  }
+  return cm;
+}
+
+ChunkManager* Metaspace::class_chunk_manager() {
+  ChunkManager* cm = (ChunkManager*)atomic_load((void* const*)&_class_chunk_manager);
+  if (cm != nullptr) {
+    return cm;
+  }
+  _class_space_lock.lock();
+  if (_class_chunk_manager == nullptr) {
+    size_t bytes = align_up(CompressedClassSpaceSize, metaspace::MAX_CHUNK_BYTE_SIZE);
+    guarantee(bytes <= CompressedKlassPointers::KlassEncodingMetaspaceMax,
+              "CompressedClassSpaceSize too large: " SIZE_FORMAT, CompressedClassSpaceSize);
+    VirtualSpaceNode* node = VirtualSpaceNode::create(bytes / BytesPerWord);
+    if (node == nullptr) {
+      fprintf(stderr, "Could not reserve " SIZE_FORMAT " bytes for compressed class space\n", bytes);
+      std::abort();
+    }
+    // base/shift 必须在第一个 Klass 分配出去之前设置好
+    CompressedKlassPointers::initialize((address)node->base(), bytes);
+    _class_space_node = node;
+    ChunkManager* created = new ChunkManager(new VirtualSpaceList(node));
+    // base 处的第一个 chunk 留作保护区，保证 narrowKlass 0 只表示空指针
+    created->get_chunk(metaspace::HIGHEST_CHUNK_LEVEL);
+    atomic_store((void**)&_class_chunk_manager, (void*)created);
+  }
+  cm = _class_chunk_manager;
+  _class_space_lock.unlock();
+  return cm;
+}
+
+MetaWord* Metaspace::allocate(ClassLoaderData* loader_data, size_t word_size, MetadataType mdtype) {
+  MetaWord* p = loader_data->metaspace_non_null()->allocate(word_size, mdtype);
+  if (p != nullptr) {
+    Copy::fill_to_words((HeapWord*)p, word_size, 0);
+  }
+  return p;
+}
+
+bool Metaspace::contains(const void* p) {
+  if (is_in_class_space(p)) {
+    return true;
+  }
+  ChunkManager* cm = (ChunkManager*)atomic_load((void* const*)&_chunk_manager);
+  return cm != nullptr && cm->contains(p);
+}
+
+bool Metaspace::is_in_class_space(const void* p) {
+  ChunkManager* cm = (ChunkManager*)atomic_load((void* const*)&_class_chunk_manager);
+  return cm != nullptr && _class_space_node->contains(p);
+}
+
+void Metaspace::print_on(outputStream* st) {
+  st->print_cr("Metaspace statistics:");
+  st->print_cr(" non-class space:");
+  chunk_manager()->print_on(st);
+  if (_class_chunk_manager != nullptr) {
+    st->print_cr(" class space: base=" PTR_FORMAT " shift=%d",
+                 (void*)CompressedKlassPointers::base(), CompressedKlassPointers::shift());
+    _class_chunk_manager->print_on(st);
+  }
+}
+
+// ========== ClassLoaderMetaspace ==========
+
+ClassLoaderMetaspace::ClassLoaderMetaspace(Metaspace::MetaspaceType type)
+  : _lock(Mutex::leaf + 2, "ClassLoaderMetaspace"), _type(type),
+    _vsm(new SpaceManager(Metaspace::chunk_manager(), type == Metaspace::BootMetaspaceType)),
+    _class_vsm(nullptr) {}
+
+ClassLoaderMetaspace::~ClassLoaderMetaspace() {
+  delete _vsm;
+  delete _class_vsm;
+}
+
+void ClassLoaderMetaspace::lock() {
+  _lock.lock();
+}
+
+void ClassLoaderMetaspace::unlock() {
+  _lock.unlock();
+}
+
+// 持锁
+SpaceManager* ClassLoaderMetaspace::class_vsm() {
+  if (_class_vsm == nullptr) {
+    _class_vsm = new SpaceManager(Metaspace::class_chunk_manager(),
+                                  _type == Metaspace::BootMetaspaceType);
+  }
+  return _class_vsm;
+}
+
+SpaceManager* ClassLoaderMetaspace::get_space_manager(Metaspace::MetadataType mdtype) {
+  if (mdtype == Metaspace::ClassType && Metaspace::using_class_space()) {
+    return class_vsm();
+  }
+  return _vsm;
+}
+
+MetaWord* ClassLoaderMetaspace::allocate(size_t word_size, Metaspace::MetadataType mdtype) {
+  lock();
+  MetaWord* p = get_space_manager(mdtype)->allocate(word_size);
+  unlock();
+  return p;
+}
+
+void ClassLoaderMetaspace::deallocate(MetaWord* p, size_t word_size, bool is_class) {
+  lock();
+  if (is_class && Metaspace::is_in_class_space(p)) {
+    class_vsm()->deallocate(p, word_size);
+  } else {
+    _vsm->deallocate(p, word_size);
+  }
+  unlock();
+}
+
+size_t ClassLoaderMetaspace::used_words(Metaspace::MetadataType mdtype) const {
+  const SpaceManager* sm = (mdtype == Metaspace::ClassType) ? _class_vsm : _vsm;
+  return sm == nullptr ? 0 : sm->used_words();
+}
+
+size_t ClassLoaderMetaspace::capacity_words(Metaspace::MetadataType mdtype) const {
+  const SpaceManager* sm = (mdtype == Metaspace::ClassType) ? _class_vsm : _vsm;
+  return sm == nullptr ? 0 : sm->capacity_words();
+}
+
+size_t ClassLoaderMetaspace::used_words() const {
+  return used_words(Metaspace::NonClassType) + used_words(Metaspace::ClassType);
+}
+
+size_t ClassLoaderMetaspace::capacity_words() const {
+  return capacity_words(Metaspace::NonClassType) + capacity_words(Metaspace::ClassType);
+}
+
+int ClassLoaderMetaspace::num_chunks() const {
+  return _vsm->num_chunks() + (_class_vsm == nullptr ? 0 : _class_vsm->num_chunks());
+}
+
+size_t ClassLoaderMetaspace::free_block_words() const {
+  return _vsm->free_block_words() + (_class_vsm == nullptr ? 0 : _class_vsm->free_block_words());
+}
+
+void ClassLoaderMetaspace::print_on(outputStream* st) const {
+  st->print_cr("  %s metaspace:", _type == Metaspace::BootMetaspaceType ? "boot" : "standard");
+  _vsm->print_on(st, "non-class");
+  if (_class_vsm != nullptr) {
+    _class_vsm->print_on(st, "class");
+  }
+}
+
+// ========== MetaspaceObj / Klass 的分配 ==========
+
+static void* allocate_metadata_or_abort(ClassLoaderData* loader_data, size_t word_size,
+                                        Metaspace::MetadataType mdtype) {
+  MetaWord* p = Metaspace::allocate(loader_data, word_size, mdtype);
+  if (p == nullptr) {
+    fprintf(stderr, "OutOfMemoryError: %s (requested " SIZE_FORMAT " words)\n",
+            mdtype == Metaspace::ClassType && Metaspace::using_class_space()
+              ? "Compressed class space" : "Metaspace",
+            word_size);
+    std::abort();
+  }
+  return p;
+}
+
+void* MetaspaceObj::operator new(size_t, ClassLoaderData* loader_data, size_t word_size) throw() {
+  return allocate_metadata_or_abort(loader_data, word_size, Metaspace::NonClassType);
+}
+
+void* MetaspaceObj::operator new(size_t size, ClassLoaderData* loader_data) throw() {
+  return operator new(size, loader_data, align_up(size, BytesPerWord) / BytesPerWord);
+}
+
+void* Klass::operator new(size_t, ClassLoaderData* loader_data, size_t word_size) throw() {
+  return allocate_metadata_or_abort(loader_data, word_size, Metaspace::ClassType);
+}
+
+void* Klass::operator new(size_t size, ClassLoaderData* loader_data) throw() {
+  return operator new(size, loader_data, align_up(size, BytesPerWord) / BytesPerWord);
+}
@@ -0,0 +1,110 @@
+/*
+ * my_jvm - Metaspace
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace.hpp
+ * 类元数据（Klass、Method、Array<T> ...）不再逐个 malloc，而是按
+ * ClassLoaderData 分到各自的 ClassLoaderMetaspace 里 bump 分配：
+ *
+ *  - ChunkManager（每个空间一个）：从预留的虚拟地址空间切 chunk，buddy 式分裂/合并
+ *  - ClassLoaderMetaspace（每个 loader 一个）：每个空间一个 SpaceManager，
+ *    在当前 chunk 里 bump 分配，提前释放的块进 BlockFreelist 复用
+ *  - loader 卸载时整串 chunk 一次性还给 ChunkManager，不逐个释放元数据
+ *
+ * 两个空间：
+ *  - non-class space：除 Klass 外的元数据，按需预留新的 node
+ *  - class space（UseCompressedClassPointers）：只放 Klass，是一段固定的
+ *    CompressedClassSpaceSize 大小的预留区间，Klass* 可以压缩成 32 位的 narrowKlass
+ *
+ * 简化：没有单独的 commit 步骤（物理页在首次访问时分配）。
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_HPP
+#define MY_JVM_MEMORY_METASPACE_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/mutex.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class ClassLoaderData;
+class outputStream;
+
+namespace metaspace {
+class ChunkManager;
+class SpaceManager;
+}
+
+// ========== Metaspace ==========
+
+class Metaspace : AllStatic {
+ public:
+  enum MetaspaceType {
+    StandardMetaspaceType,   // 普通 class loader
+    BootMetaspaceType        // 启动类加载器：类多，一开始就用大 chunk
+  };
+
+  enum MetadataType {
+    NonClassType,
+    ClassType                // Klass，UseCompressedClassPointers 时放在压缩类空间
+  };
+
+  // non-class space 每个 VirtualSpaceNode 预留的大小
+  static const size_t VirtualSpaceNodeWordSize = 64 * 1024 * 1024 / BytesPerWord;
+
+  static bool using_class_space();
+
+  static metaspace::ChunkManager* chunk_manager();
+  // 第一次调用时预留压缩类空间，并设置 CompressedKlassPointers 的 base/shift
+  static metaspace::ChunkManager* class_chunk_manager();
+
+  // 从 loader_data 的 metaspace 分配 word_size 个字并清零；
+  // 地址空间用完时返回 nullptr
+  static MetaWord* allocate(ClassLoaderData* loader_data, size_t word_size,
+                            MetadataType mdtype = NonClassType);
+
+  static bool contains(const void* p);
+  static bool is_in_class_space(const void* p);
+
+  static void print_on(outputStream* st);
+};
+
+// ========== ClassLoaderMetaspace ==========
+// 一个 class loader 的所有元数据，随 ClassLoaderData 一起销毁
+
+class ClassLoaderMetaspace : public CHeapObj<mtClass> {
+ private:
+  Mutex                          _lock;
+  Metaspace::MetaspaceType       _type;
+  metaspace::SpaceManager*       _vsm;        // non-class space
+  metaspace::SpaceManager*       _class_vsm;  // class space，第一次分配 Klass 时创建
+
+  void lock();
+  void unlock();
+
+  metaspace::SpaceManager* class_vsm();
+  metaspace::SpaceManager* get_space_manager(Metaspace::MetadataType mdtype);
+
+ public:
+  ClassLoaderMetaspace(Metaspace::MetaspaceType type);
+  // 所有 chunk 一次性还给 ChunkManager
+  ~ClassLoaderMetaspace();
+
+  MetaWord* allocate(size_t word_size, Metaspace::MetadataType mdtype = Metaspace::NonClassType);
+  // 提前释放（例如类解析失败时丢弃的数组），块留在本 loader 里复用
+  void      deallocate(MetaWord* p, size_t word_size, bool is_class = false);
+
+  Metaspace::MetaspaceType type() const { return _type; }
+
+  // 统计（字，两个空间合计）
+  size_t used_words() const;
+  size_t capacity_words() const;
+  int    num_chunks() const;
+  size_t free_block_words() const;
+
+  // 单个空间
+  size_t used_words(Metaspace::MetadataType mdtype) const;
+  size_t capacity_words(Metaspace::MetadataType mdtype) const;
+
+  void print_on(outputStream* st) const;
+};
+
+#endif // MY_JVM_MEMORY_METASPACE_HPP
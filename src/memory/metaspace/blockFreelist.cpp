@@ -0,0 +1,63 @@
+/*
+ * my_jvm - Metaspace block free list implementation
+ */
+
+#include "memory/metaspace/blockFreelist.hpp"
+
+namespace metaspace {
+
+BlockFreelist::BlockFreelist() : _large(nullptr), _free_words(0), _num_blocks(0) {
+  for (int i = 0; i <= SmallBlockMaxWordSize; i++) {
+    _small[i] = nullptr;
+  }
+}
+
+void BlockFreelist::return_block(MetaWord* p, size_t word_size) {
+  assert(word_size >= MinBlockWordSize, "block too small");
+  Block* b = (Block*)p;
+  b->_word_size = word_size;
+  if (word_size <= SmallBlockMaxWordSize) {
+    b->_next = _small[word_size];
+    _small[word_size] = b;
+  } else {
+    b->_next = _large;
+    _large = b;
+  }
+  _free_words += word_size;
+  _num_blocks++;
+}
+
+MetaWord* BlockFreelist::get_block(size_t word_size) {
+  if (_num_blocks == 0) {
+    return nullptr;
+  }
+  if (word_size <= SmallBlockMaxWordSize && _small[word_size] != nullptr) {
+    Block* b = _small[word_size];
+    _small[word_size] = b->_next;
+    _free_words -= word_size;
+    _num_blocks--;
+    return (MetaWord*)b;
+  }
+
+  // 大块首次适配，切下的剩余部分放回
+  for (Block** link = &_large; *link != nullptr; link = &(*link)->_next) {
+    Block* b = *link;
+    if (b->_word_size < word_size) {
+      continue;
+    }
+    size_t remainder = b->_word_size - word_size;
+    if (remainder != 0 && remainder < MinBlockWordSize) {
+      continue;
+    }
+    *link = b->_next;
+    _free_words -= b->_word_size;
+    _num_blocks--;
+    if (remainder != 0) {
+      return_block((MetaWord*)b + word_size, remainder);
+    }
+    return (MetaWord*)b;
+  }
+  return nullptr;
+}
+
+} // namespace metaspace
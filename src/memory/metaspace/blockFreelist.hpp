@@ -0,0 +1,51 @@
+/*
+ * my_jvm - Metaspace block free list
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace/blockFreelist.hpp
+ * 简化版本：小块按字数分桶（精确匹配），大块放一条链表做首次适配，
+ * 代替 OpenJDK 的 SmallBlocks + BinaryTreeDictionary。
+ * 收的是某个 ClassLoaderMetaspace 里提前释放的元数据，以及换 chunk 时剩下的尾巴。
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_BLOCKFREELIST_HPP
+#define MY_JVM_MEMORY_METASPACE_BLOCKFREELIST_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+namespace metaspace {
+
+class BlockFreelist : public CHeapObj<mtClass> {
+ public:
+  enum {
+    MinBlockWordSize      = 2,    // 放得下 Block 头
+    SmallBlockMaxWordSize = 64    // 不超过的按字数分桶
+  };
+
+ private:
+  // 空闲块头，直接写在块的内存里
+  struct Block {
+    Block* _next;
+    size_t _word_size;
+  };
+
+  Block* _small[SmallBlockMaxWordSize + 1];
+  Block* _large;
+  size_t _free_words;
+  size_t _num_blocks;
+
+ public:
+  BlockFreelist();
+
+  // word_size >= MinBlockWordSize
+  void      return_block(MetaWord* p, size_t word_size);
+  // 找不到合适的块返回 nullptr
+  MetaWord* get_block(size_t word_size);
+
+  size_t free_words() const { return _free_words; }
+  size_t num_blocks() const { return _num_blocks; }
+};
+
+} // namespace metaspace
+
+#endif // MY_JVM_MEMORY_METASPACE_BLOCKFREELIST_HPP
@@ -0,0 +1,212 @@
+/*
+ * my_jvm - Metaspace chunk manager implementation
+ */
+
+#include "memory/metaspace/chunkManager.hpp"
+#include "runtime/os.hpp"
+#include "utilities/ostream.hpp"
+
+namespace metaspace {
+
+ChunkManager::ChunkManager(size_t node_word_size)
+  : _vslist(new VirtualSpaceList(node_word_size)), _lock(Mutex::leaf, "ChunkManager"),
+    _free_words(0), _in_use_words(0) {
+  for (int i = 0; i < NUM_CHUNK_LEVELS; i++) {
+    _free_lists[i] = nullptr;
+    _num_free[i] = 0;
+  }
+}
+
+ChunkManager::ChunkManager(VirtualSpaceList* vslist)
+  : _vslist(vslist), _lock(Mutex::leaf, "ChunkManager"), _free_words(0), _in_use_words(0) {
+  for (int i = 0; i < NUM_CHUNK_LEVELS; i++) {
+    _free_lists[i] = nullptr;
+    _num_free[i] = 0;
+  }
+}
+
+ChunkManager::~ChunkManager() {
+  for (int i = 0; i < NUM_CHUNK_LEVELS; i++) {
+    while (_free_lists[i] != nullptr) {
+      Metachunk* c = _free_lists[i];
+      remove_from_freelist(c);
+      delete c;
+    }
+  }
+  delete _vslist;
+}
+
+void ChunkManager::lock() {
+  _lock.lock();
+}
+
+void ChunkManager::unlock() {
+  _lock.unlock();
+}
+
+// ========== 空闲链表 ==========
+
+void ChunkManager::add_to_freelist(Metachunk* c) {
+  chunklevel_t level = c->level();
+  c->_state = Metachunk::state_free;
+  c->_prev = nullptr;
+  c->_next = _free_lists[level];
+  if (c->_next != nullptr) {
+    c->_next->_prev = c;
+  }
+  _free_lists[level] = c;
+  _num_free[level]++;
+  _free_words += c->word_size();
+}
+
+void ChunkManager::remove_from_freelist(Metachunk* c) {
+  chunklevel_t level = c->level();
+  if (c->_prev != nullptr) {
+    c->_prev->_next = c->_next;
+  } else {
+    _free_lists[level] = c->_next;
+  }
+  if (c->_next != nullptr) {
+    c->_next->_prev = c->_prev;
+  }
+  c->_prev = c->_next = nullptr;
+  _num_free[level]--;
+  _free_words -= c->word_size();
+}
+
+// ========== 分裂与合并 ==========
+
+void ChunkManager::split_chunk(Metachunk* c, chunklevel_t target_level) {
+  while (c->_level < target_level) {
+    c->_level++;
+    Metachunk* follower = new Metachunk(c->_base + c->word_size(), c->_level, c->_node);
+    follower->_prev_in_vs = c;
+    follower->_next_in_vs = c->_next_in_vs;
+    if (c->_next_in_vs != nullptr) {
+      c->_next_in_vs->_prev_in_vs = follower;
+    }
+    c->_next_in_vs = follower;
+    add_to_freelist(follower);
+  }
+}
+
+Metachunk* ChunkManager::merge_with_buddies(Metachunk* c) {
+  while (c->_level > ROOT_CHUNK_LEVEL) {
+    // root chunk 按 4M 对齐，level L 的 chunk 按自身大小对齐：
+    // 地址在 2 倍大小边界上的是前一半（leader），buddy 紧跟其后，否则 buddy 在前
+    size_t bytes = c->word_size() * BytesPerWord;
+    bool is_leader = ((uintptr_t)c->_base & bytes) == 0;
+    Metachunk* buddy = is_leader ? c->_next_in_vs : c->_prev_in_vs;
+    if (buddy == nullptr || !buddy->is_free() || buddy->_level != c->_level) {
+      break;
+    }
+    remove_from_freelist(buddy);
+    Metachunk* leader   = is_leader ? c : buddy;
+    Metachunk* follower = is_leader ? buddy : c;
+    leader->_next_in_vs = follower->_next_in_vs;
+    if (follower->_next_in_vs != nullptr) {
+      follower->_next_in_vs->_prev_in_vs = leader;
+    }
+    leader->_level--;
+    delete follower;
+    c = leader;
+  }
+  return c;
+}
+
+// ========== 分配与归还 ==========
+
+Metachunk* ChunkManager::get_chunk(chunklevel_t level) {
+  assert(level >= ROOT_CHUNK_LEVEL && level <= HIGHEST_CHUNK_LEVEL, "bad level");
+  lock();
+  Metachunk* c = nullptr;
+  // 从最小的合适 chunk 开始找
+  for (chunklevel_t l = level; l >= ROOT_CHUNK_LEVEL; l--) {
+    if (_free_lists[l] != nullptr) {
+      c = _free_lists[l];
+      remove_from_freelist(c);
+      break;
+    }
+  }
+  if (c == nullptr) {
+    c = _vslist->allocate_root_chunk();
+  }
+  if (c != nullptr) {
+    split_chunk(c, level);
+    c->_state = Metachunk::state_in_use;
+    c->_used_words = 0;
+    _in_use_words += c->word_size();
+  }
+  unlock();
+  return c;
+}
+
+void ChunkManager::return_chunk_locked(Metachunk* c) {
+  assert(!c->is_free(), "double free of chunk");
+  _in_use_words -= c->word_size();
+  c->_state = Metachunk::state_free;
+  c->_used_words = 0;
+  c = merge_with_buddies(c);
+  if (c->_level <= UncommitLevel) {
+    os::uncommit_memory((char*)c->_base, c->word_size() * BytesPerWord);
+  }
+  add_to_freelist(c);
+}
+
+void ChunkManager::return_chunk(Metachunk* c) {
+  lock();
+  return_chunk_locked(c);
+  unlock();
+}
+
+void ChunkManager::return_chunks(Metachunk* list) {
+  lock();
+  while (list != nullptr) {
+    Metachunk* next = list->_next;
+    list->_prev = list->_next = nullptr;
+    return_chunk_locked(list);
+    list = next;
+  }
+  unlock();
+}
+
+bool ChunkManager::contains(const void* p) {
+  lock();
+  bool result = _vslist->contains(p);
+  unlock();
+  return result;
+}
+
+size_t ChunkManager::reserved_words() {
+  lock();
+  size_t result = _vslist->reserved_words();
+  unlock();
+  return result;
+}
+
+size_t ChunkManager::carved_words() {
+  lock();
+  size_t result = _vslist->used_words();
+  unlock();
+  return result;
+}
+
+void ChunkManager::print_on(outputStream* st) {
+  lock();
+  st->print_cr("  reserved=" SIZE_FORMAT "K (%d nodes) carved=" SIZE_FORMAT "K in use=" SIZE_FORMAT
+               "K free=" SIZE_FORMAT "K",
+               _vslist->reserved_words() * BytesPerWord / 1024, _vslist->num_nodes(),
+               _vslist->used_words() * BytesPerWord / 1024,
+               _in_use_words * BytesPerWord / 1024, _free_words * BytesPerWord / 1024);
+  st->print("  free chunks:");
+  for (int i = 0; i < NUM_CHUNK_LEVELS; i++) {
+    if (_num_free[i] > 0) {
+      st->print(" " SIZE_FORMAT "K x" SIZE_FORMAT, word_size_for_level(i) * BytesPerWord / 1024,
+                _num_free[i]);
+    }
+  }
+  st->cr();
+  unlock();
+}
+
+} // namespace metaspace
@@ -0,0 +1,80 @@
+/*
+ * my_jvm - Metaspace chunk manager
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace/chunkManager.hpp
+ * 以及 JEP 387 的 buddy 分配：
+ *  - 每个 level 一条空闲链表
+ *  - 取 chunk 时从最接近的 level 找，没有就切一个新的 root chunk，
+ *    对半分到目标 level，分出的另一半进空闲链表
+ *  - 还 chunk 时和 buddy 逐级合并；合并出的大 chunk 用 madvise 还给 OS
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_CHUNKMANAGER_HPP
+#define MY_JVM_MEMORY_METASPACE_CHUNKMANAGER_HPP
+
+#include "memory/allocation.hpp"
+#include "memory/metaspace/metachunk.hpp"
+#include "memory/metaspace/virtualSpaceNode.hpp"
+#include "runtime/mutex.hpp"
+
+class outputStream;
+
+namespace metaspace {
+
+class ChunkManager : public CHeapObj<mtClass> {
+ public:
+  enum {
+    // 合并后不小于这个大小（64K）的空闲 chunk 归还物理内存
+    UncommitLevel = 6
+  };
+
+ private:
+  VirtualSpaceList* _vslist;
+  Mutex             _lock;
+
+  Metachunk*        _free_lists[NUM_CHUNK_LEVELS];
+  size_t            _num_free[NUM_CHUNK_LEVELS];
+  size_t            _free_words;
+  size_t            _in_use_words;
+
+  void lock();
+  void unlock();
+
+  void add_to_freelist(Metachunk* c);
+  void remove_from_freelist(Metachunk* c);
+
+  // 对半分到 target_level，分出的后一半进空闲链表（持锁）
+  void split_chunk(Metachunk* c, chunklevel_t target_level);
+  // 和空闲的 buddy 逐级合并，返回合并后的 chunk（持锁）
+  Metachunk* merge_with_buddies(Metachunk* c);
+
+  void return_chunk_locked(Metachunk* c);
+
+ public:
+  ChunkManager(size_t node_word_size);
+  // 从给定的地址空间取 chunk（压缩类空间）
+  ChunkManager(VirtualSpaceList* vslist);
+  ~ChunkManager();
+
+  // 取一个 level 为 level 的 chunk；地址空间用完返回 nullptr
+  Metachunk* get_chunk(chunklevel_t level);
+
+  // 归还一个 chunk / 经 next() 串起来的一串 chunk（只加一次锁）
+  void return_chunk(Metachunk* c);
+  void return_chunks(Metachunk* list);
+
+  bool contains(const void* p);
+
+  // 统计（字）
+  size_t free_words() const          { return _free_words; }
+  size_t in_use_words() const        { return _in_use_words; }
+  size_t num_free_chunks(chunklevel_t level) const { return _num_free[level]; }
+  size_t reserved_words();
+  size_t carved_words();
+
+  void print_on(outputStream* st);
+};
+
+} // namespace metaspace
+
+#endif // MY_JVM_MEMORY_METASPACE_CHUNKMANAGER_HPP
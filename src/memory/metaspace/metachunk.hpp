@@ -0,0 +1,107 @@
+/*
+ * my_jvm - Metaspace chunk
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace/metachunk.hpp
+ * 以及后续版本（JEP 387）的 buddy 式 chunk level：
+ *   root chunk 4M 为 level 0，每降一级大小减半，最小 1K（level 12）。
+ * Chunk 头放在 C 堆上而不是 chunk 内存里，这样空闲 chunk 可以整块归还 OS。
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_METACHUNK_HPP
+#define MY_JVM_MEMORY_METASPACE_METACHUNK_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+namespace metaspace {
+
+class VirtualSpaceNode;
+
+// ========== chunk level ==========
+
+typedef int chunklevel_t;
+
+enum {
+  ROOT_CHUNK_LEVEL    = 0,
+  HIGHEST_CHUNK_LEVEL = 12,
+  NUM_CHUNK_LEVELS    = HIGHEST_CHUNK_LEVEL + 1
+};
+
+const size_t MAX_CHUNK_BYTE_SIZE = 4 * 1024 * 1024;
+const size_t MAX_CHUNK_WORD_SIZE = MAX_CHUNK_BYTE_SIZE / BytesPerWord;
+const size_t MIN_CHUNK_WORD_SIZE = MAX_CHUNK_WORD_SIZE >> HIGHEST_CHUNK_LEVEL;
+
+inline size_t word_size_for_level(chunklevel_t level) {
+  return MAX_CHUNK_WORD_SIZE >> level;
+}
+
+// 能放下 word_size 的最小 chunk（最高 level）
+inline chunklevel_t level_fitting_word_size(size_t word_size) {
+  chunklevel_t level = HIGHEST_CHUNK_LEVEL;
+  while (level > ROOT_CHUNK_LEVEL && word_size_for_level(level) < word_size) {
+    level--;
+  }
+  return level;
+}
+
+// ========== Metachunk ==========
+
+class Metachunk : public CHeapObj<mtClass> {
+  friend class ChunkManager;
+
+ public:
+  enum State { state_free, state_in_use };
+
+ private:
+  MetaWord*         _base;
+  chunklevel_t      _level;
+  State             _state;
+  size_t            _used_words;   // 已分配的字数（bump 指针 = _base + _used_words）
+  VirtualSpaceNode* _node;
+
+  // 所在链表：ChunkManager 的空闲链表，或 ClassLoaderMetaspace 的 chunk 链表
+  Metachunk*        _prev;
+  Metachunk*        _next;
+
+  // 同一个 root chunk 里地址相邻的 chunk，用来找 buddy
+  Metachunk*        _prev_in_vs;
+  Metachunk*        _next_in_vs;
+
+ public:
+  Metachunk(MetaWord* base, chunklevel_t level, VirtualSpaceNode* node)
+    : _base(base), _level(level), _state(state_free), _used_words(0), _node(node),
+      _prev(nullptr), _next(nullptr), _prev_in_vs(nullptr), _next_in_vs(nullptr) {}
+
+  MetaWord*    base() const       { return _base; }
+  MetaWord*    top() const        { return _base + _used_words; }
+  MetaWord*    end() const        { return _base + word_size(); }
+  chunklevel_t level() const      { return _level; }
+  size_t       word_size() const  { return word_size_for_level(_level); }
+  size_t       used_words() const { return _used_words; }
+  size_t       free_words() const { return word_size() - _used_words; }
+  bool         is_free() const    { return _state == state_free; }
+  VirtualSpaceNode* node() const  { return _node; }
+
+  Metachunk* prev() const         { return _prev; }
+  Metachunk* next() const         { return _next; }
+  void set_prev(Metachunk* c)     { _prev = c; }
+  void set_next(Metachunk* c)     { _next = c; }
+
+  bool contains(const void* p) const {
+    return (const MetaWord*)p >= _base && (const MetaWord*)p < end();
+  }
+
+  // 在 chunk 内 bump 分配；放不下返回 nullptr
+  MetaWord* allocate(size_t word_size) {
+    if (free_words() < word_size) {
+      return nullptr;
+    }
+    MetaWord* p = top();
+    _used_words += word_size;
+    return p;
+  }
+};
+
+} // namespace metaspace
+
+#endif // MY_JVM_MEMORY_METASPACE_METACHUNK_HPP
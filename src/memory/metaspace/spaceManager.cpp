@@ -0,0 +1,107 @@
+/*
+ * my_jvm - Metaspace space manager implementation
+ */
+
+#include "memory/metaspace/spaceManager.hpp"
+#include "memory/metaspace/blockFreelist.hpp"
+#include "memory/metaspace/chunkManager.hpp"
+#include "utilities/ostream.hpp"
+
+namespace metaspace {
+
+SpaceManager::SpaceManager(ChunkManager* chunk_manager, bool is_boot)
+  : _chunk_manager(chunk_manager), _is_boot(is_boot), _chunks(nullptr),
+    _block_freelist(nullptr), _num_chunks(0), _used_words(0) {}
+
+SpaceManager::~SpaceManager() {
+  _chunk_manager->return_chunks(_chunks);
+  delete _block_freelist;
+}
+
+// 参考 JEP 387 的 chunk 增长序列：普通 loader 从 4K 开始逐步翻倍到 64K，
+// 大部分只加载几个类的 loader 只占一两个小 chunk；启动类加载器直接用 256K
+static const chunklevel_t standard_chunk_levels[] = { 10, 10, 9, 8, 7, 6 };
+static const chunklevel_t boot_chunk_level = 4;
+
+chunklevel_t SpaceManager::next_chunk_level(size_t word_size) const {
+  chunklevel_t level;
+  if (_is_boot) {
+    level = boot_chunk_level;
+  } else {
+    const int n = (int)(sizeof(standard_chunk_levels) / sizeof(standard_chunk_levels[0]));
+    level = standard_chunk_levels[MIN2(_num_chunks, n - 1)];
+  }
+  return MIN2(level, level_fitting_word_size(word_size));
+}
+
+MetaWord* SpaceManager::allocate_from_new_chunk(size_t word_size) {
+  if (word_size > MAX_CHUNK_WORD_SIZE) {
+    return nullptr;
+  }
+  Metachunk* c = _chunk_manager->get_chunk(next_chunk_level(word_size));
+  if (c == nullptr) {
+    return nullptr;
+  }
+  // 旧 chunk 剩下的尾巴放进 freelist，之后的小分配还能用上
+  Metachunk* old = _chunks;
+  if (old != nullptr && old->free_words() >= BlockFreelist::MinBlockWordSize) {
+    size_t left = old->free_words();
+    MetaWord* tail = old->allocate(left);
+    if (_block_freelist == nullptr) {
+      _block_freelist = new BlockFreelist();
+    }
+    _block_freelist->return_block(tail, left);
+  }
+  c->set_next(_chunks);
+  _chunks = c;
+  _num_chunks++;
+  return c->allocate(word_size);
+}
+
+MetaWord* SpaceManager::allocate(size_t word_size) {
+  word_size = MAX2(word_size, (size_t)BlockFreelist::MinBlockWordSize);
+  MetaWord* p = nullptr;
+  if (_block_freelist != nullptr) {
+    p = _block_freelist->get_block(word_size);
+  }
+  if (p == nullptr && _chunks != nullptr) {
+    p = _chunks->allocate(word_size);
+  }
+  if (p == nullptr) {
+    p = allocate_from_new_chunk(word_size);
+  }
+  if (p != nullptr) {
+    _used_words += word_size;
+  }
+  return p;
+}
+
+void SpaceManager::deallocate(MetaWord* p, size_t word_size) {
+  word_size = MAX2(word_size, (size_t)BlockFreelist::MinBlockWordSize);
+  if (_block_freelist == nullptr) {
+    _block_freelist = new BlockFreelist();
+  }
+  _block_freelist->return_block(p, word_size);
+  _used_words -= word_size;
+}
+
+size_t SpaceManager::capacity_words() const {
+  size_t sum = 0;
+  for (Metachunk* c = _chunks; c != nullptr; c = c->next()) {
+    sum += c->word_size();
+  }
+  return sum;
+}
+
+size_t SpaceManager::free_block_words() const {
+  return _block_freelist == nullptr ? 0 : _block_freelist->free_words();
+}
+
+void SpaceManager::print_on(outputStream* st, const char* name) const {
+  st->print_cr("    %s: used=" SIZE_FORMAT "K capacity=" SIZE_FORMAT "K chunks=%d"
+               " free blocks=" SIZE_FORMAT "K",
+               name, _used_words * BytesPerWord / 1024, capacity_words() * BytesPerWord / 1024,
+               _num_chunks, free_block_words() * BytesPerWord / 1024);
+}
+
+} // namespace metaspace
@@ -0,0 +1,58 @@
+/*
+ * my_jvm - Metaspace space manager
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace/spaceManager.hpp
+ * 一个 ClassLoaderMetaspace 在一个空间（class / non-class）里的分配：
+ * 持有从 ChunkManager 取来的 chunk，在当前 chunk 里 bump 分配，
+ * 提前释放的块和换 chunk 时剩下的尾巴放进 BlockFreelist。
+ * 调用方（ClassLoaderMetaspace）持锁。
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_SPACEMANAGER_HPP
+#define MY_JVM_MEMORY_METASPACE_SPACEMANAGER_HPP
+
+#include "memory/allocation.hpp"
+#include "memory/metaspace/metachunk.hpp"
+
+class outputStream;
+
+namespace metaspace {
+
+class BlockFreelist;
+class ChunkManager;
+
+class SpaceManager : public CHeapObj<mtClass> {
+ private:
+  ChunkManager*  _chunk_manager;
+  bool           _is_boot;
+  Metachunk*     _chunks;           // 经 next() 串起来，第一个是当前 chunk
+  BlockFreelist* _block_freelist;   // 按需创建
+  int            _num_chunks;
+  size_t         _used_words;
+
+  // 下一个 chunk 的 level：按已有 chunk 个数逐步变大
+  chunklevel_t next_chunk_level(size_t word_size) const;
+
+  MetaWord* allocate_from_new_chunk(size_t word_size);
+
+ public:
+  SpaceManager(ChunkManager* chunk_manager, bool is_boot);
+  // 所有 chunk 一次性还给 ChunkManager
+  ~SpaceManager();
+
+  // 不清零；放不下（或超过 root chunk）时返回 nullptr
+  MetaWord* allocate(size_t word_size);
+  void      deallocate(MetaWord* p, size_t word_size);
+
+  // 统计（字）
+  size_t used_words() const     { return _used_words; }
+  size_t capacity_words() const;
+  int    num_chunks() const     { return _num_chunks; }
+  size_t free_block_words() const;
+
+  void print_on(outputStream* st, const char* name) const;
+};
+
+} // namespace metaspace
+
+#endif // MY_JVM_MEMORY_METASPACE_SPACEMANAGER_HPP
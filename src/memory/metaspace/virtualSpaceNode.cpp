@@ -0,0 +1,86 @@
+/*
+ * my_jvm - Metaspace virtual space node implementation
+ */
+
+#include "memory/metaspace/virtualSpaceNode.hpp"
+#include "runtime/os.hpp"
+
+namespace metaspace {
+
+// ========== VirtualSpaceNode ==========
+
+VirtualSpaceNode* VirtualSpaceNode::create(size_t word_size) {
+  assert(is_aligned(word_size, MAX_CHUNK_WORD_SIZE), "node must hold whole root chunks");
+  char* base = os::reserve_memory_aligned(word_size * BytesPerWord, MAX_CHUNK_BYTE_SIZE);
+  if (base == nullptr) {
+    return nullptr;
+  }
+  return new VirtualSpaceNode((MetaWord*)base, word_size);
+}
+
+VirtualSpaceNode::~VirtualSpaceNode() {
+  os::release_memory((char*)_base, _word_size * BytesPerWord);
+}
+
+Metachunk* VirtualSpaceNode::allocate_root_chunk() {
+  if (_top + MAX_CHUNK_WORD_SIZE > end()) {
+    return nullptr;
+  }
+  Metachunk* c = new Metachunk(_top, ROOT_CHUNK_LEVEL, this);
+  _top += MAX_CHUNK_WORD_SIZE;
+  return c;
+}
+
+// ========== VirtualSpaceList ==========
+
+VirtualSpaceList::~VirtualSpaceList() {
+  VirtualSpaceNode* n = _first;
+  while (n != nullptr) {
+    VirtualSpaceNode* next = n->next();
+    delete n;
+    n = next;
+  }
+}
+
+Metachunk* VirtualSpaceList::allocate_root_chunk() {
+  if (_current != nullptr) {
+    Metachunk* c = _current->allocate_root_chunk();
+    if (c != nullptr) {
+      return c;
+    }
+  }
+  if (!_can_expand) {
+    return nullptr;
+  }
+  VirtualSpaceNode* node = VirtualSpaceNode::create(_node_word_size);
+  if (node == nullptr) {
+    return nullptr;
+  }
+  node->set_next(_first);
+  _first = _current = node;
+  _num_nodes++;
+  return node->allocate_root_chunk();
+}
+
+bool VirtualSpaceList::contains(const void* p) const {
+  for (VirtualSpaceNode* n = _first; n != nullptr; n = n->next()) {
+    if (n->contains(p)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t VirtualSpaceList::reserved_words() const {
+  return (size_t)_num_nodes * _node_word_size;
+}
+
+size_t VirtualSpaceList::used_words() const {
+  size_t sum = 0;
+  for (VirtualSpaceNode* n = _first; n != nullptr; n = n->next()) {
+    sum += n->used_words();
+  }
+  return sum;
+}
+
+} // namespace metaspace
@@ -0,0 +1,83 @@
+/*
+ * my_jvm - Metaspace virtual space node
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/metaspace/virtualSpaceNode.hpp
+ *      hotspot/src/hotspot/share/memory/metaspace/virtualSpaceList.hpp
+ * 简化版本：每个 node 用 mmap 预留一段按 root chunk 对齐的地址空间，
+ * 从低到高切出 root chunk；物理页在首次访问时才分配，没有单独的 commit 步骤。
+ */
+
+#ifndef MY_JVM_MEMORY_METASPACE_VIRTUALSPACENODE_HPP
+#define MY_JVM_MEMORY_METASPACE_VIRTUALSPACENODE_HPP
+
+#include "memory/allocation.hpp"
+#include "memory/metaspace/metachunk.hpp"
+
+namespace metaspace {
+
+// ========== VirtualSpaceNode ==========
+
+class VirtualSpaceNode : public CHeapObj<mtClass> {
+ private:
+  MetaWord*         _base;
+  MetaWord*         _top;          // 尚未切出 root chunk 的起点
+  size_t            _word_size;    // 预留大小
+  VirtualSpaceNode* _next;
+
+  VirtualSpaceNode(MetaWord* base, size_t word_size)
+    : _base(base), _top(base), _word_size(word_size), _next(nullptr) {}
+
+ public:
+  // 预留 word_size 个字（root chunk 大小的整数倍），失败返回 nullptr
+  static VirtualSpaceNode* create(size_t word_size);
+  ~VirtualSpaceNode();
+
+  // 切出一个 root chunk，空间用完返回 nullptr
+  Metachunk* allocate_root_chunk();
+
+  MetaWord* base() const         { return _base; }
+  MetaWord* end() const          { return _base + _word_size; }
+  size_t    word_size() const    { return _word_size; }
+  size_t    used_words() const   { return (size_t)(_top - _base); }
+  bool      contains(const void* p) const {
+    return (const MetaWord*)p >= _base && (const MetaWord*)p < end();
+  }
+
+  VirtualSpaceNode* next() const     { return _next; }
+  void set_next(VirtualSpaceNode* n) { _next = n; }
+};
+
+// ========== VirtualSpaceList ==========
+// 所有 node 组成的链表，调用方（ChunkManager）持锁。
+// 压缩类空间只有一个固定的 node，不能扩展
+
+class VirtualSpaceList : public CHeapObj<mtClass> {
+ private:
+  VirtualSpaceNode* _first;
+  VirtualSpaceNode* _current;      // 正在切 root chunk 的 node
+  size_t            _node_word_size;
+  int               _num_nodes;
+  bool              _can_expand;
+
+ public:
+  VirtualSpaceList(size_t node_word_size)
+    : _first(nullptr), _current(nullptr), _node_word_size(node_word_size), _num_nodes(0),
+      _can_expand(true) {}
+  // 只用给定的 node
+  VirtualSpaceList(VirtualSpaceNode* node)
+    : _first(node), _current(node), _node_word_size(node->word_size()), _num_nodes(1),
+      _can_expand(false) {}
+  ~VirtualSpaceList();
+
+  // 当前 node 用完时预留新 node；预留失败或不能扩展时返回 nullptr
+  Metachunk* allocate_root_chunk();
+
+  bool   contains(const void* p) const;
+  size_t reserved_words() const;
+  size_t used_words() const;
+  int    num_nodes() const { return _num_nodes; }
+};
+
+} // namespace metaspace
+
+#endif // MY_JVM_MEMORY_METASPACE_VIRTUALSPACENODE_HPP
@@ -2,13 +2,17 @@
  * my_jvm - Resource Area (简化版)
  * 
  * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/resourceArea.hpp
- * 简化版本：去除 Thread 依赖，只保留 Arena 状态保存/恢复
+ * 简化版本：只保留 Arena 状态保存/恢复
+ *
+ * 每个线程一个 ResourceArea（Thread::resource_area()），
+ * 分配快速路径无需任何同步
  */
 
 #ifndef MY_JVM_MEMORY_RESOURCEAREA_HPP
 #define MY_JVM_MEMORY_RESOURCEAREA_HPP
 
 #include "memory/arena.hpp"
+#include "runtime/thread.hpp"
 
 // ========== ResourceArea ==========
 
@@ -32,39 +36,44 @@ class ResourceMark : public StackObj {
  protected:
   ResourceArea* _area;       // 关联的 ResourceArea
   Chunk*        _chunk;      // 保存的 Chunk
+  Chunk*        _last;       // 保存的链表尾
   char*         _hwm;        // 保存的高水位
   char*         _max;        // 保存的最大边界
   size_t        _size_in_bytes; // 保存的总大小
+  size_t        _prior_used;    // 保存的非当前 Chunk 已用字节
+  size_t        _next_chunk_len; // 保存的下次扩展大小，避免循环里的标记让 Chunk 越长越大
 
  public:
   ResourceMark(ResourceArea* r) 
     : _area(r), 
       _chunk(r->_chunk), 
+      _last(r->_last),
       _hwm(r->_hwm), 
       _max(r->_max),
-      _size_in_bytes(r->_size_in_bytes) {}
+      _size_in_bytes(r->_size_in_bytes),
+      _prior_used(r->_prior_used),
+      _next_chunk_len(r->_next_chunk_len) {}
+
+  // 标记指定线程 / 当前线程的 ResourceArea
+  ResourceMark(Thread* thread) : ResourceMark(thread->resource_area()) {}
+  ResourceMark() : ResourceMark(Thread::current()) {}
 
   ~ResourceMark() {
     reset_to_mark();
   }
 
   void reset_to_mark() {
-    // 释放后续 Chunk
-    if (_chunk != nullptr && _chunk->next() != nullptr) {
-      Chunk* k = _chunk->next();
-      while (k != nullptr) {
-        Chunk* next = k->next();
-        delete k;
-        k = next;
-      }
-      _chunk->set_next(nullptr);
-    }
-    
+    // 链表按分配先后排列，释放标记时链表尾之后的 Chunk（标准大小的回到 ChunkPool）；
+    // 标记时 Arena 还是空的（_last 为 nullptr）则整条链表都释放
+    _area->free_chunks_after(_last);
+
     // 恢复 Arena 状态
     _area->_chunk = _chunk;
     _area->_hwm = _hwm;
     _area->_max = _max;
-    _area->_size_in_bytes = _size_in_bytes;
+    _area->_prior_used = _prior_used;
+    _area->_next_chunk_len = _next_chunk_len;
+    _area->set_size_in_bytes(_size_in_bytes);
   }
 };
 
@@ -76,8 +85,10 @@ class ResourceMark : public StackObj {
 #define NEW_RESOURCE_OBJ(type) \
   NEW_RESOURCE_ARRAY(type, 1)
 
-// 全局 ResourceArea（简化版）
-extern ResourceArea* current_resource_area();
+// 当前线程的 ResourceArea
+inline ResourceArea* current_resource_area() {
+  return Thread::current()->resource_area();
+}
 
 inline void* resource_allocate_bytes(size_t size, 
                                      AllocFailType alloc_failmode = AllocFailStrategy::EXIT_OOM) {
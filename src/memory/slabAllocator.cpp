@@ -0,0 +1,381 @@
+/*
+ * my_jvm - Slab allocator implementation
+ */
+
+#include "memory/slabAllocator.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/mutex.hpp"
+#include "runtime/os.hpp"
+#include "utilities/ostream.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// ========== 大小类 ==========
+
+const u2 SlabAllocator::_class_size[NumSizeClasses] = {
+   16,  32,  48,  64,  80,  96, 112, 128,
+  160, 192, 224, 256, 320, 384, 448, 512,
+  640, 768, 896, 1040
+};
+
+// 下标为 (size + 15) / 16
+const u1 SlabAllocator::_size_to_class[MaxBlockSize / 16 + 1] = {
+   0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  8,  9,  9, 10, 10, 11,
+  11, 12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15,
+  15, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17,
+  17, 18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19,
+  19, 19
+};
+
+// ========== 全局状态 ==========
+
+uintptr_t SlabAllocator::_base     = 0;
+uintptr_t SlabAllocator::_reserved = 0;
+
+thread_local SlabThreadCache* SlabAllocator::_cache         = nullptr;
+thread_local bool             SlabAllocator::_cache_retired = false;
+
+// 每种 (MEMFLAGS, 大小类) 的中心链表：还有空闲块的 Slab
+struct SlabClass {
+  SpinLock        _lock;
+  Slab*           _partial;
+  volatile size_t _used;      // 分出去的块数（包括各线程 magazine 中的），持锁更新
+
+  constexpr SlabClass() : _lock(SpinLock::special + 1, "SlabClass"), _partial(nullptr), _used(0) {}
+};
+
+static SlabClass      _slab_classes[mt_number_of_types][SlabAllocator::NumSizeClasses];
+
+// 保护下面几个字段；加锁顺序总是先 SlabClass 再它
+static SpinLock       _slab_lock(SpinLock::special, "SlabAllocator");
+static bool           _slab_init_failed = false;
+static uintptr_t      _slab_top = 0;          // 预留区间中还没切过的部分
+static Slab*          _empty_slabs = nullptr; // 空 Slab，可以给任意 (MEMFLAGS, 大小类) 复用
+static size_t         _slabs_in_use = 0;
+static size_t         _slabs_free = 0;
+
+// 所有线程缓存，usage() 遍历；加锁顺序在 SlabClass 之前
+static SpinLock         _caches_lock(SpinLock::special + 2, "SlabThreadCache list");
+static SlabThreadCache* _caches = nullptr;
+
+// Slab 头之后第一个块的偏移
+static const size_t slab_header_size = (sizeof(Slab) + 15) & ~(size_t)15;
+
+static char* slab_end(Slab* s) {
+  return (char*)s + SlabAllocator::SlabSize;
+}
+
+// 第一次走慢速路径时预留地址空间；失败后不再重试，全部回退到 malloc
+bool SlabAllocator::initialize() {
+  if (_slab_init_failed) {
+    return false;
+  }
+  _slab_lock.lock();
+  if (_reserved == 0 && !_slab_init_failed) {
+    char* base = os::reserve_memory_aligned(ReservedSize, SlabSize);
+    if (base == nullptr) {
+      _slab_init_failed = true;
+    } else {
+      _base = _slab_top = (uintptr_t)base;
+      // 最后设置 _reserved，之后 contains() 才会返回 true
+      atomic_store(&_reserved, (uintptr_t)ReservedSize);
+    }
+  }
+  bool ok = (_reserved != 0);
+  _slab_lock.unlock();
+  return ok;
+}
+
+// ========== Slab 的分配与回收（持有 SlabClass 的锁） ==========
+
+static Slab* new_slab(MEMFLAGS flags, int cls, uintptr_t limit) {
+  _slab_lock.lock();
+  Slab* s = _empty_slabs;
+  if (s != nullptr) {
+    _empty_slabs = s->_next;
+    _slabs_free--;
+  } else if (_slab_top + SlabAllocator::SlabSize <= limit) {
+    s = (Slab*)_slab_top;
+    _slab_top += SlabAllocator::SlabSize;
+  }
+  if (s != nullptr) {
+    _slabs_in_use++;
+  }
+  _slab_lock.unlock();
+
+  if (s != nullptr) {
+    s->_flags = flags;
+    s->_class = cls;
+    s->_prev = s->_next = nullptr;
+    s->_free = nullptr;
+    s->_top = (char*)s + slab_header_size;
+    s->_used = 0;
+    s->_on_partial = false;
+  }
+  return s;
+}
+
+static void free_slab(Slab* s) {
+  _slab_lock.lock();
+  s->_next = _empty_slabs;
+  _empty_slabs = s;
+  _slabs_in_use--;
+  _slabs_free++;
+  _slab_lock.unlock();
+}
+
+static void partial_add(SlabClass* sc, Slab* s) {
+  s->_prev = nullptr;
+  s->_next = sc->_partial;
+  if (sc->_partial != nullptr) {
+    sc->_partial->_prev = s;
+  }
+  sc->_partial = s;
+  s->_on_partial = true;
+}
+
+static void partial_remove(SlabClass* sc, Slab* s) {
+  if (s->_prev != nullptr) {
+    s->_prev->_next = s->_next;
+  } else {
+    sc->_partial = s->_next;
+  }
+  if (s->_next != nullptr) {
+    s->_next->_prev = s->_prev;
+  }
+  s->_prev = s->_next = nullptr;
+  s->_on_partial = false;
+}
+
+// 从中心链表取最多 n 个块，返回实际取到的个数
+static int refill(MEMFLAGS flags, int cls, void** out, int n, uintptr_t limit) {
+  SlabClass* sc = &_slab_classes[flags][cls];
+  size_t bs = SlabAllocator::class_size(cls);
+  int got = 0;
+  sc->_lock.lock();
+  while (got < n) {
+    Slab* s = sc->_partial;
+    if (s == nullptr) {
+      s = new_slab(flags, cls, limit);
+      if (s == nullptr) {
+        break;
+      }
+      partial_add(sc, s);
+    }
+    while (got < n) {
+      void* b;
+      if (s->_free != nullptr) {
+        b = s->_free;
+        s->_free = *(void**)b;
+      } else if (s->_top + bs <= slab_end(s)) {
+        b = s->_top;
+        s->_top += bs;
+      } else {
+        break;
+      }
+      s->_used++;
+      out[got++] = b;
+    }
+    if (s->_free == nullptr && s->_top + bs > slab_end(s)) {
+      partial_remove(sc, s);
+    }
+  }
+  sc->_used = sc->_used + got;
+  sc->_lock.unlock();
+  return got;
+}
+
+// 把 n 个同一 (MEMFLAGS, 大小类) 的块还给各自的 Slab
+static void release(MEMFLAGS flags, int cls, void** blocks, int n) {
+  SlabClass* sc = &_slab_classes[flags][cls];
+  sc->_lock.lock();
+  for (int i = 0; i < n; i++) {
+    void* b = blocks[i];
+    Slab* s = SlabAllocator::slab_of(b);
+    *(void**)b = s->_free;
+    s->_free = b;
+    s->_used--;
+    if (!s->_on_partial) {
+      partial_add(sc, s);
+    }
+    // 空 Slab 交回全局复用，但每种类型至少留一个，避免来回切换
+    if (s->_used == 0 && (sc->_partial != s || s->_next != nullptr)) {
+      partial_remove(sc, s);
+      free_slab(s);
+    }
+  }
+  sc->_used = sc->_used - n;
+  sc->_lock.unlock();
+}
+
+// ========== 线程缓存 ==========
+
+// 线程退出时归还 magazine（thread_local 析构函数在线程退出时运行）
+class SlabThreadCacheRetirer {
+ public:
+  ~SlabThreadCacheRetirer() {
+    SlabAllocator::retire_thread();
+  }
+};
+
+static SlabThreadCache* register_thread(SlabThreadCache** cache_addr, bool retired) {
+  if (retired) {
+    // 线程正在退出，之后的分配/释放直接走中心链表
+    return nullptr;
+  }
+  // 缓存和 magazine 用 ::calloc 分配，不经过 AllocateHeap，避免递归
+  SlabThreadCache* cache = (SlabThreadCache*)::calloc(1, sizeof(SlabThreadCache));
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  static thread_local SlabThreadCacheRetirer retirer;
+  (void)retirer;
+
+  _caches_lock.lock();
+  cache->_next = _caches;
+  _caches = cache;
+  _caches_lock.unlock();
+
+  *cache_addr = cache;
+  return cache;
+}
+
+static SlabMagazine* get_magazine(SlabThreadCache* cache, MEMFLAGS flags, int cls) {
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  SlabMagazine* m = cache->_magazines[flags][cls];
+  if (m == nullptr) {
+    m = (SlabMagazine*)::calloc(1, sizeof(SlabMagazine));
+    // usage() 在其他线程读
+    Atomic::store(&cache->_magazines[flags][cls], m, memory_order_release);
+  }
+  return m;
+}
+
+void SlabAllocator::retire_thread() {
+  SlabThreadCache* cache = _cache;
+  _cache = nullptr;
+  _cache_retired = true;
+  if (cache == nullptr) {
+    return;
+  }
+
+  // 持锁摘下并归还，保证 usage() 不会漏算或重复计算 magazine 里的块
+  _caches_lock.lock();
+  SlabThreadCache** p = &_caches;
+  while (*p != cache) {
+    p = &(*p)->_next;
+  }
+  *p = cache->_next;
+  for (int f = 0; f < mt_number_of_types; f++) {
+    for (int c = 0; c < NumSizeClasses; c++) {
+      SlabMagazine* m = cache->_magazines[f][c];
+      if (m != nullptr && m->_count > 0) {
+        release((MEMFLAGS)f, c, m->_blocks, m->_count);
+      }
+    }
+  }
+  _caches_lock.unlock();
+
+  for (int f = 0; f < mt_number_of_types; f++) {
+    for (int c = 0; c < NumSizeClasses; c++) {
+      ::free(cache->_magazines[f][c]);
+    }
+  }
+  ::free(cache);
+}
+
+// ========== 慢速路径 ==========
+
+void* SlabAllocator::allocate_slow(int cls, MEMFLAGS flags) {
+  if (_reserved == 0 && !initialize()) {
+    return nullptr;
+  }
+  uintptr_t limit = _base + _reserved;
+
+  SlabThreadCache* cache = _cache;
+  if (cache == nullptr) {
+    cache = register_thread(&_cache, _cache_retired);
+  }
+  SlabMagazine* m = get_magazine(cache, flags, cls);
+  if (m == nullptr) {
+    void* b;
+    return refill(flags, cls, &b, 1, limit) == 1 ? b : nullptr;
+  }
+  m->_count = refill(flags, cls, m->_blocks, BatchSize, limit);
+  if (m->_count == 0) {
+    return nullptr;
+  }
+  return m->_blocks[--m->_count];
+}
+
+void SlabAllocator::free_slow(void* p) {
+  Slab* slab = slab_of(p);
+  MEMFLAGS flags = slab->_flags;
+  int cls = slab->_class;
+
+  SlabThreadCache* cache = _cache;
+  if (cache == nullptr) {
+    cache = register_thread(&_cache, _cache_retired);
+  }
+  SlabMagazine* m = get_magazine(cache, flags, cls);
+  if (m == nullptr) {
+    release(flags, cls, &p, 1);
+    return;
+  }
+  if (m->_count == MagazineSize) {
+    // 满了：把最早放进来的一批还回去，留下最近释放的（缓存里还热）
+    release(flags, cls, m->_blocks, BatchSize);
+    memmove(&m->_blocks[0], &m->_blocks[BatchSize], (MagazineSize - BatchSize) * sizeof(void*));
+    m->_count -= BatchSize;
+  }
+  m->_blocks[m->_count++] = p;
+}
+
+// ========== 统计 ==========
+
+void SlabAllocator::usage(MEMFLAGS flags, size_t* count, size_t* bytes) {
+  // 先读 magazine 再读中心计数：中间发生的 refill 只会让结果偏大
+  intptr_t cached[NumSizeClasses] = {};
+  _caches_lock.lock();
+  for (SlabThreadCache* cache = _caches; cache != nullptr; cache = cache->_next) {
+    for (int c = 0; c < NumSizeClasses; c++) {
+      SlabMagazine* m = Atomic::load(&cache->_magazines[flags][c], memory_order_acquire);
+      if (m != nullptr) {
+        cached[c] += Atomic::load(&m->_count);
+      }
+    }
+  }
+  _caches_lock.unlock();
+
+  *count = 0;
+  *bytes = 0;
+  for (int c = 0; c < NumSizeClasses; c++) {
+    intptr_t n = (intptr_t)Atomic::load(&_slab_classes[flags][c]._used) - cached[c];
+    if (n > 0) {
+      *count += (size_t)n;
+      *bytes += (size_t)n * class_size(c);
+    }
+  }
+}
+
+size_t SlabAllocator::slabs_in_use() {
+  return _slabs_in_use;
+}
+
+size_t SlabAllocator::slabs_free() {
+  return _slabs_free;
+}
+
+void SlabAllocator::print_statistics(outputStream* st) {
+  _slab_lock.lock();
+  size_t in_use = _slabs_in_use;
+  size_t free = _slabs_free;
+  size_t carved = _reserved == 0 ? 0 : (size_t)(_slab_top - _base);
+  _slab_lock.unlock();
+  st->print_cr("SlabAllocator statistics:");
+  st->print_cr("  reserved=" SIZE_FORMAT "K carved=" SIZE_FORMAT "K slabs in use=" SIZE_FORMAT
+               " empty=" SIZE_FORMAT,
+               _reserved / 1024, carved / 1024, in_use, free);
+}
@@ -0,0 +1,153 @@
+/*
+ * my_jvm - Slab allocator
+ *
+ * OpenJDK 11 的 C 堆分配（os::malloc）直接走 libc malloc。
+ * VM 内部有大量同样大小的小对象（Chunk 头、符号、监视器、句柄块），
+ * 这里给 AllocateHeap / FreeHeap 加一层 slab 分配器：
+ *
+ *  - 大小类：16 ~ 1040 字节共 20 档，相邻档位相差不超过 25%。最大一档是 1024 加上
+ *    NMT 的 16 字节 MallocHeader：1K 的请求（stringStream 的默认缓冲区等）在 NMT detail 下仍在 slab 里
+ *  - Slab：从一段预留的虚拟地址空间里切出 64K 对齐的块，每个 Slab 只放
+ *    同一种 (MEMFLAGS, 大小类) 的对象，Slab 头记录类型，释放时按地址找回
+ *  - Magazine：每个线程每种 (MEMFLAGS, 大小类) 一个小数组缓存空闲块，
+ *    快速路径不加锁；空了/满了才成批和中心链表交换
+ *  - NMT summary：slab 块不带 MallocHeader，某种 MEMFLAGS 的用量由 usage() 得出
+ *   （中心链表分出去的块减去各线程 magazine 里缓存的），快速路径上没有额外的统计
+ *
+ * 大于 MaxBlockSize 的请求、预留空间用完时，回退到 malloc。
+ * -XX:-UseSlabAllocator 关闭（必须在第一次分配之前设置）。
+ */
+
+#ifndef MY_JVM_MEMORY_SLABALLOCATOR_HPP
+#define MY_JVM_MEMORY_SLABALLOCATOR_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include "utilities/macros.hpp"
+
+class outputStream;
+class SlabMagazine;
+class SlabThreadCache;
+
+// ========== Slab ==========
+// 位于每个 Slab 的开头，后面紧跟着块
+
+struct Slab {
+  // 分配给某个 (MEMFLAGS, 大小类) 后不变，释放的快速路径只读这两个字段
+  MEMFLAGS _flags;
+  int      _class;
+
+  // 以下由所属 (MEMFLAGS, 大小类) 的中心锁保护
+  Slab*    _prev;         // 有空闲块的 Slab 组成的双向链表
+  Slab*    _next;
+  void*    _free;         // 已释放块的单链表
+  char*    _top;          // 从未分配过的区域的起点
+  size_t   _used;         // 分配出去的块数（包括各线程 magazine 中的）
+  bool     _on_partial;   // 是否在双向链表上
+};
+
+class SlabAllocator : AllStatic {
+ public:
+  enum {
+    SlabSize       = 64 * 1024,   // 每个 Slab 的大小，也是对齐单位
+    MaxBlockSize   = 1024 + 16,   // 超过的请求走 malloc
+    NumSizeClasses = 20,
+    MagazineSize   = 32,          // 每个 magazine 最多缓存的块数
+    BatchSize      = 16           // magazine 与中心链表之间一次搬运的块数
+  };
+
+  // 预留的虚拟地址空间（物理页在首次使用时才分配）
+  static const size_t ReservedSize = (size_t)1024 * 1024 * 1024;
+
+ private:
+  static uintptr_t _base;         // 预留区间起点，未初始化时为 0
+  static uintptr_t _reserved;     // 预留区间大小，未初始化时为 0
+
+  static thread_local SlabThreadCache* _cache;
+  static thread_local bool             _cache_retired;
+
+  static const u2 _class_size[NumSizeClasses];
+  static const u1 _size_to_class[MaxBlockSize / 16 + 1];
+
+  static bool  initialize();
+  static void* allocate_slow(int cls, MEMFLAGS flags);
+  static void  free_slow(void* p);
+
+  static inline SlabMagazine* magazine(SlabThreadCache* cache, MEMFLAGS flags, int cls);
+
+ public:
+  static int    size_class(size_t size)    { return _size_to_class[(size + 15) >> 4]; }
+  static size_t class_size(int cls)        { return _class_size[cls]; }
+
+  // p 是否是 slab 分配的块（可以在任意线程、任意时刻调用）
+  static bool contains(const void* p) {
+    return (uintptr_t)p - _base < _reserved;
+  }
+
+  // 分配 size 字节（size <= MaxBlockSize），返回 16 字节对齐的块；
+  // 预留空间用完时返回 nullptr，由调用方回退到 malloc
+  static inline void* allocate(size_t size, MEMFLAGS flags);
+  static inline void  free(void* p);
+
+  static Slab* slab_of(const void* p) {
+    return (Slab*)((uintptr_t)p & ~((uintptr_t)SlabSize - 1));
+  }
+
+  // 块所在 Slab 的 MEMFLAGS 和块大小
+  static MEMFLAGS block_flags(const void* p) { return slab_of(p)->_flags; }
+  static size_t   block_size(const void* p)  { return class_size(slab_of(p)->_class); }
+
+  // flags 类型已分配出去的块数和字节数（按大小类计）。遍历所有线程缓存，结果是近似快照
+  static void usage(MEMFLAGS flags, size_t* count, size_t* bytes);
+
+  // 线程退出时把 magazine 中的块还给中心链表
+  static void retire_thread();
+
+  // 统计
+  static size_t slabs_in_use();
+  static size_t slabs_free();
+  static void   print_statistics(outputStream* st);
+};
+
+// ========== SlabMagazine / SlabThreadCache ==========
+// 线程私有，不需要同步
+
+class SlabMagazine {
+ public:
+  int   _count;
+  void* _blocks[SlabAllocator::MagazineSize];
+};
+
+class SlabThreadCache {
+ public:
+  // 按需分配，大部分线程只用到少数几种 (MEMFLAGS, 大小类)
+  SlabMagazine*    _magazines[mt_number_of_types][SlabAllocator::NumSizeClasses];
+  SlabThreadCache* _next;   // 所有线程缓存的链表，usage() 遍历
+};
+
+// ========== 快速路径 ==========
+
+inline SlabMagazine* SlabAllocator::magazine(SlabThreadCache* cache, MEMFLAGS flags, int cls) {
+  return cache == nullptr ? nullptr : cache->_magazines[flags][cls];
+}
+
+inline void* SlabAllocator::allocate(size_t size, MEMFLAGS flags) {
+  int cls = size_class(size);
+  SlabMagazine* m = magazine(_cache, flags, cls);
+  if (MY_JVM_LIKELY(m != nullptr && m->_count > 0)) {
+    return m->_blocks[--m->_count];
+  }
+  return allocate_slow(cls, flags);
+}
+
+inline void SlabAllocator::free(void* p) {
+  Slab* slab = slab_of(p);
+  SlabMagazine* m = magazine(_cache, slab->_flags, slab->_class);
+  if (MY_JVM_LIKELY(m != nullptr && m->_count < MagazineSize)) {
+    m->_blocks[m->_count++] = p;
+    return;
+  }
+  free_slow(p);
+}
+
+#endif // MY_JVM_MEMORY_SLABALLOCATOR_HPP
@@ -0,0 +1,85 @@
+/*
+ * my_jvm - Reserved virtual address space implementation
+ */
+
+#include "memory/virtualspace.hpp"
+#include "oops/compressedOops.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/os.hpp"
+
+// ========== ReservedSpace ==========
+
+ReservedSpace::ReservedSpace(size_t size, size_t alignment)
+  : _base(os::reserve_memory_aligned(size, alignment)), _size(size), _alignment(alignment) {
+  if (_base == nullptr) {
+    _size = 0;
+  }
+}
+
+void ReservedSpace::release() {
+  if (_base != nullptr) {
+    os::release_memory(_base, _size);
+    _base = nullptr;
+    _size = 0;
+  }
+}
+
+// ========== ReservedHeapSpace ==========
+
+bool ReservedHeapSpace::try_reserve_range(uint64_t highest, uint64_t lowest,
+                                          size_t size, size_t alignment) {
+  highest = align_down(highest, alignment);
+  lowest  = align_up(lowest, alignment);
+  if (highest < lowest) {
+    return false;
+  }
+  uint64_t stride = align_up((highest - lowest) / AttemptsPerRange, alignment);
+  if (stride == 0) {
+    stride = alignment;
+  }
+  for (uint64_t attach = highest; attach >= lowest; attach -= stride) {
+    char* base = os::attempt_reserve_memory_at((char*)attach, size);
+    if (base != nullptr) {
+      _base = base;
+      _size = size;
+      _alignment = alignment;
+      return true;
+    }
+    if (attach < lowest + stride) {
+      break;
+    }
+  }
+  return false;
+}
+
+ReservedHeapSpace::ReservedHeapSpace(size_t size, size_t alignment) : ReservedSpace() {
+  size = align_up(size, alignment);
+  if (UseCompressedOops && size + MinObjAlignmentInBytes > CompressedOops::OopEncodingHeapMax) {
+    // 32 位放不下整个堆，和 OpenJDK 的参数推导一样关掉压缩指针
+    UseCompressedOops = false;
+  }
+  if (UseCompressedOops) {
+    const uint64_t min_base = align_up((uint64_t)HeapBaseMinAddress, (uint64_t)alignment);
+    // 堆顶不超过 4G
+    if (min_base + size <= CompressedOops::UnscaledOopHeapMax) {
+      try_reserve_range(CompressedOops::UnscaledOopHeapMax - size, min_base, size, alignment);
+    }
+    // 堆顶不超过 32G
+    if (!is_reserved() && min_base + size <= CompressedOops::OopEncodingHeapMax) {
+      try_reserve_range(CompressedOops::OopEncodingHeapMax - size,
+                        MAX2(min_base, CompressedOops::UnscaledOopHeapMax), size, alignment);
+    }
+  }
+  if (!is_reserved()) {
+    char* base = os::reserve_memory_aligned(size, alignment);
+    if (base == nullptr) {
+      return;
+    }
+    _base = base;
+    _size = size;
+    _alignment = alignment;
+  }
+  if (UseCompressedOops) {
+    CompressedOops::initialize((address)_base, _size);
+  }
+}
@@ -0,0 +1,64 @@
+/*
+ * my_jvm - Reserved virtual address space
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/memory/virtualspace.hpp
+ * 简化版本：ReservedSpace 只记录一段预留的地址空间（物理页在首次访问时分配），
+ * ReservedHeapSpace 预留 Java 堆时按 UseCompressedOops 选择位置，
+ * 并据此确定压缩指针的模式（见 oops/compressedOops.hpp）。
+ */
+
+#ifndef MY_JVM_MEMORY_VIRTUALSPACE_HPP
+#define MY_JVM_MEMORY_VIRTUALSPACE_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+// ========== ReservedSpace ==========
+
+class ReservedSpace {
+ protected:
+  char*  _base;
+  size_t _size;
+  size_t _alignment;
+
+  ReservedSpace(char* base, size_t size, size_t alignment)
+    : _base(base), _size(size), _alignment(alignment) {}
+
+ public:
+  ReservedSpace() : _base(nullptr), _size(0), _alignment(0) {}
+  // 在任意地址预留，起点按 alignment 对齐；失败时 is_reserved() 为 false
+  ReservedSpace(size_t size, size_t alignment);
+
+  char*  base() const        { return _base; }
+  char*  end() const         { return _base + _size; }
+  size_t size() const        { return _size; }
+  size_t alignment() const   { return _alignment; }
+  bool   is_reserved() const { return _base != nullptr; }
+
+  bool contains(const void* p) const {
+    return (const char*)p >= _base && (const char*)p < end();
+  }
+
+  void release();
+};
+
+// ========== ReservedHeapSpace ==========
+// UseCompressedOops 时依次尝试：
+//   1. 堆顶不超过 4G（Unscaled，解码不需要移位和加基址）
+//   2. 堆顶不超过 32G（ZeroBased，只需移位）
+//   3. 任意地址（HeapBased）
+// 每一档从高到低试几个地址，都不低于 HeapBaseMinAddress
+
+class ReservedHeapSpace : public ReservedSpace {
+ private:
+  enum { AttemptsPerRange = 8 };
+
+  // 在 [lowest, highest] 之间按 alignment 对齐地试若干个起点
+  bool try_reserve_range(uint64_t highest, uint64_t lowest, size_t size, size_t alignment);
+
+ public:
+  // 成功后已经调用过 CompressedOops::initialize；失败时 is_reserved() 为 false
+  ReservedHeapSpace(size_t size, size_t alignment);
+};
+
+#endif // MY_JVM_MEMORY_VIRTUALSPACE_HPP
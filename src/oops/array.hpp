@@ -10,6 +10,7 @@
 
 #include "globalDefinitions.hpp"
 #include "metadata.hpp"
+#include "utilities/vectorSearch.hpp"
 
 // ========== Array 模板类 ==========
 // 参考：array.hpp 第 36-155 行
@@ -22,6 +23,21 @@ private:
     T   _data[1];                       // 数组内存（变长数组）
 
 public:
+    // ========== 构造与大小 ==========
+    // 在 Metaspace 中分配：new (loader_data, Array<T>::size(length)) Array<T>(length)
+    // 通常经 MetadataFactory::new_array 调用
+
+    Array() : _length(0) {}
+    explicit Array(int length) : _length(length) {}
+
+    // length 个元素的数组占用的字数（_data 已包含一个元素）
+    static int size(int length) {
+        size_t bytes = sizeof(Array<T>) + (size_t)MAX2(length - 1, 0) * sizeof(T);
+        return (int)(align_up(bytes, (size_t)BytesPerWord) / BytesPerWord);
+    }
+
+    int size() const { return size(_length); }
+
     // ========== 基本操作 ==========
 
     int length() const { return _length; }
@@ -47,11 +63,11 @@ public:
     }
 
     // ========== 查找 ==========
+    // 和 OpenJDK 一样从后往前找，返回最后一个相等元素的下标；
+    // 指针、整数元素走 VectorSearch 的 SIMD 核心
 
     int index_of(const T& x) const {
-        int i = _length;
-        while (i-- > 0 && _data[i] != x);
-        return i;
+        return VectorSearch::find_last(_data, _length, x);
     }
 
     bool contains(const T& x) const {
@@ -0,0 +1,250 @@
+/*
+ * my_jvm - Compressed pointers
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/oops/oop.inline.hpp（encode/decode_klass）
+ *      hotspot/src/hotspot/share/memory/universe.hpp（narrow_klass_base/shift）
+ * 以及 JDK 13+ 的 oops/compressedOops.hpp（CompressedKlassPointers）
+ *
+ * 压缩对象指针：narrowOop = (oop - base) >> shift，模式在预留堆时确定：
+ *   Unscaled   堆顶 <= 4G        oop = narrowOop
+ *   ZeroBased  堆顶 <= 32G       oop = narrowOop << 3
+ *   HeapBased  其他              oop = base + (narrowOop << 3)，0 仍表示空指针
+ * 热路径（字段访问、GC 扫描）按模式实例化模板 NarrowOopCodec<M>，
+ * 解码不需要读全局变量也没有分支（HeapBased 除外需要判空）。
+ *
+ * 压缩类指针：Klass 只分配在压缩类空间（Metaspace 的 class space）里，
+ * narrowKlass = (Klass* - base) >> shift，32 位即可寻址整个空间。
+ * 0 表示空指针：Metaspace 把 base 处最小的一个 chunk 留作保护区，
+ * 不会有 Klass 分配在偏移 0 处。
+ */
+
+#ifndef MY_JVM_OOPS_COMPRESSEDOOPS_HPP
+#define MY_JVM_OOPS_COMPRESSEDOOPS_HPP
+
+#include "globalDefinitions.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/debug.hpp"
+#include <type_traits>
+
+// ========== 常量 ==========
+// 参考：globalDefinitions.hpp LogKlassAlignmentInBytes
+
+const int    LogKlassAlignmentInBytes = 3;
+const int    KlassAlignmentInBytes    = 1 << LogKlassAlignmentInBytes;
+
+// 对象按 8 字节对齐（ObjectAlignmentInBytes 固定为 8）
+const int    LogMinObjAlignmentInBytes = 3;
+const int    MinObjAlignmentInBytes    = 1 << LogMinObjAlignmentInBytes;
+
+// ========== CompressedOops ==========
+// 参考：universe.hpp NARROW_OOP_MODE / narrow_oop_base / narrow_oop_shift
+
+class CompressedOops {
+public:
+    enum Mode {
+        UnscaledNarrowOop,
+        ZeroBasedNarrowOop,
+        HeapBasedNarrowOop
+    };
+
+    // 各模式能覆盖的堆顶地址
+    static const uint64_t UnscaledOopHeapMax = (uint64_t)UINT32_MAX + 1;
+    static const uint64_t OopEncodingHeapMax = UnscaledOopHeapMax << LogMinObjAlignmentInBytes;
+
+private:
+    static inline Mode    _mode  = UnscaledNarrowOop;
+    static inline address _base  = 0;
+    static inline int     _shift = 0;
+    static inline address _heap_begin = 0;
+    static inline address _heap_end   = 0;
+
+public:
+    // 预留好 Java 堆之后调用一次（ReservedHeapSpace），按堆的位置选模式
+    static void initialize(address heap_begin, size_t heap_size) {
+        address heap_end = heap_begin + heap_size;
+        _heap_begin = heap_begin;
+        _heap_end   = heap_end;
+        if ((uint64_t)heap_end <= UnscaledOopHeapMax) {
+            _mode  = UnscaledNarrowOop;
+            _base  = 0;
+            _shift = 0;
+        } else if ((uint64_t)heap_end <= OopEncodingHeapMax) {
+            _mode  = ZeroBasedNarrowOop;
+            _base  = 0;
+            _shift = LogMinObjAlignmentInBytes;
+        } else {
+            // base 比堆起点低一个对象对齐单位（MinObjAlignmentInBytes），堆起点编码成 1，
+            // 堆里任何对象都不会编码成 0（0 留给 null）
+            guarantee(heap_size + MinObjAlignmentInBytes <= OopEncodingHeapMax,
+                      "heap too large for compressed oops");
+            _mode  = HeapBasedNarrowOop;
+            _base  = heap_begin - MinObjAlignmentInBytes;
+            _shift = LogMinObjAlignmentInBytes;
+        }
+    }
+
+    static Mode        mode()  { return _mode; }
+    static address     base()  { return _base; }
+    static int         shift() { return _shift; }
+    static const char* mode_to_string(Mode mode) {
+        switch (mode) {
+            case UnscaledNarrowOop:  return "32-bit";
+            case ZeroBasedNarrowOop: return "Zero based";
+            case HeapBasedNarrowOop: return "Non-zero based";
+            default:                 return "???";
+        }
+    }
+
+    static bool is_in(const void* p) {
+        return (address)p >= _heap_begin && (address)p < _heap_end;
+    }
+
+    // 按当前模式调用 f(std::integral_constant<Mode, M>)，
+    // 在 f 内用 NarrowOopCodec<M> 编解码，循环里不再有模式判断
+    template <typename F>
+    static auto dispatch(F&& f) {
+        switch (_mode) {
+            case UnscaledNarrowOop:
+                return f(std::integral_constant<Mode, UnscaledNarrowOop>());
+            case ZeroBasedNarrowOop:
+                return f(std::integral_constant<Mode, ZeroBasedNarrowOop>());
+            default:
+                return f(std::integral_constant<Mode, HeapBasedNarrowOop>());
+        }
+    }
+
+    // ========== 通用编码 / 解码 ==========
+    // 不区分模式，用运行时的 base/shift（冷路径用）
+
+    static bool is_null(narrowOop v) { return v == 0; }
+
+    static oop decode_not_null(narrowOop v) {
+        return (oop)(_base + ((address)v << _shift));
+    }
+    static oop decode(narrowOop v) {
+        return is_null(v) ? (oop)nullptr : decode_not_null(v);
+    }
+    static narrowOop encode_not_null(oop o) {
+        assert(is_in(o), "oop not in heap");
+        return (narrowOop)(((address)o - _base) >> _shift);
+    }
+    static narrowOop encode(oop o) {
+        return o == nullptr ? (narrowOop)0 : encode_not_null(o);
+    }
+};
+
+// ========== NarrowOopCodec ==========
+// 模式是模板参数：Unscaled / ZeroBased 的 shift 和 base 都是常量，
+// 解码是一次零扩展（加一次移位），0 自然解码成 nullptr，没有分支
+
+template <CompressedOops::Mode M>
+class NarrowOopCodec {
+public:
+    static const int shift = (M == CompressedOops::UnscaledNarrowOop) ? 0 : LogMinObjAlignmentInBytes;
+
+    static oop decode_not_null(narrowOop v) {
+        if constexpr (M == CompressedOops::HeapBasedNarrowOop) {
+            return (oop)(CompressedOops::base() + ((address)v << shift));
+        } else {
+            return (oop)((address)v << shift);
+        }
+    }
+
+    static oop decode(narrowOop v) {
+        if constexpr (M == CompressedOops::HeapBasedNarrowOop) {
+            return v == 0 ? (oop)nullptr : decode_not_null(v);
+        } else {
+            return decode_not_null(v);
+        }
+    }
+
+    static narrowOop encode_not_null(oop o) {
+        if constexpr (M == CompressedOops::HeapBasedNarrowOop) {
+            return (narrowOop)(((address)o - CompressedOops::base()) >> shift);
+        } else {
+            return (narrowOop)((address)o >> shift);
+        }
+    }
+
+    static narrowOop encode(oop o) {
+        if constexpr (M == CompressedOops::HeapBasedNarrowOop) {
+            return o == nullptr ? (narrowOop)0 : encode_not_null(o);
+        } else {
+            return encode_not_null(o);
+        }
+    }
+
+    // 堆里引用槽的读写
+    static oop  load(const narrowOop* p)       { return decode(*p); }
+    static void store(narrowOop* p, oop o)     { *p = encode(o); }
+
+    // 对 [from, to) 中的每个非空引用调用 f(oop)（GC 扫描引用字段块、对象数组）
+    template <typename F>
+    static void iterate(const narrowOop* from, const narrowOop* to, F&& f) {
+        for (const narrowOop* p = from; p < to; p++) {
+            narrowOop v = *p;
+            if (v != 0) {
+                f(decode_not_null(v));
+            }
+        }
+    }
+};
+
+// 堆里一个引用槽的大小：UseCompressedOops 时 4 字节，否则 8 字节
+inline int heap_oop_size() {
+    return UseCompressedOops ? (int)sizeof(narrowOop) : (int)sizeof(oop);
+}
+
+// ========== CompressedKlassPointers ==========
+
+class CompressedKlassPointers {
+public:
+    // shift = 0 时能覆盖的最大范围
+    static const uint64_t UnscaledClassSpaceMax = (uint64_t)UINT32_MAX + 1;
+    // shift = LogKlassAlignmentInBytes 时能覆盖的最大范围
+    static const uint64_t KlassEncodingMetaspaceMax = UnscaledClassSpaceMax << LogKlassAlignmentInBytes;
+
+private:
+    static inline address _base  = 0;
+    static inline int     _shift = 0;
+    static inline size_t  _range = 0;
+
+public:
+    // 预留压缩类空间后调用一次（Metaspace::class_chunk_manager）
+    static void initialize(address base, size_t range) {
+        _base  = base;
+        _shift = (range <= UnscaledClassSpaceMax) ? 0 : LogKlassAlignmentInBytes;
+        _range = range;
+    }
+
+    static address base()  { return _base; }
+    static int     shift() { return _shift; }
+    static size_t  range() { return _range; }
+
+    static bool is_null(narrowKlass v) { return v == 0; }
+    static bool is_in_encoding_range(const Klass* k) {
+        return (address)k - _base < _range;
+    }
+
+    // ========== 编码 / 解码 ==========
+
+    static narrowKlass encode_not_null(const Klass* k) {
+        assert(k != nullptr && is_in_encoding_range(k), "klass not in compressed class space");
+        return (narrowKlass)(((address)k - _base) >> _shift);
+    }
+
+    static narrowKlass encode(const Klass* k) {
+        return k == nullptr ? (narrowKlass)0 : encode_not_null(k);
+    }
+
+    static Klass* decode_not_null(narrowKlass v) {
+        assert(!is_null(v), "narrow klass value can never be zero");
+        return (Klass*)(_base + ((address)v << _shift));
+    }
+
+    static Klass* decode(narrowKlass v) {
+        return is_null(v) ? nullptr : decode_not_null(v);
+    }
+};
+
+#endif // MY_JVM_OOPS_COMPRESSEDOOPS_HPP
@@ -267,6 +267,11 @@ public:
     ConstantPool* constants() const { return _constants; }
     void set_constants(ConstantPool* c) { _constants = c; }
 
+    // ========== 实例大小 ==========
+    // 参考：instanceKlass.hpp size_helper —— 实例的字数，分配时直接用
+
+    int size_helper() const { return layout_helper_to_size_helper(layout_helper()); }
+
     // ========== 字段相关 ==========
 
     int nonstatic_field_size() const { return _nonstatic_field_size; }
@@ -158,13 +158,98 @@ public:
             _primary_supers[i] = nullptr;
         }
     }
+
+    // ========== 分配 ==========
+    // 参考：klass.cpp Klass::operator new
+    // Klass 分配在压缩类空间里（UseCompressedClassPointers），
+    // 对象头才能用 32 位的 narrowKlass 引用它（实现在 memory/metaspace.cpp）
+    void* operator new(size_t size, ClassLoaderData* loader_data, size_t word_size) throw();
+    void* operator new(size_t size, ClassLoaderData* loader_data) throw();
     
     // ========== 布局辅助 ==========
-    
+    // 参考：klass.hpp 第 100-115 行、第 330-400 行
+    //
+    // _layout_helper 让分配和 GC 扫描只读一个 jint 就能算出对象大小，不需要虚调用：
+    //
+    //   实例类：> 0，对象大小（字节，按 HeapWord 对齐），最低位为 1 表示
+    //           需要走慢速路径（大小不固定，或分配时要特殊处理）
+    //   数组类：< 0，四个字节从高到低为
+    //             tag        0x80 对象数组 / 0xC0 基本类型数组
+    //             hsz        数组头（第一个元素的偏移）字节数
+    //             ebt        元素的 BasicType
+    //             log2(esz)  元素字节数的 log2
+    //   其他：  0（_lh_neutral_value），大小只能走慢速路径
+
+    enum {
+        _lh_neutral_value           = 0,
+        _lh_instance_slow_path_bit  = 0x01,
+        _lh_log2_element_size_shift = BitsPerByte * 0,
+        _lh_log2_element_size_mask  = BitsPerLong - 1,
+        _lh_element_type_shift      = BitsPerByte * 1,
+        _lh_element_type_mask       = 0xFF,
+        _lh_header_size_shift       = BitsPerByte * 2,
+        _lh_header_size_mask        = 0xFF,
+        _lh_array_tag_bits          = 2,
+        _lh_array_tag_shift         = BitsPerInt - _lh_array_tag_bits,
+        _lh_array_tag_obj_value     = ~0x01   // 0x80000000 >> 30
+    };
+
+    static const unsigned int _lh_array_tag_type_value = 0xFFFFFFFF;  // ~0x00，0xC0000000 >> 30
+
     jint layout_helper() const { return _layout_helper; }
     void set_layout_helper(jint lh) { _layout_helper = lh; }
-    
-    bool is_array() const { return _layout_helper < 0; }
+
+    static bool layout_helper_is_instance(jint lh) {
+        return lh > (jint)_lh_neutral_value;
+    }
+    static bool layout_helper_is_array(jint lh) {
+        return lh < (jint)_lh_neutral_value;
+    }
+    static bool layout_helper_is_typeArray(jint lh) {
+        // 无符号比较：tag 0xC0 的都比 0xC0000000 大
+        return (juint)lh >= (_lh_array_tag_type_value << _lh_array_tag_shift);
+    }
+    static bool layout_helper_is_objArray(jint lh) {
+        return lh < (jint)(_lh_array_tag_type_value << _lh_array_tag_shift);
+    }
+
+    // 实例：对象字节数 / 是否要走慢速路径
+    static int layout_helper_size_in_bytes(jint lh) {
+        return (int)lh & ~(int)_lh_instance_slow_path_bit;
+    }
+    static bool layout_helper_needs_slow_path(jint lh) {
+        return (lh & _lh_instance_slow_path_bit) != 0;
+    }
+    static int layout_helper_to_size_helper(jint lh) {
+        return layout_helper_size_in_bytes(lh) >> LogHeapWordSize;
+    }
+
+    // 数组：头大小 / 元素类型 / log2(元素字节数)
+    static int layout_helper_header_size(jint lh) {
+        return (lh >> _lh_header_size_shift) & _lh_header_size_mask;
+    }
+    static BasicType layout_helper_element_type(jint lh) {
+        return (BasicType)((lh >> _lh_element_type_shift) & _lh_element_type_mask);
+    }
+    static int layout_helper_log2_element_size(jint lh) {
+        return (lh >> _lh_log2_element_size_shift) & _lh_log2_element_size_mask;
+    }
+
+    // 编码
+    static jint instance_layout_helper(int size_in_words, bool slow_path_flag) {
+        return (size_in_words << LogHeapWordSize) | (slow_path_flag ? _lh_instance_slow_path_bit : 0);
+    }
+    static jint array_layout_helper(jint tag, int hsize, BasicType etype, int log2_esize) {
+        return (jint)(((juint)tag << _lh_array_tag_shift)
+             | (hsize << _lh_header_size_shift)
+             | ((int)etype << _lh_element_type_shift)
+             | (log2_esize << _lh_log2_element_size_shift));
+    }
+    // 按当前的 UseCompressedClassPointers / UseCompressedOops 算头大小和元素大小
+    // （实现在 oop.hpp，需要 arrayOopDesc）
+    static jint array_layout_helper(BasicType etype);
+
+    bool is_array() const { return layout_helper_is_array(_layout_helper); }
     
     // ========== 修饰符和访问标志 ==========
     
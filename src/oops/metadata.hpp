@@ -17,6 +17,8 @@
 
 #include "globalDefinitions.hpp"
 
+class ClassLoaderData;
+
 // ========== MetaspaceObj 基类（简化版）==========
 // 所有存在于 Metaspace 的对象都继承自这个基类
 
@@ -24,6 +26,16 @@ class MetaspaceObj {
 public:
     // MetaspaceObj 是虚基类
     virtual ~MetaspaceObj() {}
+
+    // ========== 分配 ==========
+    // 参考：allocation.hpp MetaspaceObj::operator new
+    // 从 loader_data 的 Metaspace 分配并清零（实现在 memory/metaspace.cpp），
+    // 变长对象（Array<T>）传入按字计的实际大小。
+    // 元数据随 ClassLoaderData 卸载整体回收，delete 不做任何事；
+    // 需要提前归还空间时用 MetadataFactory::free_metadata / free_array
+    void* operator new(size_t size, ClassLoaderData* loader_data, size_t word_size) throw();
+    void* operator new(size_t size, ClassLoaderData* loader_data) throw();
+    void operator delete(void*) {}
     
     // 判断类型（简化版）
     virtual bool is_klass() const { return false; }
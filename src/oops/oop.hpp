@@ -5,14 +5,22 @@
  * 简化版本
  * 
  * 注意：oopDesc 是 Java 堆上的对象，Klass 是 Metaspace 里的元数据，两者独立
+ *
+ * 对象头布局（64-bit）：
+ *   UseCompressedClassPointers 关闭：[0] mark (8)  [8] Klass* (8)        → 头 16 字节
+ *   UseCompressedClassPointers 打开：[0] mark (8)  [8] narrowKlass (4)
+ *                                    [12] klass gap（数组长度或第一个字段）→ 头 12 字节
  */
 
 #ifndef MY_JVM_OOPS_OOP_HPP
 #define MY_JVM_OOPS_OOP_HPP
 
 #include "globalDefinitions.hpp"
+#include "compressedOops.hpp"
 #include "markOop.hpp"
 #include "klass.hpp"
+#include "runtime/globals.hpp"
+#include <cstddef>
 
 // ========== oopDesc 类 ==========
 // 这是所有 Java 对象在 JVM 内部的基类
@@ -47,37 +55,128 @@ public:
     void set_mark_raw(volatile markOop m) { _mark = m; }
     
     // ========== Klass 指针访问 ==========
+    // 参考：oop.inline.hpp oopDesc::klass / set_klass
+    // UseCompressedClassPointers 时按 narrowKlass 存取，k 必须在压缩类空间里
     
-    Klass* klass() const { return _metadata._klass; }
-    void set_klass(Klass* k) { _metadata._klass = k; }
+    Klass* klass() const {
+        if (UseCompressedClassPointers) {
+            return CompressedKlassPointers::decode_not_null(_metadata._compressed_klass);
+        }
+        return _metadata._klass;
+    }
+
+    Klass* klass_or_null() const {
+        if (UseCompressedClassPointers) {
+            return CompressedKlassPointers::decode(_metadata._compressed_klass);
+        }
+        return _metadata._klass;
+    }
+
+    void set_klass(Klass* k) {
+        if (UseCompressedClassPointers) {
+            _metadata._compressed_klass = CompressedKlassPointers::encode(k);
+        } else {
+            _metadata._klass = k;
+        }
+    }
     
     // 压缩指针版本
     narrowKlass compressed_klass() const { return _metadata._compressed_klass; }
     void set_compressed_klass(narrowKlass nk) { _metadata._compressed_klass = nk; }
+
+    // ========== klass gap ==========
+    // narrowKlass 之后的 4 字节：数组放长度，实例放第一个字段
+
+    int klass_gap() const {
+        return *(const int*)((const char*)this + klass_gap_offset_in_bytes());
+    }
+    void set_klass_gap(int v) {
+        if (UseCompressedClassPointers) {
+            *(int*)((char*)this + klass_gap_offset_in_bytes()) = v;
+        }
+    }
+
+    // ========== 偏移 ==========
+    // 参考：oop.hpp mark_offset_in_bytes / klass_offset_in_bytes / klass_gap_offset_in_bytes
+
+    static int mark_offset_in_bytes()      { return (int)offsetof(oopDesc, _mark); }
+    static int klass_offset_in_bytes()     { return (int)offsetof(oopDesc, _metadata._klass); }
+    static int klass_gap_offset_in_bytes() {
+        return klass_offset_in_bytes() + (int)sizeof(narrowKlass);
+    }
+
+    // 对象头的字数（按未压缩布局，sizeof(oopDesc) / HeapWordSize）
+    static int header_size() { return (int)(sizeof(oopDesc) / sizeof(HeapWord)); }
     
-    // ========== 对象类型判断 ==========
-    // 注意：需要完整类型，所以这些函数在这里简化实现
+    // ========== 引用字段访问 ==========
+    // 参考：oop.inline.hpp obj_field / obj_field_put
+    // UseCompressedOops 时字段是 4 字节的 narrowOop
+
+    template <typename T>
+    T* field_addr(int offset) const { return (T*)((char*)this + offset); }
+
+    oop obj_field(int offset) const {
+        if (UseCompressedOops) {
+            return CompressedOops::decode(*field_addr<narrowOop>(offset));
+        }
+        return *field_addr<oop>(offset);
+    }
+
+    void obj_field_put(int offset, oop value) {
+        if (UseCompressedOops) {
+            *field_addr<narrowOop>(offset) = CompressedOops::encode(value);
+        } else {
+            *field_addr<oop>(offset) = value;
+        }
+    }
+
+    // 已知压缩模式的版本，热路径在 CompressedOops::dispatch 里用
+    template <CompressedOops::Mode M>
+    oop obj_field_narrow(int offset) const {
+        return NarrowOopCodec<M>::load(field_addr<narrowOop>(offset));
+    }
+
+    template <CompressedOops::Mode M>
+    void obj_field_put_narrow(int offset, oop value) {
+        NarrowOopCodec<M>::store(field_addr<narrowOop>(offset), value);
+    }
     
+    // ========== 对象类型判断 ==========
+    // 参考：oop.inline.hpp oopDesc::is_instance / is_array
+    // 只看 klass 的 layout helper，不做虚调用
+
     // 判断是否为数组
-    bool is_array() const { 
-        return _metadata._klass != nullptr && _metadata._klass->is_array_klass();
+    bool is_array() const {
+        Klass* k = klass_or_null();
+        return k != nullptr && Klass::layout_helper_is_array(k->layout_helper());
     }
-    
+
     // 判断是否为对象数组
-    bool is_objArray() const { 
-        return _metadata._klass != nullptr && _metadata._klass->is_objArray_klass();
+    bool is_objArray() const {
+        Klass* k = klass_or_null();
+        return k != nullptr && Klass::layout_helper_is_objArray(k->layout_helper());
     }
-    
+
     // 判断是否为基本类型数组
-    bool is_typeArray() const { 
-        return _metadata._klass != nullptr && _metadata._klass->is_typeArray_klass();
+    bool is_typeArray() const {
+        Klass* k = klass_or_null();
+        return k != nullptr && Klass::layout_helper_is_typeArray(k->layout_helper());
     }
-    
+
     // 判断是否为实例对象
-    bool is_instance() const { 
-        return _metadata._klass != nullptr && _metadata._klass->is_instance_klass();
+    bool is_instance() const {
+        Klass* k = klass_or_null();
+        return k != nullptr && Klass::layout_helper_is_instance(k->layout_helper());
     }
-    
+
+    // ========== 对象大小 ==========
+    // 参考：oop.inline.hpp oopDesc::size_given_klass
+    // 实例直接取 layout helper 里的字节数，数组由长度和 log2(元素大小) 算出。
+    // 慢速路径位和中性值（0）表示大小不能由 layout helper 得出，返回 0
+
+    inline int size_given_klass(Klass* klass) const;
+    int size() const { return size_given_klass(klass()); }
+
     // ========== 锁状态判断 ==========
     
     bool is_unlocked() const { return markWord_is_unlocked(_mark); }
@@ -93,20 +192,91 @@ public:
 typedef oopDesc* oop;
 
 
+// ========== 实例 oop ==========
+// 参考：instanceOop.hpp
+
+class instanceOopDesc : public oopDesc {
+public:
+    // 第一个实例字段的偏移：压缩类指针时用上 klass gap（12），否则 16
+    static int base_offset_in_bytes() {
+        return UseCompressedClassPointers ? klass_gap_offset_in_bytes()
+                                          : (int)sizeof(instanceOopDesc);
+    }
+};
+
+// 实例对象指针
+typedef instanceOopDesc* instanceOop;
+
+
 // ========== 数组 oop ==========
+// 参考：arrayOop.hpp
 
 class arrayOopDesc : public oopDesc {
 public:
-    // 数组长度（负数长度表示空数组）
-    int32_t length() const;
-    void set_length(int32_t len);
+    // 长度字段的偏移：压缩类指针时放在 klass gap（12），否则紧跟对象头（16）
+    static int length_offset_in_bytes() {
+        return UseCompressedClassPointers ? klass_gap_offset_in_bytes()
+                                          : (int)sizeof(arrayOopDesc);
+    }
+
+    // 数组头大小（按 HeapWord 对齐）：压缩类指针时 16，否则 24
+    static int header_size_in_bytes() {
+        return (int)align_up((size_t)length_offset_in_bytes() + sizeof(int32_t), sizeof(HeapWord));
+    }
+
+    // 第一个元素的偏移：与 OpenJDK 11 一致，任何元素类型都从对齐后的数组头之后开始
+    // （压缩类指针时 16，否则 24；未压缩时长度字段后的 4 字节空着）
+    static int base_offset_in_bytes(int /* element_size */) {
+        return header_size_in_bytes();
+    }
+
+    // 数组长度
+    int32_t length() const {
+        return *(const int32_t*)((const char*)this + length_offset_in_bytes());
+    }
+    void set_length(int32_t len) {
+        *(int32_t*)((char*)this + length_offset_in_bytes()) = len;
+    }
     
     // 获取数组元数据
     // Klass* klass() const;  // 继承自 oopDesc
+
+    // 数组对象的字数：头 + length 个元素，按对象对齐
+    // 参考：typeArrayOop.hpp typeArrayOopDesc::object_size(int lh, int length)
+    static int object_size(jint lh, int length) {
+        size_t size_in_bytes = ((size_t)length << Klass::layout_helper_log2_element_size(lh))
+                             + (size_t)Klass::layout_helper_header_size(lh);
+        return (int)(align_up(size_in_bytes, (size_t)MinObjAlignmentInBytes) >> LogHeapWordSize);
+    }
 };
 
 // 数组对象指针
 typedef arrayOopDesc* arrayOop;
 
 
+// ========== 依赖 arrayOopDesc 的 inline 函数 ==========
+
+inline int oopDesc::size_given_klass(Klass* klass) const {
+    jint lh = klass->layout_helper();
+    if (lh > Klass::_lh_neutral_value) {
+        if (!Klass::layout_helper_needs_slow_path(lh)) {
+            return Klass::layout_helper_to_size_helper(lh);
+        }
+        return 0;
+    }
+    if (lh < Klass::_lh_neutral_value) {
+        return arrayOopDesc::object_size(lh, ((const arrayOopDesc*)this)->length());
+    }
+    return 0;
+}
+
+// 参考：klass.cpp Klass::array_layout_helper(BasicType)
+inline jint Klass::array_layout_helper(BasicType etype) {
+    int esize = is_reference_type(etype) ? heap_oop_size() : type2aelembytes(etype);
+    int hsize = arrayOopDesc::base_offset_in_bytes(esize);
+    jint tag = is_reference_type(etype) ? (jint)_lh_array_tag_obj_value : (jint)_lh_array_tag_type_value;
+    return array_layout_helper(tag, hsize, etype, exact_log2((size_t)esize));
+}
+
+
 #endif // MY_JVM_OOPS_OOP_HPP
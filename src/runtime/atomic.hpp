@@ -1,130 +1,312 @@
 /*
  * my_jvm - Atomic operations
- * 
+ *
  * 原子操作封装，来自 OpenJDK 11 hotspot/src/share/vm/runtime/atomic.hpp
  * 简化版本
+ *
+ * Atomic:: 支持 1/2/4/8 字节的整数、枚举和指针，每个操作可以指定内存序：
+ *
+ *   memory_order_relaxed       只保证原子性，用于统计计数器
+ *   memory_order_acquire       之后的读写不会被重排到它前面
+ *   memory_order_release       之前的读写不会被重排到它后面
+ *   memory_order_acq_rel       两者都有
+ *   memory_order_conservative  前后都是全屏障（HotSpot 的默认语义），读改写操作的默认值
+ *
+ * load/store 默认 relaxed，与 HotSpot 一致；需要 acquire/release 时显式指定，
+ * 或使用 OrderAccess::load_acquire / release_store。
+ *
+ * 文件末尾的 atomic_load / atomic_cas 等自由函数是早期接口，全部是 conservative，
+ * 保留给已有代码使用。
  */
 
 #ifndef MY_JVM_RUNTIME_ATOMIC_HPP
 #define MY_JVM_RUNTIME_ATOMIC_HPP
 
 #include "globalDefinitions.hpp"
+#include <type_traits>
+
+// ========== 内存序 ==========
+
+enum atomic_memory_order {
+    memory_order_relaxed      = __ATOMIC_RELAXED,
+    memory_order_acquire      = __ATOMIC_ACQUIRE,
+    memory_order_release      = __ATOMIC_RELEASE,
+    memory_order_acq_rel      = __ATOMIC_ACQ_REL,
+    memory_order_conservative = __ATOMIC_SEQ_CST
+};
+
+// ========== Atomic ==========
+
+// 只有静态成员。不继承 AllStatic：memory/allocation.hpp 会带进 utilities/debug.hpp，
+// 而 debug.hpp 重新定义 assert，这个头文件被只用 <cassert> 的代码包含
+class Atomic {
+ private:
+    Atomic() = delete;
+
+    template <typename T>
+    struct Identity { typedef T type; };
+
+    template <typename T>
+    static void check_type() {
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+                      "Atomic only supports 1, 2, 4 and 8 byte types");
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                      "Atomic only supports integer, enum and pointer types");
+    }
+
+    template <typename T>
+    static void check_arithmetic_type() {
+        check_type<T>();
+        static_assert(std::is_integral<T>::value || std::is_pointer<T>::value,
+                      "Atomic arithmetic needs an integer or pointer type");
+    }
+
+    // load 不能带 release 语义，store 不能带 acquire 语义，这里换成最接近的合法内存序
+    static constexpr int load_order(atomic_memory_order order) {
+        return order == memory_order_release ? __ATOMIC_RELAXED :
+               order == memory_order_acq_rel ? __ATOMIC_ACQUIRE : (int)order;
+    }
+    static constexpr int store_order(atomic_memory_order order) {
+        return order == memory_order_acquire ? __ATOMIC_RELAXED :
+               order == memory_order_acq_rel ? __ATOMIC_RELEASE : (int)order;
+    }
+    // CAS 失败时只是一次读
+    static constexpr int cas_failure_order(atomic_memory_order order) {
+        return load_order(order);
+    }
+
+    // 指针加减以元素为单位，GCC 的内建函数以字节为单位
+    template <typename T, typename I>
+    static intptr_t scaled(I value) {
+        return (intptr_t)value * (intptr_t)sizeof(typename std::remove_pointer<T>::type);
+    }
+
+ public:
+    // ---------- 读/写 ----------
+
+    template <typename T>
+    static T load(const volatile T* p, atomic_memory_order order = memory_order_relaxed) {
+        check_type<T>();
+        T result;
+        __atomic_load(p, &result, load_order(order));
+        return result;
+    }
+
+    template <typename T>
+    static void store(volatile T* p, typename Identity<T>::type value,
+                      atomic_memory_order order = memory_order_relaxed) {
+        check_type<T>();
+        __atomic_store(p, &value, store_order(order));
+    }
+
+    // ---------- 交换 ----------
+
+    // 返回旧值
+    template <typename T>
+    static T xchg(volatile T* dest, typename Identity<T>::type value,
+                  atomic_memory_order order = memory_order_conservative) {
+        check_type<T>();
+        T result;
+        __atomic_exchange(dest, &value, &result, (int)order);
+        return result;
+    }
+
+    // *dest == compare_value 时写入 exchange_value；总是返回 *dest 的旧值
+    template <typename T>
+    static T cmpxchg(volatile T* dest, typename Identity<T>::type compare_value,
+                     typename Identity<T>::type exchange_value,
+                     atomic_memory_order order = memory_order_conservative) {
+        check_type<T>();
+        __atomic_compare_exchange(dest, &compare_value, &exchange_value, false,
+                                  (int)order, cas_failure_order(order));
+        return compare_value;
+    }
+
+    // ---------- 算术（指针以元素为单位） ----------
+
+    template <typename T, typename I>
+    static T fetch_and_add(volatile T* dest, I value,
+                           atomic_memory_order order = memory_order_conservative) {
+        check_arithmetic_type<T>();
+        static_assert(std::is_integral<I>::value, "addend must be an integer");
+        if constexpr (std::is_pointer<T>::value) {
+            return (T)__atomic_fetch_add((volatile intptr_t*)dest,
+                                         scaled<T>(value), (int)order);
+        } else {
+            return __atomic_fetch_add(dest, (T)value, (int)order);
+        }
+    }
+
+    template <typename T, typename I>
+    static T add_and_fetch(volatile T* dest, I value,
+                           atomic_memory_order order = memory_order_conservative) {
+        check_arithmetic_type<T>();
+        static_assert(std::is_integral<I>::value, "addend must be an integer");
+        if constexpr (std::is_pointer<T>::value) {
+            return (T)__atomic_add_fetch((volatile intptr_t*)dest,
+                                         scaled<T>(value), (int)order);
+        } else {
+            return __atomic_add_fetch(dest, (T)value, (int)order);
+        }
+    }
+
+    template <typename T, typename I>
+    static T sub_and_fetch(volatile T* dest, I value,
+                           atomic_memory_order order = memory_order_conservative) {
+        check_arithmetic_type<T>();
+        static_assert(std::is_integral<I>::value, "subtrahend must be an integer");
+        if constexpr (std::is_pointer<T>::value) {
+            return (T)__atomic_sub_fetch((volatile intptr_t*)dest,
+                                         scaled<T>(value), (int)order);
+        } else {
+            return __atomic_sub_fetch(dest, (T)value, (int)order);
+        }
+    }
+
+    template <typename T>
+    static void inc(volatile T* dest, atomic_memory_order order = memory_order_conservative) {
+        add_and_fetch(dest, 1, order);
+    }
+
+    template <typename T>
+    static void dec(volatile T* dest, atomic_memory_order order = memory_order_conservative) {
+        sub_and_fetch(dest, 1, order);
+    }
+
+    // ---------- 位运算（mark word、card table 等按位更新） ----------
+    // 返回旧值
+
+    template <typename T>
+    static T fetch_and_or(volatile T* dest, typename Identity<T>::type bits,
+                          atomic_memory_order order = memory_order_conservative) {
+        static_assert(std::is_integral<T>::value, "bitwise operations need an integer type");
+        check_type<T>();
+        return __atomic_fetch_or(dest, bits, (int)order);
+    }
+
+    template <typename T>
+    static T fetch_and_and(volatile T* dest, typename Identity<T>::type bits,
+                           atomic_memory_order order = memory_order_conservative) {
+        static_assert(std::is_integral<T>::value, "bitwise operations need an integer type");
+        check_type<T>();
+        return __atomic_fetch_and(dest, bits, (int)order);
+    }
+
+    template <typename T>
+    static T fetch_and_xor(volatile T* dest, typename Identity<T>::type bits,
+                           atomic_memory_order order = memory_order_conservative) {
+        static_assert(std::is_integral<T>::value, "bitwise operations need an integer type");
+        check_type<T>();
+        return __atomic_fetch_xor(dest, bits, (int)order);
+    }
+};
 
 // ========== 原子加载 ==========
 
 inline jint atomic_load(const jint* addr) {
-    return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return Atomic::load(addr, memory_order_conservative);
 }
 
 inline juint atomic_load(const juint* addr) {
-    return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return Atomic::load(addr, memory_order_conservative);
 }
 
 inline intptr_t atomic_load(const intptr_t* addr) {
-    return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return Atomic::load(addr, memory_order_conservative);
 }
 
 inline uintptr_t atomic_load(const uintptr_t* addr) {
-    return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return Atomic::load(addr, memory_order_conservative);
 }
 
 inline void* atomic_load(void* const* addr) {
-    return __atomic_load_n(addr, __ATOMIC_SEQ_CST);
+    return Atomic::load(addr, memory_order_conservative);
 }
 
 // ========== 原子存储 ==========
 
 inline void atomic_store(jint* addr, jint val) {
-    __atomic_store_n(addr, val, __ATOMIC_SEQ_CST);
+    Atomic::store(addr, val, memory_order_conservative);
 }
 
 inline void atomic_store(juint* addr, juint val) {
-    __atomic_store_n(addr, val, __ATOMIC_SEQ_CST);
+    Atomic::store(addr, val, memory_order_conservative);
 }
 
 inline void atomic_store(intptr_t* addr, intptr_t val) {
-    __atomic_store_n(addr, val, __ATOMIC_SEQ_CST);
+    Atomic::store(addr, val, memory_order_conservative);
 }
 
 inline void atomic_store(uintptr_t* addr, uintptr_t val) {
-    __atomic_store_n(addr, val, __ATOMIC_SEQ_CST);
+    Atomic::store(addr, val, memory_order_conservative);
 }
 
 inline void atomic_store(void** addr, void* val) {
-    __atomic_store_n(addr, val, __ATOMIC_SEQ_CST);
+    Atomic::store(addr, val, memory_order_conservative);
 }
 
 // ========== CAS（Compare And Swap） ==========
 
 // 返回旧值
 inline jint atomic_cas(jint* addr, jint exchange_val, jint compare_val) {
-    __atomic_compare_exchange_n(addr, &compare_val, &exchange_val, false, 
-                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-    return compare_val;
+    return Atomic::cmpxchg(addr, compare_val, exchange_val);
 }
 
 inline juint atomic_cas(juint* addr, juint exchange_val, juint compare_val) {
-    __atomic_compare_exchange_n(addr, &compare_val, &exchange_val, false, 
-                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-    return compare_val;
+    return Atomic::cmpxchg(addr, compare_val, exchange_val);
 }
 
 inline intptr_t atomic_cas(intptr_t* addr, intptr_t exchange_val, intptr_t compare_val) {
-    __atomic_compare_exchange_n(addr, &compare_val, &exchange_val, false, 
-                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-    return compare_val;
+    return Atomic::cmpxchg(addr, compare_val, exchange_val);
 }
 
 inline uintptr_t atomic_cas(uintptr_t* addr, uintptr_t exchange_val, uintptr_t compare_val) {
-    __atomic_compare_exchange_n(addr, &compare_val, &exchange_val, false, 
-                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-    return compare_val;
+    return Atomic::cmpxchg(addr, compare_val, exchange_val);
 }
 
 inline void* atomic_cas(void** addr, void* exchange_val, void* compare_val) {
-    __atomic_compare_exchange_n(addr, &compare_val, &exchange_val, false, 
-                                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
-    return compare_val;
+    return Atomic::cmpxchg(addr, compare_val, exchange_val);
 }
 
 // ========== 原子加法 ==========
+// 返回旧值
 
 inline jint atomic_add(jint* addr, jint val) {
-    return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::fetch_and_add(addr, val);
 }
 
 inline juint atomic_add(juint* addr, juint val) {
-    return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::fetch_and_add(addr, val);
 }
 
 inline intptr_t atomic_add(intptr_t* addr, intptr_t val) {
-    return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::fetch_and_add(addr, val);
 }
 
 inline uintptr_t atomic_add(uintptr_t* addr, uintptr_t val) {
-    return __atomic_fetch_add(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::fetch_and_add(addr, val);
 }
 
 // ========== 原子交换 ==========
 
 inline jint atomic_xchg(jint* addr, jint val) {
-    return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::xchg(addr, val);
 }
 
 inline juint atomic_xchg(juint* addr, juint val) {
-    return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::xchg(addr, val);
 }
 
 inline intptr_t atomic_xchg(intptr_t* addr, intptr_t val) {
-    return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::xchg(addr, val);
 }
 
 inline uintptr_t atomic_xchg(uintptr_t* addr, uintptr_t val) {
-    return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::xchg(addr, val);
 }
 
 inline void* atomic_xchg(void** addr, void* val) {
-    return __atomic_exchange_n(addr, val, __ATOMIC_SEQ_CST);
+    return Atomic::xchg(addr, val);
 }
 
 #endif // MY_JVM_RUNTIME_ATOMIC_HPP
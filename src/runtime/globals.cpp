@@ -0,0 +1,137 @@
+/*
+ * my_jvm - VM flags implementation
+ */
+
+#include "runtime/globals.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// ========== flag 定义（默认值） ==========
+
+ccstr  NativeMemoryTracking       = "summary";
+intx   NMTStackDepth              = 4;
+bool   UseSlabAllocator           = true;
+bool   UseTransparentHugePages    = false;
+bool   UseCompressedClassPointers = true;
+size_t CompressedClassSpaceSize   = (size_t)1024 * 1024 * 1024;
+bool   UseCompressedOops          = true;
+size_t HeapBaseMinAddress         = (size_t)2 * 1024 * 1024 * 1024;
+size_t MaxHeapSize                = (size_t)256 * 1024 * 1024;
+size_t G1HeapRegionSize           = 0;
+bool   UseTLAB                    = true;
+bool   ResizeTLAB                 = true;
+size_t TLABSize                   = 0;
+size_t MinTLABSize                = 2 * 1024;
+uintx  TLABRefillWasteFraction    = 64;
+uintx  TLABWasteIncrement         = 4;
+uintx  TLABAllocationWeight       = 35;
+intx   UseSSE                     = 4;
+intx   UseAVX                     = 2;
+bool   UsePopCountInstruction     = true;
+bool   UseBMI1Instructions        = true;
+bool   UseBMI2Instructions        = true;
+bool   UseCLMUL                   = true;
+bool   UseFastStosb               = true;
+size_t BlockZeroingLowLimit       = 0;
+size_t NonTemporalFillLimit       = 0;
+bool   LockContentionStatistics   = false;
+
+// ========== flag 表 ==========
+
+enum VMFlagType {
+  VMFlag_bool,
+  VMFlag_intx,
+  VMFlag_uintx,
+  VMFlag_size_t,
+  VMFlag_ccstr
+};
+
+struct VMFlag {
+  const char* _name;
+  VMFlagType  _type;
+  void*       _addr;
+};
+
+static VMFlag flag_table[] = {
+  { "NativeMemoryTracking",       VMFlag_ccstr,  &NativeMemoryTracking       },
+  { "NMTStackDepth",              VMFlag_intx,   &NMTStackDepth              },
+  { "UseSlabAllocator",           VMFlag_bool,   &UseSlabAllocator           },
+  { "UseTransparentHugePages",    VMFlag_bool,   &UseTransparentHugePages    },
+  { "UseCompressedClassPointers", VMFlag_bool,   &UseCompressedClassPointers },
+  { "CompressedClassSpaceSize",   VMFlag_size_t, &CompressedClassSpaceSize   },
+  { "UseCompressedOops",          VMFlag_bool,   &UseCompressedOops          },
+  { "HeapBaseMinAddress",         VMFlag_size_t, &HeapBaseMinAddress         },
+  { "MaxHeapSize",                VMFlag_size_t, &MaxHeapSize                },
+  { "G1HeapRegionSize",           VMFlag_size_t, &G1HeapRegionSize           },
+  { "UseTLAB",                    VMFlag_bool,   &UseTLAB                    },
+  { "ResizeTLAB",                 VMFlag_bool,   &ResizeTLAB                 },
+  { "TLABSize",                   VMFlag_size_t, &TLABSize                   },
+  { "MinTLABSize",                VMFlag_size_t, &MinTLABSize                },
+  { "TLABRefillWasteFraction",    VMFlag_uintx,  &TLABRefillWasteFraction    },
+  { "TLABWasteIncrement",         VMFlag_uintx,  &TLABWasteIncrement         },
+  { "TLABAllocationWeight",       VMFlag_uintx,  &TLABAllocationWeight       },
+  { "UseSSE",                     VMFlag_intx,   &UseSSE                     },
+  { "UseAVX",                     VMFlag_intx,   &UseAVX                     },
+  { "UsePopCountInstruction",     VMFlag_bool,   &UsePopCountInstruction     },
+  { "UseBMI1Instructions",        VMFlag_bool,   &UseBMI1Instructions        },
+  { "UseBMI2Instructions",        VMFlag_bool,   &UseBMI2Instructions        },
+  { "UseCLMUL",                   VMFlag_bool,   &UseCLMUL                   },
+  { "UseFastStosb",               VMFlag_bool,   &UseFastStosb               },
+  { "BlockZeroingLowLimit",       VMFlag_size_t, &BlockZeroingLowLimit       },
+  { "NonTemporalFillLimit",       VMFlag_size_t, &NonTemporalFillLimit       },
+  { "LockContentionStatistics",   VMFlag_bool,   &LockContentionStatistics   },
+};
+
+static VMFlag* find_flag(const char* name, size_t len) {
+  for (size_t i = 0; i < sizeof(flag_table) / sizeof(flag_table[0]); i++) {
+    if (strlen(flag_table[i]._name) == len && strncmp(flag_table[i]._name, name, len) == 0) {
+      return &flag_table[i];
+    }
+  }
+  return nullptr;
+}
+
+bool process_vm_flag(const char* arg) {
+  if (strncmp(arg, "-XX:", 4) != 0) {
+    return false;
+  }
+  arg += 4;
+
+  // -XX:+Name / -XX:-Name
+  if (*arg == '+' || *arg == '-') {
+    VMFlag* flag = find_flag(arg + 1, strlen(arg + 1));
+    if (flag == nullptr || flag->_type != VMFlag_bool) {
+      return false;
+    }
+    *(bool*)flag->_addr = (*arg == '+');
+    return true;
+  }
+
+  // -XX:Name=value
+  const char* eq = strchr(arg, '=');
+  if (eq == nullptr) {
+    return false;
+  }
+  VMFlag* flag = find_flag(arg, (size_t)(eq - arg));
+  if (flag == nullptr) {
+    return false;
+  }
+  const char* value = eq + 1;
+  char* end = nullptr;
+  switch (flag->_type) {
+    case VMFlag_intx:
+      *(intx*)flag->_addr = (intx)strtoll(value, &end, 0);
+      return *value != '\0' && *end == '\0';
+    case VMFlag_uintx:
+      *(uintx*)flag->_addr = (uintx)strtoull(value, &end, 0);
+      return *value != '\0' && *end == '\0';
+    case VMFlag_size_t:
+      *(size_t*)flag->_addr = (size_t)strtoull(value, &end, 0);
+      return *value != '\0' && *end == '\0';
+    case VMFlag_ccstr:
+      *(ccstr*)flag->_addr = value;
+      return true;
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,117 @@
+/*
+ * my_jvm - VM flags
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/globals.hpp
+ * 简化版本：没有 product/develop 宏体系和参数解析，
+ * 每个 flag 是一个普通全局变量，默认值定义在 globals.cpp。
+ * 必须在相关子系统首次使用前设置（例如 main 开头）。
+ */
+
+#ifndef MY_JVM_RUNTIME_GLOBALS_HPP
+#define MY_JVM_RUNTIME_GLOBALS_HPP
+
+#include "utilities/globalDefinitions.hpp"
+
+typedef const char* ccstr;
+
+// ========== Native Memory Tracking ==========
+
+// NMT 级别：off / summary / detail（首次 malloc 时确定，之后不可更改）。
+// 默认 summary：slab 块上没有额外开销，见 services/memTracker.hpp
+extern ccstr NativeMemoryTracking;
+
+// detail 模式下记录的调用栈深度
+extern intx NMTStackDepth;
+
+// ========== C 堆分配 ==========
+
+// AllocateHeap 的小块走 SlabAllocator（关闭后全部直接 malloc）
+extern bool UseSlabAllocator;
+
+// ========== 大页 ==========
+
+// 允许增长策略里打开了 use_huge_pages 的 Arena 用 2M 对齐的 mmap + MADV_HUGEPAGE 分配 Chunk
+extern bool UseTransparentHugePages;
+
+// ========== 压缩类指针 ==========
+
+// 对象头里的 Klass* 压缩成 32 位 narrowKlass，实例字段/数组长度从偏移 12 开始
+// （必须在第一个 Klass 分配之前设置）
+extern bool UseCompressedClassPointers;
+
+// 压缩类空间的预留大小（不超过 32G）
+extern size_t CompressedClassSpaceSize;
+
+// ========== 压缩对象指针 ==========
+
+// 堆里的引用字段存成 32 位 narrowOop（必须在预留 Java 堆之前设置）
+extern bool UseCompressedOops;
+
+// 预留 Java 堆时尝试的最低地址（压缩指针模式下优先放在 4G / 32G 以下）
+extern size_t HeapBaseMinAddress;
+
+// ========== Java 堆 ==========
+
+// Java 堆的大小（G1CollectedHeap::initialize 未指定大小时使用）
+extern size_t MaxHeapSize;
+
+// region 大小，0 表示按堆大小自动选择（1M ~ 32M 之间的 2 的幂）
+extern size_t G1HeapRegionSize;
+
+// ========== TLAB ==========
+
+// 对象在线程私有的 TLAB 里 bump 分配
+extern bool UseTLAB;
+
+// 按线程的分配速率调整 TLAB 大小
+extern bool ResizeTLAB;
+
+// TLAB 的初始大小（字节），0 表示按 region 大小自动选择
+extern size_t TLABSize;
+
+// TLAB 的最小大小（字节）
+extern size_t MinTLABSize;
+
+// TLAB 剩余空间超过 desired_size / TLABRefillWasteFraction 时不丢弃，
+// 对象改在 TLAB 外分配
+extern uintx TLABRefillWasteFraction;
+
+// 每次在 TLAB 外分配后，允许丢弃的空间增加多少字
+extern uintx TLABWasteIncrement;
+
+// 分配比例加权平均中新样本的权重（百分比）
+extern uintx TLABAllocationWeight;
+
+// ========== CPU 特性 ==========
+
+// 允许使用的 SSE 级别上限：2、3（SSSE3）、4（SSE4.1/4.2），实际还受 CPU 支持限制
+extern intx UseSSE;
+
+// 允许使用的 AVX 级别上限：0 只用 SSE，1 AVX，2 AVX2，3 AVX-512（实际还受 CPU 支持限制）
+extern intx UseAVX;
+
+// 以下 Use* 在 VM_Version 初始化时按 CPU 支持情况关掉，见 runtime/vm_version.hpp
+extern bool UsePopCountInstruction;
+extern bool UseBMI1Instructions;
+extern bool UseBMI2Instructions;
+extern bool UseCLMUL;
+extern bool UseFastStosb;     // 有 ERMS 时允许用 rep stosb
+
+// Copy::fill_to_words / zero_to_words 从多少字节起改用 rep stos，0 表示按 CPU 自动选择
+extern size_t BlockZeroingLowLimit;
+
+// 从多少字节起改用绕过缓存的非临时写，0 表示按缓存大小自动选择
+extern size_t NonTemporalFillLimit;
+
+// ========== VM 内部锁 ==========
+
+// 每个 SpinLock / Mutex 统计竞争次数（自旋、park），只在慢速路径上计数
+extern bool LockContentionStatistics;
+
+// ========== flag 解析 ==========
+
+// 解析形如 "-XX:Name=value" / "-XX:+Name" / "-XX:-Name" 的参数，
+// 成功返回 true（未知 flag 或格式错误返回 false）
+bool process_vm_flag(const char* arg);
+
+#endif // MY_JVM_RUNTIME_GLOBALS_HPP
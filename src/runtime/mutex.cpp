@@ -0,0 +1,186 @@
+/*
+ * my_jvm - VM internal locks implementation (Linux futex)
+ */
+
+#include "runtime/mutex.hpp"
+#include "runtime/os.hpp"
+#include "utilities/ostream.hpp"
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ========== 平台辅助 ==========
+
+// *addr 仍等于 expected 时睡眠，直到被唤醒或超时；超时返回 ETIMEDOUT，其他情况返回 0
+static int futex_wait(volatile jint* addr, jint expected, const struct timespec* timeout) {
+  if (syscall(SYS_futex, (jint*)addr, FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0) != 0) {
+    return errno == ETIMEDOUT ? ETIMEDOUT : 0;
+  }
+  return 0;
+}
+
+static void futex_wake(volatile jint* addr, int count) {
+  syscall(SYS_futex, (jint*)addr, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// ========== 加锁顺序检查（ASSERT） ==========
+
+// 当前线程持有的锁，最近获取的在表头
+static thread_local LockBase* _owned_locks = nullptr;
+
+void LockBase::check_rank() const {
+  for (LockBase* l = _owned_locks; l != nullptr; l = l->_next_owned) {
+    if (l == this) {
+      fatal("recursive locking of %s", _name);
+    }
+    if (l->_rank <= _rank) {
+      fatal("lock rank violation: acquiring %s (rank %d) while holding %s (rank %d)",
+            _name, _rank, l->_name, l->_rank);
+    }
+  }
+}
+
+void LockBase::push_owned() {
+  _next_owned = _owned_locks;
+  _owned_locks = this;
+}
+
+// 解锁顺序不要求和加锁相反，从链表中间摘掉也可以
+void LockBase::pop_owned() {
+  LockBase** p = &_owned_locks;
+  while (*p != this) {
+    if (*p == nullptr) {
+      fatal("unlocking %s, which is not owned by this thread", _name);
+    }
+    p = &(*p)->_next_owned;
+  }
+  *p = _next_owned;
+  _next_owned = nullptr;
+}
+
+bool LockBase::owned_by_self() const {
+  if (!ASSERT) {
+    return is_locked();
+  }
+  for (LockBase* l = _owned_locks; l != nullptr; l = l->_next_owned) {
+    if (l == this) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LockBase::print_on(outputStream* st) const {
+  st->print_cr("%-28s rank=%-4d %s contended=" SIZE_FORMAT " blocked=" SIZE_FORMAT,
+               _name, _rank, is_locked() ? "locked  " : "unlocked",
+               contended_count(), blocked_count());
+}
+
+// ========== SpinLock ==========
+
+void SpinLock::lock_contended() {
+  count_contended();
+  // 单核上自旋只会拖住持锁线程，直接让出 CPU
+  int delay = os::processor_count() > 1 ? 1 : MaxBackoff + 1;
+  for (;;) {
+    // test：只读等待，锁释放之前不去抢缓存行
+    while (Atomic::load(&_state) != 0) {
+      if (delay > MaxBackoff) {
+        count_blocked();
+        os::naked_yield();
+      } else {
+        for (int i = 0; i < delay; i++) {
+          os::spin_pause();
+        }
+        delay <<= 1;
+      }
+    }
+    // test-and-set
+    if (Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+// ========== Mutex ==========
+
+void Mutex::lock_contended() {
+  count_contended();
+
+  if (os::processor_count() > 1) {
+    jint limit = Atomic::load(&_spin_limit);
+    for (jint i = 0; i < limit; i++) {
+      jint s = Atomic::load(&_state);
+      if (s == 2) {
+        break;   // 已经有线程在 park，自旋大概率拿不到
+      }
+      if (s == 0 && Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) == 0) {
+        Atomic::store(&_spin_limit, MIN2(limit * 2, (jint)MaxSpin));
+        return;
+      }
+      os::spin_pause();
+    }
+    Atomic::store(&_spin_limit, MAX2(limit / 2, (jint)MinSpin));
+  }
+
+  raw_lock_with_waiters();
+}
+
+// 把状态设成 2 再睡，这样释放锁的线程知道要唤醒别人。
+// 拿到锁时状态也是 2，解锁会多一次 futex_wake，换来不会漏掉等待者
+void Mutex::raw_lock_with_waiters() {
+  while (Atomic::xchg(&_state, 2, memory_order_acquire) != 0) {
+    count_blocked();
+    futex_wait(&_state, 2, nullptr);
+  }
+}
+
+void Mutex::wake_waiter() {
+  futex_wake(&_state, 1);
+}
+
+// ========== Monitor ==========
+
+bool Monitor::wait(jlong timeout_ms) {
+  assert(owned_by_self(), "wait on %s without holding it", _name);
+
+  // 持锁读取序号：之后的 notify 一定会改变它，futex_wait 因此不会漏掉通知
+  jint seq = Atomic::load(&_wait_seq);
+  _waiters++;
+  if (ASSERT) pop_owned();
+  raw_unlock();
+
+  struct timespec ts;
+  const struct timespec* timeout = nullptr;
+  if (timeout_ms > 0) {
+    ts.tv_sec = (time_t)(timeout_ms / 1000);
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+    timeout = &ts;
+  }
+  bool timed_out = futex_wait(&_wait_seq, seq, timeout) == ETIMEDOUT;
+
+  // 可能有其他被唤醒的线程在抢锁，按“有等待者”加锁
+  raw_lock_with_waiters();
+  if (ASSERT) push_owned();
+  _waiters--;
+  return timed_out;
+}
+
+void Monitor::notify() {
+  assert(owned_by_self(), "notify on %s without holding it", _name);
+  if (_waiters > 0) {
+    Atomic::inc(&_wait_seq, memory_order_relaxed);
+    futex_wake(&_wait_seq, 1);
+  }
+}
+
+void Monitor::notify_all() {
+  assert(owned_by_self(), "notify_all on %s without holding it", _name);
+  if (_waiters > 0) {
+    Atomic::inc(&_wait_seq, memory_order_relaxed);
+    futex_wake(&_wait_seq, INT_MAX);
+  }
+}
@@ -0,0 +1,236 @@
+/*
+ * my_jvm - VM internal locks
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/mutex.hpp
+ *          和 hotspot/src/hotspot/share/runtime/mutexLocker.hpp
+ * OpenJDK 的 Monitor 建在 ParkEvent 上；这里直接用 Linux futex：
+ *
+ *  - SpinLock：test-and-test-and-set + 指数退避，用于只有几条指令的临界区（分配器内部）
+ *  - Mutex   ：futex 锁，拿不到时先自适应自旋，再 park
+ *  - Monitor ：Mutex 加上 wait / notify / notify_all
+ *
+ * 无竞争时 lock 是一次 CAS，unlock 是一次 release 写（SpinLock）或一次交换（Mutex）。
+ * 锁都不可重入，构造函数是 constexpr，可以做静态变量而不用担心初始化顺序。
+ *
+ * 每个锁有一个 rank。debug 构建（ASSERT）下检查加锁顺序：持有锁时只能再获取
+ * rank 更低的锁，违反时立即报错，而不是等到真的死锁。try_lock 不检查顺序。
+ * -XX:+LockContentionStatistics 打开每个锁的竞争计数。
+ */
+
+#ifndef MY_JVM_RUNTIME_MUTEX_HPP
+#define MY_JVM_RUNTIME_MUTEX_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/debug.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class outputStream;
+
+// ========== LockBase ==========
+// 三种锁共用的名字、rank、加锁顺序检查和统计
+
+class LockBase {
+ public:
+  // 数值越小越“内层”：持有 rank 为 r 的锁时只能再拿 rank < r 的锁
+  enum lock_rank {
+    event       = 0,
+    special     = event + 2,     // 内存分配器内部（slab、NMT）：持有时不能再分配内存
+    leaf        = special + 3,   // 临界区内不再拿 VM 锁（分配内存除外）
+    nonleaf     = leaf + 10,
+    max_nonleaf = nonleaf + 900
+  };
+
+ protected:
+  volatile jint  _state;        // 0 表示空闲，其余含义由子类决定
+  const int      _rank;
+  const char*    _name;
+  LockBase*      _next_owned;   // 当前线程持有的锁组成的链表（只在 ASSERT 下维护）
+
+  // 竞争统计，只在慢速路径上更新
+  volatile size_t _contended;   // 第一次 CAS 失败的次数
+  volatile size_t _blocked;     // 让出 CPU（SpinLock）或 park（Mutex）的次数
+
+  constexpr LockBase(int rank, const char* name)
+    : _state(0), _rank(rank), _name(name), _next_owned(nullptr), _contended(0), _blocked(0) {}
+
+  // 加锁顺序检查（ASSERT）：加锁前 check_rank，拿到后 push_owned，解锁前 pop_owned
+  void check_rank() const;
+  void push_owned();
+  void pop_owned();
+
+  void count_contended() {
+    if (LockContentionStatistics) {
+      Atomic::inc(&_contended, memory_order_relaxed);
+    }
+  }
+  void count_blocked() {
+    if (LockContentionStatistics) {
+      Atomic::inc(&_blocked, memory_order_relaxed);
+    }
+  }
+
+ public:
+  const char* name() const { return _name; }
+  int         rank() const { return _rank; }
+  bool        is_locked() const { return Atomic::load(&_state) != 0; }
+
+  // 当前线程是否持有这个锁；只在 ASSERT 下准确，用于断言
+  bool owned_by_self() const;
+
+  size_t contended_count() const { return Atomic::load(&_contended); }
+  size_t blocked_count() const   { return Atomic::load(&_blocked); }
+
+  void print_on(outputStream* st) const;
+};
+
+// ========== SpinLock ==========
+
+class SpinLock : public LockBase {
+ private:
+  // 指数退避的上限（pause 次数），超过后改为让出 CPU
+  enum { MaxBackoff = 1024 };
+
+  void lock_contended();
+
+ public:
+  constexpr SpinLock(int rank, const char* name) : LockBase(rank, name) {}
+
+  void lock() {
+    if (ASSERT) check_rank();
+    if (Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) != 0) {
+      lock_contended();
+    }
+    if (ASSERT) push_owned();
+  }
+
+  bool try_lock() {
+    if (Atomic::load(&_state) == 0 && Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) == 0) {
+      if (ASSERT) push_owned();
+      return true;
+    }
+    return false;
+  }
+
+  void unlock() {
+    if (ASSERT) pop_owned();
+    Atomic::store(&_state, 0, memory_order_release);
+  }
+};
+
+// ========== Mutex ==========
+// _state：0 空闲，1 已加锁且没有等待者，2 已加锁且可能有线程在 futex 上等待
+
+class Mutex : public LockBase {
+ private:
+  // 自适应自旋次数：上一次靠自旋拿到锁就翻倍，没拿到就减半
+  enum { InitialSpin = 64, MinSpin = 8, MaxSpin = 4096 };
+
+  volatile jint _spin_limit;
+
+  void lock_contended();
+  void wake_waiter();
+
+ protected:
+  // 不做 ASSERT 记账的加锁/解锁，Monitor::wait 用
+  void raw_lock_with_waiters();
+  void raw_unlock() {
+    if (Atomic::xchg(&_state, 0, memory_order_release) == 2) {
+      wake_waiter();
+    }
+  }
+
+ public:
+  constexpr Mutex(int rank, const char* name) : LockBase(rank, name), _spin_limit(InitialSpin) {}
+
+  void lock() {
+    if (ASSERT) check_rank();
+    if (Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) != 0) {
+      lock_contended();
+    }
+    if (ASSERT) push_owned();
+  }
+
+  bool try_lock() {
+    if (Atomic::cmpxchg(&_state, 0, 1, memory_order_acquire) == 0) {
+      if (ASSERT) push_owned();
+      return true;
+    }
+    return false;
+  }
+
+  void unlock() {
+    if (ASSERT) pop_owned();
+    raw_unlock();
+  }
+};
+
+// ========== Monitor ==========
+// 和 OpenJDK 一样允许虚假唤醒，调用方要在循环里重新检查条件
+
+class Monitor : public Mutex {
+ private:
+  volatile jint _wait_seq;   // 每次 notify 加一，等待者在它上面 futex_wait
+  volatile jint _waiters;    // 正在 wait 的线程数（持锁修改），为 0 时 notify 不进内核
+
+ public:
+  constexpr Monitor(int rank, const char* name) : Mutex(rank, name), _wait_seq(0), _waiters(0) {}
+
+  // 必须持有锁。timeout_ms 为 0 表示一直等；超时返回 true
+  bool wait(jlong timeout_ms = 0);
+  void notify();
+  void notify_all();
+};
+
+// ========== 作用域加锁 ==========
+// 和 OpenJDK 一样，传入 nullptr 时什么也不做
+
+class MutexLocker : public StackObj {
+ private:
+  Mutex* _mutex;
+
+ public:
+  explicit MutexLocker(Mutex* mutex) : _mutex(mutex) {
+    if (_mutex != nullptr) {
+      _mutex->lock();
+    }
+  }
+  ~MutexLocker() {
+    if (_mutex != nullptr) {
+      _mutex->unlock();
+    }
+  }
+};
+
+class MonitorLocker : public StackObj {
+ private:
+  Monitor* _monitor;
+
+ public:
+  explicit MonitorLocker(Monitor* monitor) : _monitor(monitor) {
+    _monitor->lock();
+  }
+  ~MonitorLocker() {
+    _monitor->unlock();
+  }
+
+  bool wait(jlong timeout_ms = 0) { return _monitor->wait(timeout_ms); }
+  void notify()                   { _monitor->notify(); }
+  void notify_all()               { _monitor->notify_all(); }
+};
+
+class SpinLocker : public StackObj {
+ private:
+  SpinLock* _lock;
+
+ public:
+  explicit SpinLocker(SpinLock* lock) : _lock(lock) {
+    _lock->lock();
+  }
+  ~SpinLocker() {
+    _lock->unlock();
+  }
+};
+
+#endif // MY_JVM_RUNTIME_MUTEX_HPP
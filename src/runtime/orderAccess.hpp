@@ -0,0 +1,71 @@
+/*
+ * my_jvm - Memory ordering
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/orderAccess.hpp
+ *          和 hotspot/src/hotspot/os_cpu/linux_x86/orderAccess_linux_x86.hpp
+ *
+ * 四种屏障，名字表示屏障前后哪两类访问不能重排：
+ *
+ *   loadload    前面的读  |  后面的读
+ *   storestore  前面的写  |  后面的写
+ *   loadstore   前面的读  |  后面的写
+ *   storeload   前面的写  |  后面的读（最贵，x86 上唯一需要真正指令的一种）
+ *
+ * acquire = loadload + loadstore，release = storestore + loadstore，fence = 全部。
+ * x86-64 是 TSO，只有 storeload 需要指令，其余只是编译器屏障；
+ * 其他平台交给 __atomic_thread_fence（aarch64 上是 dmb ishld / dmb ish）。
+ */
+
+#ifndef MY_JVM_RUNTIME_ORDERACCESS_HPP
+#define MY_JVM_RUNTIME_ORDERACCESS_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+
+class OrderAccess : AllStatic {
+ private:
+  static void compiler_barrier() {
+    __asm__ volatile ("" : : : "memory");
+  }
+
+ public:
+  static void loadload()   { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+  static void storestore() { __atomic_thread_fence(__ATOMIC_RELEASE); }
+  static void loadstore()  { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+  static void storeload()  { fence(); }
+
+  static void acquire()    { __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+  static void release()    { __atomic_thread_fence(__ATOMIC_RELEASE); }
+
+  static void fence() {
+#if defined(__x86_64__)
+    // 对栈顶做一次 lock 前缀的空操作，比 mfence 便宜，效果相同（与 HotSpot 一致）
+    compiler_barrier();
+    __asm__ volatile ("lock; addl $0,0(%%rsp)" : : : "cc", "memory");
+    compiler_barrier();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+  }
+
+  // ========== 带屏障的读写 ==========
+
+  template <typename T>
+  static T load_acquire(const volatile T* p) {
+    return Atomic::load(p, memory_order_acquire);
+  }
+
+  template <typename T, typename V>
+  static void release_store(volatile T* p, V value) {
+    Atomic::store(p, (T)value, memory_order_release);
+  }
+
+  // release 写之后再加一个 storeload，用于 Dekker 式的“先写自己的标记再读对方的”
+  template <typename T, typename V>
+  static void release_store_fence(volatile T* p, V value) {
+    Atomic::store(p, (T)value, memory_order_release);
+    fence();
+  }
+};
+
+#endif // MY_JVM_RUNTIME_ORDERACCESS_HPP
@@ -0,0 +1,165 @@
+/*
+ * my_jvm - Operating system interface (Linux)
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/os/linux/os_linux.cpp
+ */
+
+#include "runtime/os.hpp"
+#include <cstdio>
+#include <cstring>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ========== 页大小 ==========
+
+size_t os::vm_page_size() {
+  static const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+static size_t read_large_page_size() {
+  size_t size = 2 * 1024 * 1024;
+  FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+  if (f != nullptr) {
+    unsigned long value;
+    if (fscanf(f, "%lu", &value) == 1 && is_power_of_2(value)) {
+      size = (size_t)value;
+    }
+    fclose(f);
+  }
+  return size;
+}
+
+size_t os::large_page_size() {
+  static const size_t large_page_size = read_large_page_size();
+  return large_page_size;
+}
+
+// ========== 处理器与调度 ==========
+
+int os::processor_count() {
+  static const int count = MAX2((int)sysconf(_SC_NPROCESSORS_ONLN), 1);
+  return count;
+}
+
+// glibc 在 x86 上用 CPUID 得到这些值，虚拟机里可能读不到
+size_t os::cache_size(int level) {
+  static const long sizes[] = {
+    sysconf(_SC_LEVEL1_DCACHE_SIZE),
+    sysconf(_SC_LEVEL2_CACHE_SIZE),
+    sysconf(_SC_LEVEL3_CACHE_SIZE)
+  };
+  if (level < 1 || level > 3 || sizes[level - 1] <= 0) {
+    return 0;
+  }
+  return (size_t)sizes[level - 1];
+}
+
+void os::naked_yield() {
+  sched_yield();
+}
+
+// 文件内容形如 "always [madvise] never"，方括号里是当前模式
+static os::THPMode read_thp_mode() {
+  os::THPMode mode = os::thp_never;
+  FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (f != nullptr) {
+    char buf[128];
+    if (fgets(buf, sizeof(buf), f) != nullptr) {
+      if (strstr(buf, "[always]") != nullptr) {
+        mode = os::thp_always;
+      } else if (strstr(buf, "[madvise]") != nullptr) {
+        mode = os::thp_madvise;
+      }
+    }
+    fclose(f);
+  }
+  return mode;
+}
+
+os::THPMode os::transparent_huge_pages_mode() {
+  static const THPMode mode = read_thp_mode();
+  return mode;
+}
+
+// ========== 匿名内存映射 ==========
+
+char* os::reserve_memory_aligned(size_t size, size_t alignment) {
+  assert(is_power_of_2(alignment) && is_aligned(size, vm_page_size()), "bad size or alignment");
+  // 多映射 alignment 字节，再把头尾多余的部分还回去
+  size_t extra = size + alignment;
+  void* p = ::mmap(nullptr, extra, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  char* start = (char*)p;
+  char* aligned = align_up(start, alignment);
+  size_t head = (size_t)(aligned - start);
+  size_t tail = extra - head - size;
+  if (head > 0) {
+    ::munmap(start, head);
+  }
+  if (tail > 0) {
+    ::munmap(aligned + size, tail);
+  }
+  return aligned;
+}
+
+char* os::attempt_reserve_memory_at(char* addr, size_t size) {
+  // 只作为提示传给 mmap，内核选了别的地址就放弃
+  void* p = ::mmap(addr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  if (p != addr) {
+    ::munmap(p, size);
+    return nullptr;
+  }
+  return addr;
+}
+
+void os::release_memory(char* addr, size_t size) {
+  ::munmap(addr, size);
+}
+
+bool os::uncommit_memory(char* addr, size_t size) {
+  return ::madvise(addr, size, MADV_DONTNEED) == 0;
+}
+
+bool os::request_huge_pages(char* addr, size_t size) {
+#ifdef MADV_HUGEPAGE
+  return ::madvise(addr, size, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
+size_t os::anon_huge_page_bytes(const char* addr, size_t size) {
+  FILE* f = fopen("/proc/self/smaps", "r");
+  if (f == nullptr) {
+    return 0;
+  }
+  uintptr_t lo = (uintptr_t)addr;
+  uintptr_t hi = lo + size;
+  size_t overlap = 0;   // 当前映射与查询区间重叠的字节，0 表示不相关
+  size_t total = 0;
+  char line[512];
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    unsigned long start, end;
+    size_t kb;
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+      // 新映射的首行
+      uintptr_t s = MAX2((uintptr_t)start, lo);
+      uintptr_t e = MIN2((uintptr_t)end, hi);
+      overlap = s < e ? (size_t)(e - s) : 0;
+    } else if (overlap > 0 && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+      // 相邻的匿名映射可能被内核合并，最多只算重叠的部分
+      total += MIN2(kb * 1024, overlap);
+    }
+  }
+  fclose(f);
+  return total;
+}
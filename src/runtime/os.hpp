@@ -0,0 +1,73 @@
+/*
+ * my_jvm - Operating system interface
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/os.hpp
+ *      hotspot/src/hotspot/os/linux/os_linux.cpp
+ * 简化版本：只有 Linux，只提供匿名内存映射、透明大页和锁需要的几个接口
+ */
+
+#ifndef MY_JVM_RUNTIME_OS_HPP
+#define MY_JVM_RUNTIME_OS_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class os : AllStatic {
+ public:
+  // 透明大页（THP）模式，对应 /sys/kernel/mm/transparent_hugepage/enabled
+  enum THPMode {
+    thp_never,      // 不可用（内核关闭或不支持）
+    thp_madvise,    // 只对 MADV_HUGEPAGE 的区间生效
+    thp_always      // 对所有匿名内存生效
+  };
+
+  // ========== 页大小 ==========
+
+  static size_t vm_page_size();
+  // 透明大页大小（hpage_pmd_size，读不到时按 2M）
+  static size_t large_page_size();
+  static THPMode transparent_huge_pages_mode();
+  static bool can_use_transparent_huge_pages() {
+    return transparent_huge_pages_mode() != thp_never;
+  }
+
+  // ========== 处理器与调度 ==========
+
+  // 可用的处理器个数（启动时读一次）
+  static int  processor_count();
+  // 第 level 级数据缓存（或统一缓存）的大小，读不到时返回 0
+  static size_t cache_size(int level);
+  // 让出 CPU（sched_yield），用于自旋等待
+  static void naked_yield();
+  // 自旋等待循环里的一次 CPU 提示（x86 pause / aarch64 yield）
+  static void spin_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ volatile ("pause" : : : "memory");
+#elif defined(__aarch64__)
+    __asm__ volatile ("yield" : : : "memory");
+#endif
+  }
+
+  // ========== 匿名内存映射 ==========
+
+  // 映射 size 字节可读写的匿名内存，起始地址按 alignment 对齐（2 的幂）。
+  // 物理页在首次访问时才分配。失败返回 nullptr
+  static char* reserve_memory_aligned(size_t size, size_t alignment);
+  // 尝试在 addr 处映射 size 字节；地址被占用时返回 nullptr（不覆盖已有映射）
+  static char* attempt_reserve_memory_at(char* addr, size_t size);
+  static void  release_memory(char* addr, size_t size);
+
+  // 把 [addr, addr + size) 的物理页还给 OS（MADV_DONTNEED），
+  // 地址仍然有效，再次访问时得到清零的新页
+  static bool uncommit_memory(char* addr, size_t size);
+
+  // 对 [addr, addr + size) 请求透明大页（MADV_HUGEPAGE）。
+  // 失败时内存照常可用，只是不会用大页
+  static bool request_huge_pages(char* addr, size_t size);
+
+  // [addr, addr + size) 中实际由大页支撑的字节数，
+  // 来自 /proc/self/smaps 的 AnonHugePages；需要读整个文件，只用于统计
+  static size_t anon_huge_page_bytes(const char* addr, size_t size);
+};
+
+#endif // MY_JVM_RUNTIME_OS_HPP
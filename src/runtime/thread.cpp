@@ -0,0 +1,82 @@
+/*
+ * my_jvm - Thread implementation
+ */
+
+#include "runtime/thread.hpp"
+#include "memory/resourceArea.hpp"
+#include "utilities/stripedCounter.hpp"
+
+// ========== 线程私有 Thread* ==========
+
+thread_local Thread* Thread::_thr_current = nullptr;
+
+// ========== Threads ==========
+
+Mutex   Threads::_lock(Mutex::leaf, "Threads_lock");
+Thread* Threads::_thread_list = nullptr;
+int     Threads::_number_of_threads = 0;
+
+void Threads::add(Thread* thread) {
+  MutexLocker ml(&_lock);
+  thread->_next = _thread_list;
+  _thread_list = thread;
+  Atomic::store(&_number_of_threads, _number_of_threads + 1);
+}
+
+void Threads::remove(Thread* thread) {
+  MutexLocker ml(&_lock);
+  Thread** p = &_thread_list;
+  while (*p != thread) {
+    assert(*p != nullptr, "thread not in list");
+    p = &(*p)->_next;
+  }
+  // 和摘链在同一个临界区里，sum() 不会把这个线程算两次或漏掉
+  PerThreadCounter::retire_thread(thread);
+  *p = thread->_next;
+  thread->_next = nullptr;
+  Atomic::store(&_number_of_threads, _number_of_threads - 1);
+}
+
+// 线程退出时析构当前 Thread（thread_local 析构函数在线程退出时运行）
+class ThreadExitHook {
+ public:
+  ~ThreadExitHook() {
+    Thread* thread = Thread::current_or_null();
+    if (thread != nullptr) {
+      delete thread;
+    }
+  }
+};
+
+// ========== Thread 实现 ==========
+
+Thread::Thread() : _rcu_counter(0), _next(nullptr) {
+  for (int i = 0; i < local_counter_slots; i++) {
+    _local_counters[i] = 0;
+  }
+  _resource_area = new ResourceArea(mtThread);
+  Threads::add(this);
+}
+
+Thread::~Thread() {
+  assert((_rcu_counter & 1) == 0, "thread exiting inside a GlobalCounter critical section");
+  // 先从链表摘下，之后 write_synchronize 不会再等这个线程
+  Threads::remove(this);
+  _tlab.retire();
+  // ResourceArea 析构时所有 Chunk 回到 ChunkPool
+  delete _resource_area;
+  _resource_area = nullptr;
+  if (_thr_current == this) {
+    _thr_current = nullptr;
+  }
+}
+
+Thread* Thread::attach_current_thread() {
+  assert(_thr_current == nullptr, "already attached");
+  // 首次使用时构造，线程退出时析构
+  static thread_local ThreadExitHook exit_hook;
+  (void)exit_hook;
+  Thread* thread = new Thread();
+  _thr_current = thread;
+  return thread;
+}
@@ -0,0 +1,104 @@
+/*
+ * my_jvm - Thread (简化版)
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/thread.hpp
+ * 简化版本：只保留线程私有的 VM 资源（ResourceArea、TLAB），
+ * 尚无 JavaThread / 线程状态 / safepoint 支持
+ *
+ * 生命周期：
+ *   - 线程第一次调用 Thread::current() 时惰性创建并附加，同时加入 Threads 链表
+ *   - 线程退出时自动析构，ResourceArea 的 Chunk 回到 ChunkPool，TLAB 被丢弃
+ */
+
+#ifndef MY_JVM_RUNTIME_THREAD_HPP
+#define MY_JVM_RUNTIME_THREAD_HPP
+
+#include "gc/shared/threadLocalAllocBuffer.hpp"
+#include "memory/allocation.hpp"
+#include "runtime/mutex.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class ResourceArea;
+
+// ========== Thread ==========
+
+class Thread : public CHeapObj<mtThread> {
+ public:
+  // PerThreadCounter 的槽位数
+  enum { local_counter_slots = 16 };
+
+ private:
+  // 当前线程的 Thread*（对应 OpenJDK 的 Thread::_thr_current）
+  static thread_local Thread* _thr_current;
+
+  ResourceArea* _resource_area;   // 线程私有的资源区
+  ThreadLocalAllocBuffer _tlab;   // 线程私有的 Java 对象分配缓冲
+
+  // GlobalCounter 的读端计数：只有本线程写，write_synchronize 读
+  volatile uintx _rcu_counter;
+
+  // PerThreadCounter 的本线程部分：只有本线程写，sum() 读
+  volatile jlong _local_counters[local_counter_slots];
+
+  Thread* _next;                  // Threads 链表
+
+  // 为尚未附加的线程创建 Thread 并注册线程退出时的析构
+  static Thread* attach_current_thread();
+
+ public:
+  Thread();
+  virtual ~Thread();
+
+  // 当前线程（未附加则惰性创建）
+  static Thread* current() {
+    Thread* thread = _thr_current;
+    if (MY_JVM_UNLIKELY(thread == nullptr)) {
+      thread = attach_current_thread();
+    }
+    return thread;
+  }
+
+  // 当前线程（未附加时返回 nullptr，不会创建）
+  static Thread* current_or_null() { return _thr_current; }
+
+  ResourceArea* resource_area() const { return _resource_area; }
+  ThreadLocalAllocBuffer& tlab()      { return _tlab; }
+
+  volatile uintx* get_rcu_counter()   { return &_rcu_counter; }
+  volatile jlong* local_counter_addr(int slot) { return &_local_counters[slot]; }
+
+  DISALLOW_COPY_AND_ASSIGN(Thread);
+
+  friend class Threads;
+  friend class PerThreadCounter;
+};
+
+// ========== Threads ==========
+// 所有已附加的 Thread（对应 OpenJDK 的 Threads，简化成一个加锁的链表）
+
+class Threads : AllStatic {
+  friend class Thread;
+  friend class PerThreadCounter;
+
+ private:
+  static Mutex   _lock;
+  static Thread* _thread_list;
+  static int     _number_of_threads;
+
+  static void add(Thread* thread);
+  static void remove(Thread* thread);
+
+ public:
+  static int number_of_threads() { return Atomic::load(&_number_of_threads); }
+
+  // 持锁遍历所有线程：f(Thread*)。遍历期间线程不会析构，也不会有新线程加入
+  template <typename F>
+  static void threads_do(F f) {
+    MutexLocker ml(&_lock);
+    for (Thread* t = _thread_list; t != nullptr; t = t->_next) {
+      f(t);
+    }
+  }
+};
+
+#endif // MY_JVM_RUNTIME_THREAD_HPP
@@ -0,0 +1,229 @@
+/*
+ * my_jvm - CPU feature detection implementation
+ */
+
+#include "runtime/vm_version.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/os.hpp"
+#include "utilities/ostream.hpp"
+#include <cstdio>
+#include <cstring>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+uint64_t      VM_Version::_cpu_features       = 0;
+uint64_t      VM_Version::_features           = 0;
+int           VM_Version::_cache_line_size    = DEFAULT_CACHE_LINE_SIZE;
+size_t        VM_Version::_L1_data_cache_size = 0;
+size_t        VM_Version::_L2_cache_size      = 0;
+size_t        VM_Version::_L3_cache_size      = 0;
+char          VM_Version::_features_string[256];
+volatile bool VM_Version::_initialized        = false;
+
+// ========== CPUID ==========
+
+#if defined(__x86_64__)
+
+// XCR0：OS 用 XSAVE 保存哪些寄存器状态
+static uint64_t xgetbv() {
+  uint32_t eax, edx;
+  __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+}
+
+uint64_t VM_Version::detect_cpu_features() {
+  unsigned int eax, ebx, ecx, edx;
+  uint64_t result = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return CPU_SSE2;   // x86_64 一定有 SSE2
+  }
+  if (edx & (1u << 26)) result |= CPU_SSE2;
+  if (ecx & (1u << 0))  result |= CPU_SSE3;
+  if (ecx & (1u << 9))  result |= CPU_SSSE3;
+  if (ecx & (1u << 19)) result |= CPU_SSE4_1;
+  if (ecx & (1u << 20)) result |= CPU_SSE4_2;
+  if (ecx & (1u << 23)) result |= CPU_POPCNT;
+  if (ecx & (1u << 1))  result |= CPU_CLMUL;
+  if (edx & (1u << 19)) {
+    // CLFLUSH 的行大小（8 字节为单位），sysfs 读不到时用它
+    _cache_line_size = (int)((ebx >> 8) & 0xff) * 8;
+  }
+
+  // AVX 要求 OS 开启 XSAVE 并保存 XMM/YMM 状态，AVX-512 还要 opmask 和 ZMM 状态
+  bool os_avx = false;
+  bool os_avx512 = false;
+  if ((ecx & (1u << 27)) != 0) {   // OSXSAVE
+    uint64_t xcr0 = xgetbv();
+    os_avx    = (xcr0 & 0x6) == 0x6;
+    os_avx512 = (xcr0 & 0xe6) == 0xe6;
+  }
+  if (os_avx && (ecx & (1u << 28))) result |= CPU_AVX;
+
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    if (ebx & (1u << 3)) result |= CPU_BMI1;
+    if (ebx & (1u << 8)) result |= CPU_BMI2;
+    if (ebx & (1u << 9)) result |= CPU_ERMS;
+    if ((result & CPU_AVX) != 0 && (ebx & (1u << 5))) result |= CPU_AVX2;
+    if (os_avx512 && (result & CPU_AVX2) != 0 && (ebx & (1u << 16))) {
+      result |= CPU_AVX512F;
+      if (ebx & (1u << 30)) result |= CPU_AVX512BW;
+      if (ebx & (1u << 31)) result |= CPU_AVX512VL;
+    }
+  }
+  return result;
+}
+
+#else
+
+uint64_t VM_Version::detect_cpu_features() {
+  return 0;
+}
+
+#endif // __x86_64__
+
+// ========== 缓存 ==========
+
+// 读 sysfs 里的一行，去掉换行；失败返回 false
+static bool read_sysfs_line(const char* path, char* buf, size_t len) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) {
+    return false;
+  }
+  bool ok = fgets(buf, (int)len, f) != nullptr;
+  fclose(f);
+  if (ok) {
+    buf[strcspn(buf, "\n")] = '\0';
+  }
+  return ok;
+}
+
+// "48K" / "2048K" / "105M"
+static size_t parse_cache_size(const char* s) {
+  char* end;
+  size_t value = (size_t)strtoull(s, &end, 10);
+  if (*end == 'K') return value * 1024;
+  if (*end == 'M') return value * 1024 * 1024;
+  return value;
+}
+
+// cpu0 的 index0..N：每个目录一级缓存，type 是 Data / Instruction / Unified
+void VM_Version::detect_caches() {
+  bool line_from_sysfs = false;
+  for (int index = 0; index < 8; index++) {
+    char path[128];
+    char level[16], type[32], size[32], line[16];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+    if (!read_sysfs_line(path, level, sizeof(level))) {
+      break;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+    if (!read_sysfs_line(path, type, sizeof(type)) || strcmp(type, "Instruction") == 0) {
+      continue;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+    size_t bytes = read_sysfs_line(path, size, sizeof(size)) ? parse_cache_size(size) : 0;
+    switch (atoi(level)) {
+      case 1: _L1_data_cache_size = bytes; break;
+      case 2: _L2_cache_size      = bytes; break;
+      case 3: _L3_cache_size      = bytes; break;
+      default: break;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", index);
+    if (!line_from_sysfs && read_sysfs_line(path, line, sizeof(line)) && atoi(line) > 0) {
+      _cache_line_size = atoi(line);
+      line_from_sysfs = true;
+    }
+  }
+  // 容器或虚拟机里可能没有 sysfs 的缓存目录
+  if (_L1_data_cache_size == 0) _L1_data_cache_size = os::cache_size(1);
+  if (_L2_cache_size == 0)      _L2_cache_size      = os::cache_size(2);
+  if (_L3_cache_size == 0)      _L3_cache_size      = os::cache_size(3);
+  if (!is_power_of_2(_cache_line_size)) {
+    _cache_line_size = DEFAULT_CACHE_LINE_SIZE;
+  }
+}
+
+// ========== flag ==========
+
+// flag 只能调低：UseAVX=2 的机器上指定 UseAVX=3 也只用 AVX2
+void VM_Version::adjust_flags() {
+  uint64_t f = _cpu_features;
+
+  intx sse_level = (f & CPU_SSE4_1) != 0 ? 4 : (f & CPU_SSSE3) != 0 ? 3 : (f & CPU_SSE2) != 0 ? 2 : 0;
+  UseSSE = MIN2(UseSSE, sse_level);
+  intx avx_level = (f & CPU_AVX512F) != 0 ? 3 : (f & CPU_AVX2) != 0 ? 2 : (f & CPU_AVX) != 0 ? 1 : 0;
+  UseAVX = MIN2(UseAVX, avx_level);
+  if (UseSSE < 4) {
+    // AVX 的编码依赖 SSE4 级别的指令
+    UseAVX = 0;
+  }
+
+  UsePopCountInstruction &= (f & CPU_POPCNT) != 0;
+  UseBMI1Instructions    &= (f & CPU_BMI1) != 0;
+  UseBMI2Instructions    &= (f & CPU_BMI2) != 0;
+  UseCLMUL               &= (f & CPU_CLMUL) != 0;
+  UseFastStosb           &= (f & CPU_ERMS) != 0;
+
+  if (UseSSE < 4) f &= ~(uint64_t)(CPU_SSE4_1 | CPU_SSE4_2);
+  if (UseSSE < 3) f &= ~(uint64_t)(CPU_SSE3 | CPU_SSSE3);
+  if (UseAVX < 3) f &= ~(uint64_t)(CPU_AVX512F | CPU_AVX512BW | CPU_AVX512VL);
+  if (UseAVX < 2) f &= ~(uint64_t)CPU_AVX2;
+  if (UseAVX < 1) f &= ~(uint64_t)CPU_AVX;
+  if (!UsePopCountInstruction) f &= ~(uint64_t)CPU_POPCNT;
+  if (!UseBMI1Instructions)    f &= ~(uint64_t)CPU_BMI1;
+  if (!UseBMI2Instructions)    f &= ~(uint64_t)CPU_BMI2;
+  if (!UseCLMUL)               f &= ~(uint64_t)CPU_CLMUL;
+  if (!UseFastStosb)           f &= ~(uint64_t)CPU_ERMS;
+  _features = f;
+}
+
+// ========== 初始化 ==========
+
+static const struct {
+  uint64_t    flag;
+  const char* name;
+} feature_names[] = {
+  { VM_Version::CPU_SSE2,     "sse2"     },
+  { VM_Version::CPU_SSE3,     "sse3"     },
+  { VM_Version::CPU_SSSE3,    "ssse3"    },
+  { VM_Version::CPU_SSE4_1,   "sse4.1"   },
+  { VM_Version::CPU_SSE4_2,   "sse4.2"   },
+  { VM_Version::CPU_POPCNT,   "popcnt"   },
+  { VM_Version::CPU_CLMUL,    "clmul"    },
+  { VM_Version::CPU_AVX,      "avx"      },
+  { VM_Version::CPU_AVX2,     "avx2"     },
+  { VM_Version::CPU_AVX512F,  "avx512f"  },
+  { VM_Version::CPU_AVX512BW, "avx512bw" },
+  { VM_Version::CPU_AVX512VL, "avx512vl" },
+  { VM_Version::CPU_BMI1,     "bmi1"     },
+  { VM_Version::CPU_BMI2,     "bmi2"     },
+  { VM_Version::CPU_ERMS,     "erms"     },
+};
+
+void VM_Version::initialize() {
+  _cpu_features = detect_cpu_features();
+  detect_caches();
+  adjust_flags();
+
+  // 先在局部缓冲区里拼好：并发初始化时 _features_string 只会被同样的字节覆盖
+  char buf[sizeof(_features_string)];
+  stringStream ss(buf, sizeof(buf));
+  for (size_t i = 0; i < sizeof(feature_names) / sizeof(feature_names[0]); i++) {
+    if ((_features & feature_names[i].flag) != 0) {
+      ss.print("%s%s", ss.size() == 0 ? "" : ", ", feature_names[i].name);
+    }
+  }
+  memcpy(_features_string, buf, ss.size() + 1);
+  OrderAccess::release_store(&_initialized, true);
+}
+
+void VM_Version::print_on(outputStream* st) {
+  st->print_cr("CPU features: %s", features_string());
+  st->print_cr("Cache: line %d, L1d " SIZE_FORMAT "K, L2 " SIZE_FORMAT "K, L3 " SIZE_FORMAT "K",
+               _cache_line_size, _L1_data_cache_size / 1024, _L2_cache_size / 1024, _L3_cache_size / 1024);
+  st->print_cr("Flags: UseSSE=%d UseAVX=%d UsePopCountInstruction=%d UseBMI1Instructions=%d UseBMI2Instructions=%d"
+               " UseCLMUL=%d UseFastStosb=%d",
+               (int)UseSSE, (int)UseAVX, UsePopCountInstruction, UseBMI1Instructions, UseBMI2Instructions,
+               UseCLMUL, UseFastStosb);
+}
@@ -0,0 +1,123 @@
+/*
+ * my_jvm - CPU feature detection
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/runtime/vm_version.hpp
+ *                hotspot/src/hotspot/cpu/x86/vm_version_x86.hpp
+ * 简化版本：只检测优化核心用得到的特性，不生成 CPUID stub，直接用 <cpuid.h>。
+ *
+ *  - 特性来自 CPUID；AVX / AVX-512 还要求 OS 保存对应的寄存器状态（XGETBV）
+ *  - 缓存大小和缓存行大小优先读 /sys/devices/system/cpu/cpu0/cache，
+ *    读不到时退回 sysconf / CPUID
+ *  - initialize() 按检测结果调低 UseSSE / UseAVX，关掉 CPU 不支持的 Use* flag，
+ *    再从 features() 里去掉被 flag 关掉的特性。之后只需要看 supports_*()
+ *
+ * 第一次查询时惰性初始化，所以 flag 要在第一次使用优化核心之前设置。
+ *
+ * 核心选择：每个模块列一张 Kernel 表，按从快到慢的顺序写，最后一项是基线实现，
+ * select() 返回第一项 CPU 支持的。选中的函数指针由模块自己发布（见 Copy、VectorSearch）。
+ */
+
+#ifndef MY_JVM_RUNTIME_VM_VERSION_HPP
+#define MY_JVM_RUNTIME_VM_VERSION_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/orderAccess.hpp"
+#include "utilities/debug.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class outputStream;
+
+class VM_Version : AllStatic {
+ public:
+  enum Feature_Flag : uint64_t {
+    CPU_SSE2     = (uint64_t)1 << 0,
+    CPU_SSE3     = (uint64_t)1 << 1,
+    CPU_SSSE3    = (uint64_t)1 << 2,
+    CPU_SSE4_1   = (uint64_t)1 << 3,
+    CPU_SSE4_2   = (uint64_t)1 << 4,
+    CPU_POPCNT   = (uint64_t)1 << 5,
+    CPU_CLMUL    = (uint64_t)1 << 6,    // PCLMULQDQ
+    CPU_AVX      = (uint64_t)1 << 7,
+    CPU_AVX2     = (uint64_t)1 << 8,
+    CPU_AVX512F  = (uint64_t)1 << 9,
+    CPU_AVX512BW = (uint64_t)1 << 10,
+    CPU_AVX512VL = (uint64_t)1 << 11,
+    CPU_BMI1     = (uint64_t)1 << 12,
+    CPU_BMI2     = (uint64_t)1 << 13,
+    CPU_ERMS     = (uint64_t)1 << 14    // Enhanced REP MOVSB/STOSB
+  };
+
+  // 核心表的一项：需要的特性（CPU_* 的组合）、名字、实现
+  template <typename T>
+  struct Kernel {
+    uint64_t    required;
+    const char* name;
+    T           impl;
+  };
+
+ private:
+  static uint64_t      _cpu_features;        // CPU 和 OS 实际支持的
+  static uint64_t      _features;            // 再去掉被 flag 关掉的
+  static int           _cache_line_size;
+  static size_t        _L1_data_cache_size;
+  static size_t        _L2_cache_size;
+  static size_t        _L3_cache_size;
+  static char          _features_string[256];
+  static volatile bool _initialized;
+
+  static void ensure_initialized() {
+    if (!OrderAccess::load_acquire(&_initialized)) {
+      initialize();
+    }
+  }
+
+  static uint64_t detect_cpu_features();
+  static void     detect_caches();
+  static void     adjust_flags();
+
+ public:
+  // 多个线程同时初始化时写入的是同样的值
+  static void initialize();
+
+  static uint64_t features()     { ensure_initialized(); return _features; }
+  static uint64_t cpu_features() { ensure_initialized(); return _cpu_features; }
+
+  static bool supports(uint64_t required) { return (features() & required) == required; }
+
+  static bool supports_sse2()     { return supports(CPU_SSE2); }
+  static bool supports_sse4_2()   { return supports(CPU_SSE4_2); }
+  static bool supports_popcnt()   { return supports(CPU_POPCNT); }
+  static bool supports_clmul()    { return supports(CPU_CLMUL); }
+  static bool supports_avx()      { return supports(CPU_AVX); }
+  static bool supports_avx2()     { return supports(CPU_AVX2); }
+  static bool supports_avx512bw() { return supports(CPU_AVX512F | CPU_AVX512BW | CPU_AVX512VL); }
+  static bool supports_bmi1()     { return supports(CPU_BMI1); }
+  static bool supports_bmi2()     { return supports(CPU_BMI2); }
+  static bool supports_erms()     { return supports(CPU_ERMS); }
+
+  // 缓存行大小（字节）；缓存大小读不到时为 0
+  static int    cache_line_size()    { ensure_initialized(); return _cache_line_size; }
+  static size_t L1_data_cache_size() { ensure_initialized(); return _L1_data_cache_size; }
+  static size_t L2_cache_size()      { ensure_initialized(); return _L2_cache_size; }
+  static size_t L3_cache_size()      { ensure_initialized(); return _L3_cache_size; }
+
+  // 例如 "sse2, sse3, ssse3, sse4.1, sse4.2, popcnt, clmul, avx, avx2, bmi1, bmi2, erms"
+  static const char* features_string() { ensure_initialized(); return _features_string; }
+
+  static void print_on(outputStream* st);
+
+  // 返回表中第一项 CPU 支持的；最后一项必须是基线实现
+  template <typename T, size_t N>
+  static const Kernel<T>& select(const Kernel<T> (&table)[N]) {
+    for (size_t i = 0; i < N - 1; i++) {
+      if (supports(table[i].required)) {
+        return table[i];
+      }
+    }
+    assert((cpu_features() & table[N - 1].required) == table[N - 1].required,
+           "baseline kernel %s not supported", table[N - 1].name);
+    return table[N - 1];
+  }
+};
+
+#endif // MY_JVM_RUNTIME_VM_VERSION_HPP
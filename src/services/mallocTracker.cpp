@@ -0,0 +1,248 @@
+/*
+ * my_jvm - Malloc tracker implementation
+ */
+
+#include "services/mallocTracker.hpp"
+#include "memory/slabAllocator.hpp"
+#include "runtime/globals.hpp"
+#include "services/memTracker.hpp"
+#include <cstdlib>
+#include <new>
+
+// ========== MallocMemorySummary ==========
+
+MallocMemory          MallocMemorySummary::_retired[mt_number_of_types];
+ThreadMallocCounters* MallocMemorySummary::_threads = nullptr;
+SpinLock              MallocMemorySummary::_threads_lock(LockBase::special, "NMT thread counters");
+
+thread_local ThreadMallocCounters* MallocMemorySummary::_local = nullptr;
+thread_local bool                  MallocMemorySummary::_local_retired = false;
+
+// 线程退出时折叠计数（thread_local 析构函数在线程退出时运行）
+class ThreadMallocCountersRetirer {
+ public:
+  ~ThreadMallocCountersRetirer() {
+    MallocMemorySummary::retire_thread();
+  }
+};
+
+void MallocMemorySummary::lock_threads() {
+  _threads_lock.lock();
+}
+
+void MallocMemorySummary::unlock_threads() {
+  _threads_lock.unlock();
+}
+
+ThreadMallocCounters* MallocMemorySummary::register_thread() {
+  if (_local_retired) {
+    // 线程正在退出，之后的分配直接计入 _retired
+    return nullptr;
+  }
+  // 计数块本身用 ::calloc 分配，不计入 NMT
+  ThreadMallocCounters* counters = (ThreadMallocCounters*)::calloc(1, sizeof(ThreadMallocCounters));
+  if (counters == nullptr) {
+    return nullptr;
+  }
+  static thread_local ThreadMallocCountersRetirer retirer;
+  (void)retirer;
+
+  lock_threads();
+  counters->_next = _threads;
+  _threads = counters;
+  unlock_threads();
+
+  _local = counters;
+  return counters;
+}
+
+void MallocMemorySummary::retire_thread() {
+  ThreadMallocCounters* counters = _local;
+  _local = nullptr;
+  _local_retired = true;
+  if (counters == nullptr) {
+    return;
+  }
+
+  lock_threads();
+  ThreadMallocCounters** p = &_threads;
+  while (*p != counters) {
+    p = &(*p)->_next;
+  }
+  *p = counters->_next;
+  // 持锁折叠，保证 snapshot() 不会漏算或重复计算
+  for (int i = 0; i < mt_number_of_types; i++) {
+    const ThreadMallocCounters::Counters& c = counters->_types[i];
+    _retired[i].add(c.malloc_count, c.malloc_size, c.arena_count, c.arena_size);
+  }
+  unlock_threads();
+
+  ::free(counters);
+}
+
+MallocMemory MallocMemorySummary::snapshot(MEMFLAGS flag) {
+  MallocMemory result = header_snapshot(flag);
+  // 不能在持有 _threads_lock 时取：SlabAllocator 的锁 rank 更高
+  if (MemTracker::tracking_level() == NMT_summary) {
+    size_t count;
+    size_t bytes;
+    SlabAllocator::usage(flag, &count, &bytes);
+    result.add(count, bytes, 0, 0);
+  }
+  return result;
+}
+
+MallocMemory MallocMemorySummary::header_snapshot(MEMFLAGS flag) {
+  int index = NMTUtil::flag_to_index(flag);
+  size_t malloc_count = _retired[index].malloc_count();
+  size_t malloc_size  = _retired[index].malloc_size();
+  size_t arena_count  = _retired[index].arena_count();
+  size_t arena_size   = _retired[index].arena_size();
+
+  lock_threads();
+  for (ThreadMallocCounters* c = _threads; c != nullptr; c = c->_next) {
+    malloc_count += c->_types[index].malloc_count;
+    malloc_size  += c->_types[index].malloc_size;
+    arena_count  += c->_types[index].arena_count;
+    arena_size   += c->_types[index].arena_size;
+  }
+  unlock_threads();
+
+  MallocMemory result;
+  result.add(malloc_count, malloc_size, arena_count, arena_size);
+  return result;
+}
+
+size_t MallocMemorySummary::total_malloc() {
+  size_t total = 0;
+  for (int i = 0; i < mt_number_of_types; i++) {
+    total += snapshot(NMTUtil::index_to_flag(i)).malloc_size();
+  }
+  return total;
+}
+
+size_t MallocMemorySummary::total_arena() {
+  size_t total = 0;
+  for (int i = 0; i < mt_number_of_types; i++) {
+    total += snapshot(NMTUtil::index_to_flag(i)).arena_size();
+  }
+  return total;
+}
+
+size_t MallocMemorySummary::total_count() {
+  size_t total = 0;
+  for (int i = 0; i < mt_number_of_types; i++) {
+    total += snapshot(NMTUtil::index_to_flag(i)).malloc_count();
+  }
+  return total;
+}
+
+size_t MallocMemorySummary::tracking_overhead() {
+  size_t count = 0;
+  for (int i = 0; i < mt_number_of_types; i++) {
+    count += header_snapshot(NMTUtil::index_to_flag(i)).malloc_count();
+  }
+  return count * sizeof(MallocHeader);
+}
+
+// ========== MallocSiteTable ==========
+
+MallocSiteHashtableEntry* volatile MallocSiteTable::_table[MallocSiteTable::table_size];
+
+MallocSite* MallocSiteTable::lookup_or_add(const NativeCallStack& stack, size_t* bucket_idx,
+                                           size_t* pos_idx, MEMFLAGS flags) {
+  unsigned int index = hash_to_index(stack.hash());
+  *bucket_idx = (size_t)index;
+  *pos_idx = 0;
+
+  // 空桶：CAS 安装第一个条目
+  MallocSiteHashtableEntry* head =
+    (MallocSiteHashtableEntry*)atomic_load((void* const*)&_table[index]);
+  if (head == nullptr) {
+    // 条目本身用 ::malloc 分配，不计入 NMT
+    void* mem = ::malloc(sizeof(MallocSiteHashtableEntry));
+    if (mem == nullptr) return nullptr;
+    MallocSiteHashtableEntry* entry = ::new (mem) MallocSiteHashtableEntry(stack, flags);
+    if (atomic_cas((void**)&_table[index], (void*)entry, (void*)nullptr) == nullptr) {
+      return entry->data();
+    }
+    ::free(mem);
+    head = (MallocSiteHashtableEntry*)atomic_load((void* const*)&_table[index]);
+  }
+
+  // 沿链表查找，到尾部仍未找到则无锁追加
+  while (head != nullptr && (*pos_idx) <= MAX_BUCKET_LENGTH) {
+    MallocSite* site = head->data();
+    if (site->flags() == flags && site->call_stack()->equals(stack)) {
+      return site;
+    }
+    if (head->next() == nullptr && (*pos_idx) < MAX_BUCKET_LENGTH) {
+      void* mem = ::malloc(sizeof(MallocSiteHashtableEntry));
+      if (mem == nullptr) return nullptr;
+      MallocSiteHashtableEntry* entry = ::new (mem) MallocSiteHashtableEntry(stack, flags);
+      if (head->atomic_set_next(entry)) {
+        (*pos_idx)++;
+        return entry->data();
+      }
+      // 别的线程抢先追加了，继续往后找
+      ::free(mem);
+    }
+    head = head->next();
+    (*pos_idx)++;
+  }
+  return nullptr;
+}
+
+MallocSite* MallocSiteTable::malloc_site(size_t bucket_idx, size_t pos_idx) {
+  assert(bucket_idx < table_size, "Invalid bucket index");
+  MallocSiteHashtableEntry* head =
+    (MallocSiteHashtableEntry*)atomic_load((void* const*)&_table[bucket_idx]);
+  for (size_t index = 0; index < pos_idx && head != nullptr; index++) {
+    head = head->next();
+  }
+  assert(head != nullptr, "Invalid position index");
+  return head != nullptr ? head->data() : nullptr;
+}
+
+bool MallocSiteTable::allocation_at(const NativeCallStack& stack, size_t size,
+                                    size_t* bucket_idx, size_t* pos_idx, MEMFLAGS flags) {
+  MallocSite* site = lookup_or_add(stack, bucket_idx, pos_idx, flags);
+  if (site != nullptr) {
+    site->allocate(size);
+  }
+  return site != nullptr;
+}
+
+bool MallocSiteTable::deallocation_at(size_t size, size_t bucket_idx, size_t pos_idx) {
+  MallocSite* site = malloc_site(bucket_idx, pos_idx);
+  if (site != nullptr) {
+    site->deallocate(size);
+    return true;
+  }
+  return false;
+}
+
+// ========== MallocHeader ==========
+
+void MallocHeader::record_site(const NativeCallStack& stack) {
+  size_t bucket_idx;
+  size_t pos_idx;
+  if (MallocSiteTable::allocation_at(stack, _size, &bucket_idx, &pos_idx, flags())) {
+    _bucket_idx = (u4)bucket_idx;
+    _pos_idx = (u2)pos_idx;
+  }
+}
+
+void MallocHeader::release_site() const {
+  MallocSiteTable::deallocation_at(size(), _bucket_idx, _pos_idx);
+}
+
+// ========== MallocTracker ==========
+
+void MallocTracker::record_malloc_site(MallocHeader* header, address caller_pc) {
+  NativeCallStack stack(caller_pc, (int)NMTStackDepth);
+  header->record_site(stack);
+}
+
+// header 必须保持 16 字节，以保证用户内存的对齐与 malloc 一致
+static_assert(sizeof(MallocHeader) == 16, "MallocHeader must be 16 bytes");
@@ -0,0 +1,401 @@
+/*
+ * my_jvm - Malloc tracker
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/services/mallocTracker.hpp
+ *             和 hotspot/src/hotspot/share/services/mallocSiteTable.hpp
+ *
+ * 走 malloc 的块在用户内存前放一个 16 字节的 MallocHeader：
+ *
+ *   +-------------------+---------------------+
+ *   | MallocHeader (16) | 用户内存 (size)       |
+ *   +-------------------+---------------------+
+ *   ^ malloc 返回值      ^ AllocateHeap 返回值
+ *
+ * summary 模式：按 MemoryType 累加 malloc / arena 的字节数与次数。
+ *   slab 块不带 header：Slab 已经记录了 MEMFLAGS 和大小类，用量由
+ *   SlabAllocator::usage() 汇总时算出，按大小类计（比请求的字节数略大）
+ * detail  模式：所有块都带 header，另外按调用栈累加到 MallocSiteTable
+ */
+
+#ifndef MY_JVM_SERVICES_MALLOCTRACKER_HPP
+#define MY_JVM_SERVICES_MALLOCTRACKER_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/mutex.hpp"
+#include "services/nmtCommon.hpp"
+#include "utilities/nativeCallStack.hpp"
+#include "utilities/stripedCounter.hpp"
+#include <new>
+
+class outputStream;
+
+// ========== MemoryCounter ==========
+// 一组 (次数, 字节数) 计数器，多线程并发更新
+
+class MemoryCounter {
+ private:
+  volatile size_t _count;
+  volatile size_t _size;
+
+ public:
+  constexpr MemoryCounter() : _count(0), _size(0) {}
+
+  // 只是统计数字，不用来同步其他数据，relaxed 即可
+  void allocate(size_t sz) {
+    Atomic::fetch_and_add(&_count, 1, memory_order_relaxed);
+    if (sz > 0) {
+      Atomic::fetch_and_add(&_size, sz, memory_order_relaxed);
+    }
+  }
+
+  void deallocate(size_t sz) {
+    Atomic::fetch_and_add(&_count, -1, memory_order_relaxed);
+    if (sz > 0) {
+      Atomic::fetch_and_add(&_size, 0 - sz, memory_order_relaxed);
+    }
+  }
+
+  void resize(long sz) {
+    if (sz != 0) {
+      Atomic::fetch_and_add(&_size, sz, memory_order_relaxed);
+    }
+  }
+
+  // 一次性累加（count/size 可以是回绕后的“负数”）
+  void add(size_t count, size_t sz) {
+    Atomic::fetch_and_add(&_count, count, memory_order_relaxed);
+    Atomic::fetch_and_add(&_size, sz, memory_order_relaxed);
+  }
+
+  size_t count() const { return Atomic::load(&_count); }
+  size_t size()  const { return Atomic::load(&_size); }
+};
+
+// ========== MallocMemory ==========
+// 单个 MemoryType 的 malloc 和 arena 统计（汇总结果）
+
+class MallocMemory {
+ private:
+  MemoryCounter _malloc;
+  MemoryCounter _arena;
+
+ public:
+  constexpr MallocMemory() {}
+
+  void record_malloc(size_t sz) { _malloc.allocate(sz); }
+  void record_free(size_t sz)   { _malloc.deallocate(sz); }
+
+  void record_new_arena()       { _arena.allocate(0); }
+  void record_arena_free()      { _arena.deallocate(0); }
+  void record_arena_size_change(long sz) { _arena.resize(sz); }
+
+  // 汇总时累加
+  void add(size_t malloc_count, size_t malloc_size, size_t arena_count, size_t arena_size) {
+    _malloc.add(malloc_count, malloc_size);
+    _arena.add(arena_count, arena_size);
+  }
+
+  size_t malloc_size()  const { return _malloc.size(); }
+  size_t malloc_count() const { return _malloc.count(); }
+  size_t arena_size()   const { return _arena.size(); }
+  size_t arena_count()  const { return _arena.count(); }
+};
+
+// ========== ThreadMallocCounters ==========
+// 线程私有的计数块：热路径上只做普通加法，没有原子操作和共享缓存行写。
+// 一个线程 malloc、另一个线程 free 时，两边的计数一正一负，汇总后抵消。
+// 线程退出时计数折叠进全局的 retired 计数。
+
+class ThreadMallocCounters {
+  friend class MallocMemorySummary;
+
+ private:
+  // 同一类型的四个计数放在一起，一次 malloc 或 free 只写一条缓存行
+  struct Counters {
+    volatile size_t malloc_count;
+    volatile size_t malloc_size;
+    volatile size_t arena_count;
+    volatile size_t arena_size;
+  };
+
+  Counters              _types[mt_number_of_types];
+  ThreadMallocCounters* _next;   // 所有活动线程的计数块链表
+
+ public:
+  void record_malloc(size_t sz, int index) {
+    Counters& c = _types[index];
+    c.malloc_count = c.malloc_count + 1;
+    c.malloc_size  = c.malloc_size + sz;
+  }
+  void record_free(size_t sz, int index) {
+    Counters& c = _types[index];
+    c.malloc_count = c.malloc_count - 1;
+    c.malloc_size  = c.malloc_size - sz;
+  }
+  void record_new_arena(int index)  { _types[index].arena_count = _types[index].arena_count + 1; }
+  void record_arena_free(int index) { _types[index].arena_count = _types[index].arena_count - 1; }
+  void record_arena_size_change(long sz, int index) {
+    _types[index].arena_size = _types[index].arena_size + (size_t)sz;
+  }
+};
+
+// ========== MallocMemorySummary ==========
+// 所有 MemoryType 的汇总统计
+
+class MallocMemorySummary : AllStatic {
+ private:
+  // 已退出线程（以及线程退出阶段）的计数，原子更新
+  static MallocMemory           _retired[mt_number_of_types];
+
+  // 活动线程的计数块
+  static ThreadMallocCounters*  _threads;
+  static SpinLock               _threads_lock;
+
+  static thread_local ThreadMallocCounters* _local;
+  static thread_local bool                  _local_retired;
+
+  static void lock_threads();
+  static void unlock_threads();
+
+  // 为当前线程注册计数块；线程已进入退出阶段时返回 nullptr
+  static ThreadMallocCounters* register_thread();
+
+ public:
+  // 线程退出时把本线程的计数折叠到 _retired
+  static void retire_thread();
+
+  static inline ThreadMallocCounters* local() {
+    ThreadMallocCounters* counters = _local;
+    if (MY_JVM_UNLIKELY(counters == nullptr)) {
+      counters = register_thread();
+    }
+    return counters;
+  }
+
+  static void record_malloc(size_t size, MEMFLAGS flag) {
+    ThreadMallocCounters* counters = local();
+    if (MY_JVM_LIKELY(counters != nullptr)) {
+      counters->record_malloc(size, NMTUtil::flag_to_index(flag));
+    } else {
+      _retired[NMTUtil::flag_to_index(flag)].record_malloc(size);
+    }
+  }
+  static void record_free(size_t size, MEMFLAGS flag) {
+    ThreadMallocCounters* counters = local();
+    if (MY_JVM_LIKELY(counters != nullptr)) {
+      counters->record_free(size, NMTUtil::flag_to_index(flag));
+    } else {
+      _retired[NMTUtil::flag_to_index(flag)].record_free(size);
+    }
+  }
+  static void record_new_arena(MEMFLAGS flag) {
+    ThreadMallocCounters* counters = local();
+    if (MY_JVM_LIKELY(counters != nullptr)) {
+      counters->record_new_arena(NMTUtil::flag_to_index(flag));
+    } else {
+      _retired[NMTUtil::flag_to_index(flag)].record_new_arena();
+    }
+  }
+  static void record_arena_free(MEMFLAGS flag) {
+    ThreadMallocCounters* counters = local();
+    if (MY_JVM_LIKELY(counters != nullptr)) {
+      counters->record_arena_free(NMTUtil::flag_to_index(flag));
+    } else {
+      _retired[NMTUtil::flag_to_index(flag)].record_arena_free();
+    }
+  }
+  static void record_arena_size_change(long size, MEMFLAGS flag) {
+    ThreadMallocCounters* counters = local();
+    if (MY_JVM_LIKELY(counters != nullptr)) {
+      counters->record_arena_size_change(size, NMTUtil::flag_to_index(flag));
+    } else {
+      _retired[NMTUtil::flag_to_index(flag)].record_arena_size_change(size);
+    }
+  }
+
+  // 汇总某个类型当前的统计（遍历所有活动线程，结果是近似快照）。
+  // summary 模式下包括不带 header 的 slab 块
+  static MallocMemory snapshot(MEMFLAGS flag);
+
+  // 只汇总带 MallocHeader 的块
+  static MallocMemory header_snapshot(MEMFLAGS flag);
+
+  static size_t total_malloc();
+  static size_t total_arena();
+  static size_t total_count();
+
+  // MallocHeader 本身的开销
+  static size_t tracking_overhead();
+};
+
+// ========== MallocSite / MallocSiteTable ==========
+// detail 模式：按 (调用栈, MemoryType) 统计
+
+// 热点调用点会被所有线程同时更新，计数用 StripedCounter：
+// 没有竞争时和普通原子计数一样，出现竞争后才分配 cell
+
+class MallocSite {
+ private:
+  NativeCallStack _call_stack;
+  StripedCounter  _count;
+  StripedCounter  _size;
+  MEMFLAGS        _flags;
+
+ public:
+  MallocSite(const NativeCallStack& stack, MEMFLAGS flags)
+    : _call_stack(stack), _flags(flags) {}
+
+  const NativeCallStack* call_stack() const { return &_call_stack; }
+  MEMFLAGS flags() const { return _flags; }
+  size_t size()  const { return (size_t)_size.sum(); }
+  size_t count() const { return (size_t)_count.sum(); }
+
+  void allocate(size_t size) {
+    _count.inc();
+    _size.add((jlong)size);
+  }
+  void deallocate(size_t size) {
+    _count.dec();
+    _size.add(-(jlong)size);
+  }
+};
+
+class MallocSiteHashtableEntry {
+ private:
+  MallocSite                         _malloc_site;
+  MallocSiteHashtableEntry* volatile _next;
+
+ public:
+  MallocSiteHashtableEntry(const NativeCallStack& stack, MEMFLAGS flags)
+    : _malloc_site(stack, flags), _next(nullptr) {}
+
+  MallocSite* data() { return &_malloc_site; }
+  MallocSiteHashtableEntry* next() const {
+    return (MallocSiteHashtableEntry*)atomic_load((void* const*)&_next);
+  }
+
+  // 无锁追加到链表尾：成功返回 true
+  bool atomic_set_next(MallocSiteHashtableEntry* entry) {
+    return atomic_cas((void**)&_next, (void*)entry, (void*)nullptr) == nullptr;
+  }
+};
+
+class MallocSiteTable : AllStatic {
+ public:
+  enum {
+    table_base_size = 128,
+    table_size      = table_base_size * NativeCallStack::NMT_TrackingStackDepth - 1,
+    // 每个桶链表的最大长度（pos_idx 用 u2 保存）
+    MAX_BUCKET_LENGTH = 0xFFFF
+  };
+
+ private:
+  static MallocSiteHashtableEntry* volatile _table[table_size];
+
+  static unsigned int hash_to_index(unsigned int hash) { return hash % table_size; }
+
+  // 查找或插入 (stack, flags) 对应的 MallocSite，返回桶下标和链表位置
+  static MallocSite* lookup_or_add(const NativeCallStack& stack, size_t* bucket_idx,
+                                   size_t* pos_idx, MEMFLAGS flags);
+  static MallocSite* malloc_site(size_t bucket_idx, size_t pos_idx);
+
+ public:
+  // 记录一次分配，失败（表满或内存不足）返回 false
+  static bool allocation_at(const NativeCallStack& stack, size_t size,
+                            size_t* bucket_idx, size_t* pos_idx, MEMFLAGS flags);
+  // 记录一次释放
+  static bool deallocation_at(size_t size, size_t bucket_idx, size_t pos_idx);
+
+  // 遍历所有调用点
+  template <typename F>
+  static void iterate(F f) {
+    for (int i = 0; i < table_size; i++) {
+      MallocSiteHashtableEntry* head =
+        (MallocSiteHashtableEntry*)atomic_load((void* const*)&_table[i]);
+      for (MallocSiteHashtableEntry* e = head; e != nullptr; e = e->next()) {
+        f(e->data());
+      }
+    }
+  }
+};
+
+// ========== MallocHeader ==========
+// summary 模式的记录和撤销内联在 AllocateHeap / FreeHeap 里：只写 header 和本线程的计数块。
+// 调用栈只在 detail 模式下登记，不在内联路径上
+
+class MallocHeader {
+ private:
+  size_t _size;         // 用户请求的字节数
+  u4     _bucket_idx;   // detail 模式：MallocSiteTable 桶下标
+  u2     _pos_idx;      // detail 模式：桶内链表位置
+  u1     _flags;        // MemoryType
+
+  void release_site() const;
+
+ public:
+  enum { no_site = 0xFFFFFFFF };
+
+  MallocHeader(size_t size, MEMFLAGS flags)
+    : _size(size), _bucket_idx(no_site), _pos_idx(0), _flags((u1)flags) {
+    MallocMemorySummary::record_malloc(size, flags);
+  }
+
+  size_t   size()  const { return _size; }
+  MEMFLAGS flags() const { return (MEMFLAGS)_flags; }
+
+  // detail 模式：按调用栈登记到 MallocSiteTable
+  void record_site(const NativeCallStack& stack);
+
+  // 释放时撤销统计
+  void release() const {
+    MallocMemorySummary::record_free(size(), flags());
+    if (MY_JVM_UNLIKELY(_bucket_idx != (u4)no_site)) {
+      release_site();
+    }
+  }
+};
+
+// ========== MallocTracker ==========
+
+class MallocTracker : AllStatic {
+ private:
+  static void record_malloc_site(MallocHeader* header, address caller_pc);
+
+ public:
+  static size_t malloc_header_size(NMT_TrackingLevel level) {
+    return (level == NMT_off) ? 0 : sizeof(MallocHeader);
+  }
+
+  // slab 块只在 detail 模式下带 header
+  static size_t slab_header_size(NMT_TrackingLevel level) {
+    return (level == NMT_detail) ? sizeof(MallocHeader) : 0;
+  }
+
+  // 在 malloc 返回的 base 上放置 header，返回用户内存地址
+  static void* record_malloc(void* malloc_base, size_t size, MEMFLAGS flags,
+                             address caller_pc, NMT_TrackingLevel level) {
+    assert(level != NMT_off, "precondition");
+    if (malloc_base == nullptr) {
+      return nullptr;
+    }
+    MallocHeader* header = ::new (malloc_base) MallocHeader(size, flags);
+    if (level == NMT_detail) {
+      record_malloc_site(header, caller_pc);
+    }
+    return (void*)((char*)header + sizeof(MallocHeader));
+  }
+
+  // 撤销统计，返回真正的 malloc base
+  static void* record_free(void* memblock) {
+    MallocHeader* header = malloc_header(memblock);
+    header->release();
+    return (void*)header;
+  }
+
+  static MallocHeader* malloc_header(void* memblock) {
+    return (MallocHeader*)((char*)memblock - sizeof(MallocHeader));
+  }
+};
+
+#endif // MY_JVM_SERVICES_MALLOCTRACKER_HPP
@@ -0,0 +1,105 @@
+/*
+ * my_jvm - Native Memory Tracking reporters implementation
+ */
+
+#include "services/memReporter.hpp"
+#include "services/memTracker.hpp"
+#include "utilities/ostream.hpp"
+#include <algorithm>
+#include <vector>
+
+// ========== MemReporterBase ==========
+
+void MemReporterBase::print_malloc(size_t amount, size_t count, MEMFLAGS flag) const {
+  outputStream* out = output();
+  out->print("(malloc=" SIZE_FORMAT "%s", amount_in_current_scale(amount), current_scale());
+  if (flag != mtNone) {
+    out->print(" type=%s", NMTUtil::flag_to_name(flag));
+  }
+  if (count > 0) {
+    out->print(" #" SIZE_FORMAT, count);
+  }
+  out->print(")");
+}
+
+void MemReporterBase::print_arena(size_t amount, size_t count) const {
+  output()->print("(arena=" SIZE_FORMAT "%s #" SIZE_FORMAT ")",
+                  amount_in_current_scale(amount), current_scale(), count);
+}
+
+// ========== MemSummaryReporter ==========
+
+void MemSummaryReporter::report() {
+  outputStream* out = output();
+  size_t total_malloc = MallocMemorySummary::total_malloc();
+  size_t total_arena  = MallocMemorySummary::total_arena();
+  size_t overhead     = MallocMemorySummary::tracking_overhead();
+
+  out->print_cr("\nNative Memory Tracking:\n");
+  out->print_cr("Total: malloc=" SIZE_FORMAT "%s, arena=" SIZE_FORMAT "%s",
+                amount_in_current_scale(total_malloc), current_scale(),
+                amount_in_current_scale(total_arena), current_scale());
+  out->cr();
+
+  for (int index = 0; index < mt_number_of_types; index++) {
+    MEMFLAGS flag = NMTUtil::index_to_flag(index);
+    // NMT 自身的开销单独报告
+    if (flag == mtNMT) continue;
+    MallocMemory malloc_memory = MallocMemorySummary::snapshot(flag);
+    report_summary_of_type(flag, &malloc_memory);
+  }
+
+  out->print_cr("%27s (tracking overhead=" SIZE_FORMAT "%s)", "",
+                amount_in_current_scale(overhead), current_scale());
+  out->cr();
+}
+
+void MemSummaryReporter::report_summary_of_type(MEMFLAGS flag, const MallocMemory* malloc_memory) {
+  // 没有任何分配的类型不打印
+  if (malloc_memory->malloc_count() == 0 && malloc_memory->arena_count() == 0 &&
+      malloc_memory->malloc_size() == 0 && malloc_memory->arena_size() == 0) {
+    return;
+  }
+  outputStream* out = output();
+  size_t total = malloc_memory->malloc_size() + malloc_memory->arena_size();
+  out->print_cr("-%26s (total=" SIZE_FORMAT "%s)", NMTUtil::flag_to_name(flag),
+                amount_in_current_scale(total), current_scale());
+
+  out->print("%28s", " ");
+  print_malloc(malloc_memory->malloc_size(), malloc_memory->malloc_count());
+  out->cr();
+
+  if (malloc_memory->arena_count() > 0 || malloc_memory->arena_size() > 0) {
+    out->print("%28s", " ");
+    print_arena(malloc_memory->arena_size(), malloc_memory->arena_count());
+    out->cr();
+  }
+  out->cr();
+}
+
+// ========== MemDetailReporter ==========
+
+void MemDetailReporter::report() {
+  outputStream* out = output();
+
+  // 快照后按大小降序排列（std::vector 在 ::malloc 上分配，不影响统计）
+  std::vector<const MallocSite*> sites;
+  MallocSiteTable::iterate([&](const MallocSite* site) {
+    if (site->size() > 0) {
+      sites.push_back(site);
+    }
+  });
+  std::sort(sites.begin(), sites.end(), [](const MallocSite* a, const MallocSite* b) {
+    return a->size() > b->size();
+  });
+
+  out->print_cr("Details:\n");
+  for (const MallocSite* site : sites) {
+    // 小于一个 scale 单位的调用点不打印
+    if (amount_in_current_scale(site->size()) == 0) continue;
+    site->call_stack()->print_on(out);
+    out->print("%29s", " ");
+    print_malloc(site->size(), site->count(), site->flags());
+    out->print_cr("\n");
+  }
+}
@@ -0,0 +1,57 @@
+/*
+ * my_jvm - Native Memory Tracking reporters
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/services/memReporter.hpp
+ */
+
+#ifndef MY_JVM_SERVICES_MEMREPORTER_HPP
+#define MY_JVM_SERVICES_MEMREPORTER_HPP
+
+#include "services/mallocTracker.hpp"
+
+class outputStream;
+
+// ========== MemReporterBase ==========
+
+class MemReporterBase : public StackObj {
+ private:
+  outputStream* _output;
+  size_t        _scale;
+
+ protected:
+  outputStream* output() const { return _output; }
+  size_t scale() const { return _scale; }
+  const char* current_scale() const { return NMTUtil::scale_name(_scale); }
+  size_t amount_in_current_scale(size_t amount) const {
+    return NMTUtil::amount_in_scale(amount, _scale);
+  }
+
+  void print_malloc(size_t amount, size_t count, MEMFLAGS flag = mtNone) const;
+  void print_arena(size_t amount, size_t count) const;
+
+ public:
+  MemReporterBase(outputStream* out, size_t scale) : _output(out), _scale(scale) {}
+};
+
+// ========== MemSummaryReporter ==========
+// 按 MemoryType 汇总
+
+class MemSummaryReporter : public MemReporterBase {
+ public:
+  MemSummaryReporter(outputStream* out, size_t scale) : MemReporterBase(out, scale) {}
+  void report();
+
+ private:
+  void report_summary_of_type(MEMFLAGS flag, const MallocMemory* malloc_memory);
+};
+
+// ========== MemDetailReporter ==========
+// 按调用点明细（按字节数降序）
+
+class MemDetailReporter : public MemReporterBase {
+ public:
+  MemDetailReporter(outputStream* out, size_t scale) : MemReporterBase(out, scale) {}
+  void report();
+};
+
+#endif // MY_JVM_SERVICES_MEMREPORTER_HPP
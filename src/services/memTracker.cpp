@@ -0,0 +1,35 @@
+/*
+ * my_jvm - Native Memory Tracking implementation
+ */
+
+#include "services/memTracker.hpp"
+#include "services/memReporter.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/ostream.hpp"
+
+volatile NMT_TrackingLevel MemTracker::_tracking_level = NMT_unknown;
+
+NMT_TrackingLevel MemTracker::init_tracking_level() {
+  NMT_TrackingLevel level = NMTUtil::parse_tracking_level(NativeMemoryTracking);
+  if (level == NMT_unknown) {
+    warning("Invalid NMT option: %s, tracking is off", NativeMemoryTracking);
+    level = NMT_off;
+  }
+  // 多个线程同时初始化时得到的结果相同，无需加锁
+  _tracking_level = level;
+  return level;
+}
+
+void MemTracker::report(bool summary_only, outputStream* output, size_t scale) {
+  NMT_TrackingLevel level = tracking_level();
+  if (level == NMT_off) {
+    output->print_cr("Native memory tracking is not enabled");
+    return;
+  }
+  MemSummaryReporter summary(output, scale);
+  summary.report();
+  if (!summary_only && level == NMT_detail) {
+    MemDetailReporter detail(output, scale);
+    detail.report();
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * my_jvm - Native Memory Tracking entry points
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/services/memTracker.hpp
+ *
+ * 用法：启动前设置 -XX:NativeMemoryTracking=summary|detail，
+ * 运行中调用 MemTracker::report() 打印报告。
+ * 追踪级别在第一次 AllocateHeap 时确定，之后不可更改
+ * （已分配内存块的 MallocHeader 依赖于级别）。
+ *
+ * 开销（Release，microbench nmt_malloc / nmt_workload）：
+ *  - summary：slab 块（<= 1K）不写 header、不更新计数，用量在报告时由 SlabAllocator 算出，
+ *    和 off 的差别在测量噪声以内；大块和 slab 用完后的 malloc 块仍写 header、更新本线程计数
+ *  - detail：每次分配都要抓调用栈，约慢两个数量级，只用于排查
+ * 所以默认 summary。
+ */
+
+#ifndef MY_JVM_SERVICES_MEMTRACKER_HPP
+#define MY_JVM_SERVICES_MEMTRACKER_HPP
+
+#include "services/mallocTracker.hpp"
+#include "services/nmtCommon.hpp"
+
+class outputStream;
+
+// ========== MemTracker ==========
+
+class MemTracker : AllStatic {
+ private:
+  static volatile NMT_TrackingLevel _tracking_level;
+
+  static NMT_TrackingLevel init_tracking_level();
+
+ public:
+  static inline NMT_TrackingLevel tracking_level() {
+    NMT_TrackingLevel level = _tracking_level;
+    if (MY_JVM_UNLIKELY(level == NMT_unknown)) {
+      level = init_tracking_level();
+    }
+    return level;
+  }
+
+  static bool enabled() { return tracking_level() != NMT_off; }
+
+  // ---------- malloc ----------
+
+  static inline size_t malloc_header_size(NMT_TrackingLevel level) {
+    return MallocTracker::malloc_header_size(level);
+  }
+
+  static inline void* record_malloc(void* mem_base, size_t size, MEMFLAGS flag,
+                                    address caller_pc, NMT_TrackingLevel level) {
+    if (level != NMT_off) {
+      return MallocTracker::record_malloc(mem_base, size, flag, caller_pc, level);
+    }
+    return mem_base;
+  }
+
+  // 返回真正需要 free 的地址
+  static inline void* record_free(void* memblock, NMT_TrackingLevel level) {
+    if (level != NMT_off) {
+      return MallocTracker::record_free(memblock);
+    }
+    return memblock;
+  }
+
+  // ---------- slab ----------
+  // summary 模式下 slab 块不带 header，这两个函数什么都不做
+
+  static inline size_t slab_header_size(NMT_TrackingLevel level) {
+    return MallocTracker::slab_header_size(level);
+  }
+
+  static inline void* record_slab_malloc(void* mem_base, size_t size, MEMFLAGS flag,
+                                         address caller_pc, NMT_TrackingLevel level) {
+    if (level == NMT_detail) {
+      return MallocTracker::record_malloc(mem_base, size, flag, caller_pc, level);
+    }
+    return mem_base;
+  }
+
+  static inline void* record_slab_free(void* memblock, NMT_TrackingLevel level) {
+    if (level == NMT_detail) {
+      return MallocTracker::record_free(memblock);
+    }
+    return memblock;
+  }
+
+  // ---------- arena ----------
+
+  static inline void record_new_arena(MEMFLAGS flag) {
+    if (tracking_level() != NMT_off) {
+      MallocMemorySummary::record_new_arena(flag);
+    }
+  }
+
+  static inline void record_arena_free(MEMFLAGS flag) {
+    if (tracking_level() != NMT_off) {
+      MallocMemorySummary::record_arena_free(flag);
+    }
+  }
+
+  static inline void record_arena_size_change(long diff, MEMFLAGS flag) {
+    if (diff != 0 && tracking_level() != NMT_off) {
+      MallocMemorySummary::record_arena_size_change(diff, flag);
+    }
+  }
+
+  // ---------- 报告 ----------
+
+  // summary_only=false 且处于 detail 模式时额外输出调用点
+  static void report(bool summary_only, outputStream* output, size_t scale = 1024);
+};
+
+#endif // MY_JVM_SERVICES_MEMTRACKER_HPP
@@ -0,0 +1,65 @@
+/*
+ * my_jvm - Native Memory Tracking common implementation
+ */
+
+#include "services/nmtCommon.hpp"
+#include <cstring>
+
+// 顺序必须与 allocation.hpp 中的 MemoryType 一致
+static const char* _memory_type_names[] = {
+  "Java Heap",
+  "Class",
+  "Thread",
+  "Thread Stack",
+  "Code",
+  "GC",
+  "Compiler",
+  "Internal",
+  "Other",
+  "Symbol",
+  "Native Memory Tracking",
+  "Shared class space",
+  "Arena Chunk",
+  "Test",
+  "Tracing",
+  "Logging",
+  "Arguments",
+  "Module",
+  "Synchronizer",
+  "Safepoint",
+  "Unknown"
+};
+
+static_assert(sizeof(_memory_type_names) / sizeof(_memory_type_names[0]) == mt_number_of_types,
+              "memory type names out of sync with MemoryType");
+
+const char* NMTUtil::flag_to_name(MEMFLAGS flag) {
+  return _memory_type_names[flag_to_index(flag)];
+}
+
+const char* NMTUtil::tracking_level_to_string(NMT_TrackingLevel level) {
+  switch (level) {
+    case NMT_off:     return "off";
+    case NMT_summary: return "summary";
+    case NMT_detail:  return "detail";
+    default:          return "unknown";
+  }
+}
+
+NMT_TrackingLevel NMTUtil::parse_tracking_level(const char* s) {
+  if (s == nullptr) return NMT_unknown;
+  if (strcmp(s, "off") == 0)     return NMT_off;
+  if (strcmp(s, "summary") == 0) return NMT_summary;
+  if (strcmp(s, "detail") == 0)  return NMT_detail;
+  return NMT_unknown;
+}
+
+const char* NMTUtil::scale_name(size_t scale) {
+  switch (scale) {
+    case 1:                  return "";
+    case 1024:               return "KB";
+    case 1024 * 1024:        return "MB";
+    case 1024 * 1024 * 1024: return "GB";
+    default:                 return "?";
+  }
+}
@@ -0,0 +1,47 @@
+/*
+ * my_jvm - Native Memory Tracking common definitions
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/services/nmtCommon.hpp
+ */
+
+#ifndef MY_JVM_SERVICES_NMTCOMMON_HPP
+#define MY_JVM_SERVICES_NMTCOMMON_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+// ========== 追踪级别 ==========
+
+enum NMT_TrackingLevel {
+  NMT_unknown = 0xFF,   // 尚未初始化
+  NMT_off     = 0x00,   // 关闭
+  NMT_summary = 0x40,   // 按 MemoryType 汇总
+  NMT_detail  = 0x80    // 汇总 + 调用点
+};
+
+// ========== NMTUtil ==========
+
+class NMTUtil : AllStatic {
+ public:
+  // MemoryType 与数组下标互转
+  static inline int flag_to_index(MEMFLAGS flag) {
+    return (int)flag;
+  }
+  static inline MEMFLAGS index_to_flag(int index) {
+    return (MEMFLAGS)index;
+  }
+
+  static const char* flag_to_name(MEMFLAGS flag);
+  static const char* tracking_level_to_string(NMT_TrackingLevel level);
+
+  // 解析 -XX:NativeMemoryTracking 的取值，无法识别时返回 NMT_unknown
+  static NMT_TrackingLevel parse_tracking_level(const char* s);
+
+  // 按比例（K/M/G）换算
+  static const char* scale_name(size_t scale);
+  static size_t amount_in_scale(size_t amount, size_t scale) {
+    return (amount + scale / 2) / scale;
+  }
+};
+
+#endif // MY_JVM_SERVICES_NMTCOMMON_HPP
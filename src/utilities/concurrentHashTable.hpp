@@ -0,0 +1,558 @@
+/*
+ * my_jvm - Concurrent hash table
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/concurrentHashTable.hpp
+ *                                        concurrentHashTable.inline.hpp
+ * SymbolTable、StringTable、SystemDictionary 的基础。
+ *
+ *  - 查找无锁且 wait-free：在 GlobalCounter 读端临界区里沿桶的链表走，只读不写
+ *  - 插入 CAS 桶头，不加锁；失败（桶头变了或桶被锁）就退出临界区重试
+ *  - 删除先锁桶（桶头指针的最低位），摘下节点，解锁后 write_synchronize，
+ *    等所有可能还在看这个节点的读者离开再释放
+ *  - 扩容/缩容在线进行，读写都不停：
+ *      grow  ：表大小翻倍，旧桶 i 的链表拆成新桶 i 和 i + 旧大小（unzip）
+ *      shrink：表大小减半，新桶 i 由旧桶 i 和 i + 新大小的链表首尾相接而成
+ *    处理过的旧桶打上 redirect 标记，读写者看到后改去 _new_table
+ *
+ * 桶头指针的低两位是状态：LOCK 表示有写者独占（删除或扩容中），REDIRECT 表示
+ * 内容已经搬到 _new_table。被 redirect 的桶一直保持 LOCK，插入的 CAS 会失败。
+ *
+ * CONFIG 需要提供：
+ *   static uintx get_hash(const VALUE& value);
+ *   static void* allocate_node(size_t size, const VALUE& value);
+ *   static void  free_node(void* memory, const VALUE& value);
+ * LOOKUP_FUNC 需要提供：
+ *   uintx get_hash() const;
+ *   bool  equals(const VALUE* value);
+ *
+ * VALUE 要能按位复制（通常是指针或句柄），节点释放时不调用析构函数。
+ * 同一个线程不能在查找的回调里再做删除或扩容（临界区里不能 write_synchronize）。
+ */
+
+#ifndef MY_JVM_UTILITIES_CONCURRENTHASHTABLE_HPP
+#define MY_JVM_UTILITIES_CONCURRENTHASHTABLE_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/mutex.hpp"
+#include "runtime/orderAccess.hpp"
+#include "runtime/os.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/debug.hpp"
+#include "utilities/globalCounter.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+template <typename VALUE, typename CONFIG, MEMFLAGS F>
+class ConcurrentHashTable : public CHeapObj<F> {
+  static_assert(std::is_trivially_copyable<VALUE>::value,
+                "ConcurrentHashTable values are copied bitwise and never destructed");
+
+ public:
+  enum {
+    DEFAULT_START_SIZE_LOG2 = 5,
+    DEFAULT_MAX_SIZE_LOG2   = 21,
+    DEFAULT_GROW_HINT       = 4,     // 查找走过的链长超过它时提示调用方扩容
+    SPINPAUSES_PER_YIELD    = 8192
+  };
+
+ private:
+  // ========== Node ==========
+
+  class Node {
+   private:
+    Node* volatile _next;
+    VALUE          _value;
+
+   public:
+    Node(const VALUE& value, Node* next) : _next(next), _value(value) {}
+
+    Node* next() const                 { return OrderAccess::load_acquire(&_next); }
+    Node* const volatile* next_ptr()   { return &_next; }
+    void set_next(Node* node)          { _next = node; }
+    VALUE* value()                     { return &_value; }
+
+    static Node* create_node(const VALUE& value, Node* next = nullptr) {
+      return ::new (CONFIG::allocate_node(sizeof(Node), value)) Node(value, next);
+    }
+    static void destroy_node(Node* node) {
+      CONFIG::free_node((void*)node, node->_value);
+    }
+  };
+
+  // ========== Bucket ==========
+  // 桶头指针的低两位是状态位，节点至少按指针大小对齐，低两位总是 0
+
+  class Bucket {
+   private:
+    Node* volatile _first;
+
+    static const uintptr_t STATE_LOCK_BIT     = 0x1;
+    static const uintptr_t STATE_REDIRECT_BIT = 0x2;
+    static const uintptr_t STATE_MASK         = 0x3;
+
+    static Node* set_state(Node* n, uintptr_t bits) {
+      return (Node*)((uintptr_t)n | bits);
+    }
+    static uintptr_t get_state(Node* n) {
+      return (uintptr_t)n & STATE_MASK;
+    }
+    static bool is_state(Node* n, uintptr_t bits) {
+      return (get_state(n) & bits) != 0;
+    }
+
+   public:
+    static Node* clear_state(Node* n) {
+      return (Node*)((uintptr_t)n & ~STATE_MASK);
+    }
+
+    Node* first_raw() const { return OrderAccess::load_acquire(&_first); }
+    Node* first() const     { return clear_state(first_raw()); }
+
+    // 写者遍历链表、摘节点时用的指针位置
+    Node* const volatile* first_ptr() { return &_first; }
+
+    bool have_redirect() const { return is_state(first_raw(), STATE_REDIRECT_BIT); }
+    bool is_locked() const     { return is_state(first_raw(), STATE_LOCK_BIT); }
+
+    // 桶头还是 expect 且没有状态位时换成 node
+    bool cas_first(Node* node, Node* expect) {
+      if (is_locked()) {
+        return false;
+      }
+      return Atomic::cmpxchg(&_first, clear_state(expect), node) == clear_state(expect);
+    }
+
+    bool trylock() {
+      if (is_locked()) {
+        return false;
+      }
+      Node* tmp = first();
+      return Atomic::cmpxchg(&_first, tmp, set_state(tmp, STATE_LOCK_BIT)) == tmp;
+    }
+
+    void lock() {
+      int i = 0;
+      while (!trylock()) {
+        if (++i == SPINPAUSES_PER_YIELD) {
+          os::naked_yield();
+          i = 0;
+        } else {
+          os::spin_pause();
+        }
+      }
+    }
+
+    void unlock() {
+      assert(is_locked(), "bucket must be locked");
+      assert(!have_redirect(), "unlocking a redirected bucket");
+      OrderAccess::release_store(&_first, first());
+    }
+
+    // 只在持锁时调用，之后桶一直保持加锁状态
+    void redirect() {
+      assert(is_locked(), "bucket must be locked");
+      OrderAccess::release_store(&_first, set_state(_first, STATE_REDIRECT_BIT));
+    }
+
+    // 持锁时改写链表中的一个指针（桶头或某个节点的 _next），保留原有的状态位
+    void release_assign_node_ptr(Node* const volatile* dst, Node* node) const {
+      assert(is_locked(), "bucket must be locked");
+      Node* volatile* tmp = (Node* volatile*)dst;
+      OrderAccess::release_store(tmp, set_state(node, get_state(*dst)));
+    }
+
+    // 缩容时把 node 接到链表末尾
+    void release_assign_last_node_next(Node* node) {
+      assert(is_locked(), "bucket must be locked");
+      Node* const volatile* ret = first_ptr();
+      while (clear_state(*ret) != nullptr) {
+        ret = clear_state(*ret)->next_ptr();
+      }
+      release_assign_node_ptr(ret, node);
+    }
+
+    // 扩容/缩容时把旧桶原样复制到新表（包括 LOCK 位），发布之前调用
+    void copy_from(const Bucket& other) {
+      OrderAccess::release_store(&_first, Atomic::load(&other._first));
+    }
+  };
+
+  // ========== InternalTable ==========
+
+  class InternalTable : public CHeapObj<F> {
+   public:
+    const size_t _log2_size;
+    const size_t _size;
+    const size_t _hash_mask;
+    Bucket*      _buckets;
+
+    explicit InternalTable(size_t log2_size)
+      : _log2_size(log2_size), _size((size_t)1 << log2_size), _hash_mask(_size - 1) {
+      _buckets = NEW_C_HEAP_ARRAY(Bucket, _size, F);
+      memset((void*)_buckets, 0, _size * sizeof(Bucket));
+    }
+
+    ~InternalTable() {
+      FREE_C_HEAP_ARRAY(Bucket, _buckets);
+    }
+
+    Bucket* get_bucket(size_t idx) { return &_buckets[idx]; }
+    size_t  bucket_idx(uintx hash) const { return hash & _hash_mask; }
+  };
+
+  // ========== 成员 ==========
+
+  InternalTable* volatile _table;       // 当前表
+  InternalTable* volatile _new_table;   // 扩容/缩容过程中的目标表，其余时间为 nullptr
+  const size_t            _log2_size_limit;
+  const size_t            _log2_start_size;
+  const size_t            _grow_hint;
+  // 扩容、缩容、do_scan 互斥。rank 为 nonleaf：持有时会 write_synchronize（拿 Threads_lock）
+  Mutex                   _resize_lock;
+
+  InternalTable* get_table() const     { return OrderAccess::load_acquire(&_table); }
+  InternalTable* get_new_table() const { return OrderAccess::load_acquire(&_new_table); }
+
+  // 必须在临界区里调用：碰到 redirect 就去新表
+  Bucket* get_bucket(uintx hash) const {
+    InternalTable* table = get_table();
+    Bucket* bucket = table->get_bucket(table->bucket_idx(hash));
+    if (bucket->have_redirect()) {
+      table = get_new_table();
+      bucket = table->get_bucket(table->bucket_idx(hash));
+    }
+    return bucket;
+  }
+
+  // 返回时桶已加锁；桶在解锁之前不会被 redirect，所以可以在临界区外使用
+  Bucket* get_bucket_locked(Thread* thread, uintx hash) {
+    int i = 0;
+    for (;;) {
+      {
+        GlobalCounter::CriticalSection cs(thread);
+        Bucket* bucket = get_bucket(hash);
+        if (bucket->trylock()) {
+          return bucket;
+        }
+      }
+      if (++i == SPINPAUSES_PER_YIELD) {
+        os::naked_yield();
+        i = 0;
+      } else {
+        os::spin_pause();
+      }
+    }
+  }
+
+  template <typename LOOKUP_FUNC>
+  static Node* get_node(const Bucket* bucket, LOOKUP_FUNC& lookup_f, size_t* loop_count) {
+    size_t loops = 0;
+    Node* node = bucket->first();
+    while (node != nullptr) {
+      loops++;
+      if (lookup_f.equals(node->value())) {
+        break;
+      }
+      node = node->next();
+    }
+    *loop_count = loops;
+    return node;
+  }
+
+  // ---------- 扩容 ----------
+
+  // 把旧桶的链表拆到新表的 even_index 和 odd_index 两个桶（此时两个新桶都指向整条链）。
+  // 每次只改一个指针，改完等读者离开：否则在 even 链上找东西的读者可能被带到 odd 链上
+  void unzip_bucket(InternalTable* old_table, InternalTable* new_table,
+                    size_t even_index, size_t odd_index) {
+    Bucket* even_bucket = new_table->get_bucket(even_index);
+    Bucket* odd_bucket  = new_table->get_bucket(odd_index);
+    Node* const volatile* even = even_bucket->first_ptr();
+    Node* const volatile* odd  = odd_bucket->first_ptr();
+    Node* aux = old_table->get_bucket(even_index)->first();
+    while (aux != nullptr) {
+      Node* aux_next = aux->next();
+      size_t aux_index = new_table->bucket_idx(CONFIG::get_hash(*aux->value()));
+      bool moved;
+      if (aux_index == even_index) {
+        // aux 留在 even 链，odd 链跳过它
+        moved = Bucket::clear_state(*odd) != aux_next;
+        if (moved) {
+          odd_bucket->release_assign_node_ptr(odd, aux_next);
+        }
+        even = aux->next_ptr();
+      } else {
+        assert(aux_index == odd_index, "node in wrong bucket");
+        moved = Bucket::clear_state(*even) != aux_next;
+        if (moved) {
+          even_bucket->release_assign_node_ptr(even, aux_next);
+        }
+        odd = aux->next_ptr();
+      }
+      aux = aux_next;
+      if (moved) {
+        GlobalCounter::write_synchronize();
+      }
+    }
+  }
+
+  void grow_range(size_t start, size_t stop) {
+    InternalTable* old_table = get_table();
+    InternalTable* new_table = get_new_table();
+    for (size_t even_index = start; even_index < stop; even_index++) {
+      Bucket* bucket = old_table->get_bucket(even_index);
+      bucket->lock();
+      size_t odd_index = even_index + old_table->_size;
+      // 两个新桶都先指向整条链（带 LOCK 位），写者跟着 redirect 过去后会等 unzip 结束
+      new_table->get_bucket(even_index)->copy_from(*bucket);
+      new_table->get_bucket(odd_index)->copy_from(*bucket);
+      bucket->redirect();
+      if (bucket->first() != nullptr) {
+        // 等从旧桶进来的读者离开，之后改节点的 _next 不会影响他们
+        GlobalCounter::write_synchronize();
+        unzip_bucket(old_table, new_table, even_index, odd_index);
+      }
+      new_table->get_bucket(even_index)->unlock();
+      new_table->get_bucket(odd_index)->unlock();
+    }
+  }
+
+  // ---------- 缩容 ----------
+
+  void shrink_range(size_t start, size_t stop) {
+    InternalTable* old_table = get_table();
+    InternalTable* new_table = get_new_table();
+    for (size_t bucket_it = start; bucket_it < stop; bucket_it++) {
+      Bucket* b_old_even = old_table->get_bucket(bucket_it);
+      Bucket* b_old_odd  = old_table->get_bucket(bucket_it + new_table->_size);
+      b_old_even->lock();
+      b_old_odd->lock();
+      Bucket* b_new = new_table->get_bucket(bucket_it);
+      b_new->copy_from(*b_old_even);
+      // 在 even 链上找东西的读者多走几步 odd 链上的节点，不影响结果
+      b_new->release_assign_last_node_next(b_old_odd->first());
+      b_old_even->redirect();
+      b_old_odd->redirect();
+      GlobalCounter::write_synchronize();
+      b_new->unlock();
+    }
+  }
+
+  // ---------- 扩容/缩容的公共部分（持有 _resize_lock） ----------
+
+  void resize_epilog() {
+    InternalTable* old_table = get_table();
+    OrderAccess::release_store(&_table, get_new_table());
+    // 之后进入临界区的线程只会看到新表
+    GlobalCounter::write_synchronize();
+    OrderAccess::release_store(&_new_table, (InternalTable*)nullptr);
+    delete old_table;
+  }
+
+  template <typename SCAN_FUNC>
+  void do_scan_locked(SCAN_FUNC& scan_f) {
+    InternalTable* table = get_table();
+    for (size_t i = 0; i < table->_size; i++) {
+      Bucket* bucket = table->get_bucket(i);
+      assert(!bucket->have_redirect(), "no resize while holding the resize lock");
+      for (Node* node = bucket->first(); node != nullptr; node = node->next()) {
+        if (!scan_f(node->value())) {
+          return;
+        }
+      }
+    }
+  }
+
+ public:
+  ConcurrentHashTable(size_t log2size = DEFAULT_START_SIZE_LOG2,
+                      size_t log2size_limit = DEFAULT_MAX_SIZE_LOG2,
+                      size_t grow_hint = DEFAULT_GROW_HINT)
+    : _new_table(nullptr), _log2_size_limit(log2size_limit), _log2_start_size(log2size),
+      _grow_hint(grow_hint), _resize_lock(Mutex::nonleaf, "ConcurrentHashTable_resize_lock") {
+    assert(log2size <= log2size_limit, "start size above limit");
+    _table = new InternalTable(log2size);
+  }
+
+  ~ConcurrentHashTable() {
+    InternalTable* table = get_table();
+    for (size_t i = 0; i < table->_size; i++) {
+      Node* node = table->get_bucket(i)->first();
+      while (node != nullptr) {
+        Node* next = node->next();
+        Node::destroy_node(node);
+        node = next;
+      }
+    }
+    delete table;
+  }
+
+  size_t get_size_log2(Thread* thread) {
+    GlobalCounter::CriticalSection cs(thread);
+    return get_table()->_log2_size;
+  }
+
+  bool is_max_size_reached() {
+    return get_table()->_log2_size >= _log2_size_limit;
+  }
+
+  // ========== 查找 ==========
+
+  // 找到时在临界区内调用 found_f(VALUE*)，返回是否找到。
+  // 走过的链长超过 grow hint 时把 *grow_hint 置为 true
+  template <typename LOOKUP_FUNC, typename FOUND_FUNC>
+  bool get(Thread* thread, LOOKUP_FUNC lookup_f, FOUND_FUNC found_f, bool* grow_hint = nullptr) {
+    GlobalCounter::CriticalSection cs(thread);
+    size_t loops;
+    Node* node = get_node(get_bucket(lookup_f.get_hash()), lookup_f, &loops);
+    if (grow_hint != nullptr) {
+      *grow_hint = loops > _grow_hint;
+    }
+    if (node == nullptr) {
+      return false;
+    }
+    found_f(node->value());
+    return true;
+  }
+
+  // ========== 插入 ==========
+
+  // 不存在时插入 value；found_f 在临界区内调用，参数是新插入的或已有的值。
+  // 返回是否插入了新值
+  template <typename LOOKUP_FUNC, typename FOUND_FUNC>
+  bool insert_get(Thread* thread, LOOKUP_FUNC lookup_f, const VALUE& value, FOUND_FUNC found_f,
+                  bool* grow_hint = nullptr) {
+    uintx hash = lookup_f.get_hash();
+    Node* new_node = Node::create_node(value);
+    bool inserted = false;
+    size_t loops = 0;
+    int i = 0;
+    for (;;) {
+      bool locked;
+      {
+        GlobalCounter::CriticalSection cs(thread);
+        Bucket* bucket = get_bucket(hash);
+        Node* first_at_start = bucket->first();
+        Node* old = get_node(bucket, lookup_f, &loops);
+        if (old != nullptr) {
+          found_f(old->value());
+          break;
+        }
+        new_node->set_next(first_at_start);
+        if (bucket->cas_first(new_node, first_at_start)) {
+          found_f(new_node->value());
+          new_node = nullptr;
+          inserted = true;
+          break;
+        }
+        // CAS 失败可能是桶头变了，也可能是桶被锁（删除或扩容中）
+        locked = bucket->is_locked();
+      }
+      if (locked || ++i == SPINPAUSES_PER_YIELD) {
+        os::naked_yield();
+        i = 0;
+      } else {
+        os::spin_pause();
+      }
+    }
+    if (new_node != nullptr) {
+      // 没有发布过，其他线程看不到
+      Node::destroy_node(new_node);
+    }
+    if (grow_hint != nullptr) {
+      *grow_hint = loops > _grow_hint;
+    }
+    return inserted;
+  }
+
+  template <typename LOOKUP_FUNC>
+  bool insert(Thread* thread, LOOKUP_FUNC lookup_f, const VALUE& value, bool* grow_hint = nullptr) {
+    return insert_get(thread, lookup_f, value, [](VALUE*) {}, grow_hint);
+  }
+
+  // ========== 删除 ==========
+
+  // 删除匹配的节点，释放前调用 delete_f(VALUE*)（此时已没有读者能看到它）
+  template <typename LOOKUP_FUNC, typename DELETE_FUNC>
+  bool remove(Thread* thread, LOOKUP_FUNC lookup_f, DELETE_FUNC delete_f) {
+    Bucket* bucket = get_bucket_locked(thread, lookup_f.get_hash());
+    Node* const volatile* rem_n_prev = bucket->first_ptr();
+    Node* rem_n = bucket->first();
+    while (rem_n != nullptr) {
+      if (lookup_f.equals(rem_n->value())) {
+        bucket->release_assign_node_ptr(rem_n_prev, rem_n->next());
+        break;
+      }
+      rem_n_prev = rem_n->next_ptr();
+      rem_n = rem_n->next();
+    }
+    bucket->unlock();
+    if (rem_n == nullptr) {
+      return false;
+    }
+    // 等还在 rem_n 上的读者离开
+    GlobalCounter::write_synchronize();
+    delete_f(rem_n->value());
+    Node::destroy_node(rem_n);
+    return true;
+  }
+
+  template <typename LOOKUP_FUNC>
+  bool remove(Thread* thread, LOOKUP_FUNC lookup_f) {
+    return remove(thread, lookup_f, [](VALUE*) {});
+  }
+
+  // ========== 扩容/缩容 ==========
+  // 已有线程在扩容/缩容，或大小已到上限/下限时返回 false。
+  // 调用线程不能在临界区里，也不能持有 rank 不高于 nonleaf 的锁
+
+  bool grow(size_t log2size_limit = 0) {
+    size_t limit = log2size_limit == 0 ? _log2_size_limit : MIN2(log2size_limit, _log2_size_limit);
+    if (!_resize_lock.try_lock()) {
+      return false;
+    }
+    InternalTable* old_table = get_table();
+    if (old_table->_log2_size >= limit) {
+      _resize_lock.unlock();
+      return false;
+    }
+    OrderAccess::release_store(&_new_table, new InternalTable(old_table->_log2_size + 1));
+    grow_range(0, old_table->_size);
+    resize_epilog();
+    _resize_lock.unlock();
+    return true;
+  }
+
+  bool shrink(size_t log2size_limit = 0) {
+    size_t limit = MAX2(log2size_limit, _log2_start_size);
+    if (!_resize_lock.try_lock()) {
+      return false;
+    }
+    InternalTable* old_table = get_table();
+    if (old_table->_log2_size <= limit || old_table->_log2_size == 0) {
+      _resize_lock.unlock();
+      return false;
+    }
+    InternalTable* new_table = new InternalTable(old_table->_log2_size - 1);
+    OrderAccess::release_store(&_new_table, new_table);
+    shrink_range(0, new_table->_size);
+    resize_epilog();
+    _resize_lock.unlock();
+    return true;
+  }
+
+  // ========== 遍历 ==========
+
+  // 对每个值调用 scan_f(VALUE*)，返回 false 时停止。遍历期间不会扩容/缩容，
+  // 并发的插入/删除可能看得到也可能看不到
+  template <typename SCAN_FUNC>
+  void do_scan(Thread* thread, SCAN_FUNC scan_f) {
+    MutexLocker ml(&_resize_lock);
+    GlobalCounter::CriticalSection cs(thread);
+    do_scan_locked(scan_f);
+  }
+};
+
+#endif // MY_JVM_UTILITIES_CONCURRENTHASHTABLE_HPP
@@ -0,0 +1,655 @@
+/*
+ * my_jvm - Copy kernels
+ *
+ * conjoint / arrayof 核心都分两个方向：目标在源之前（或不重叠）时从低地址往高地址复制，
+ * 否则从高地址往低地址复制。每一块都是先读后写，重叠时也不会读到已经写过的字节。
+ *
+ * 块的大小都是 2 的幂，剩余字节数按位拆成 16/8/4/2/1 字节的块；字节数是元素宽度的
+ * 倍数时，只会用到不小于元素宽度的块，块的边界也落在元素边界上。
+ *
+ * 这个文件编译时关掉了 -ftree-loop-distribute-patterns（见 CMakeLists.txt），
+ * 否则 GCC 会把复制循环认成 memmove 调用，失去元素原子性。
+ */
+
+#include "utilities/copy.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/vm_version.hpp"
+#include "utilities/macros.hpp"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// ========== 一次读、一次写的块 ==========
+// aligned(1) 的类型允许不对齐的访问，编译成一条 mov / movdqu / vmovdqu。
+// 这些类型不能作模板实参（GCC 会丢掉 aligned 属性），所以每种宽度单独写。
+// 32 字节的向量只在 AVX2 核心里使用，内联后是一条 ymm 读写
+
+typedef uint16_t  u2_unaligned  __attribute__((aligned(1), may_alias));
+typedef uint32_t  u4_unaligned  __attribute__((aligned(1), may_alias));
+typedef uint64_t  u8_unaligned  __attribute__((aligned(1), may_alias));
+typedef long long v16_unaligned __attribute__((vector_size(16), aligned(1), may_alias));
+typedef long long v16_aligned   __attribute__((vector_size(16), may_alias));
+typedef long long v32_unaligned __attribute__((vector_size(32), aligned(1), may_alias));
+typedef long long v32_aligned   __attribute__((vector_size(32), may_alias));
+
+static ALWAYSINLINE void move2(const char* from, char* to) {
+  u2_unaligned v = *(const u2_unaligned*)from;
+  *(u2_unaligned*)to = v;
+}
+
+static ALWAYSINLINE void move4(const char* from, char* to) {
+  u4_unaligned v = *(const u4_unaligned*)from;
+  *(u4_unaligned*)to = v;
+}
+
+static ALWAYSINLINE void move8(const char* from, char* to) {
+  u8_unaligned v = *(const u8_unaligned*)from;
+  *(u8_unaligned*)to = v;
+}
+
+static ALWAYSINLINE void move16(const char* from, char* to) {
+  v16_unaligned v = *(const v16_unaligned*)from;
+  *(v16_unaligned*)to = v;
+}
+
+// 向量宽度的块。move_pair / move_quad 两块、四块一起读完再写；
+// *_aligned 的目标按向量宽度对齐
+struct Vector16 {
+  enum { size = 16 };
+  static ALWAYSINLINE void move(const char* from, char* to) {
+    move16(from, to);
+  }
+  static ALWAYSINLINE void move_pair(const char* from, char* to) {
+    v16_unaligned a = *(const v16_unaligned*)from;
+    v16_unaligned b = *(const v16_unaligned*)(from + 16);
+    *(v16_unaligned*)to = a;
+    *(v16_unaligned*)(to + 16) = b;
+  }
+  static ALWAYSINLINE void move_quad(const char* from, char* to) {
+    v16_unaligned a = *(const v16_unaligned*)from;
+    v16_unaligned b = *(const v16_unaligned*)(from + 16);
+    v16_unaligned c = *(const v16_unaligned*)(from + 32);
+    v16_unaligned d = *(const v16_unaligned*)(from + 48);
+    *(v16_unaligned*)to = a;
+    *(v16_unaligned*)(to + 16) = b;
+    *(v16_unaligned*)(to + 32) = c;
+    *(v16_unaligned*)(to + 48) = d;
+  }
+  static ALWAYSINLINE void move_aligned(const char* from, char* to) {
+    v16_unaligned v = *(const v16_unaligned*)from;
+    *(v16_aligned*)to = v;
+  }
+  static ALWAYSINLINE void move_pair_aligned(const char* from, char* to) {
+    v16_unaligned a = *(const v16_unaligned*)from;
+    v16_unaligned b = *(const v16_unaligned*)(from + 16);
+    *(v16_aligned*)to = a;
+    *(v16_aligned*)(to + 16) = b;
+  }
+  static ALWAYSINLINE void move_quad_aligned(const char* from, char* to) {
+    v16_unaligned a = *(const v16_unaligned*)from;
+    v16_unaligned b = *(const v16_unaligned*)(from + 16);
+    v16_unaligned c = *(const v16_unaligned*)(from + 32);
+    v16_unaligned d = *(const v16_unaligned*)(from + 48);
+    *(v16_aligned*)to = a;
+    *(v16_aligned*)(to + 16) = b;
+    *(v16_aligned*)(to + 32) = c;
+    *(v16_aligned*)(to + 48) = d;
+  }
+};
+
+struct Vector32 {
+  enum { size = 32 };
+  static ALWAYSINLINE void move(const char* from, char* to) {
+    v32_unaligned v = *(const v32_unaligned*)from;
+    *(v32_unaligned*)to = v;
+  }
+  static ALWAYSINLINE void move_pair(const char* from, char* to) {
+    v32_unaligned a = *(const v32_unaligned*)from;
+    v32_unaligned b = *(const v32_unaligned*)(from + 32);
+    *(v32_unaligned*)to = a;
+    *(v32_unaligned*)(to + 32) = b;
+  }
+  static ALWAYSINLINE void move_quad(const char* from, char* to) {
+    v32_unaligned a = *(const v32_unaligned*)from;
+    v32_unaligned b = *(const v32_unaligned*)(from + 32);
+    v32_unaligned c = *(const v32_unaligned*)(from + 64);
+    v32_unaligned d = *(const v32_unaligned*)(from + 96);
+    *(v32_unaligned*)to = a;
+    *(v32_unaligned*)(to + 32) = b;
+    *(v32_unaligned*)(to + 64) = c;
+    *(v32_unaligned*)(to + 96) = d;
+  }
+  static ALWAYSINLINE void move_aligned(const char* from, char* to) {
+    v32_unaligned v = *(const v32_unaligned*)from;
+    *(v32_aligned*)to = v;
+  }
+  static ALWAYSINLINE void move_pair_aligned(const char* from, char* to) {
+    v32_unaligned a = *(const v32_unaligned*)from;
+    v32_unaligned b = *(const v32_unaligned*)(from + 32);
+    *(v32_aligned*)to = a;
+    *(v32_aligned*)(to + 32) = b;
+  }
+  static ALWAYSINLINE void move_quad_aligned(const char* from, char* to) {
+    v32_unaligned a = *(const v32_unaligned*)from;
+    v32_unaligned b = *(const v32_unaligned*)(from + 32);
+    v32_unaligned c = *(const v32_unaligned*)(from + 64);
+    v32_unaligned d = *(const v32_unaligned*)(from + 96);
+    *(v32_aligned*)to = a;
+    *(v32_aligned*)(to + 32) = b;
+    *(v32_aligned*)(to + 64) = c;
+    *(v32_aligned*)(to + 96) = d;
+  }
+};
+
+// ========== 不足一个向量的尾部（bytes < 32） ==========
+
+static ALWAYSINLINE void tail_forward(const char* from, char* to, size_t bytes) {
+  if (bytes & 16) { move16(from, to); from += 16; to += 16; }
+  if (bytes & 8)  { move8(from, to);  from += 8;  to += 8;  }
+  if (bytes & 4)  { move4(from, to);  from += 4;  to += 4;  }
+  if (bytes & 2)  { move2(from, to);  from += 2;  to += 2;  }
+  if (bytes & 1)  { *to = *from; }
+}
+
+// from、to 是块的起点，从末尾往前复制
+static ALWAYSINLINE void tail_backward(const char* from, char* to, size_t bytes) {
+  const char* fe = from + bytes;
+  char*       te = to + bytes;
+  if (bytes & 1)  { fe -= 1;  te -= 1;  *te = *fe; }
+  if (bytes & 2)  { fe -= 2;  te -= 2;  move2(fe, te); }
+  if (bytes & 4)  { fe -= 4;  te -= 4;  move4(fe, te); }
+  if (bytes & 8)  { fe -= 8;  te -= 8;  move8(fe, te); }
+  if (bytes & 16) { fe -= 16; te -= 16; move16(fe, te); }
+}
+
+static ALWAYSINLINE bool copy_forward(const char* from, const char* to, size_t bytes) {
+  return to <= from || to >= from + bytes;
+}
+
+// ========== conjoint：只要求元素按自身大小对齐 ==========
+// 主循环每次四个向量，剩余部分再按两个、一个向量和尾部处理
+
+template <typename V>
+static ALWAYSINLINE void conjoint(const void* src, void* dst, size_t bytes) {
+  const size_t W = V::size;
+  const char* from = (const char*)src;
+  char*       to   = (char*)dst;
+  if (copy_forward(from, to, bytes)) {
+    for (; bytes >= 4 * W; bytes -= 4 * W, from += 4 * W, to += 4 * W) {
+      V::move_quad(from, to);
+    }
+    if (bytes >= 2 * W) {
+      V::move_pair(from, to);
+      bytes -= 2 * W; from += 2 * W; to += 2 * W;
+    }
+    if (bytes >= W) {
+      V::move(from, to);
+      bytes -= W; from += W; to += W;
+    }
+    tail_forward(from, to, bytes);
+  } else {
+    const char* fe = from + bytes;
+    char*       te = to + bytes;
+    for (; bytes >= 4 * W; bytes -= 4 * W) {
+      fe -= 4 * W; te -= 4 * W;
+      V::move_quad(fe, te);
+    }
+    if (bytes >= 2 * W) {
+      fe -= 2 * W; te -= 2 * W;
+      V::move_pair(fe, te);
+      bytes -= 2 * W;
+    }
+    if (bytes >= W) {
+      fe -= W; te -= W;
+      V::move(fe, te);
+      bytes -= W;
+    }
+    tail_backward(from, to, bytes);
+  }
+}
+
+// ========== arrayof：from、to 都按 HeapWord 对齐 ==========
+// 先用 8 字节的块把目标对齐到向量宽度，主循环用对齐的写
+
+template <typename V>
+static ALWAYSINLINE void arrayof(const void* src, void* dst, size_t bytes) {
+  const size_t W = V::size;
+  const char* from = (const char*)src;
+  char*       to   = (char*)dst;
+  if (copy_forward(from, to, bytes)) {
+    while (((uintptr_t)to & (W - 1)) != 0 && bytes >= 8) {
+      move8(from, to);
+      bytes -= 8; from += 8; to += 8;
+    }
+    for (; bytes >= 4 * W; bytes -= 4 * W, from += 4 * W, to += 4 * W) {
+      V::move_quad_aligned(from, to);
+    }
+    if (bytes >= 2 * W) {
+      V::move_pair_aligned(from, to);
+      bytes -= 2 * W; from += 2 * W; to += 2 * W;
+    }
+    if (bytes >= W) {
+      V::move_aligned(from, to);
+      bytes -= W; from += W; to += W;
+    }
+    tail_forward(from, to, bytes);
+  } else {
+    // 末尾不足 8 字节的部分先复制，之后的末端按 8 字节对齐
+    size_t odd = bytes & 7;
+    tail_backward(from + bytes - odd, to + bytes - odd, odd);
+    bytes -= odd;
+    const char* fe = from + bytes;
+    char*       te = to + bytes;
+    while (((uintptr_t)te & (W - 1)) != 0 && bytes >= 8) {
+      fe -= 8; te -= 8;
+      move8(fe, te);
+      bytes -= 8;
+    }
+    for (; bytes >= 4 * W; bytes -= 4 * W) {
+      fe -= 4 * W; te -= 4 * W;
+      V::move_quad_aligned(fe, te);
+    }
+    if (bytes >= 2 * W) {
+      fe -= 2 * W; te -= 2 * W;
+      V::move_pair_aligned(fe, te);
+      bytes -= 2 * W;
+    }
+    if (bytes >= W) {
+      fe -= W; te -= W;
+      V::move_aligned(fe, te);
+      bytes -= W;
+    }
+    tail_backward(from, to, bytes);
+  }
+}
+
+// ========== disjoint：不重叠，bytes 至少一个向量 ==========
+// 剩下不足一个向量的部分用一次和前面重叠的向量复制盖住：源和目标不重叠，重复写入的内容相同
+
+template <typename V>
+static ALWAYSINLINE void disjoint(const void* src, void* dst, size_t bytes) {
+  const size_t W = V::size;
+  const char* from = (const char*)src;
+  char*       to   = (char*)dst;
+  const char* fe   = from + bytes;
+  char*       te   = to + bytes;
+  for (; bytes >= 4 * W; bytes -= 4 * W, from += 4 * W, to += 4 * W) {
+    V::move_quad(from, to);
+  }
+  if (bytes >= 2 * W) {
+    V::move_pair(from, to);
+    bytes -= 2 * W; from += 2 * W; to += 2 * W;
+  }
+  if (bytes >= W) {
+    V::move(from, to);
+    bytes -= W;
+  }
+  if (bytes != 0) {
+    V::move(fe - W, te - W);
+  }
+}
+
+// ========== 核心 ==========
+
+#if defined(__x86_64__)
+
+static void sse2_conjoint(const void* from, void* to, size_t bytes) {
+  conjoint<Vector16>(from, to, bytes);
+}
+
+static void sse2_arrayof(const void* from, void* to, size_t bytes) {
+  arrayof<Vector16>(from, to, bytes);
+}
+
+static void sse2_disjoint(const void* from, void* to, size_t bytes) {
+  disjoint<Vector16>(from, to, bytes);
+}
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static void avx2_conjoint(const void* from, void* to, size_t bytes) {
+  conjoint<Vector32>(from, to, bytes);
+}
+
+AVX2_TARGET static void avx2_arrayof(const void* from, void* to, size_t bytes) {
+  arrayof<Vector32>(from, to, bytes);
+}
+
+AVX2_TARGET static void avx2_disjoint(const void* from, void* to, size_t bytes) {
+  disjoint<Vector32>(from, to, bytes);
+}
+
+#else
+
+// 其他平台不假定不对齐的访问是元素原子的：按 from、to、bytes 共同的对齐逐个单位复制
+template <typename T>
+static void scalar_units(const char* from, char* to, size_t bytes) {
+  size_t n = bytes / sizeof(T);
+  if (copy_forward(from, to, bytes)) {
+    for (size_t i = 0; i < n; i++) {
+      Atomic::store((volatile T*)to + i, Atomic::load((const volatile T*)from + i));
+    }
+  } else {
+    for (size_t i = n; i-- > 0; ) {
+      Atomic::store((volatile T*)to + i, Atomic::load((const volatile T*)from + i));
+    }
+  }
+}
+
+static void libc_disjoint(const void* from, void* to, size_t bytes) {
+  memcpy(to, from, bytes);
+}
+
+static void scalar_conjoint(const void* from, void* to, size_t bytes) {
+  uintptr_t bits = (uintptr_t)from | (uintptr_t)to | bytes;
+  if ((bits & 7) == 0) {
+    scalar_units<uint64_t>((const char*)from, (char*)to, bytes);
+  } else if ((bits & 3) == 0) {
+    scalar_units<uint32_t>((const char*)from, (char*)to, bytes);
+  } else if ((bits & 1) == 0) {
+    scalar_units<uint16_t>((const char*)from, (char*)to, bytes);
+  } else {
+    scalar_units<uint8_t>((const char*)from, (char*)to, bytes);
+  }
+}
+
+#endif // __x86_64__
+
+// ========== 填充 ==========
+// to 按 8 字节对齐，bytes 是 8 的倍数。value 每 8 字节重复一次，
+// 所以互相重叠的写写入的内容相同：头尾各用一次不对齐的写盖住，中间用对齐的写
+
+typedef void (*FillBytesFn)(char* to, size_t bytes, julong value);
+
+// initialize 设置，之后不变
+static size_t      _block_zeroing_low_limit = 0;
+static size_t      _nontemporal_fill_limit  = 0;
+static FillBytesFn _fill_methods[3]         = { nullptr, nullptr, nullptr };
+
+static ALWAYSINLINE void store8(char* to, julong value) {
+  *(u8_unaligned*)to = value;
+}
+
+#if defined(__x86_64__)
+
+// ERMS（Enhanced REP MOVSB/STOSB）下 rep stosb 按整条缓存行写。
+// value 的 8 个字节不同时只能用 rep stosq
+static void rep_stos(char* to, size_t bytes, julong value) {
+  if (value == (value & 0xff) * 0x0101010101010101ULL) {
+    __asm__ volatile ("rep stosb" : "+D"(to), "+c"(bytes) : "a"(value) : "memory");
+  } else {
+    size_t count = bytes >> 3;
+    __asm__ volatile ("rep stosq" : "+D"(to), "+c"(count) : "a"(value) : "memory");
+  }
+}
+
+static ALWAYSINLINE void sse2_fill_small(char* to, size_t bytes, __m128i v) {
+  char* end = to + bytes;
+  if (bytes < 16) {
+    if (bytes != 0) {
+      store8(to, (julong)_mm_cvtsi128_si64(v));
+      store8(end - 8, (julong)_mm_cvtsi128_si64(v));
+    }
+  } else if (bytes <= 32) {
+    _mm_storeu_si128((__m128i*)to, v);
+    _mm_storeu_si128((__m128i*)(end - 16), v);
+  } else {
+    _mm_storeu_si128((__m128i*)to, v);
+    _mm_storeu_si128((__m128i*)(to + 16), v);
+    _mm_storeu_si128((__m128i*)(end - 32), v);
+    _mm_storeu_si128((__m128i*)(end - 16), v);
+  }
+}
+
+static void sse2_fill_stores(char* to, size_t bytes, julong value) {
+  __m128i v = _mm_set1_epi64x((long long)value);
+  if (bytes <= 64) {
+    sse2_fill_small(to, bytes, v);
+    return;
+  }
+  char* end = to + bytes;
+  _mm_storeu_si128((__m128i*)to, v);
+  char* p = align_up(to + 1, 16);
+  for (; p + 64 <= end; p += 64) {
+    _mm_store_si128((__m128i*)p, v);
+    _mm_store_si128((__m128i*)(p + 16), v);
+    _mm_store_si128((__m128i*)(p + 32), v);
+    _mm_store_si128((__m128i*)(p + 48), v);
+  }
+  for (; p + 16 <= end; p += 16) {
+    _mm_store_si128((__m128i*)p, v);
+  }
+  _mm_storeu_si128((__m128i*)(end - 16), v);
+}
+
+// 按缓存行对齐后整行地做非临时写，最后 sfence：非临时写是弱序的，
+// 之后发布对象的普通写不能越过它们
+static void sse2_fill_nontemporal(char* to, size_t bytes, julong value) {
+  char* line = align_up(to, DEFAULT_CACHE_LINE_SIZE);
+  char* end  = to + bytes;
+  if (line + DEFAULT_CACHE_LINE_SIZE > end) {
+    sse2_fill_stores(to, bytes, value);
+    return;
+  }
+  __m128i v = _mm_set1_epi64x((long long)value);
+  sse2_fill_small(to, line - to, v);
+  char* p = line;
+  for (; p + 64 <= end; p += 64) {
+    _mm_stream_si128((__m128i*)p, v);
+    _mm_stream_si128((__m128i*)(p + 16), v);
+    _mm_stream_si128((__m128i*)(p + 32), v);
+    _mm_stream_si128((__m128i*)(p + 48), v);
+  }
+  _mm_sfence();
+  sse2_fill_small(p, end - p, v);
+}
+
+AVX2_TARGET static void avx2_fill_stores(char* to, size_t bytes, julong value) {
+  if (bytes < 32) {
+    sse2_fill_small(to, bytes, _mm_set1_epi64x((long long)value));
+    return;
+  }
+  __m256i v = _mm256_set1_epi64x((long long)value);
+  char* end = to + bytes;
+  if (bytes <= 64) {
+    _mm256_storeu_si256((__m256i*)to, v);
+    _mm256_storeu_si256((__m256i*)(end - 32), v);
+    return;
+  }
+  if (bytes <= 128) {
+    _mm256_storeu_si256((__m256i*)to, v);
+    _mm256_storeu_si256((__m256i*)(to + 32), v);
+    _mm256_storeu_si256((__m256i*)(end - 64), v);
+    _mm256_storeu_si256((__m256i*)(end - 32), v);
+    return;
+  }
+  _mm256_storeu_si256((__m256i*)to, v);
+  char* p = align_up(to + 1, 32);
+  for (; p + 128 <= end; p += 128) {
+    _mm256_store_si256((__m256i*)p, v);
+    _mm256_store_si256((__m256i*)(p + 32), v);
+    _mm256_store_si256((__m256i*)(p + 64), v);
+    _mm256_store_si256((__m256i*)(p + 96), v);
+  }
+  for (; p + 32 <= end; p += 32) {
+    _mm256_store_si256((__m256i*)p, v);
+  }
+  _mm256_storeu_si256((__m256i*)(end - 32), v);
+}
+
+AVX2_TARGET static void avx2_fill_nontemporal(char* to, size_t bytes, julong value) {
+  char* line = align_up(to, DEFAULT_CACHE_LINE_SIZE);
+  char* end  = to + bytes;
+  if (line + DEFAULT_CACHE_LINE_SIZE > end) {
+    avx2_fill_stores(to, bytes, value);
+    return;
+  }
+  avx2_fill_stores(to, line - to, value);
+  __m256i v = _mm256_set1_epi64x((long long)value);
+  char* p = line;
+  for (; p + 128 <= end; p += 128) {
+    _mm256_stream_si256((__m256i*)p, v);
+    _mm256_stream_si256((__m256i*)(p + 32), v);
+    _mm256_stream_si256((__m256i*)(p + 64), v);
+    _mm256_stream_si256((__m256i*)(p + 96), v);
+  }
+  for (; p + 64 <= end; p += 64) {
+    _mm256_stream_si256((__m256i*)p, v);
+    _mm256_stream_si256((__m256i*)(p + 32), v);
+  }
+  _mm_sfence();
+  avx2_fill_stores(p, end - p, value);
+}
+
+static void sse2_fill_words(HeapWord* to, size_t count, julong value) {
+  size_t bytes = count * HeapWordSize;
+  if (bytes < _block_zeroing_low_limit) {
+    sse2_fill_stores((char*)to, bytes, value);
+  } else if (bytes < _nontemporal_fill_limit) {
+    rep_stos((char*)to, bytes, value);
+  } else {
+    sse2_fill_nontemporal((char*)to, bytes, value);
+  }
+}
+
+AVX2_TARGET static void avx2_fill_words(HeapWord* to, size_t count, julong value) {
+  size_t bytes = count * HeapWordSize;
+  if (bytes < _block_zeroing_low_limit) {
+    avx2_fill_stores((char*)to, bytes, value);
+  } else if (bytes < _nontemporal_fill_limit) {
+    rep_stos((char*)to, bytes, value);
+  } else {
+    avx2_fill_nontemporal((char*)to, bytes, value);
+  }
+}
+
+#else
+
+static void scalar_fill(char* to, size_t bytes, julong value) {
+  for (size_t i = 0; i < bytes; i += 8) {
+    store8(to + i, value);
+  }
+}
+
+static void scalar_fill_words(HeapWord* to, size_t count, julong value) {
+  scalar_fill((char*)to, count * HeapWordSize, value);
+}
+
+#endif // __x86_64__
+
+// ========== 核心选择 ==========
+
+Copy::CopyFn Copy::_conjoint_atomic  = Copy::resolve_conjoint_atomic;
+Copy::CopyFn Copy::_arrayof_conjoint = Copy::resolve_arrayof_conjoint;
+Copy::CopyFn Copy::_disjoint_words   = Copy::resolve_disjoint_words;
+Copy::FillFn Copy::_fill_words       = Copy::resolve_fill_words;
+const char*  Copy::_kernel_name      = nullptr;
+
+// 填充超过最后一级缓存的 1/4 时改用非临时写：普通写要先把每一行读进缓存，
+// 写完的区域还会把缓存里别的数据挤出去。L3 由多个核共享，实测（microbench fill）
+// 在 L3/4 附近开始比 rep stos 快。读不到 L3 大小时按 L2 估计
+static size_t default_nontemporal_fill_limit() {
+  size_t l3 = VM_Version::L3_cache_size();
+  if (l3 != 0) {
+    return l3 / 4;
+  }
+  size_t l2 = VM_Version::L2_cache_size();
+  return l2 != 0 ? l2 * 8 : (size_t)16 * 1024 * 1024;
+}
+
+// rep stosb 的启动开销要几十个周期，实测 4K 以下展开的向量写更快
+static void initialize_fill_limits(bool has_fast_rep_stos) {
+  size_t nt_limit = NonTemporalFillLimit != 0 ? NonTemporalFillLimit : default_nontemporal_fill_limit();
+  size_t rep_limit = BlockZeroingLowLimit;
+  if (rep_limit == 0) {
+    // 没有 ERMS（或 -XX:-UseFastStosb）时 rep stos 不比向量写快，只用向量写和非临时写
+    rep_limit = has_fast_rep_stos ? 4 * 1024 : nt_limit;
+  }
+  _nontemporal_fill_limit  = nt_limit;
+  _block_zeroing_low_limit = MIN2(rep_limit, nt_limit);
+}
+
+// 一组核心一起选：同一个 ISA 的复制和填充
+struct CopyKernels {
+  Copy::CopyFn conjoint;
+  Copy::CopyFn arrayof;
+  Copy::CopyFn disjoint;
+  Copy::FillFn fill_words;
+  FillBytesFn  fill_stores;
+  FillBytesFn  fill_nontemporal;
+};
+
+static const VM_Version::Kernel<CopyKernels> copy_kernels[] = {
+#if defined(__x86_64__)
+  { VM_Version::CPU_AVX2, "avx2",
+    { avx2_conjoint, avx2_arrayof, avx2_disjoint, avx2_fill_words, avx2_fill_stores, avx2_fill_nontemporal } },
+  { VM_Version::CPU_SSE2, "sse2",
+    { sse2_conjoint, sse2_arrayof, sse2_disjoint, sse2_fill_words, sse2_fill_stores, sse2_fill_nontemporal } },
+#else
+  { 0, "scalar",
+    { scalar_conjoint, scalar_conjoint, libc_disjoint, scalar_fill_words, scalar_fill, scalar_fill } },
+#endif
+};
+
+// 多个线程同时初始化时写入的是同样的值
+void Copy::initialize() {
+  const VM_Version::Kernel<CopyKernels>& k = VM_Version::select(copy_kernels);
+  _fill_methods[fill_stores]      = k.impl.fill_stores;
+  _fill_methods[fill_nontemporal] = k.impl.fill_nontemporal;
+#if defined(__x86_64__)
+  _fill_methods[fill_rep_stos]    = rep_stos;
+  initialize_fill_limits(UseFastStosb);
+#else
+  _fill_methods[fill_rep_stos]    = scalar_fill;
+  initialize_fill_limits(false);
+#endif
+  // 阈值和 _fill_methods 在发布函数指针之前写好
+  atomic_store((void**)&_conjoint_atomic,  (void*)k.impl.conjoint);
+  atomic_store((void**)&_arrayof_conjoint, (void*)k.impl.arrayof);
+  atomic_store((void**)&_disjoint_words,   (void*)k.impl.disjoint);
+  atomic_store((void**)&_fill_words,       (void*)k.impl.fill_words);
+  atomic_store((void**)&_kernel_name,      (void*)k.name);
+}
+
+void Copy::resolve_conjoint_atomic(const void* from, void* to, size_t bytes) {
+  initialize();
+  _conjoint_atomic(from, to, bytes);
+}
+
+void Copy::resolve_arrayof_conjoint(const void* from, void* to, size_t bytes) {
+  initialize();
+  _arrayof_conjoint(from, to, bytes);
+}
+
+void Copy::resolve_disjoint_words(const void* from, void* to, size_t bytes) {
+  initialize();
+  _disjoint_words(from, to, bytes);
+}
+
+void Copy::resolve_fill_words(HeapWord* to, size_t count, julong value) {
+  initialize();
+  _fill_words(to, count, value);
+}
+
+void Copy::fill_words_using(FillMethod method, HeapWord* to, size_t count, julong value) {
+  kernel_name();   // 确保已经初始化
+  _fill_methods[method]((char*)to, count * HeapWordSize, value);
+}
+
+size_t Copy::block_zeroing_low_limit() {
+  kernel_name();
+  return _block_zeroing_low_limit;
+}
+
+size_t Copy::nontemporal_fill_limit() {
+  kernel_name();
+  return _nontemporal_fill_limit;
+}
+
+const char* Copy::kernel_name() {
+  if (atomic_load((void* const*)&_kernel_name) == nullptr) {
+    initialize();
+  }
+  return _kernel_name;
+}
@@ -1,88 +1,246 @@
 /*
  * my_jvm - Copy utilities
- * 
- * 内存复制工具
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/copy.hpp
+ *          和 hotspot/src/hotspot/cpu/x86/stubGenerator_x86_64.cpp 的 arraycopy stub
+ *
+ * 内存复制工具。conjoint 表示源和目标可以重叠，按 memmove 的语义处理。
+ *
+ *  - conjoint_memory / conjoint_jbytes：不保证原子性，直接 memmove
+ *  - *_atomic：元素原子。Java 数组复制时其他线程可能同时在读写，每个元素必须
+ *    用一次不小于元素宽度的读和一次写完成，不能被拆成字节（memmove 可能用
+ *    rep movsb，或者头尾重叠地复制）。元素要按自身大小对齐
+ *  - arrayof_*：源和目标都按 HeapWord 对齐（数组的第一个元素）。可以先用 8 字节
+ *    的移动把目标对齐到向量宽度，主循环用对齐的向量写
+ *
+ *  - aligned_disjoint_words：不重叠、按字对齐的复制（对象复制），小对象展开成逐字复制
+ *  - fill_to_words / zero_to_words：按大小在向量写、rep stos、非临时写之间选择，
+ *    用于清零 TLAB、新对象和整块 region
+ *
+ * x86_64 上的核心在第一次调用时由 VM_Version::select 按 CPU 特性和 -XX:UseAVX 选定（AVX2 / SSE2），
+ * 以后通过函数指针调用，见 copy.cpp。对齐的元素不会跨缓存行，向量读写即使不对齐、
+ * 跨缓存行被拆开，单个元素也不会被拆开，所以向量核心同样是元素原子的。
  */
 
 #ifndef MY_JVM_UTILITIES_COPY_HPP
 #define MY_JVM_UTILITIES_COPY_HPP
 
+#include "memory/allocation.hpp"
+#include "oops/compressedOops.hpp"
+#include "utilities/debug.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include <cstring>
 
 // ========== Copy 类声明 ==========
 
-class Copy {
-public:
-  static void conjoint_memory(void* from, void* to, size_t size);
-  static void conjoint_jbytes(void* from, void* to, size_t count);
-  static void conjoint_jshorts(jshort* from, jshort* to, size_t count);
-  static void conjoint_jints(jint* from, jint* to, size_t count);
-  static void conjoint_jlongs(jlong* from, jlong* to, size_t count);
-  static void conjoint_oops(void** from, void** to, size_t count);
-  static void arrayof_conjoint_jbytes(HeapWord* from, HeapWord* to, size_t count);
-  static void arrayof_conjoint_jshorts(HeapWord* from, HeapWord* to, size_t count);
-  static void arrayof_conjoint_jints(HeapWord* from, HeapWord* to, size_t count);
-  static void arrayof_conjoint_jlongs(HeapWord* from, HeapWord* to, size_t count);
-  static void fill_to_memory(void* to, size_t size, jubyte value);
-  static void fill_to_words(HeapWord* to, size_t count, julong value);
-  static void fill_to_bytes(void* to, size_t count, jubyte value);
-};
+class Copy : AllStatic {
+ public:
+  // 复制 bytes 个字节，元素原子（元素宽度不超过 8 且 bytes 是它的倍数）
+  typedef void (*CopyFn)(const void* from, void* to, size_t bytes);
+  // 把 count 个字填成 value
+  typedef void (*FillFn)(HeapWord* to, size_t count, julong value);
+
+ private:
+  static CopyFn      _conjoint_atomic;   // 未选定时指向 resolve_* 桩
+  static CopyFn      _arrayof_conjoint;
+  static CopyFn      _disjoint_words;    // 超过 UnrolledWords 的不重叠复制
+  static FillFn      _fill_words;
+  static const char* _kernel_name;
+
+  static void initialize();
+  static void resolve_conjoint_atomic(const void* from, void* to, size_t bytes);
+  static void resolve_arrayof_conjoint(const void* from, void* to, size_t bytes);
+  static void resolve_disjoint_words(const void* from, void* to, size_t bytes);
+  static void resolve_fill_words(HeapWord* to, size_t count, julong value);
+
+  // 先全部读出再写
+  template <size_t count>
+  static void move_words(const HeapWord* from, HeapWord* to) {
+    HeapWord tmp[count];
+    __builtin_memcpy(tmp, from, sizeof(tmp));
+    __builtin_memcpy(to, tmp, sizeof(tmp));
+  }
+
+  static void assert_disjoint(const HeapWord* from, HeapWord* to, size_t count) {
+#if ASSERT
+    assert(is_aligned((uintptr_t)from, HeapWordSize), "must be aligned: " PTR_FORMAT, from);
+    assert(is_aligned((uintptr_t)to, HeapWordSize), "must be aligned: " PTR_FORMAT, to);
+    assert(from + count <= to || to + count <= from, "source and destination overlap");
+#else
+    (void)from; (void)to; (void)count;
+#endif
+  }
+
+  static void assert_params_ok(const void* to, size_t alignment) {
+#if ASSERT
+    assert(is_aligned((uintptr_t)to, alignment), "must be aligned: " PTR_FORMAT, to);
+#else
+    (void)to; (void)alignment;
+#endif
+  }
+
+  static void assert_params_ok(const void* from, void* to, size_t alignment) {
+#if ASSERT
+    assert(is_aligned((uintptr_t)from, alignment), "must be aligned: " PTR_FORMAT, from);
+    assert(is_aligned((uintptr_t)to, alignment), "must be aligned: " PTR_FORMAT, to);
+#else
+    (void)from; (void)to; (void)alignment;
+#endif
+  }
+
+ public:
+  // ========== 不保证原子性 ==========
+
+  static void conjoint_memory(const void* from, void* to, size_t size) {
+    memmove(to, from, size);
+  }
 
-// ========== 内存复制实现 ==========
+  static void conjoint_jbytes(const void* from, void* to, size_t count) {
+    memmove(to, from, count);
+  }
 
-inline void Copy::conjoint_memory(void* from, void* to, size_t size) {
-  memmove(to, from, size);
-}
+  // ========== 元素原子 ==========
 
-inline void Copy::conjoint_jbytes(void* from, void* to, size_t count) {
-  memmove(to, from, count);
-}
+  static void conjoint_jshorts_atomic(const jshort* from, jshort* to, size_t count) {
+    assert_params_ok(from, to, sizeof(jshort));
+    _conjoint_atomic(from, to, count * sizeof(jshort));
+  }
 
-inline void Copy::conjoint_jshorts(jshort* from, jshort* to, size_t count) {
-  memmove(to, from, count * sizeof(jshort));
-}
+  static void conjoint_jints_atomic(const jint* from, jint* to, size_t count) {
+    assert_params_ok(from, to, sizeof(jint));
+    _conjoint_atomic(from, to, count * sizeof(jint));
+  }
 
-inline void Copy::conjoint_jints(jint* from, jint* to, size_t count) {
-  memmove(to, from, count * sizeof(jint));
-}
+  static void conjoint_jlongs_atomic(const jlong* from, jlong* to, size_t count) {
+    assert_params_ok(from, to, sizeof(jlong));
+    _conjoint_atomic(from, to, count * sizeof(jlong));
+  }
 
-inline void Copy::conjoint_jlongs(jlong* from, jlong* to, size_t count) {
-  memmove(to, from, count * sizeof(jlong));
-}
+  static void conjoint_oops_atomic(const oop* from, oop* to, size_t count) {
+    assert_params_ok(from, to, sizeof(oop));
+    _conjoint_atomic(from, to, count * sizeof(oop));
+  }
 
-inline void Copy::conjoint_oops(void** from, void** to, size_t count) {
-  memmove(to, from, count * sizeof(void*));
-}
+  static void conjoint_oops_atomic(const narrowOop* from, narrowOop* to, size_t count) {
+    assert_params_ok(from, to, sizeof(narrowOop));
+    _conjoint_atomic(from, to, count * sizeof(narrowOop));
+  }
 
-inline void Copy::arrayof_conjoint_jbytes(HeapWord* from, HeapWord* to, size_t count) {
-  memmove(to, from, count);
-}
+  // 按 from、to、size 共同的对齐（最多 8 字节）为单位保证原子性
+  static void conjoint_memory_atomic(const void* from, void* to, size_t size) {
+    _conjoint_atomic(from, to, size);
+  }
 
-inline void Copy::arrayof_conjoint_jshorts(HeapWord* from, HeapWord* to, size_t count) {
-  memmove(to, from, count * sizeof(jshort));
-}
+  // ========== HeapWord 对齐的数组 ==========
 
-inline void Copy::arrayof_conjoint_jints(HeapWord* from, HeapWord* to, size_t count) {
-  memmove(to, from, count * sizeof(jint));
-}
+  static void arrayof_conjoint_jbytes(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_params_ok(from, to, HeapWordSize);
+    _arrayof_conjoint(from, to, count);
+  }
 
-inline void Copy::arrayof_conjoint_jlongs(HeapWord* from, HeapWord* to, size_t count) {
-  memmove(to, from, count * sizeof(jlong));
-}
+  static void arrayof_conjoint_jshorts(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_params_ok(from, to, HeapWordSize);
+    _arrayof_conjoint(from, to, count * sizeof(jshort));
+  }
 
-inline void Copy::fill_to_memory(void* to, size_t size, jubyte value) {
-  memset(to, value, size);
-}
+  static void arrayof_conjoint_jints(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_params_ok(from, to, HeapWordSize);
+    _arrayof_conjoint(from, to, count * sizeof(jint));
+  }
 
-inline void Copy::fill_to_words(HeapWord* to, size_t count, julong value) {
-  for (size_t i = 0; i < count; i++) {
-    ((julong*)to)[i] = value;
+  static void arrayof_conjoint_jlongs(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_params_ok(from, to, HeapWordSize);
+    _arrayof_conjoint(from, to, count * sizeof(jlong));
   }
-}
 
-inline void Copy::fill_to_bytes(void* to, size_t count, jubyte value) {
-  memset(to, value, count);
-}
+  static void arrayof_conjoint_oops(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_params_ok(from, to, HeapWordSize);
+    _arrayof_conjoint(from, to, count * sizeof(oop));
+  }
+
+  // ========== 不重叠的按字复制 ==========
+  // from、to 按 HeapWord 对齐且两段不重叠，不保证每个字的原子性。
+  // 用于复制其他线程还看不到的目标，例如 GC 把对象复制到新位置。
+  // 大多数对象只有几个字，这时展开成逐字复制，不走函数指针
+
+  enum { UnrolledWords = 8 };
+
+  // 编译期已知字数的版本：不超过 UnrolledWords 时完全展开（编译器会合并成 16 字节的移动），没有分支
+  template <size_t count>
+  static void aligned_disjoint_words(const HeapWord* from, HeapWord* to) {
+    assert_disjoint(from, to, count);
+    if constexpr (count <= UnrolledWords) {
+      for (size_t i = 0; i < count; i++) {
+        to[i] = from[i];
+      }
+    } else {
+      _disjoint_words(from, to, count * HeapWordSize);
+    }
+  }
+
+  // 不超过 UnrolledWords 的小对象按 2~3、4~8 字分成两类，每类用头尾两次（可能重叠的）
+  // 16/32 字节移动完成。源和目标不重叠，重叠部分写两遍也没关系。
+  // 比按字数 switch 少了难预测的间接跳转：对象大小在热路径上几乎是随机的
+  static void aligned_disjoint_words(const HeapWord* from, HeapWord* to, size_t count) {
+    assert_disjoint(from, to, count);
+    if (count > UnrolledWords) {
+      _disjoint_words(from, to, count * HeapWordSize);
+    } else if (count >= 4) {
+      move_words<4>(from, to);
+      move_words<4>(from + count - 4, to + count - 4);
+    } else if (count >= 2) {
+      move_words<2>(from, to);
+      move_words<2>(from + count - 2, to + count - 2);
+    } else if (count == 1) {
+      to[0] = from[0];
+    }
+  }
+
+  // ========== 填充 ==========
+  // 按字填充和清零按大小选择写法（阈值见 copy.cpp 的 initialize）：
+  //   小于 BlockZeroingLowLimit：展开的 16/32 字节向量写
+  //   小于 NonTemporalFillLimit：rep stosb / rep stosq
+  //   更大：非临时写，不把整块区域读进缓存，也不挤掉缓存里的其他数据
+
+  static void fill_to_words(HeapWord* to, size_t count, julong value = 0) {
+    assert_params_ok(to, HeapWordSize);
+    _fill_words(to, count, value);
+  }
+
+  // to 按对象对齐，count 是对象对齐的整数倍（清零/填充整块堆空间）
+  static void fill_to_aligned_words(HeapWord* to, size_t count, julong value = 0) {
+    assert_params_ok(to, MinObjAlignmentInBytes);
+    assert(is_aligned(count * HeapWordSize, (size_t)MinObjAlignmentInBytes), "unaligned size: " SIZE_FORMAT, count);
+    _fill_words(to, count, value);
+  }
+
+  static void fill_to_bytes(void* to, size_t count, jubyte value = 0) {
+    memset(to, value, count);
+  }
+
+  static void fill_to_memory(void* to, size_t size, jubyte value = 0) {
+    memset(to, value, size);
+  }
+
+  static void zero_to_words(HeapWord* to, size_t count) {
+    assert_params_ok(to, HeapWordSize);
+    _fill_words(to, count, 0);
+  }
+
+  static void zero_to_bytes(void* to, size_t count) {
+    memset(to, 0, count);
+  }
+
+  // 单独使用某一种写法，和自动选择比较用（测试、基准）。to 按 HeapWord 对齐
+  enum FillMethod { fill_stores, fill_rep_stos, fill_nontemporal };
+  static void fill_words_using(FillMethod method, HeapWord* to, size_t count, julong value);
+
+  // 当前的阈值（字节）
+  static size_t block_zeroing_low_limit();
+  static size_t nontemporal_fill_limit();
+
+  // 选中的复制核心："avx2" / "sse2" / "scalar"
+  static const char* kernel_name();
+};
 
 #endif // MY_JVM_UTILITIES_COPY_HPP
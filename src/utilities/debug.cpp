@@ -0,0 +1,12 @@
+/*
+ * my_jvm - Debug support implementation
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/os/linux/os_linux.cpp 中的 breakpoint()
+ */
+
+#include "utilities/debug.hpp"
+
+// 调试器断点挂载点：在 gdb 中 `break breakpoint` 即可停在断言失败处
+extern "C" void breakpoint() {
+  // 用调试器在这里设置断点
+}
@@ -0,0 +1,88 @@
+/*
+ * my_jvm - GlobalCounter implementation
+ */
+
+#include "utilities/globalCounter.hpp"
+#include "runtime/os.hpp"
+
+GlobalCounter::PaddedCounter GlobalCounter::_global_counter;
+
+uintx GlobalCounter::advance_epoch() {
+  // conservative：推进之前摘下节点的写操作对之后读到新计数的读者可见
+  return Atomic::add_and_fetch(&_global_counter._counter, COUNTER_INCREMENT);
+}
+
+bool GlobalCounter::is_epoch_passed(uintx epoch) {
+  bool passed = true;
+  Threads::threads_do([&](Thread* thread) {
+    passed = passed && has_passed(thread, epoch);
+  });
+  return passed;
+}
+
+void GlobalCounter::write_synchronize() {
+  assert(Thread::current_or_null() == nullptr ||
+         (*Thread::current_or_null()->get_rcu_counter() & COUNTER_ACTIVE) == 0,
+         "write_synchronize inside a critical section would deadlock");
+  uintx gbl_cnt = advance_epoch();
+
+  Threads::threads_do([gbl_cnt](Thread* thread) {
+    for (int spins = 0; !has_passed(thread, gbl_cnt); spins++) {
+      if (spins < 64) {
+        os::spin_pause();
+      } else {
+        os::naked_yield();
+      }
+    }
+  });
+}
+
+// ========== DeferredFree ==========
+
+void DeferredFree::free_sealed() {
+  for (int i = 0; i < _sealed_len; i++) {
+    _sealed[i]._free(_sealed[i]._ptr);
+  }
+  _freed += _sealed_len;
+  _sealed_len = 0;
+}
+
+void DeferredFree::seal_pending() {
+  if (_sealed_len > 0) {
+    if (!GlobalCounter::is_epoch_passed(_sealed_epoch)) {
+      // 写得比读者离开得快：等上一批过期，限制未释放内存的总量
+      _synchronized++;
+      GlobalCounter::write_synchronize();
+    }
+    free_sealed();
+  }
+  for (int i = 0; i < _pending_len; i++) {
+    _sealed[i] = _pending[i];
+  }
+  _sealed_len = _pending_len;
+  _pending_len = 0;
+  _sealed_epoch = GlobalCounter::advance_epoch();
+}
+
+int DeferredFree::poll() {
+  if (_sealed_len == 0 || !GlobalCounter::is_epoch_passed(_sealed_epoch)) {
+    return 0;
+  }
+  int n = _sealed_len;
+  free_sealed();
+  return n;
+}
+
+void DeferredFree::flush() {
+  if (_pending_len == 0 && _sealed_len == 0) {
+    return;
+  }
+  // 一次等待同时覆盖两批：pending 里的内存都是在这次推进之前摘下的
+  GlobalCounter::write_synchronize();
+  free_sealed();
+  for (int i = 0; i < _pending_len; i++) {
+    _pending[i]._free(_pending[i]._ptr);
+  }
+  _freed += _pending_len;
+  _pending_len = 0;
+}
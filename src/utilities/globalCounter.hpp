@@ -0,0 +1,149 @@
+/*
+ * my_jvm - GlobalCounter
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/globalCounter.hpp
+ *                                        globalCounter.inline.hpp
+ *
+ * 一种 RCU：无锁数据结构靠它判断摘下的节点什么时候可以释放。
+ *
+ *  - 读端：进入临界区时把全局计数（最低位置 1 表示活跃）写进本线程的 _rcu_counter，
+ *    退出时写回 0。只写自己线程的字段，不写共享缓存行
+ *  - 写端：write_synchronize() 把全局计数加 2，然后等待每个线程要么不在临界区，
+ *    要么是在加 2 之后才进入的。返回后，调用之前已经从数据结构上摘下的节点
+ *    不会再被任何读者看到，可以释放
+ *
+ * 临界区可以嵌套（内层不改计数）。临界区内不能调用 write_synchronize，
+ * 也不能等待别的线程的写操作，否则会死锁。
+ *
+ * 不想在每次删除时等待读者的写者可以用 DeferredFree：摘下的内存先攒成一批，
+ * 封批时推进纪元（advance_epoch），之后所有读者都越过这个纪元（is_epoch_passed）
+ * 时整批释放，写者本身不阻塞。
+ */
+
+#ifndef MY_JVM_UTILITIES_GLOBALCOUNTER_HPP
+#define MY_JVM_UTILITIES_GLOBALCOUNTER_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/orderAccess.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class GlobalCounter : AllStatic {
+ private:
+  // 全局计数单独占一个缓存行：写者递增，读者只读
+  struct alignas(DEFAULT_CACHE_LINE_SIZE) PaddedCounter {
+    volatile uintx _counter;
+  };
+  static PaddedCounter _global_counter;
+
+  static const uintx COUNTER_ACTIVE    = 1;
+  static const uintx COUNTER_INCREMENT = 2;
+
+ public:
+  // 进入临界区前本线程的计数，退出时恢复，用于支持嵌套
+  typedef uintx CSContext;
+
+  static CSContext critical_section_begin(Thread* thread) {
+    volatile uintx* counter = thread->get_rcu_counter();
+    uintx old_cnt = Atomic::load(counter);
+    if ((old_cnt & COUNTER_ACTIVE) == 0) {
+      uintx new_cnt = Atomic::load(&_global_counter._counter, memory_order_acquire) | COUNTER_ACTIVE;
+      // storeload：写者读到我们的计数之前，我们不能先读数据结构
+      OrderAccess::release_store_fence(counter, new_cnt);
+    }
+    return old_cnt;
+  }
+
+  static void critical_section_end(Thread* thread, CSContext context) {
+    OrderAccess::release_store(thread->get_rcu_counter(), context);
+  }
+
+  // 等待所有在调用之前进入的读端临界区结束
+  static void write_synchronize();
+
+  // 非阻塞版本：advance_epoch() 返回一个纪元，is_epoch_passed(epoch) 为 true 时
+  // 在 advance_epoch() 之前进入的临界区都已结束
+  static uintx advance_epoch();
+  static bool  is_epoch_passed(uintx epoch);
+
+  class CriticalSection;
+
+ private:
+  // thread 不在临界区，或者是在 epoch 推进之后进入的
+  static bool has_passed(Thread* thread, uintx epoch) {
+    uintx cnt = OrderAccess::load_acquire(thread->get_rcu_counter());
+    // 按回绕比较：活跃且计数比 epoch 旧，说明是在推进之前进入的
+    return (cnt & COUNTER_ACTIVE) == 0 || (intx)(cnt - epoch) >= 0;
+  }
+};
+
+// 作用域内处于读端临界区
+class GlobalCounter::CriticalSection : public StackObj {
+ private:
+  Thread*   _thread;
+  CSContext _context;
+
+ public:
+  explicit CriticalSection(Thread* thread)
+    : _thread(thread), _context(critical_section_begin(thread)) {}
+
+  ~CriticalSection() {
+    critical_section_end(_thread, _context);
+  }
+};
+
+// ========== DeferredFree ==========
+// 单个写者使用（多个写者共用时由调用方加锁）。每批最多 BatchSize 个：
+// 待封批的满了以后，如果上一批的纪元还没过去就先 write_synchronize 等它。
+// flush() 和析构会等待并释放所有剩余的内存。defer 可能阻塞，不能在临界区里调用
+
+class DeferredFree : public CHeapObj<mtInternal> {
+ public:
+  typedef void (*free_func_t)(void* p);
+
+ private:
+  enum { BatchSize = 64 };
+
+  struct Entry {
+    void*       _ptr;
+    free_func_t _free;
+  };
+
+  Entry _pending[BatchSize];   // 已摘下、还没封批
+  int   _pending_len;
+  Entry _sealed[BatchSize];    // 已封批，等读者越过 _sealed_epoch
+  int   _sealed_len;
+  uintx _sealed_epoch;
+
+  size_t _freed;               // 累计释放个数
+  size_t _synchronized;        // 因为上一批还没过期而阻塞等待的次数
+
+  void free_sealed();
+  void seal_pending();
+
+ public:
+  DeferredFree() : _pending_len(0), _sealed_len(0), _sealed_epoch(0), _freed(0), _synchronized(0) {}
+  ~DeferredFree() { flush(); }
+
+  // ptr 已经从所有共享数据结构上摘下；读者都离开后调用 free_func(ptr)
+  void defer(void* ptr, free_func_t free_func) {
+    if (_pending_len == BatchSize) {
+      seal_pending();
+    }
+    _pending[_pending_len]._ptr = ptr;
+    _pending[_pending_len]._free = free_func;
+    _pending_len++;
+  }
+
+  // 上一批的纪元已经过去就释放它，不阻塞。返回释放的个数
+  int poll();
+
+  // 等待并释放全部
+  void flush();
+
+  int    pending_count() const       { return _pending_len + _sealed_len; }
+  size_t freed_count() const         { return _freed; }
+  size_t synchronized_count() const  { return _synchronized; }
+};
+
+#endif // MY_JVM_UTILITIES_GLOBALCOUNTER_HPP
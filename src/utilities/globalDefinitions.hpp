@@ -31,6 +31,8 @@ typedef uint16_t         jchar;        // 16位无符号（Java char 是 UTF-16
 // 有符号和无符号别名
 typedef uint8_t          juint8_t;
 typedef uint16_t         juint16_t;
+typedef uint8_t          jubyte;        // 8位无符号
+typedef uint16_t         jushort;       // 16位无符号
 typedef uint32_t         juint;         // 32位无符号
 typedef uint64_t         julong;        // 64位无符号
 
@@ -47,11 +49,16 @@ typedef int16_t          s2;   // 2字节有符号
 typedef int32_t          s4;   // 4字节有符号
 typedef int64_t          s8;   // 8字节有符号
 
+// 机器字长整数（VM flag 等使用）
+typedef intptr_t         intx;
+typedef uintptr_t        uintx;
+
 // ========== 指针类型 ==========
 // 标准库已定义，直接使用
 
 typedef uintptr_t address;
 typedef uintptr_t HeapWord;
+typedef uintptr_t MetaWord;    // Metaspace 的分配单位
 
 // ========== OOP 相关类型 - 参考 oopsHierarchy.hpp ==========
 
@@ -68,6 +75,9 @@ typedef class Klass*    KlassPtr;
 // narrowKlass: 压缩的类指针（32位）
 typedef uint32_t narrowKlass;
 
+// narrowOop: 压缩的对象指针（32位），参考 oopsHierarchy.hpp
+typedef juint narrowOop;
+
 // Method 前向声明（Metaspace 里的方法元数据）
 class Method;
 typedef class Method*    MethodPtr;
@@ -98,6 +108,57 @@ typedef markOop markWord;
 #define BitsPerInt         32
 #define BitsPerLong        64
 
+// HeapWord 的大小（Java 堆按字分配）
+const int HeapWordSize    = sizeof(HeapWord);
+#ifdef MY_JVM64
+const int LogHeapWordSize = 3;
+#else
+const int LogHeapWordSize = 2;
+#endif
+
+// 缓存行大小（x86-64 / aarch64 的常见值），多线程频繁写的字段按它填充，避免伪共享
+const int DEFAULT_CACHE_LINE_SIZE = 64;
+
+// ========== BasicType ==========
+// 参考：globalDefinitions.hpp BasicType，取值和 JVM 规范 newarray 的 atype 一致
+
+enum BasicType {
+  T_BOOLEAN  = 4,
+  T_CHAR     = 5,
+  T_FLOAT    = 6,
+  T_DOUBLE   = 7,
+  T_BYTE     = 8,
+  T_SHORT    = 9,
+  T_INT      = 10,
+  T_LONG     = 11,
+  T_OBJECT   = 12,
+  T_ARRAY    = 13,
+  T_VOID     = 14,
+  T_ILLEGAL  = 99
+};
+
+inline bool is_reference_type(BasicType t) {
+  return t == T_OBJECT || t == T_ARRAY;
+}
+
+// 数组元素的字节数。引用类型按未压缩算（8），
+// UseCompressedOops 时调用方应改用 heap_oop_size()
+inline int type2aelembytes(BasicType t) {
+  switch (t) {
+    case T_BOOLEAN:
+    case T_BYTE:   return 1;
+    case T_CHAR:
+    case T_SHORT:  return 2;
+    case T_FLOAT:
+    case T_INT:    return 4;
+    case T_DOUBLE:
+    case T_LONG:
+    case T_OBJECT:
+    case T_ARRAY:  return 8;
+    default:       return 0;
+  }
+}
+
 // ========== 对齐函数 ==========
 
 #define align_mask(alignment) ((alignment) - 1)
@@ -176,4 +237,18 @@ inline bool is_power_of_2(size_t x) {
   return x != 0 && (x & (x - 1)) == 0;
 }
 
+template <class T> inline T MAX2(T a, T b) { return (a > b) ? a : b; }
+template <class T> inline T MIN2(T a, T b) { return (a < b) ? a : b; }
+
+// 2 的幂的 log2
+inline int exact_log2(size_t x) {
+  return __builtin_ctzll((unsigned long long)x);
+}
+
+// 两个指针之间的元素个数（left >= right），默认按 HeapWord 计
+inline size_t pointer_delta(const volatile void* left, const volatile void* right,
+                            size_t element_size = HeapWordSize) {
+  return ((uintptr_t)left - (uintptr_t)right) / element_size;
+}
+
 #endif // MY_JVM_UTILITIES_GLOBALDEFINITIONS_HPP
@@ -1,18 +1,30 @@
 /*
  * my_jvm - Growable Array
- * 
+ *
  * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/growableArray.hpp
  * 简化版本：去除 oop/ostream 依赖
+ *
+ * 和 OpenJDK 11 的差别（都是为了 append 为主的用法）：
+ *  - 只有 [0, _len) 里的元素是构造过的，[_len, _max) 是未初始化的内存，
+ *    扩容时不再默认构造整个新容量
+ *  - 扩容时移动（而不是复制）旧元素；平凡可复制的 E 直接 memcpy
+ *  - Arena / ResourceArea 上的数组如果是 Arena 里最后分配的块，原地扩展
  */
 
 #ifndef MY_JVM_UTILITIES_GROWABLEARRAY_HPP
 #define MY_JVM_UTILITIES_GROWABLEARRAY_HPP
 
 #include "memory/allocation.hpp"
+#include "memory/arena.hpp"
+#include "memory/resourceArea.hpp"
 #include "utilities/debug.hpp"
 #include "utilities/globalDefinitions.hpp"
+#include "utilities/quickSort.hpp"
+#include "utilities/vectorSearch.hpp"
 #include <new>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 
 // ========== GenericGrowableArray 基类 ==========
 
@@ -27,7 +39,7 @@ class GenericGrowableArray : public ResourceObj {
   bool on_stack()  const { return _arena == nullptr; }
   bool on_arena()  const { return _arena > (Arena*)1; }
 
-  GenericGrowableArray(int initial_size, int initial_len, bool c_heap, 
+  GenericGrowableArray(int initial_size, int initial_len, bool c_heap,
                        MEMFLAGS flags = mtNone) {
     _len = initial_len;
     _max = initial_size;
@@ -44,6 +56,11 @@ class GenericGrowableArray : public ResourceObj {
     assert(_len >= 0 && _len <= _max, "initial_len too big");
   }
 
+  // Arena 或 ResourceArea 上的数组所在的 Arena
+  Arena* raw_arena() const {
+    return on_arena() ? _arena : current_resource_area();
+  }
+
   void* raw_allocate(int elementSize);
   void free_C_heap(void* elements);
 };
@@ -55,60 +72,76 @@ class GrowableArray : public GenericGrowableArray {
  private:
   E* _data;
 
-  void grow(int j) {
-    int new_max = _max;
-    if (new_max == 0) new_max = 2;
+  static const bool _trivial = std::is_trivially_copyable<E>::value;
+
+  static int next_capacity(int max, int j) {
+    int new_max = max == 0 ? 2 : max;
     while (new_max <= j) new_max = new_max * 2;
-    
-    E* new_data;
-    if (on_C_heap()) {
-      new_data = (E*)AllocateHeap(new_max * sizeof(E), _memflags);
-    } else if (on_arena()) {
-      new_data = (E*)_arena->Amalloc(new_max * sizeof(E));
+    return new_max;
+  }
+
+  // 把 [0, _len) 移动到 new_data 并析构原来的元素
+  void relocate(E* new_data) {
+    if (_trivial) {
+      if (_len > 0) {
+        memcpy((void*)new_data, (void*)_data, _len * sizeof(E));
+      }
     } else {
-      new_data = (E*)resource_allocate_bytes(new_max * sizeof(E));
-    }
-    
-    // 复制旧数据
-    for (int i = 0; i < _len; i++) {
-      ::new ((void*)&new_data[i]) E(_data[i]);
+      for (int i = 0; i < _len; i++) {
+        ::new ((void*)&new_data[i]) E(std::move(_data[i]));
+        _data[i].~E();
+      }
     }
-    
-    // 初始化新元素
-    for (int i = _len; i < new_max; i++) {
-      ::new ((void*)&new_data[i]) E();
+  }
+
+  // 容量扩到大于 j
+  void grow(int j) {
+    int new_max = next_capacity(_max, j);
+    size_t old_bytes = (size_t)_max * sizeof(E);
+    size_t new_bytes = (size_t)new_max * sizeof(E);
+
+    if (on_C_heap()) {
+      E* new_data = (E*)AllocateHeap(new_bytes, _memflags);
+      relocate(new_data);
+      if (_data != nullptr) {
+        FreeHeap(_data);
+      }
+      _data = new_data;
+    } else {
+      Arena* arena = raw_arena();
+      if (_data != nullptr && arena->Agrow(_data, old_bytes, new_bytes)) {
+        // 原地扩展，元素不用动
+      } else if (_trivial) {
+        _data = (E*)arena->Arealloc(_data, old_bytes, new_bytes);
+      } else {
+        E* new_data = (E*)arena->Amalloc(new_bytes);
+        relocate(new_data);
+        _data = new_data;
+      }
     }
-    
-    // 释放旧数据
-    if (on_C_heap() && _data != nullptr) {
-      for (int i = 0; i < _max; i++) {
+    _max = new_max;
+  }
+
+  void destruct_range(int from, int to) {
+    if (!std::is_trivially_destructible<E>::value) {
+      for (int i = from; i < to; i++) {
         _data[i].~E();
       }
-      FreeHeap(_data);
     }
-    
-    _data = new_data;
-    _max = new_max;
   }
 
  public:
   GrowableArray(int initial_size, bool c_heap = false, MEMFLAGS flags = mtInternal)
     : GenericGrowableArray(initial_size, 0, c_heap, flags) {
-    _data = (E*)raw_allocate(sizeof(E));
-    for (int i = 0; i < _max; i++) {
-      ::new ((void*)&_data[i]) E();
-    }
+    _data = _max > 0 ? (E*)raw_allocate(sizeof(E)) : nullptr;
   }
 
   GrowableArray(Arena* arena, int initial_size, int initial_len, const E& filler)
     : GenericGrowableArray(arena, initial_size, initial_len) {
-    _data = (E*)raw_allocate(sizeof(E));
+    _data = _max > 0 ? (E*)raw_allocate(sizeof(E)) : nullptr;
     for (int i = 0; i < _len; i++) {
       ::new ((void*)&_data[i]) E(filler);
     }
-    for (int i = _len; i < _max; i++) {
-      ::new ((void*)&_data[i]) E();
-    }
   }
 
   ~GrowableArray() {
@@ -119,11 +152,11 @@ class GrowableArray : public GenericGrowableArray {
 
   void clear_and_deallocate() {
     if (_data != nullptr) {
-      for (int i = 0; i < _max; i++) {
-        _data[i].~E();
-      }
+      destruct_range(0, _len);
       if (on_C_heap()) {
         FreeHeap(_data);
+      } else {
+        raw_arena()->Afree(_data, (size_t)_max * sizeof(E));
       }
       _data = nullptr;
     }
@@ -158,17 +191,42 @@ class GrowableArray : public GenericGrowableArray {
 
   // 修改
   void append(const E& e) {
-    if (_len == _max) grow(_len);
-    ::new ((void*)&_data[_len]) E(e);
+    if (_len == _max) {
+      // e 可能就是数组里的元素，扩容前先复制出来
+      E copy(e);
+      grow(_len);
+      ::new ((void*)&_data[_len]) E(std::move(copy));
+    } else {
+      ::new ((void*)&_data[_len]) E(e);
+    }
+    _len++;
+  }
+
+  void append(E&& e) {
+    if (_len == _max) {
+      E tmp(std::move(e));
+      grow(_len);
+      ::new ((void*)&_data[_len]) E(std::move(tmp));
+    } else {
+      ::new ((void*)&_data[_len]) E(std::move(e));
+    }
     _len++;
   }
 
   void push(const E& e) { append(e); }
+  void push(E&& e) { append(std::move(e)); }
+
+  // 预留容量，之后 append 到 capacity 之前都不会扩容
+  void reserve(int capacity) {
+    if (capacity > _max) grow(capacity - 1);
+  }
 
   E pop() {
     assert(!is_empty(), "empty list");
     _len--;
-    return _data[_len];
+    E result(std::move(_data[_len]));
+    _data[_len].~E();
+    return result;
   }
 
   E top() const {
@@ -182,36 +240,44 @@ class GrowableArray : public GenericGrowableArray {
   }
 
   void at_put_grow(int i, const E& e, const E& fill) {
-    if (i >= _len) {
-      while (i >= _max) grow(i);
-      for (int j = _len; j < i; j++) {
-        ::new ((void*)&_data[j]) E(fill);
-      }
-      _len = i + 1;
+    if (i < _len) {
+      _data[i] = e;
+      return;
     }
-    _data[i] = e;
+    if (i >= _max) {
+      E e_copy(e);
+      E fill_copy(fill);
+      grow(i);
+      at_put_grow(i, e_copy, fill_copy);
+      return;
+    }
+    for (int j = _len; j < i; j++) {
+      ::new ((void*)&_data[j]) E(fill);
+    }
+    ::new ((void*)&_data[i]) E(e);
+    _len = i + 1;
   }
 
-  void clear() { _len = 0; }
+  void clear() {
+    destruct_range(0, _len);
+    _len = 0;
+  }
 
   void trunc_to(int length) {
     assert(0 <= length && length <= _len, "length out of bounds");
+    destruct_range(length, _len);
     _len = length;
   }
 
-  // 查找
+  // 查找（指针、整数元素走 VectorSearch 的 SIMD 核心）
   int find(const E& e) const {
-    for (int i = 0; i < _len; i++) {
-      if (_data[i] == e) return i;
-    }
-    return -1;
+    return VectorSearch::find_first(_data, _len, e);
   }
 
   int find_from(int idx, const E& e) const {
-    for (int i = idx; i < _len; i++) {
-      if (_data[i] == e) return i;
-    }
-    return -1;
+    if (idx >= _len) return -1;
+    int i = VectorSearch::find_first(_data + idx, _len - idx, e);
+    return i < 0 ? -1 : idx + i;
   }
 
   bool contains(const E& e) const {
@@ -221,10 +287,16 @@ class GrowableArray : public GenericGrowableArray {
   // 删除
   void remove_at(int i) {
     assert(0 <= i && i < _len, "index out of bounds");
+    if (_trivial) {
+      memmove((void*)&_data[i], (void*)&_data[i + 1], (_len - 1 - i) * sizeof(E));
+      _len--;
+      return;
+    }
     for (int j = i; j < _len - 1; j++) {
-      _data[j] = _data[j + 1];
+      _data[j] = std::move(_data[j + 1]);
     }
     _len--;
+    _data[_len].~E();
   }
 
   void remove(const E& e) {
@@ -232,6 +304,91 @@ class GrowableArray : public GenericGrowableArray {
     if (idx >= 0) remove_at(idx);
   }
 
+  // 用最后一个元素填补被删的位置，O(1)，不保持顺序
+  void delete_at(int i) {
+    assert(0 <= i && i < _len, "index out of bounds");
+    _len--;
+    if (i < _len) {
+      _data[i] = std::move(_data[_len]);
+    }
+    _data[_len].~E();
+  }
+
+  // 在 idx 之前插入，后面的元素后移
+  void insert_before(int idx, const E& e) {
+    assert(0 <= idx && idx <= _len, "index out of bounds");
+    if (idx == _len) {
+      append(e);
+      return;
+    }
+    if (_len == _max) {
+      E copy(e);
+      grow(_len);
+      insert_before(idx, copy);
+      return;
+    }
+    if (_trivial) {
+      memmove((void*)&_data[idx + 1], (void*)&_data[idx], (_len - idx) * sizeof(E));
+      ::new ((void*)&_data[idx]) E(e);
+    } else {
+      ::new ((void*)&_data[_len]) E(std::move(_data[_len - 1]));
+      for (int j = _len - 1; j > idx; j--) {
+        _data[j] = std::move(_data[j - 1]);
+      }
+      _data[idx] = e;
+    }
+    _len++;
+  }
+
+  // ========== 有序数组 ==========
+  // 比较器是模板参数，编译器可以内联：compare(a, b) 返回负数 / 0 / 正数
+
+  // introsort，不稳定。比较函数作为模板实参时编译期已知，可以内联
+  template <int compare(const E&, const E&)>
+  void sort() {
+    QuickSort::sort(_data, (size_t)_len, [](const E& a, const E& b) { return compare(a, b); });
+  }
+
+  // 比较器是 lambda / 函数对象时，类型本身就确定了调用目标
+  template <typename Compare>
+  void sort(Compare compare) {
+    QuickSort::sort(_data, (size_t)_len, compare);
+  }
+
+  // 在按 compare 升序排好的数组里二分查找 key。找到时 found = true 并返回下标
+  // （有多个相等元素时是其中任意一个）；找不到时返回插入点，即第一个大于 key 的位置
+  // 参考：OpenJDK 12 growableArray.hpp find_sorted
+  template <typename K, int compare(const K&, const E&)>
+  int find_sorted(const K& key, bool& found) const {
+    found = false;
+    int min = 0;
+    int max = _len - 1;
+    while (max >= min) {
+      int mid = (int)(((juint)max + (juint)min) / 2);
+      int diff = compare(key, _data[mid]);
+      if (diff > 0) {
+        min = mid + 1;
+      } else if (diff < 0) {
+        max = mid - 1;
+      } else {
+        found = true;
+        return mid;
+      }
+    }
+    return min;
+  }
+
+  // 没有相等元素时按序插入，返回数组里的那个元素
+  template <int compare(const E&, const E&)>
+  E insert_sorted(const E& key) {
+    bool found;
+    int location = find_sorted<E, compare>(key, found);
+    if (!found) {
+      insert_before(location, key);
+    }
+    return at(location);
+  }
+
   // 迭代器支持
   E* begin() { return _data; }
   E* end() { return _data + _len; }
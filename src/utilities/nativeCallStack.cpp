@@ -0,0 +1,53 @@
+/*
+ * my_jvm - Native call stack implementation
+ */
+
+#include "utilities/debug.hpp"
+#include "utilities/nativeCallStack.hpp"
+#include "utilities/ostream.hpp"
+#include <dlfcn.h>
+#include <execinfo.h>
+
+NativeCallStack::NativeCallStack(address caller_pc, int depth) : _hash_value(0) {
+  enum { max_frames = 16 };
+  void* frames[max_frames];
+  int nframes = backtrace(frames, max_frames);
+
+  // 找到 caller_pc 所在的帧，之前的都是分配器内部帧
+  int start = 0;
+  while (start < nframes && (address)frames[start] != caller_pc) {
+    start++;
+  }
+
+  if (depth > NMT_TrackingStackDepth) depth = NMT_TrackingStackDepth;
+  int n = 0;
+  if (start == nframes) {
+    // 没找到（例如被尾调用优化掉了），至少记录调用者
+    _stack[n++] = caller_pc;
+  } else {
+    for (int i = start; i < nframes && n < depth; i++) {
+      _stack[n++] = (address)frames[i];
+    }
+  }
+  for (int i = n; i < NMT_TrackingStackDepth; i++) {
+    _stack[i] = 0;
+  }
+
+  for (int i = 0; i < NMT_TrackingStackDepth; i++) {
+    _hash_value += (unsigned int)(_stack[i] ^ (_stack[i] >> 32));
+    _hash_value *= 31;
+  }
+}
+
+void NativeCallStack::print_on(outputStream* out, int indent) const {
+  for (int i = 0; i < NMT_TrackingStackDepth && _stack[i] != 0; i++) {
+    out->sp(indent);
+    Dl_info info;
+    if (dladdr((void*)_stack[i], &info) != 0 && info.dli_sname != nullptr) {
+      out->print_cr("[0x%016lx] %s+0x%lx", (unsigned long)_stack[i], info.dli_sname,
+                    (unsigned long)(_stack[i] - (address)info.dli_saddr));
+    } else {
+      out->print_cr("[0x%016lx]", (unsigned long)_stack[i]);
+    }
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * my_jvm - Native call stack
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/nativeCallStack.hpp
+ * 简化版本：用 backtrace() 抓取固定深度的调用栈，供 NMT detail 模式使用
+ */
+
+#ifndef MY_JVM_UTILITIES_NATIVECALLSTACK_HPP
+#define MY_JVM_UTILITIES_NATIVECALLSTACK_HPP
+
+#include "utilities/debug.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+class outputStream;
+
+// 当前函数的返回地址（即调用者的 pc）
+#define CALLER_PC ((address)__builtin_return_address(0))
+
+// ========== NativeCallStack ==========
+
+class NativeCallStack {
+ public:
+  enum { NMT_TrackingStackDepth = 4 };
+
+ private:
+  address      _stack[NMT_TrackingStackDepth];
+  unsigned int _hash_value;
+
+ public:
+  NativeCallStack() : _hash_value(0) {
+    for (int i = 0; i < NMT_TrackingStackDepth; i++) {
+      _stack[i] = 0;
+    }
+  }
+
+  // 抓取当前调用栈，从 caller_pc 所在的帧开始记录 depth 帧
+  // （caller_pc 之前的帧属于分配器内部，丢弃）
+  NativeCallStack(address caller_pc, int depth);
+
+  bool is_empty() const { return _stack[0] == 0; }
+  address get_frame(int index) const {
+    assert(index >= 0 && index < NMT_TrackingStackDepth, "index out of bounds");
+    return _stack[index];
+  }
+
+  unsigned int hash() const { return _hash_value; }
+
+  bool equals(const NativeCallStack& other) const {
+    if (hash() != other.hash()) return false;
+    for (int i = 0; i < NMT_TrackingStackDepth; i++) {
+      if (_stack[i] != other._stack[i]) return false;
+    }
+    return true;
+  }
+
+  void print_on(outputStream* out, int indent = 0) const;
+};
+
+#endif // MY_JVM_UTILITIES_NATIVECALLSTACK_HPP
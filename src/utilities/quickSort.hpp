@@ -0,0 +1,153 @@
+/*
+ * my_jvm - Introsort
+ *
+ * 参考 OpenJDK 11 hotspot/src/hotspot/share/utilities/quickSort.hpp
+ * OpenJDK 的 QuickSort 是三数取中的快排，最坏 O(n^2)。这里改成 introsort：
+ *
+ *  - 三数取中的快排，递归较短的一边、循环较长的一边（栈深度 O(log n)）
+ *  - 递归深度超过 2*log2(n) 时对这一段改用堆排序，最坏 O(n log n)
+ *  - 不超过 InsertionSortThreshold 个元素时用插入排序
+ *
+ * 比较器是模板参数（函数对象或函数指针），compare(a, b) 返回负数 / 0 / 正数，
+ * 编译器可以把比较内联到排序循环里。不稳定排序。
+ */
+
+#ifndef MY_JVM_UTILITIES_QUICKSORT_HPP
+#define MY_JVM_UTILITIES_QUICKSORT_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include <utility>
+
+class QuickSort : AllStatic {
+ public:
+  enum { InsertionSortThreshold = 16 };
+
+ private:
+  template <typename T>
+  static void swap(T* array, size_t x, size_t y) {
+    T tmp(std::move(array[x]));
+    array[x] = std::move(array[y]);
+    array[y] = std::move(tmp);
+  }
+
+  template <typename T, typename C>
+  static void insertion_sort(T* array, size_t length, C& comparator) {
+    for (size_t i = 1; i < length; i++) {
+      if (comparator(array[i], array[i - 1]) < 0) {
+        T tmp(std::move(array[i]));
+        size_t j = i;
+        do {
+          array[j] = std::move(array[j - 1]);
+          j--;
+        } while (j > 0 && comparator(tmp, array[j - 1]) < 0);
+        array[j] = std::move(tmp);
+      }
+    }
+  }
+
+  template <typename T, typename C>
+  static void sift_down(T* array, size_t root, size_t length, C& comparator) {
+    T tmp(std::move(array[root]));
+    size_t child;
+    while ((child = 2 * root + 1) < length) {
+      if (child + 1 < length && comparator(array[child], array[child + 1]) < 0) {
+        child++;
+      }
+      if (comparator(tmp, array[child]) >= 0) {
+        break;
+      }
+      array[root] = std::move(array[child]);
+      root = child;
+    }
+    array[root] = std::move(tmp);
+  }
+
+  template <typename T, typename C>
+  static void heap_sort_impl(T* array, size_t length, C& comparator) {
+    for (size_t i = length / 2; i-- > 0; ) {
+      sift_down(array, i, length, comparator);
+    }
+    for (size_t end = length - 1; end > 0; end--) {
+      swap(array, 0, end);
+      sift_down(array, 0, end, comparator);
+    }
+  }
+
+  // 三数取中：排好 first / middle / last，中值留在 middle
+  // 参考：quickSort.hpp find_pivot
+  template <typename T, typename C>
+  static size_t find_pivot(T* array, size_t length, C& comparator) {
+    size_t middle = length / 2;
+    if (comparator(array[0], array[middle]) > 0) swap(array, 0, middle);
+    if (comparator(array[0], array[length - 1]) > 0) swap(array, 0, length - 1);
+    if (comparator(array[middle], array[length - 1]) > 0) swap(array, middle, length - 1);
+    return middle;
+  }
+
+  // Hoare 划分，返回右半段的起点。array[0] <= pivot <= array[length-1] 作为哨兵
+  // 参考：quickSort.hpp partition
+  template <typename T, typename C>
+  static size_t partition(T* array, size_t pivot, size_t length, C& comparator) {
+    size_t left = 0;
+    size_t right = length - 1;
+    for (;;) {
+      for (; comparator(array[left], array[pivot]) < 0; ++left) {}
+      for (; comparator(array[right], array[pivot]) > 0; --right) {}
+      if (left >= right) {
+        return right + 1;
+      }
+      // 枢轴被换走后跟着它的新位置
+      if (pivot == left) {
+        pivot = right;
+      } else if (pivot == right) {
+        pivot = left;
+      }
+      swap(array, left, right);
+      left++;
+      right--;
+    }
+  }
+
+  template <typename T, typename C>
+  static void introsort(T* array, size_t length, int depth_limit, C& comparator) {
+    while (length > InsertionSortThreshold) {
+      if (depth_limit-- == 0) {
+        heap_sort_impl(array, length, comparator);
+        return;
+      }
+      size_t pivot = find_pivot(array, length, comparator);
+      size_t split = partition(array, pivot, length, comparator);
+      // 递归短的一边
+      if (split < length - split) {
+        introsort(array, split, depth_limit, comparator);
+        array += split;
+        length -= split;
+      } else {
+        introsort(array + split, length - split, depth_limit, comparator);
+        length = split;
+      }
+    }
+    insertion_sort(array, length, comparator);
+  }
+
+ public:
+  template <typename T, typename C>
+  static void sort(T* array, size_t length, C comparator) {
+    if (length < 2) {
+      return;
+    }
+    int log2n = 63 - __builtin_clzll((unsigned long long)length);
+    introsort(array, length, 2 * log2n, comparator);
+  }
+
+  // introsort 的退化分支，单独暴露出来便于测试
+  template <typename T, typename C>
+  static void heap_sort(T* array, size_t length, C comparator) {
+    if (length >= 2) {
+      heap_sort_impl(array, length, comparator);
+    }
+  }
+};
+
+#endif // MY_JVM_UTILITIES_QUICKSORT_HPP
@@ -0,0 +1,161 @@
+/*
+ * my_jvm - Lock-free append-only segmented array
+ *
+ * GrowableArray 扩容时会搬动元素，只能单线程使用。很多全局登记表
+ * （类列表、jmethodID 表、NMT 调用点）是多线程只追加、随时读的，这里提供一个
+ * 不加锁的只追加数组：
+ *
+ *  - 元素存在一串段里，第 k 段有 FirstSegmentSize << k 个槽位，段一旦分配就不再移动，
+ *    所以已经拿到的元素地址一直有效
+ *  - append 用 Atomic::fetch_and_add 领取下标，段不存在时 CAS 安装（输的线程释放自己分配的段）
+ *  - 每个槽位有一个发布标记：写者先构造元素再 release 写标记，读者 acquire 读标记
+ *    之后才读元素。length() 是已领取的下标数，其中可能有还没发布的槽位
+ *
+ * 不支持删除；元素在数组析构时析构。
+ */
+
+#ifndef MY_JVM_UTILITIES_SEGMENTEDARRAY_HPP
+#define MY_JVM_UTILITIES_SEGMENTEDARRAY_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "utilities/debug.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include <cstring>
+#include <new>
+
+template <class E, MEMFLAGS F = mtInternal>
+class SegmentedArray : public CHeapObj<F> {
+ public:
+  enum {
+    LogFirstSegmentSize = 4,
+    FirstSegmentSize    = 1 << LogFirstSegmentSize,
+    MaxSegments         = 27       // 总容量 16 * (2^27 - 1)，不超过 int
+  };
+
+  static const uintptr_t Capacity = ((uintptr_t)FirstSegmentSize << MaxSegments) - FirstSegmentSize;
+
+ private:
+  struct Slot {
+    E             _value;
+    volatile jint _published;
+  };
+
+  Slot* volatile     _segments[MaxSegments];
+  volatile uintptr_t _claimed;     // 已领取的下标数
+
+  // 下标所在的段和段内偏移：i + 16 的最高位决定段号
+  static int segment_index(uintptr_t i) {
+    return 63 - __builtin_clzll((unsigned long long)(i + FirstSegmentSize)) - LogFirstSegmentSize;
+  }
+  static uintptr_t segment_offset(uintptr_t i, int seg) {
+    return i + FirstSegmentSize - ((uintptr_t)FirstSegmentSize << seg);
+  }
+  static size_t segment_length(int seg) {
+    return (size_t)FirstSegmentSize << seg;
+  }
+
+  Slot* segment(int seg) const {
+    return Atomic::load(&_segments[seg], memory_order_acquire);
+  }
+
+  Slot* ensure_segment(int seg) {
+    Slot* s = segment(seg);
+    if (s != nullptr) {
+      return s;
+    }
+    size_t bytes = segment_length(seg) * sizeof(Slot);
+    Slot* fresh = (Slot*)AllocateHeap(bytes, F);
+    memset((void*)fresh, 0, bytes);
+    // release 让清零后的段对其他线程可见；失败时 acquire 读到赢家的段
+    Slot* prev = Atomic::cmpxchg(&_segments[seg], (Slot*)nullptr, fresh, memory_order_acq_rel);
+    if (prev != nullptr) {
+      // 别的线程先装好了
+      FreeHeap(fresh);
+      return prev;
+    }
+    return fresh;
+  }
+
+  Slot* slot_at(int i) const {
+    int seg = segment_index((uintptr_t)i);
+    Slot* s = segment(seg);
+    return s == nullptr ? nullptr : &s[segment_offset((uintptr_t)i, seg)];
+  }
+
+ public:
+  SegmentedArray() : _claimed(0) {
+    for (int i = 0; i < MaxSegments; i++) {
+      _segments[i] = nullptr;
+    }
+  }
+
+  ~SegmentedArray() {
+    int len = length();
+    for (int seg = 0; seg < MaxSegments && _segments[seg] != nullptr; seg++) {
+      Slot* s = _segments[seg];
+      uintptr_t first = ((uintptr_t)FirstSegmentSize << seg) - FirstSegmentSize;
+      for (size_t j = 0; j < segment_length(seg) && first + j < (uintptr_t)len; j++) {
+        if (s[j]._published) {
+          s[j]._value.~E();
+        }
+      }
+      FreeHeap(s);
+    }
+  }
+
+  // 追加，返回元素的下标。可以被多个线程并发调用
+  int append(const E& e) {
+    // 只需要下标唯一，元素的可见性由段指针和发布标记保证
+    uintptr_t i = Atomic::fetch_and_add(&_claimed, 1, memory_order_relaxed);
+    guarantee(i < Capacity, "SegmentedArray is full");
+    int seg = segment_index(i);
+    Slot* slot = &ensure_segment(seg)[segment_offset(i, seg)];
+    ::new ((void*)&slot->_value) E(e);
+    // 发布：元素构造完成之后才可见
+    Atomic::store(&slot->_published, 1, memory_order_release);
+    return (int)i;
+  }
+
+  // 已领取的下标数（[0, length()) 中可能还有正在写入、尚未发布的槽位）
+  int length() const {
+    return (int)Atomic::load(&_claimed);
+  }
+
+  bool is_published(int i) const {
+    Slot* slot = slot_at(i);
+    return slot != nullptr && Atomic::load(&slot->_published, memory_order_acquire) != 0;
+  }
+
+  // 读已发布的元素
+  const E& at(int i) const {
+    assert(is_published(i), "element not published");
+    return slot_at(i)->_value;
+  }
+
+  const E* adr_at(int i) const { return &at(i); }
+
+  // 按下标顺序访问 [0, length()) 中已发布的元素：f(index, value)
+  template <typename Func>
+  void iterate(Func f) const {
+    int len = length();
+    for (int seg = 0; seg < MaxSegments; seg++) {
+      uintptr_t first = ((uintptr_t)FirstSegmentSize << seg) - FirstSegmentSize;
+      if (first >= (uintptr_t)len) {
+        break;
+      }
+      Slot* s = segment(seg);
+      if (s == nullptr) {
+        continue;
+      }
+      size_t n = MIN2(segment_length(seg), (size_t)((uintptr_t)len - first));
+      for (size_t j = 0; j < n; j++) {
+        if (Atomic::load(&s[j]._published, memory_order_acquire) != 0) {
+          f((int)(first + j), s[j]._value);
+        }
+      }
+    }
+  }
+};
+
+#endif // MY_JVM_UTILITIES_SEGMENTEDARRAY_HPP
@@ -0,0 +1,113 @@
+/*
+ * my_jvm - Striped and per-thread counters implementation
+ */
+
+#include "utilities/stripedCounter.hpp"
+#include "runtime/os.hpp"
+#include "utilities/debug.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// ========== StripedCounter ==========
+
+juint StripedCounter::make_probe() {
+  // 用线程私有变量的地址区分线程，乘法哈希把高位的差异带到低位
+  static thread_local char marker;
+  uint64_t h = (uint64_t)(uintptr_t)&marker * 0x9E3779B97F4A7C15ULL;
+  juint probe = (juint)(h >> 32);
+  return probe != 0 ? probe : 1;
+}
+
+StripedCounter::Cell* StripedCounter::inflate() {
+  Cell* cells = Atomic::load(&_cells, memory_order_acquire);
+  if (cells != nullptr) {
+    return cells;
+  }
+  int n = 1;
+  while (n < os::processor_count() && n < MaxCells) {
+    n <<= 1;
+  }
+  size_t bytes = n * sizeof(Cell);
+  Cell* fresh = (Cell*)::aligned_alloc(sizeof(Cell), bytes);
+  guarantee(fresh != nullptr, "out of memory for counter cells");
+  memset((void*)fresh, 0, bytes);
+  // 并发 inflate 的线程写入的 mask 相同；CAS 的 release 让清零后的 cell 和 mask 先可见
+  Atomic::store(&_cell_mask, (jint)(n - 1));
+  Cell* prev = Atomic::cmpxchg(&_cells, (Cell*)nullptr, fresh, memory_order_acq_rel);
+  if (prev != nullptr) {
+    ::free(fresh);
+    return prev;
+  }
+  return fresh;
+}
+
+StripedCounter::~StripedCounter() {
+  ::free((void*)_cells);
+}
+
+jlong StripedCounter::sum() const {
+  jlong sum = Atomic::load(&_base);
+  Cell* cells = Atomic::load(&_cells, memory_order_acquire);
+  if (cells != nullptr) {
+    int n = (int)Atomic::load(&_cell_mask) + 1;
+    for (int i = 0; i < n; i++) {
+      sum += Atomic::load(&cells[i]._value);
+    }
+  }
+  return sum;
+}
+
+void StripedCounter::reset() {
+  Atomic::store(&_base, (jlong)0);
+  Cell* cells = Atomic::load(&_cells, memory_order_acquire);
+  if (cells != nullptr) {
+    int n = (int)Atomic::load(&_cell_mask) + 1;
+    for (int i = 0; i < n; i++) {
+      Atomic::store(&cells[i]._value, (jlong)0);
+    }
+  }
+}
+
+// ========== PerThreadCounter ==========
+
+PerThreadCounter* PerThreadCounter::_counters[Thread::local_counter_slots];
+
+PerThreadCounter::PerThreadCounter() : _slot(-1), _retired(0) {
+  MutexLocker ml(&Threads::_lock);
+  for (int i = 0; i < Thread::local_counter_slots; i++) {
+    if (_counters[i] == nullptr) {
+      _counters[i] = this;
+      _slot = i;
+      break;
+    }
+  }
+  guarantee(_slot >= 0, "too many PerThreadCounters (max %d)", (int)Thread::local_counter_slots);
+}
+
+PerThreadCounter::~PerThreadCounter() {
+  // 清掉各线程的槽位，留给下一个计数器
+  MutexLocker ml(&Threads::_lock);
+  for (Thread* t = Threads::_thread_list; t != nullptr; t = t->_next) {
+    Atomic::store(t->local_counter_addr(_slot), (jlong)0);
+  }
+  _counters[_slot] = nullptr;
+}
+
+void PerThreadCounter::retire_thread(Thread* thread) {
+  assert(Threads::_lock.owned_by_self(), "must hold Threads_lock");
+  for (int i = 0; i < Thread::local_counter_slots; i++) {
+    jlong v = Atomic::load(thread->local_counter_addr(i));
+    if (_counters[i] != nullptr && v != 0) {
+      Atomic::fetch_and_add(&_counters[i]->_retired, v, memory_order_relaxed);
+    }
+  }
+}
+
+jlong PerThreadCounter::sum() const {
+  MutexLocker ml(&Threads::_lock);
+  jlong sum = Atomic::load(&_retired);
+  for (Thread* t = Threads::_thread_list; t != nullptr; t = t->_next) {
+    sum += Atomic::load(t->local_counter_addr(_slot));
+  }
+  return sum;
+}
@@ -0,0 +1,115 @@
+/*
+ * my_jvm - Striped and per-thread counters
+ *
+ * 统计计数器（调用次数、分配次数/字节数）被很多线程频繁更新、很少读取。
+ * 所有线程对同一个字 Atomic::fetch_and_add 时，那条缓存行在核之间来回传递，
+ * 核数越多越慢。这里提供两种把写分散开的计数器，读的时候再求和：
+ *
+ *  - StripedCounter：类似 java.util.concurrent.atomic.LongAdder。
+ *    没有竞争时只有一个 _base 字，用 CAS 更新；第一次 CAS 失败后分配一组
+ *    各占一条缓存行的 cell（个数取不小于处理器数的 2 的幂，最多 64），
+ *    之后每个线程按自己的哈希选 cell 做 relaxed 加法。sum() 是 _base 加所有 cell。
+ *
+ *  - PerThreadCounter：每个线程在自己的 Thread 里有一个槽位，更新是普通的读-加-写，
+ *    没有原子指令。sum() 持 Threads_lock 遍历所有线程；线程退出时槽位的值折叠进
+ *    _retired。同时存在的 PerThreadCounter 最多 Thread::local_counter_slots 个。
+ *
+ * 两者的 sum() 都只是近似快照：并发的更新可能算进去也可能没算进去。
+ */
+
+#ifndef MY_JVM_UTILITIES_STRIPEDCOUNTER_HPP
+#define MY_JVM_UTILITIES_STRIPEDCOUNTER_HPP
+
+#include "memory/allocation.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/globalDefinitions.hpp"
+
+// ========== StripedCounter ==========
+// cell 用 ::aligned_alloc 分配而不是 AllocateHeap，NMT 自己的统计也能用它
+
+class StripedCounter {
+ private:
+  enum { MaxCells = 64 };
+
+  struct alignas(DEFAULT_CACHE_LINE_SIZE) Cell {
+    volatile jlong _value;
+  };
+
+  volatile jlong _base;
+  Cell* volatile _cells;      // 第一次竞争时分配，之后不变
+  volatile jint  _cell_mask;  // cell 个数 - 1，在发布 _cells 之前写好
+
+  // 当前线程选 cell 用的哈希，每个线程第一次使用时算一次
+  static juint thread_probe() {
+    static thread_local juint probe = 0;
+    if (MY_JVM_UNLIKELY(probe == 0)) {
+      probe = make_probe();
+    }
+    return probe;
+  }
+  static juint make_probe();
+
+  Cell* inflate();
+
+ public:
+  constexpr StripedCounter() : _base(0), _cells(nullptr), _cell_mask(0) {}
+  ~StripedCounter();
+
+  void add(jlong v) {
+    Cell* cells = Atomic::load(&_cells, memory_order_acquire);
+    if (MY_JVM_LIKELY(cells == nullptr)) {
+      jlong b = Atomic::load(&_base);
+      if (Atomic::cmpxchg(&_base, b, b + v, memory_order_relaxed) == b) {
+        return;
+      }
+      cells = inflate();
+    }
+    Atomic::fetch_and_add(&cells[thread_probe() & (juint)_cell_mask]._value, v, memory_order_relaxed);
+  }
+
+  void inc() { add(1); }
+  void dec() { add(-1); }
+
+  jlong sum() const;
+
+  // 清零；和并发的 add 之间没有原子性
+  void reset();
+
+  // 已分配的 cell 个数（没有竞争过时为 0）
+  int cells() const {
+    return Atomic::load(&_cells, memory_order_acquire) == nullptr ? 0 : (int)Atomic::load(&_cell_mask) + 1;
+  }
+};
+
+// ========== PerThreadCounter ==========
+
+class PerThreadCounter : public CHeapObj<mtInternal> {
+  friend class Threads;
+
+ private:
+  static PerThreadCounter* _counters[Thread::local_counter_slots];   // 持 Threads_lock 访问
+
+  int            _slot;
+  volatile jlong _retired;    // 已退出线程的计数
+
+  // Threads::remove 持 Threads_lock 调用：把 thread 的所有槽位折叠进对应计数器
+  static void retire_thread(Thread* thread);
+
+ public:
+  PerThreadCounter();
+  ~PerThreadCounter();
+
+  // 只有本线程写自己的槽位，所以不需要原子的读改写；relaxed 读写保证 sum() 不会读到撕裂的值
+  void add(jlong v) {
+    volatile jlong* slot = Thread::current()->local_counter_addr(_slot);
+    Atomic::store(slot, Atomic::load(slot) + v);
+  }
+
+  void inc() { add(1); }
+  void dec() { add(-1); }
+
+  jlong sum() const;
+};
+
+#endif // MY_JVM_UTILITIES_STRIPEDCOUNTER_HPP
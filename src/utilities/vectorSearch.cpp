@@ -0,0 +1,242 @@
+/*
+ * my_jvm - Vectorized linear search implementation
+ */
+
+#include "utilities/vectorSearch.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/vm_version.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// ========== 标量核心 ==========
+
+template <typename T>
+static int scalar_first(const void* data, int len, uint64_t value) {
+  return VectorSearch::find_first_scalar((const T*)data, len, (T)value);
+}
+
+template <typename T>
+static int scalar_last(const void* data, int len, uint64_t value) {
+  return VectorSearch::find_last_scalar((const T*)data, len, (T)value);
+}
+
+#if defined(__x86_64__)
+
+// ========== SSE2 ==========
+// x86_64 一定有 SSE2。没有 64 位相等比较（SSE4.1 才有），
+// 用 32 位比较后把两半交换再 and，两半都相等才算相等
+
+static inline int sse2_mask32(const uint32_t* p, __m128i key) {
+  __m128i v = _mm_loadu_si128((const __m128i*)p);
+  return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, key)));
+}
+
+static inline int sse2_mask64(const uint64_t* p, __m128i key) {
+  __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), key);
+  eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+static int sse2_first32(const void* data, int len, uint64_t value) {
+  const uint32_t* p = (const uint32_t*)data;
+  __m128i key = _mm_set1_epi32((int)(uint32_t)value);
+  int i = 0;
+  for (; i + 4 <= len; i += 4) {
+    int m = sse2_mask32(p + i, key);
+    if (m != 0) return i + __builtin_ctz(m);
+  }
+  for (; i < len; i++) {
+    if (p[i] == (uint32_t)value) return i;
+  }
+  return -1;
+}
+
+static int sse2_last32(const void* data, int len, uint64_t value) {
+  const uint32_t* p = (const uint32_t*)data;
+  __m128i key = _mm_set1_epi32((int)(uint32_t)value);
+  int i = len;
+  for (; i >= 4; i -= 4) {
+    int m = sse2_mask32(p + i - 4, key);
+    if (m != 0) return i - 4 + 31 - __builtin_clz(m);
+  }
+  while (i-- > 0 && p[i] != (uint32_t)value);
+  return i;
+}
+
+static int sse2_first64(const void* data, int len, uint64_t value) {
+  const uint64_t* p = (const uint64_t*)data;
+  __m128i key = _mm_set1_epi64x((long long)value);
+  int i = 0;
+  for (; i + 4 <= len; i += 4) {
+    int m = sse2_mask64(p + i, key) | (sse2_mask64(p + i + 2, key) << 2);
+    if (m != 0) return i + __builtin_ctz(m);
+  }
+  for (; i < len; i++) {
+    if (p[i] == value) return i;
+  }
+  return -1;
+}
+
+static int sse2_last64(const void* data, int len, uint64_t value) {
+  const uint64_t* p = (const uint64_t*)data;
+  __m128i key = _mm_set1_epi64x((long long)value);
+  int i = len;
+  for (; i >= 4; i -= 4) {
+    int m = sse2_mask64(p + i - 4, key) | (sse2_mask64(p + i - 2, key) << 2);
+    if (m != 0) return i - 4 + 31 - __builtin_clz(m);
+  }
+  while (i-- > 0 && p[i] != value);
+  return i;
+}
+
+// ========== AVX2 ==========
+// 每轮比较两个 256 位向量（16 个 32 位 / 8 个 64 位元素）
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline uint32_t avx2_mask32(const uint32_t* p, __m256i key) {
+  __m256i v = _mm256_loadu_si256((const __m256i*)p);
+  return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, key)));
+}
+
+AVX2_TARGET static inline uint32_t avx2_mask64(const uint64_t* p, __m256i key) {
+  __m256i v = _mm256_loadu_si256((const __m256i*)p);
+  return (uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, key)));
+}
+
+AVX2_TARGET static int avx2_first32(const void* data, int len, uint64_t value) {
+  const uint32_t* p = (const uint32_t*)data;
+  __m256i key = _mm256_set1_epi32((int)(uint32_t)value);
+  int i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint32_t m = avx2_mask32(p + i, key) | (avx2_mask32(p + i + 8, key) << 8);
+    if (m != 0) return i + __builtin_ctz(m);
+  }
+  if (i + 8 <= len) {
+    uint32_t m = avx2_mask32(p + i, key);
+    if (m != 0) return i + __builtin_ctz(m);
+    i += 8;
+  }
+  for (; i < len; i++) {
+    if (p[i] == (uint32_t)value) return i;
+  }
+  return -1;
+}
+
+AVX2_TARGET static int avx2_last32(const void* data, int len, uint64_t value) {
+  const uint32_t* p = (const uint32_t*)data;
+  __m256i key = _mm256_set1_epi32((int)(uint32_t)value);
+  int i = len;
+  for (; i >= 16; i -= 16) {
+    uint32_t m = avx2_mask32(p + i - 16, key) | (avx2_mask32(p + i - 8, key) << 8);
+    if (m != 0) return i - 16 + 31 - __builtin_clz(m);
+  }
+  if (i >= 8) {
+    uint32_t m = avx2_mask32(p + i - 8, key);
+    if (m != 0) return i - 8 + 31 - __builtin_clz(m);
+    i -= 8;
+  }
+  while (i-- > 0 && p[i] != (uint32_t)value);
+  return i;
+}
+
+AVX2_TARGET static int avx2_first64(const void* data, int len, uint64_t value) {
+  const uint64_t* p = (const uint64_t*)data;
+  __m256i key = _mm256_set1_epi64x((long long)value);
+  int i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint32_t m = avx2_mask64(p + i, key) | (avx2_mask64(p + i + 4, key) << 4);
+    if (m != 0) return i + __builtin_ctz(m);
+  }
+  if (i + 4 <= len) {
+    uint32_t m = avx2_mask64(p + i, key);
+    if (m != 0) return i + __builtin_ctz(m);
+    i += 4;
+  }
+  for (; i < len; i++) {
+    if (p[i] == value) return i;
+  }
+  return -1;
+}
+
+AVX2_TARGET static int avx2_last64(const void* data, int len, uint64_t value) {
+  const uint64_t* p = (const uint64_t*)data;
+  __m256i key = _mm256_set1_epi64x((long long)value);
+  int i = len;
+  for (; i >= 8; i -= 8) {
+    uint32_t m = avx2_mask64(p + i - 8, key) | (avx2_mask64(p + i - 4, key) << 4);
+    if (m != 0) return i - 8 + 31 - __builtin_clz(m);
+  }
+  if (i >= 4) {
+    uint32_t m = avx2_mask64(p + i - 4, key);
+    if (m != 0) return i - 4 + 31 - __builtin_clz(m);
+    i -= 4;
+  }
+  while (i-- > 0 && p[i] != value);
+  return i;
+}
+
+#endif // __x86_64__
+
+// ========== 核心选择 ==========
+
+VectorSearch::SearchFn VectorSearch::_find_first32 = VectorSearch::resolve_first32;
+VectorSearch::SearchFn VectorSearch::_find_first64 = VectorSearch::resolve_first64;
+VectorSearch::SearchFn VectorSearch::_find_last32  = VectorSearch::resolve_last32;
+VectorSearch::SearchFn VectorSearch::_find_last64  = VectorSearch::resolve_last64;
+const char*            VectorSearch::_kernel_name  = nullptr;
+
+struct SearchKernels {
+  VectorSearch::SearchFn first32;
+  VectorSearch::SearchFn first64;
+  VectorSearch::SearchFn last32;
+  VectorSearch::SearchFn last64;
+};
+
+static const VM_Version::Kernel<SearchKernels> search_kernels[] = {
+#if defined(__x86_64__)
+  { VM_Version::CPU_AVX2, "avx2", { avx2_first32, avx2_first64, avx2_last32, avx2_last64 } },
+  { VM_Version::CPU_SSE2, "sse2", { sse2_first32, sse2_first64, sse2_last32, sse2_last64 } },
+#endif
+  { 0, "scalar",
+    { scalar_first<uint32_t>, scalar_first<uint64_t>, scalar_last<uint32_t>, scalar_last<uint64_t> } },
+};
+
+// 多个线程同时初始化时写入的是同样的值
+void VectorSearch::initialize() {
+  const VM_Version::Kernel<SearchKernels>& k = VM_Version::select(search_kernels);
+  atomic_store((void**)&_find_first32, (void*)k.impl.first32);
+  atomic_store((void**)&_find_first64, (void*)k.impl.first64);
+  atomic_store((void**)&_find_last32,  (void*)k.impl.last32);
+  atomic_store((void**)&_find_last64,  (void*)k.impl.last64);
+  atomic_store((void**)&_kernel_name,  (void*)k.name);
+}
+
+int VectorSearch::resolve_first32(const void* data, int len, uint64_t value) {
+  initialize();
+  return _find_first32(data, len, value);
+}
+
+int VectorSearch::resolve_first64(const void* data, int len, uint64_t value) {
+  initialize();
+  return _find_first64(data, len, value);
+}
+
+int VectorSearch::resolve_last32(const void* data, int len, uint64_t value) {
+  initialize();
+  return _find_last32(data, len, value);
+}
+
+int VectorSearch::resolve_last64(const void* data, int len, uint64_t value) {
+  initialize();
+  return _find_last64(data, len, value);
+}
+
+const char* VectorSearch::kernel_name() {
+  if (atomic_load((void* const*)&_kernel_name) == nullptr) {
+    initialize();
+  }
+  return _kernel_name;
+}
@@ -0,0 +1,100 @@
+/*
+ * my_jvm - Vectorized linear search
+ *
+ * OpenJDK 11 里 GrowableArray::find、Array<T>::index_of 都是逐个比较的循环。
+ * 这些查找在热路径上（secondary supers、接口列表、方法数组），元素几乎都是
+ * 指针或 32/64 位整数，这里按 CPU 特性选 SSE2 / AVX2 的比较核心：
+ *
+ *  - 一次比较 4 个（SSE2）或 8 个（AVX2）32 位元素 / 2 个或 4 个 64 位元素
+ *  - 核心在第一次调用时由 VM_Version::select 按 CPU 特性和 -XX:UseAVX 选定，之后通过函数指针调用
+ *  - 非 x86_64 平台、其他元素类型用标量循环
+ *
+ * 短数组函数调用的开销比比较本身大，长度小于 ScalarThreshold 时直接在调用点用标量循环。
+ */
+
+#ifndef MY_JVM_UTILITIES_VECTORSEARCH_HPP
+#define MY_JVM_UTILITIES_VECTORSEARCH_HPP
+
+#include "memory/allocation.hpp"
+#include "utilities/globalDefinitions.hpp"
+#include <cstring>
+#include <type_traits>
+
+class VectorSearch : AllStatic {
+ public:
+  // 返回第一个（find_first）或最后一个（find_last）等于 value 的下标，没有返回 -1
+  typedef int (*SearchFn)(const void* data, int len, uint64_t value);
+
+  enum { ScalarThreshold = 8 };
+
+  // 能走向量核心的元素类型：整数、枚举、指针，宽度 4 或 8 字节
+  template <typename T>
+  struct is_searchable {
+    static const bool value =
+        (std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value) &&
+        (sizeof(T) == 4 || sizeof(T) == 8);
+  };
+
+ private:
+  // [宽度 4/8][正向/反向]，未选定时指向 resolve_* 桩
+  static SearchFn _find_first32;
+  static SearchFn _find_first64;
+  static SearchFn _find_last32;
+  static SearchFn _find_last64;
+  static const char* _kernel_name;
+
+  static void initialize();
+  static int resolve_first32(const void* data, int len, uint64_t value);
+  static int resolve_first64(const void* data, int len, uint64_t value);
+  static int resolve_last32(const void* data, int len, uint64_t value);
+  static int resolve_last64(const void* data, int len, uint64_t value);
+
+  template <typename T>
+  static uint64_t bits(const T& value) {
+    typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type raw;
+    memcpy(&raw, &value, sizeof(T));
+    return raw;
+  }
+
+ public:
+  // 标量版本，也是不能向量化的元素类型的实现
+  template <typename T>
+  static int find_first_scalar(const T* data, int len, const T& value) {
+    for (int i = 0; i < len; i++) {
+      if (data[i] == value) return i;
+    }
+    return -1;
+  }
+
+  template <typename T>
+  static int find_last_scalar(const T* data, int len, const T& value) {
+    int i = len;
+    while (i-- > 0 && !(data[i] == value));
+    return i;
+  }
+
+  template <typename T>
+  static int find_first(const T* data, int len, const T& value) {
+    if constexpr (is_searchable<T>::value) {
+      if (len >= ScalarThreshold) {
+        return (sizeof(T) == 4 ? _find_first32 : _find_first64)(data, len, bits(value));
+      }
+    }
+    return find_first_scalar(data, len, value);
+  }
+
+  template <typename T>
+  static int find_last(const T* data, int len, const T& value) {
+    if constexpr (is_searchable<T>::value) {
+      if (len >= ScalarThreshold) {
+        return (sizeof(T) == 4 ? _find_last32 : _find_last64)(data, len, bits(value));
+      }
+    }
+    return find_last_scalar(data, len, value);
+  }
+
+  // 选中的核心："avx2" / "sse2" / "scalar"
+  static const char* kernel_name();
+};
+
+#endif // MY_JVM_UTILITIES_VECTORSEARCH_HPP
@@ -0,0 +1,1427 @@
+/*
+ * microbench.cpp
+ *
+ * my_jvm 微基准测试（不加入 ctest，手动运行）
+ *
+ * 用法：microbench [name ...]     不带参数时运行全部
+ * 建议用 Release 构建：cmake -DCMAKE_BUILD_TYPE=Release
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "memory/allocation.hpp"
+#include "classfile/classLoaderData.hpp"
+#include "gc/g1/g1CollectedHeap.hpp"
+#include "memory/arena.hpp"
+#include "memory/metaspace.hpp"
+#include "oops/compressedOops.hpp"
+#include "oops/oop.hpp"
+#include "memory/resourceArea.hpp"
+#include "memory/virtualspace.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/mutex.hpp"
+#include "runtime/orderAccess.hpp"
+#include "runtime/os.hpp"
+#include "runtime/thread.hpp"
+#include "runtime/vm_version.hpp"
+#include "services/memTracker.hpp"
+#include "utilities/concurrentHashTable.hpp"
+#include "utilities/copy.hpp"
+#include "utilities/globalCounter.hpp"
+#include "utilities/growableArray.hpp"
+#include "utilities/ostream.hpp"
+#include "utilities/segmentedArray.hpp"
+#include "utilities/stripedCounter.hpp"
+#include "utilities/vectorSearch.hpp"
+
+// ========== 辅助函数 ==========
+
+static double now_seconds() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 防止编译器把结果优化掉
+static volatile uintptr_t bench_sink;
+
+// 在 nthreads 个线程上运行 fn(tid)，返回墙钟时间（秒）
+template <typename F>
+static double run_threads(int nthreads, F fn) {
+    std::vector<std::thread> threads;
+    double start = now_seconds();
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back(fn, t);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    return now_seconds() - start;
+}
+
+static int max_bench_threads() {
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// ========== ResourceArea 多线程分配 ==========
+// 每个线程使用自己的 ResourceArea，吞吐量应随线程数线性增长
+
+static void bench_resource_area_mt() {
+    const int iterations = 200000;
+    const int allocs_per_mark = 32;
+    std::cout << "[resource_area_mt] " << iterations << " marks x "
+              << allocs_per_mark << " allocs per thread" << std::endl;
+
+    double base_rate = 0;
+    for (int nthreads = 1; nthreads <= max_bench_threads(); nthreads *= 2) {
+        double secs = run_threads(nthreads, [&](int) {
+            uintptr_t sum = 0;
+            for (int i = 0; i < iterations; i++) {
+                ResourceMark rm;
+                for (int j = 0; j < allocs_per_mark; j++) {
+                    char* p = NEW_RESOURCE_ARRAY(char, 48);
+                    p[0] = (char)j;
+                    sum += (uintptr_t)p;
+                }
+            }
+            bench_sink = sum;
+        });
+        double rate = (double)nthreads * iterations * allocs_per_mark / secs / 1e6;
+        if (nthreads == 1) base_rate = rate;
+        printf("  threads=%-3d %8.1f Mallocs/s  scaling=%.2fx\n",
+               nthreads, rate, rate / base_rate);
+    }
+}
+
+// ========== AllocateHeap / FreeHeap（NMT 开销） ==========
+// 分别用 -XX:NativeMemoryTracking=off|summary|detail 运行后对比
+
+static void bench_nmt_malloc() {
+    const int iterations = 5000000;
+    const int batch = 64;
+    static const size_t sizes[] = { 16, 48, 128, 512 };
+    std::cout << "[nmt_malloc] NMT="
+              << NMTUtil::tracking_level_to_string(MemTracker::tracking_level())
+              << ", " << iterations << " alloc/free pairs" << std::endl;
+
+    for (size_t size : sizes) {
+        char* blocks[batch];
+        double start = now_seconds();
+        for (int i = 0; i < iterations / batch; i++) {
+            for (int j = 0; j < batch; j++) {
+                blocks[j] = AllocateHeap(size, mtTest);
+            }
+            for (int j = 0; j < batch; j++) {
+                FreeHeap(blocks[j]);
+            }
+        }
+        double secs = now_seconds() - start;
+        printf("  size=%-4zu %6.1f ns/pair\n", size, secs * 1e9 / iterations);
+    }
+}
+
+// ========== NMT 在混合负载上的开销 ==========
+// 模拟加载类：方法、字段放 metaspace，方法表和字段表是 C heap 的 GrowableArray，
+// 名字用 stringStream 拼接，解析用的临时数据放 resource area。
+// AllocateHeap 只占其中一部分时间，用来和 nmt_malloc 的单纯 malloc/free 对照。
+// 各轮取最快的一轮，减小噪声
+
+static uint32_t xorshift(uint32_t* seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+static void nmt_workload_class(ClassLoaderData* cld, int k, uint32_t* seed) {
+    ResourceMark rm;
+    GrowableArray<void*> methods(0, true, mtClass);
+    GrowableArray<void*> fields(0, true, mtClass);
+    int nmethods = 4 + (int)(xorshift(seed) >> 8) % 28;
+    int nfields = 2 + (int)(xorshift(seed) >> 8) % 14;
+    for (int m = 0; m < nmethods; m++) {
+        stringStream name;
+        name.print("Lpkg/Class%d;.method%d(I)V", k, m);
+        // 字节码和常量池引用
+        size_t code_bytes = 16 + (xorshift(seed) >> 8) % 240;
+        char* scratch = NEW_RESOURCE_ARRAY(char, code_bytes);
+        memset(scratch, m, code_bytes);
+        size_t words = align_up(code_bytes + name.size(), (size_t)BytesPerWord) / BytesPerWord;
+        char* method = (char*)Metaspace::allocate(cld, words);
+        memcpy(method, scratch, code_bytes);
+        memcpy(method + code_bytes, name.base(), name.size());
+        methods.append(method);
+    }
+    for (int f = 0; f < nfields; f++) {
+        stringStream name;
+        name.print("field%d", f);
+        void* field = Metaspace::allocate(cld, 4);
+        memcpy(field, name.base(), MIN2(name.size(), (size_t)32));
+        fields.append(field);
+    }
+    bench_sink += (uintptr_t)methods.at(0) + (uintptr_t)fields.length();
+}
+
+static void bench_nmt_workload() {
+    const int loaders = 20;
+    const int classes_per_loader = 500;
+    const int rounds = 7;
+    std::cout << "[nmt_workload] NMT="
+              << NMTUtil::tracking_level_to_string(MemTracker::tracking_level())
+              << ", " << loaders << " loaders x " << classes_per_loader
+              << " classes, load then unload, best of " << rounds << std::endl;
+
+    double best = 1e30;
+    for (int round = 0; round < rounds; round++) {
+        uint32_t seed = 2463534242u;
+        double start = now_seconds();
+        for (int l = 0; l < loaders; l++) {
+            ClassLoaderData* cld = new ClassLoaderData();
+            for (int k = 0; k < classes_per_loader; k++) {
+                nmt_workload_class(cld, k, &seed);
+            }
+            delete cld;
+        }
+        best = MIN2(best, now_seconds() - start);
+    }
+    printf("  %8.1f ns/class\n", best * 1e9 / (loaders * classes_per_loader));
+}
+
+// ========== Arena::used / Arena::contains ==========
+// Chunk 数增长时两者的耗时应保持平坦
+
+static void bench_arena_queries() {
+    const int lookups = 1000000;
+    std::cout << "[arena_queries] " << lookups << " calls each" << std::endl;
+
+    for (int nchunks = 1; nchunks <= 4096; nchunks *= 4) {
+        Arena arena(mtTest);
+        std::vector<char*> ptrs;
+        for (int i = 0; i < nchunks; i++) {
+            // 超过 large_threshold，每次分配独占一个 Chunk
+            ptrs.push_back((char*)arena.Amalloc(16000));
+        }
+
+        // 经 volatile 指针调用，防止 used() 被提到循环外
+        Arena* volatile ap = &arena;
+        uintptr_t sum = 0;
+        double start = now_seconds();
+        for (int i = 0; i < lookups; i++) {
+            sum += ap->used();
+        }
+        double used_ns = (now_seconds() - start) * 1e9 / lookups;
+
+        start = now_seconds();
+        for (int i = 0; i < lookups; i++) {
+            sum += ap->contains(ptrs[((size_t)i * 7919) % ptrs.size()]) ? 1 : 0;
+        }
+        double contains_ns = (now_seconds() - start) * 1e9 / lookups;
+        bench_sink = sum;
+
+        printf("  chunks=%-5d used() %6.2f ns   contains() %6.2f ns\n",
+               nchunks, used_ns, contains_ns);
+    }
+}
+
+// ========== Arena 增长策略 ==========
+// 模拟编译器 Arena：大量小分配夹杂少量 12K~64K 的大分配，
+// 比较固定 32K Chunk、加大请求旁路、再加翻倍增长三种策略
+
+static void bench_arena_growth() {
+    const size_t total = 64 * 1024 * 1024;
+    const int rounds = 8;
+    std::cout << "[arena_growth] " << (total >> 20) << "M per arena x " << rounds << " rounds" << std::endl;
+
+    struct Config {
+        const char* name;
+        ArenaGrowthPolicy policy;
+    };
+    const Config configs[] = {
+        { "fixed",            { Chunk::size, Chunk::size, 0, false } },
+        { "fixed+bypass",     { Chunk::size, Chunk::size, Chunk::medium_size, false } },
+        { "geometric+bypass", { Chunk::size, 1024 * 1024 - Chunk::slack, Chunk::medium_size, false } },
+    };
+
+    const ArenaGrowthPolicy saved = Arena::growth_policy(mtTest);
+    for (const Config& c : configs) {
+        Arena::set_growth_policy(mtTest, c.policy);
+        ArenaStatistics st;
+        size_t nallocs = 0;
+        double cold = 0;
+        double start = now_seconds();
+        for (int r = 0; r < rounds; r++) {
+            Arena arena(mtTest);
+            uint32_t seed = 12345;
+            size_t allocated = 0;
+            nallocs = 0;
+            while (allocated < total) {
+                seed = seed * 1103515245 + 12345;
+                size_t size = (seed >> 16) % 500 == 0 ? 12 * 1024 + (seed >> 8) % (52 * 1024)
+                                                      : 16 + (seed >> 8) % 200;
+                char* p = (char*)arena.Amalloc(size);
+                p[0] = (char)size;
+                allocated += ARENA_ALIGN(size);
+                nallocs++;
+            }
+            arena.statistics(&st);
+            if (r == 0) {
+                cold = now_seconds() - start;
+            }
+        }
+        double warm = now_seconds() - start - cold;
+        // 第一轮的内存都是新触碰的；之后各轮能复用多少已释放的 Chunk 取决于策略
+        printf("  %-17s first %6.2f ns/alloc  reuse %6.2f ns/alloc  chunks=%-6zu wasted=%5.2f%%\n",
+               c.name, cold * 1e9 / nallocs, warm * 1e9 / ((double)nallocs * (rounds - 1)),
+               st.chunks, 100.0 * st.wasted() / st.size_in_bytes);
+    }
+    Arena::set_growth_policy(mtTest, saved);
+}
+
+// ========== 大页 Chunk ==========
+// 在 512M 的 Arena 里随机读写链表节点，TLB 缺失占主导；
+// 比较 malloc 的 32K Chunk 和 2M 大页 Chunk
+
+static void bench_arena_huge_pages() {
+    const size_t total = 512 * 1024 * 1024;
+    const size_t node_size = 64;
+    const size_t steps = 20000000;
+    std::cout << "[arena_huge_pages] " << (total >> 20) << "M arena, " << steps
+              << " dependent loads (THP " << (os::can_use_transparent_huge_pages() ? "available" : "unavailable")
+              << ")" << std::endl;
+
+    const ArenaGrowthPolicy saved = Arena::growth_policy(mtTest);
+    const bool saved_flag = UseTransparentHugePages;
+    for (int huge = 0; huge <= 1; huge++) {
+        UseTransparentHugePages = (huge != 0);
+        Arena::set_growth_policy(mtTest, { Chunk::size, Chunk::size, Chunk::medium_size, huge != 0 });
+
+        Arena arena(mtTest);
+        const size_t nnodes = total / node_size;
+        std::vector<char*> nodes(nnodes);
+        double start = now_seconds();
+        for (size_t i = 0; i < nnodes; i++) {
+            nodes[i] = (char*)arena.Amalloc(node_size);
+            memset(nodes[i], 0, node_size);
+        }
+        double fill_secs = now_seconds() - start;
+
+        // 把节点按随机顺序串成一个环，逐个追指针
+        uint64_t seed = 88172645463325252ULL;
+        for (size_t i = nnodes - 1; i > 0; i--) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            std::swap(nodes[i], nodes[seed % (i + 1)]);
+        }
+        for (size_t i = 0; i < nnodes; i++) {
+            *(char**)nodes[i] = nodes[(i + 1) % nnodes];
+        }
+        char* cur = nodes[0];
+        std::vector<char*>().swap(nodes);
+
+        start = now_seconds();
+        for (size_t i = 0; i < steps; i++) {
+            cur = *(char**)cur;
+        }
+        double chase_secs = now_seconds() - start;
+        bench_sink = (uintptr_t)cur;
+
+        ArenaStatistics st;
+        arena.statistics(&st);
+        printf("  %-6s fill %6.2f ns/node  chase %6.2f ns/load  chunks=%-6zu huge pages %5.1f%%\n",
+               huge ? "huge" : "malloc", fill_secs * 1e9 / nnodes, chase_secs * 1e9 / steps,
+               st.chunks, 100.0 * st.huge_page_coverage());
+    }
+    UseTransparentHugePages = saved_flag;
+    Arena::set_growth_policy(mtTest, saved);
+}
+
+// ========== SlabAllocator vs glibc malloc ==========
+// 每个线程维护 1024 个槽，随机挑一个槽释放旧块、分配新块（16~512 字节）
+
+enum HeapBenchMode { heap_glibc, heap_allocate_malloc, heap_allocate_slab };
+
+static void heap_mix(HeapBenchMode mode, int tid, size_t ops) {
+    const int slots = 1024;
+    void* live[slots] = {};
+    uint32_t seed = 2463534242u + tid;
+    for (size_t i = 0; i < ops; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int slot = seed % slots;
+        size_t size = 16 + (seed >> 12) % 497;
+        if (mode == heap_glibc) {
+            std::free(live[slot]);
+            live[slot] = std::malloc(size);
+        } else {
+            FreeHeap(live[slot]);
+            live[slot] = AllocateHeap(size, mtTest);
+        }
+        *(char*)live[slot] = (char)i;
+    }
+    for (int i = 0; i < slots; i++) {
+        if (mode == heap_glibc) {
+            std::free(live[i]);
+        } else {
+            FreeHeap(live[i]);
+        }
+    }
+}
+
+static void bench_slab_allocator() {
+    const size_t total_ops = 8000000;
+    std::cout << "[slab_allocator] " << total_ops << " free+alloc pairs, 16-512 bytes" << std::endl;
+
+    const bool saved = UseSlabAllocator;
+    const int thread_counts[] = { 1, 32 };
+    const struct {
+        const char*   name;
+        HeapBenchMode mode;
+    } modes[] = {
+        { "glibc malloc",          heap_glibc           },
+        { "AllocateHeap (malloc)", heap_allocate_malloc },
+        { "AllocateHeap (slab)",   heap_allocate_slab   },
+    };
+    for (int nthreads : thread_counts) {
+        size_t ops = total_ops / nthreads;
+        for (const auto& m : modes) {
+            UseSlabAllocator = (m.mode == heap_allocate_slab);
+            double secs = run_threads(nthreads, [&](int tid) { heap_mix(m.mode, tid, ops); });
+            printf("  threads=%-3d %-22s %6.1f ns/pair\n", nthreads, m.name,
+                   secs * 1e9 / ((double)ops * nthreads));
+        }
+    }
+    UseSlabAllocator = saved;
+}
+
+// ========== Metaspace vs malloc ==========
+// 模拟类加载：每个 loader 分配大量 16~512 字节的元数据，然后整体卸载。
+// malloc 版本必须逐个 free；Metaspace 版本卸载时整串 chunk 一次归还
+
+static void bench_metaspace() {
+    const int loaders = 200;
+    const int allocs_per_loader = 5000;
+    std::cout << "[metaspace] " << loaders << " loaders x " << allocs_per_loader
+              << " allocations (16-512 bytes), then unload" << std::endl;
+
+    for (int round = 0; round < 2; round++) {
+        std::vector<void*> blocks((size_t)loaders * allocs_per_loader);
+        uint32_t seed = 2463534242u;
+
+        double start = now_seconds();
+        for (size_t i = 0; i < blocks.size(); i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            size_t size = 16 + (seed >> 12) % 497;
+            blocks[i] = std::malloc(size);
+            memset(blocks[i], 0, size);
+        }
+        double alloc_malloc = now_seconds() - start;
+        start = now_seconds();
+        for (void* p : blocks) {
+            std::free(p);
+        }
+        double unload_malloc = now_seconds() - start;
+
+        std::vector<ClassLoaderData*> clds(loaders);
+        seed = 2463534242u;
+        start = now_seconds();
+        for (int l = 0; l < loaders; l++) {
+            clds[l] = new ClassLoaderData();
+            for (int i = 0; i < allocs_per_loader; i++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                size_t size = 16 + (seed >> 12) % 497;
+                size_t words = align_up(size, (size_t)BytesPerWord) / BytesPerWord;
+                bench_sink += (uintptr_t)Metaspace::allocate(clds[l], words);
+            }
+        }
+        double alloc_meta = now_seconds() - start;
+        start = now_seconds();
+        for (ClassLoaderData* cld : clds) {
+            delete cld;
+        }
+        double unload_meta = now_seconds() - start;
+
+        double n = (double)blocks.size();
+        printf("  round %d  malloc:    %6.1f ns/alloc  unload %7.2f ms\n", round,
+               alloc_malloc * 1e9 / n, unload_malloc * 1e3);
+        printf("  round %d  metaspace: %6.1f ns/alloc  unload %7.2f ms\n", round,
+               alloc_meta * 1e9 / n, unload_meta * 1e3);
+    }
+}
+
+// ========== 压缩类指针解码 ==========
+// 在一段模拟堆上放 1M 个对象，每个对象头指向 64 个 Klass 之一，
+// 遍历读 klass()->layout_helper()，对比直接指针和 narrowKlass 解码
+
+static void bench_klass_decode() {
+    const int nobjs = 1 << 20;
+    const int nklasses = 64;
+    const int rounds = 20;
+    std::cout << "[klass_decode] " << nobjs << " objects x " << rounds << " rounds" << std::endl;
+
+    ClassLoaderData cld;
+    Klass* klasses[nklasses];
+    for (int i = 0; i < nklasses; i++) {
+        klasses[i] = new (&cld) Klass();
+        klasses[i]->set_layout_helper(16 + i * 8);
+    }
+
+    const bool saved = UseCompressedClassPointers;
+    const bool modes[] = { false, true };
+    for (bool compressed : modes) {
+        UseCompressedClassPointers = compressed;
+        // 对象之间隔 24 字节（最小对象 + 一个字段）
+        const size_t stride = 24;
+        std::vector<char> heap((size_t)nobjs * stride);
+        uint32_t seed = 2463534242u;
+        for (int i = 0; i < nobjs; i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            ((oopDesc*)&heap[(size_t)i * stride])->set_klass(klasses[seed % nklasses]);
+        }
+        double start = now_seconds();
+        uintptr_t sum = 0;
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < nobjs; i++) {
+                sum += ((oopDesc*)&heap[(size_t)i * stride])->klass()->layout_helper();
+            }
+        }
+        double secs = now_seconds() - start;
+        bench_sink += sum;
+        printf("  %-26s %5.2f ns/object\n",
+               compressed ? "narrowKlass (decode)" : "Klass* (uncompressed)",
+               secs * 1e9 / ((double)nobjs * rounds));
+    }
+    UseCompressedClassPointers = saved;
+    printf("  narrowKlass base=%p shift=%d\n", (void*)CompressedKlassPointers::base(),
+           CompressedKlassPointers::shift());
+}
+
+// ========== 压缩对象指针 ==========
+// 在 Java 堆里放 1M 个对象，每个对象 4 个引用字段随机指向其他对象，
+// 从一个对象出发沿引用走 N 步（每步读一个字段）。对比：
+//   oop 字段（8 字节）、narrowOop + 通用解码、narrowOop + 按模式实例化的模板解码
+
+enum OopBenchMode { oop_uncompressed, oop_generic, oop_template };
+
+template <CompressedOops::Mode M>
+static uintptr_t chase_narrow(oop start, int field_base, int oop_size, size_t steps) {
+    oop o = start;
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < steps; i++) {
+        int slot = (int)((uintptr_t)o >> 4) & 3;
+        o = o->obj_field_narrow<M>(field_base + slot * oop_size);
+        sum += (uintptr_t)o;
+    }
+    return sum;
+}
+
+static uintptr_t chase_runtime(oop start, int field_base, int oop_size, size_t steps) {
+    oop o = start;
+    uintptr_t sum = 0;
+    for (size_t i = 0; i < steps; i++) {
+        int slot = (int)((uintptr_t)o >> 4) & 3;
+        o = o->obj_field(field_base + slot * oop_size);
+        sum += (uintptr_t)o;
+    }
+    return sum;
+}
+
+static void bench_compressed_oops() {
+    const size_t nobjs = 1 << 20;
+    const size_t steps = 20000000;
+    std::cout << "[compressed_oops] " << nobjs << " objects x 4 reference fields, "
+              << steps << " dependent loads" << std::endl;
+
+    const bool saved = UseCompressedOops;
+    const struct {
+        const char*  name;
+        OopBenchMode mode;
+    } modes[] = {
+        { "oop (8-byte fields)",    oop_uncompressed },
+        { "narrowOop generic",      oop_generic      },
+        { "narrowOop template",     oop_template     },
+    };
+    for (const auto& m : modes) {
+        UseCompressedOops = (m.mode != oop_uncompressed);
+        const int oop_size = heap_oop_size();
+        // 8 字节引用字段不放进 klass gap
+        const int field_base = align_up(instanceOopDesc::base_offset_in_bytes(), oop_size);
+        const size_t obj_size = align_up((size_t)field_base + 4 * oop_size, (size_t)MinObjAlignmentInBytes);
+
+        ReservedHeapSpace rs(nobjs * obj_size, 2 * 1024 * 1024);
+        uint32_t seed = 2463534242u;
+        for (size_t i = 0; i < nobjs; i++) {
+            oop o = (oop)(rs.base() + i * obj_size);
+            for (int f = 0; f < 4; f++) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                o->obj_field_put(field_base + f * oop_size, (oop)(rs.base() + (seed % nobjs) * obj_size));
+            }
+        }
+
+        oop start = (oop)rs.base();
+        double t = now_seconds();
+        uintptr_t sum;
+        if (m.mode == oop_template) {
+            sum = CompressedOops::dispatch([&](auto mode) {
+                return chase_narrow<decltype(mode)::value>(start, field_base, oop_size, steps);
+            });
+        } else {
+            sum = chase_runtime(start, field_base, oop_size, steps);
+        }
+        double secs = now_seconds() - t;
+        bench_sink += sum;
+        printf("  %-22s obj=%2zu bytes heap=%4zuM %6.2f ns/load%s%s\n", m.name, obj_size,
+               rs.size() >> 20, secs * 1e9 / steps,
+               UseCompressedOops ? "  mode=" : "",
+               UseCompressedOops ? CompressedOops::mode_to_string(CompressedOops::mode()) : "");
+        rs.release();
+    }
+    UseCompressedOops = saved;
+}
+
+// ========== TLAB 分配 ==========
+// 对象在线程的 TLAB 里 bump 分配，对比 malloc；多线程时 TLAB 不共享任何状态，
+// 只有 refill 时才在 eden region 上 CAS。堆不回收，总分配量固定
+
+static void bench_tlab_alloc() {
+    const size_t total_objs = 8 * 1024 * 1024;
+    const size_t obj_words = 4;
+    const int max_threads = max_bench_threads();
+    std::cout << "[tlab_alloc] " << total_objs << " objects x " << obj_words * HeapWordSize
+              << " bytes per run" << std::endl;
+
+    // 每个线程数跑一次 TLAB，堆要放得下全部
+    int runs = 0;
+    for (int n = 1; n <= max_threads; n *= 2) runs++;
+    if (G1CollectedHeap::heap() == nullptr &&
+        !G1CollectedHeap::initialize(align_up(total_objs * obj_words * HeapWordSize * runs * 5 / 4,
+                                              (size_t)64 * 1024 * 1024))) {
+        std::cout << "  heap reservation failed" << std::endl;
+        return;
+    }
+
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        const size_t per_thread = total_objs / nthreads;
+
+        double t_tlab = run_threads(nthreads, [&](int) {
+            uintptr_t sum = 0;
+            for (size_t i = 0; i < per_thread; i++) {
+                HeapWord* p = G1CollectedHeap::allocate(obj_words);
+                p[0] = i;
+                sum += (uintptr_t)p;
+            }
+            bench_sink += sum;
+        });
+
+        std::vector<std::vector<void*>> blocks(nthreads);
+        for (auto& v : blocks) v.reserve(per_thread);
+        double t_malloc = run_threads(nthreads, [&](int tid) {
+            std::vector<void*>& v = blocks[tid];
+            for (size_t i = 0; i < per_thread; i++) {
+                HeapWord* p = (HeapWord*)::malloc(obj_words * HeapWordSize);
+                p[0] = i;
+                v.push_back(p);
+            }
+        });
+        for (auto& v : blocks) {
+            for (void* p : v) ::free(p);
+        }
+
+        printf("  threads=%2d tlab %6.2f ns/obj  malloc %6.2f ns/obj  speedup %.1fx\n", nthreads,
+               t_tlab * 1e9 / total_objs, t_malloc * 1e9 / total_objs, t_malloc / t_tlab);
+    }
+}
+
+// ========== GrowableArray append ==========
+// 从空数组开始反复 append，对比 std::vector。平凡类型在 Arena 里原地扩展，
+// C 堆上 memcpy；std::string 扩容时移动
+
+template <typename E, typename Make>
+static void growable_append_round(const char* type_name, int rounds, int n, Make make) {
+    double t;
+    uintptr_t sum = 0;
+
+    t = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        std::vector<E> v;
+        for (int i = 0; i < n; i++) v.push_back(make(i));
+        sum += v.size();
+    }
+    double t_vector = now_seconds() - t;
+
+    t = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        GrowableArray<E> a(0, true, mtTest);
+        for (int i = 0; i < n; i++) a.append(make(i));
+        sum += a.length();
+    }
+    double t_cheap = now_seconds() - t;
+
+    t = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        ResourceMark rm;
+        GrowableArray<E> a(0);
+        for (int i = 0; i < n; i++) a.append(make(i));
+        sum += a.length();
+        a.clear();
+    }
+    double t_resource = now_seconds() - t;
+    bench_sink += sum;
+
+    double total = (double)rounds * n;
+    printf("  %-12s n=%-7d std::vector %5.2f  GrowableArray C heap %5.2f  resource area %5.2f ns/append\n",
+           type_name, n, t_vector * 1e9 / total, t_cheap * 1e9 / total, t_resource * 1e9 / total);
+}
+
+static void bench_growable_array() {
+    std::cout << "[growable_array] append from empty, capacity doubling" << std::endl;
+    const int sizes[] = { 16, 1024, 1 << 20 };
+    for (int n : sizes) {
+        int rounds = (1 << 24) / n;
+        growable_append_round<jint>("jint", rounds, n, [](int i) { return (jint)i; });
+    }
+    for (int n : sizes) {
+        int rounds = (1 << 22) / n;
+        growable_append_round<std::string>("std::string", rounds, n,
+                                           [](int i) { return std::string(i & 7, 'x'); });
+    }
+}
+
+// ========== 线性查找 ==========
+// GrowableArray::find / Array<T>::index_of 的核心，对比标量循环。
+// 查找的值一半命中（位置随机）一半不命中
+
+template <typename T>
+static void vector_search_round(const char* type_name, int len, T (*make)(int)) {
+    std::vector<T> data(len);
+    for (int i = 0; i < len; i++) data[i] = make(i);
+    const int nkeys = 256;
+    T keys[nkeys];
+    uint32_t seed = 12345;
+    for (int k = 0; k < nkeys; k++) {
+        seed = seed * 1103515245u + 12345u;
+        keys[k] = (k & 1) ? make(len + (int)(seed % 1000)) : data[(seed >> 8) % len];
+    }
+    const long total = 20000000L / len + nkeys;
+    long iters = total - total % nkeys;
+
+    double t = now_seconds();
+    long sum = 0;
+    for (long i = 0; i < iters; i++) {
+        sum += VectorSearch::find_first_scalar(data.data(), len, keys[i % nkeys]);
+    }
+    double t_scalar = now_seconds() - t;
+
+    t = now_seconds();
+    for (long i = 0; i < iters; i++) {
+        sum += VectorSearch::find_first(data.data(), len, keys[i % nkeys]);
+    }
+    double t_vector = now_seconds() - t;
+    bench_sink += sum;
+
+    printf("  %-6s len=%-6d scalar %8.1f ns  %s %8.1f ns  speedup %.1fx\n", type_name, len,
+           t_scalar * 1e9 / iters, VectorSearch::kernel_name(), t_vector * 1e9 / iters,
+           t_scalar / t_vector);
+}
+
+static jint   search_int(int i) { return i * 7 + 1; }
+static void*  search_ptr(int i) { return (void*)(uintptr_t)(0x7f0000000000ULL + (uintptr_t)i * 64); }
+
+static void bench_vector_search() {
+    std::cout << "[vector_search] linear search, half hits / half misses" << std::endl;
+    const int lens[] = { 8, 16, 64, 256, 1000, 10000 };
+    for (int len : lens) {
+        vector_search_round<jint>("jint", len, search_int);
+    }
+    for (int len : lens) {
+        vector_search_round<void*>("void*", len, search_ptr);
+    }
+}
+
+// ========== 排序与二分查找 ==========
+// QuickSort（比较器内联）对比 qsort（函数指针）和 std::sort；
+// 有序 GrowableArray 的 find_sorted 对比线性 find
+
+static int sort_compare(const jint& a, const jint& b) {
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int qsort_compare(const void* a, const void* b) {
+    return sort_compare(*(const jint*)a, *(const jint*)b);
+}
+
+static void bench_sorted_array() {
+    const int n = 1 << 20;
+    std::cout << "[sorted_array] sort " << n << " random jints, then lookups" << std::endl;
+
+    std::vector<jint> input(n);
+    uint32_t seed = 1;
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = (jint)seed;
+    }
+    std::vector<jint> v;
+    double t;
+
+    v = input;
+    t = now_seconds();
+    qsort(v.data(), v.size(), sizeof(jint), qsort_compare);
+    printf("  qsort            %7.1f ms\n", (now_seconds() - t) * 1e3);
+
+    v = input;
+    t = now_seconds();
+    std::sort(v.begin(), v.end());
+    printf("  std::sort        %7.1f ms\n", (now_seconds() - t) * 1e3);
+
+    GrowableArray<jint> a(n, true, mtTest);
+    for (int i = 0; i < n; i++) a.append(input[i]);
+    t = now_seconds();
+    a.sort<sort_compare>();
+    printf("  QuickSort        %7.1f ms\n", (now_seconds() - t) * 1e3);
+
+    const int sizes[] = { 16, 128, 1024, 10000 };
+    for (int len : sizes) {
+        GrowableArray<jint> s(len, true, mtTest);
+        for (int i = 0; i < len; i++) s.append(i * 3);
+        const long lookups = 4000000;
+        long sum = 0;
+        bool found;
+        t = now_seconds();
+        for (long i = 0; i < lookups; i++) {
+            sum += s.find_sorted<jint, sort_compare>((jint)((i * 7) % (3 * len)), found);
+        }
+        double t_binary = now_seconds() - t;
+        t = now_seconds();
+        for (long i = 0; i < lookups; i++) {
+            sum += s.find((jint)((i * 7) % (3 * len)));
+        }
+        double t_linear = now_seconds() - t;
+        bench_sink += sum;
+        printf("  len=%-6d find_sorted %6.1f ns  find (%s) %8.1f ns\n", len,
+               t_binary * 1e9 / lookups, VectorSearch::kernel_name(), t_linear * 1e9 / lookups);
+    }
+}
+
+// ========== 并发追加 ==========
+// 多个线程往同一个登记表里追加指针：SegmentedArray（atomic_add 领下标）
+// 对比 GrowableArray + 自旋锁
+
+static void bench_segmented_array() {
+    const int total = 4000000;
+    std::cout << "[segmented_array] " << total << " concurrent appends" << std::endl;
+
+    const int thread_counts[] = { 1, 4, 16 };
+    for (int nthreads : thread_counts) {
+        const int per_thread = total / nthreads;
+
+        SegmentedArray<void*, mtTest>* seg = new SegmentedArray<void*, mtTest>();
+        double t_seg = run_threads(nthreads, [&](int tid) {
+            for (int i = 0; i < per_thread; i++) {
+                seg->append((void*)(uintptr_t)((tid << 24) | i));
+            }
+        });
+        delete seg;
+
+        GrowableArray<void*> locked(0, true, mtTest);
+        volatile jint lock = 0;
+        double t_locked = run_threads(nthreads, [&](int tid) {
+            for (int i = 0; i < per_thread; i++) {
+                while (atomic_xchg((jint*)&lock, 1) != 0) {
+                    while (lock != 0) {
+                    }
+                }
+                locked.append((void*)(uintptr_t)((tid << 24) | i));
+                atomic_store((jint*)&lock, 0);
+            }
+        });
+
+        printf("  threads=%-3d SegmentedArray %6.1f ns/append  GrowableArray+lock %6.1f ns/append\n",
+               nthreads, t_seg * 1e9 / total, t_locked * 1e9 / total);
+    }
+}
+
+// ========== Atomic 内存序的开销 ==========
+// 单线程下每种内存序的读、写、读改写和屏障各自要多少 ns。
+// x86-64（TSO）上 acquire 读 / release 写就是普通 mov，只有 conservative 写（xchg）、
+// 读改写（lock 前缀）和 storeload 屏障真正花钱；弱内存序平台（aarch64 等）上
+// acquire/release 会变成 ldar/stlr，差距在那里测才能看到。
+
+static void bench_atomic_orderings() {
+    const int iters = 50000000;
+#if defined(__x86_64__)
+    const char* arch = "x86-64";
+#elif defined(__aarch64__)
+    const char* arch = "aarch64";
+#else
+    const char* arch = "other";
+#endif
+    std::cout << "[atomic_orderings] " << iters << " ops each, " << arch << std::endl;
+
+    static volatile uintptr_t cell = 0;
+    static volatile uintptr_t other = 0;
+
+    auto report = [&](const char* name, double t) {
+        printf("  %-28s %6.2f ns/op\n", name, t * 1e9 / iters);
+    };
+    auto time_it = [&](const char* name, auto op) {
+        double start = now_seconds();
+        for (int i = 0; i < iters; i++) {
+            op(i);
+        }
+        report(name, now_seconds() - start);
+    };
+
+    uintptr_t sum = 0;
+    time_it("plain volatile load",       [&](int) { sum += cell; });
+    time_it("load relaxed",              [&](int) { sum += Atomic::load(&cell); });
+    time_it("load acquire",              [&](int) { sum += Atomic::load(&cell, memory_order_acquire); });
+    time_it("load conservative",         [&](int) { sum += Atomic::load(&cell, memory_order_conservative); });
+    time_it("store relaxed",             [&](int i) { Atomic::store(&cell, (uintptr_t)i); });
+    time_it("store release",             [&](int i) { Atomic::store(&cell, (uintptr_t)i, memory_order_release); });
+    time_it("store conservative",        [&](int i) { Atomic::store(&cell, (uintptr_t)i, memory_order_conservative); });
+    time_it("fetch_and_add relaxed",     [&](int) { Atomic::fetch_and_add(&cell, 1, memory_order_relaxed); });
+    time_it("fetch_and_add conservative",[&](int) { Atomic::fetch_and_add(&cell, 1); });
+    time_it("fetch_and_or relaxed",      [&](int i) { Atomic::fetch_and_or(&cell, (uintptr_t)(i & 8), memory_order_relaxed); });
+    time_it("cmpxchg conservative",      [&](int i) { Atomic::cmpxchg(&cell, (uintptr_t)i, (uintptr_t)i + 1); });
+    time_it("loadload",                  [&](int) { sum += cell; OrderAccess::loadload(); sum += other; });
+    time_it("storestore",                [&](int i) { cell = i; OrderAccess::storestore(); other = i; });
+    time_it("storeload (lock addl)",     [&](int i) { cell = i; OrderAccess::storeload(); sum += other; });
+    time_it("storeload (mfence)",        [&](int i) { cell = i; __atomic_thread_fence(__ATOMIC_SEQ_CST); sum += other; });
+    bench_sink = sum;
+}
+
+// ========== VM 内部锁 ==========
+// 无竞争：一次 lock/unlock 的开销，和旧的 xchg 自旋锁、pthread_mutex 对比。
+// 有竞争：nthreads 个线程抢同一把锁做很短的临界区，看吞吐量
+
+static void bench_locks() {
+    const int iters = 20000000;
+    std::cout << "[locks] uncontended, " << iters << " lock/unlock pairs" << std::endl;
+
+    static volatile jlong counter = 0;
+    SpinLock spin(SpinLock::leaf, "bench spin");
+    Mutex mutex(Mutex::leaf, "bench mutex");
+    pthread_mutex_t pmutex = PTHREAD_MUTEX_INITIALIZER;
+    volatile jint xchg_lock = 0;
+
+    auto report = [&](const char* name, double t, int ops) {
+        printf("  %-24s %6.2f ns/pair\n", name, t * 1e9 / ops);
+    };
+
+    double start = now_seconds();
+    for (int i = 0; i < iters; i++) {
+        while (atomic_xchg((jint*)&xchg_lock, 1) != 0) {
+        }
+        counter = counter + 1;
+        atomic_store((jint*)&xchg_lock, 0);
+    }
+    report("xchg spin (old)", now_seconds() - start, iters);
+
+    start = now_seconds();
+    for (int i = 0; i < iters; i++) {
+        spin.lock();
+        counter = counter + 1;
+        spin.unlock();
+    }
+    report("SpinLock", now_seconds() - start, iters);
+
+    start = now_seconds();
+    for (int i = 0; i < iters; i++) {
+        mutex.lock();
+        counter = counter + 1;
+        mutex.unlock();
+    }
+    report("Mutex", now_seconds() - start, iters);
+
+    start = now_seconds();
+    for (int i = 0; i < iters; i++) {
+        pthread_mutex_lock(&pmutex);
+        counter = counter + 1;
+        pthread_mutex_unlock(&pmutex);
+    }
+    report("pthread_mutex", now_seconds() - start, iters);
+
+    const int total = 4000000;
+    std::cout << "[locks] contended, " << total << " critical sections in total" << std::endl;
+    const int thread_counts[] = { 1, 4, 16 };
+    for (int nthreads : thread_counts) {
+        const int per_thread = total / nthreads;
+        double t_spin = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                spin.lock();
+                counter = counter + 1;
+                spin.unlock();
+            }
+        });
+        double t_mutex = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                mutex.lock();
+                counter = counter + 1;
+                mutex.unlock();
+            }
+        });
+        double t_pthread = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                pthread_mutex_lock(&pmutex);
+                counter = counter + 1;
+                pthread_mutex_unlock(&pmutex);
+            }
+        });
+        printf("  threads=%-3d SpinLock %6.1f  Mutex %6.1f  pthread_mutex %6.1f ns/section\n",
+               nthreads, t_spin * 1e9 / total, t_mutex * 1e9 / total, t_pthread * 1e9 / total);
+    }
+    bench_sink = (uintptr_t)counter;
+}
+
+// ========== 统计计数器 ==========
+// 所有线程加同一个计数：单个原子字 vs StripedCounter vs PerThreadCounter。
+// 多核上单个原子字的缓存行在核之间来回传递，后两者应基本不随线程数变慢
+
+static void bench_striped_counter() {
+    const int total = 32000000;
+    std::cout << "[striped_counter] " << total << " increments in total ("
+              << max_bench_threads() << " cpus)" << std::endl;
+
+    const int thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for (int nthreads : thread_counts) {
+        const int per_thread = total / nthreads;
+        static volatile jlong single = 0;
+        StripedCounter* striped = new StripedCounter();
+        PerThreadCounter* per_thread_counter = new PerThreadCounter();
+
+        double t_single = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                Atomic::inc(&single, memory_order_relaxed);
+            }
+        });
+        double t_striped = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                striped->inc();
+            }
+        });
+        double t_local = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                per_thread_counter->inc();
+            }
+        });
+        guarantee(striped->sum() == (jlong)per_thread * nthreads, "striped sum");
+        guarantee(per_thread_counter->sum() == (jlong)per_thread * nthreads, "per-thread sum");
+        printf("  threads=%-3d atomic %6.2f  striped %6.2f (%2d cells)  per-thread %6.2f ns/inc\n",
+               nthreads, t_single * 1e9 / total, t_striped * 1e9 / total, striped->cells(),
+               t_local * 1e9 / total);
+        delete striped;
+        delete per_thread_counter;
+    }
+}
+
+// ========== GlobalCounter ==========
+// 读端进入/退出临界区的开销：只写本线程的计数。对照组是所有读者共用一个
+// 原子读者计数（读写锁的读端），线程一多就在同一条缓存行上来回争抢
+
+static void bench_global_counter() {
+    const int total = 20000000;
+    std::cout << "[global_counter] read-side critical sections, " << total << " in total" << std::endl;
+    static volatile jlong shared_readers = 0;
+
+    const int thread_counts[] = { 1, 4, 16, 64 };
+    for (int nthreads : thread_counts) {
+        const int per_thread = total / nthreads;
+        double t_rcu = run_threads(nthreads, [&](int) {
+            Thread* thread = Thread::current();
+            for (int i = 0; i < per_thread; i++) {
+                GlobalCounter::CriticalSection cs(thread);
+                bench_sink = i;
+            }
+        });
+        double t_shared = run_threads(nthreads, [&](int) {
+            for (int i = 0; i < per_thread; i++) {
+                Atomic::inc(&shared_readers);
+                bench_sink = i;
+                Atomic::dec(&shared_readers, memory_order_release);
+            }
+        });
+        printf("  threads=%-3d GlobalCounter %6.2f ns/section   shared reader count %6.2f ns/section\n",
+               nthreads, t_rcu * 1e9 / total, t_shared * 1e9 / total);
+    }
+
+    // 写端：没有读者在临界区时 write_synchronize 的耗时，以及延迟释放的吞吐量
+    Thread::current();   // 主线程也注册，write_synchronize 至少要检查一个线程
+    const int syncs = 200000;
+    double start = now_seconds();
+    for (int i = 0; i < syncs; i++) {
+        GlobalCounter::write_synchronize();
+    }
+    printf("  write_synchronize (%d threads attached)  %6.1f ns\n",
+           Threads::number_of_threads(), (now_seconds() - start) * 1e9 / syncs);
+
+    const int frees = 2000000;
+    DeferredFree* df = new DeferredFree();
+    start = now_seconds();
+    for (int i = 0; i < frees; i++) {
+        df->defer(AllocateHeap(32, mtTest), [](void* p) { FreeHeap(p); });
+        if ((i & 63) == 0) {
+            df->poll();
+        }
+    }
+    df->flush();
+    printf("  DeferredFree defer+free                 %6.1f ns/object (%zu blocking waits)\n",
+           (now_seconds() - start) * 1e9 / frees, df->synchronized_count());
+    delete df;
+
+    start = now_seconds();
+    for (int i = 0; i < frees / 10; i++) {
+        void* p = AllocateHeap(32, mtTest);
+        GlobalCounter::write_synchronize();
+        FreeHeap(p);
+    }
+    printf("  write_synchronize per free              %6.1f ns/object\n",
+           (now_seconds() - start) * 1e9 / (frees / 10));
+}
+
+// ========== ConcurrentHashTable 读多写少 ==========
+// 99% 查找、1% 插入/删除。对照组是同一张表，但每个操作都在一把全局 Mutex 里做。
+// 无锁查找只写本线程的计数，吞吐量应随线程数（到核数为止）接近线性增长
+
+struct BenchTableConfig {
+    static uintx get_hash(const uintx& value) { return value * 0x9E3779B97F4A7C15ULL; }
+    static void* allocate_node(size_t size, const uintx&) { return AllocateHeap(size, mtTest); }
+    static void free_node(void* memory, const uintx&) { FreeHeap(memory); }
+};
+
+typedef ConcurrentHashTable<uintx, BenchTableConfig, mtTest> BenchTable;
+
+struct BenchLookup {
+    uintx _key;
+    explicit BenchLookup(uintx key) : _key(key) {}
+    uintx get_hash() const { return BenchTableConfig::get_hash(_key); }
+    bool equals(const uintx* value) { return *value == _key; }
+};
+
+static void bench_concurrent_hash_table() {
+    const uintx keys = 1 << 16;
+    const int total_ops = 8000000;
+    std::cout << "[concurrent_hash_table] " << keys << " keys, 99% get / 1% insert+remove, "
+              << total_ops << " ops in total (" << max_bench_threads() << " cpus)" << std::endl;
+
+    BenchTable* table = new BenchTable(16, 16);
+    Thread* main_thread = Thread::current();
+    for (uintx k = 1; k <= keys; k++) {
+        table->insert(main_thread, BenchLookup(k), k);
+    }
+    Mutex table_lock(Mutex::nonleaf, "bench table lock");
+
+    const int thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    for (int nthreads : thread_counts) {
+        const int per_thread = total_ops / nthreads;
+        auto work = [&](int tid, bool locked) {
+            Thread* thread = Thread::current();
+            uintx seed = (uintx)tid * 0x2545F4914F6CDD1DULL + 1;
+            uintx hits = 0;
+            for (int i = 0; i < per_thread; i++) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                uintx k = (seed >> 33) % keys + 1;
+                MutexLocker ml(locked ? &table_lock : nullptr);
+                if (i % 100 == 99) {
+                    // 每个线程只改自己的键，查找用的键一直在表里
+                    uintx own = keys + 1 + (uintx)tid;
+                    table->insert(thread, BenchLookup(own), own);
+                    table->remove(thread, BenchLookup(own));
+                } else {
+                    hits += table->get(thread, BenchLookup(k), [](uintx*) {});
+                }
+            }
+            bench_sink = hits;
+        };
+        double t_cht = run_threads(nthreads, [&](int tid) { work(tid, false); });
+        double t_locked = run_threads(nthreads, [&](int tid) { work(tid, true); });
+        printf("  threads=%-3d lock-free %7.1f Mops/s   global Mutex %7.1f Mops/s\n",
+               nthreads, total_ops / t_cht / 1e6, total_ops / t_locked / 1e6);
+    }
+    delete table;
+}
+
+// ========== Copy ==========
+
+// 每种大小复制的总字节数大致相同；源和目标错开半个数组，两个方向都测
+static void copy_round(const char* name, size_t bytes, void (*copy)(jint* from, jint* to, size_t count)) {
+    size_t count = bytes / sizeof(jint);
+    jint* buf = (jint*)aligned_alloc(64, bytes * 2 + 64);
+    memset(buf, 1, bytes * 2 + 64);
+    size_t iters = MAX2((size_t)(1ULL << 31) / bytes, (size_t)4);
+    double start = now_seconds();
+    for (size_t i = 0; i < iters; i++) {
+        if (i & 1) {
+            copy(buf + count / 2, buf, count);            // 前向重叠
+        } else {
+            copy(buf + 16, buf + 16 + count / 2, count);  // 后向重叠
+        }
+    }
+    double t = now_seconds() - start;
+    printf("    %-10s %8.2f GB/s\n", name, (double)bytes * iters / t / 1e9);
+    free(buf);
+}
+
+static void bench_copy() {
+    std::cout << "[copy] overlapping jint copies (" << Copy::kernel_name() << " kernels)" << std::endl;
+    const size_t sizes[] = { 8, 32, 64, 256, 1024, 4096, 32768, 262144, 1048576, 8388608 };
+    for (size_t bytes : sizes) {
+        printf("  bytes=%zu\n", bytes);
+        copy_round("memmove", bytes, [](jint* from, jint* to, size_t count) {
+            memmove(to, from, count * sizeof(jint));
+        });
+        copy_round("conjoint", bytes, [](jint* from, jint* to, size_t count) {
+            Copy::conjoint_jints_atomic(from, to, count);
+        });
+        copy_round("arrayof", bytes, [](jint* from, jint* to, size_t count) {
+            Copy::arrayof_conjoint_jints((HeapWord*)from, (HeapWord*)to, count);
+        });
+    }
+}
+
+// ========== 填充 ==========
+
+// 每种大小填充的总字节数大致相同。working set 小于缓存时测的是写进缓存的速度，
+// 大于缓存时是写回内存的速度；非临时写在后一种情况下才有优势
+template <typename FILL>
+static double fill_round(size_t bytes, FILL fill) {
+    size_t alloc = align_up(bytes, (size_t)4096) + 4096;
+    HeapWord* buf = (HeapWord*)aligned_alloc(4096, alloc);
+    memset(buf, 1, alloc);
+    HeapWord* to = (HeapWord*)((char*)buf + 8);   // 只按 HeapWord 对齐
+    size_t count = bytes / HeapWordSize;
+    size_t iters = MAX2((size_t)(1ULL << 31) / MAX2(bytes, (size_t)64), (size_t)4);
+    double start = now_seconds();
+    for (size_t i = 0; i < iters; i++) {
+        fill(to, count);
+        bench_sink += (uintptr_t)((jlong*)to)[i % count];
+    }
+    double t = now_seconds() - start;
+    free(buf);
+    return (double)bytes * iters / t / 1e9;
+}
+
+static void bench_fill() {
+    std::cout << "[fill] zero_to_words, GB/s (" << Copy::kernel_name() << " kernels, L2 "
+              << VM_Version::L2_cache_size() / 1024 << "K, L3 " << VM_Version::L3_cache_size() / 1024 << "K)" << std::endl;
+    std::cout << "  auto: rep stos from " << Copy::block_zeroing_low_limit()
+              << " bytes, non-temporal from " << Copy::nontemporal_fill_limit() << " bytes" << std::endl;
+    printf("  %10s %9s %9s %9s %9s %9s %9s\n",
+           "bytes", "loop", "memset", "stores", "rep_stos", "nontemp", "auto");
+    const size_t sizes[] = { 16, 64, 256, 1024, 1536, 2048, 3072, 4096, 6144, 8192, 16384, 65536,
+                             1048576, 8388608, 16777216, 33554432, 50331648, 67108864, 268435456 };
+    for (size_t bytes : sizes) {
+        double loop = fill_round(bytes, [](HeapWord* to, size_t count) {
+            volatile julong* p = (volatile julong*)to;
+            for (size_t i = 0; i < count; i++) {
+                p[i] = 0;
+            }
+        });
+        double mset = fill_round(bytes, [](HeapWord* to, size_t count) {
+            memset(to, 0, count * HeapWordSize);
+        });
+        double stores = fill_round(bytes, [](HeapWord* to, size_t count) {
+            Copy::fill_words_using(Copy::fill_stores, to, count, 0);
+        });
+        double rep = fill_round(bytes, [](HeapWord* to, size_t count) {
+            Copy::fill_words_using(Copy::fill_rep_stos, to, count, 0);
+        });
+        double nt = fill_round(bytes, [](HeapWord* to, size_t count) {
+            Copy::fill_words_using(Copy::fill_nontemporal, to, count, 0);
+        });
+        double chosen = fill_round(bytes, [](HeapWord* to, size_t count) {
+            Copy::zero_to_words(to, count);
+        });
+        printf("  %10zu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", bytes, loop, mset, stores, rep, nt, chosen);
+    }
+}
+
+// ========== 对象复制 ==========
+
+// 对象大小分布（字，压缩类指针下），大致是典型服务端应用 jmap -histo 的形状：
+// 2~4 字的小对象（Integer、String、HashMap$Node、Object[] 头）占大多数，
+// 大数组很少，但占了相当一部分字节
+struct ObjectSizeBucket {
+    int    percent;
+    size_t min_words;
+    size_t max_words;
+};
+
+static const ObjectSizeBucket object_size_histogram[] = {
+    { 22, 2,   2   },   // Integer、Object、空数组
+    { 28, 3,   3   },   // String、Long、小 byte[]
+    { 18, 4,   4   },   // HashMap$Node、ArrayList
+    { 14, 5,   8   },   // 一般的实例
+    { 12, 9,   32  },   // 短字符串的 byte[]、小 Object[]
+    { 5,  33,  256 },   // 中等数组
+    { 1,  257, 2048 },  // 大数组
+};
+
+// 把 nobjs 个按分布抽样的对象从 from-space 依次复制到 to-space，对象之间没有空隙
+static void object_copy_round(size_t nobjs, int rounds) {
+    std::vector<size_t> sizes(nobjs);
+    uint64_t seed = 88172645463325252ULL;
+    size_t total_words = 0;
+    for (size_t i = 0; i < nobjs; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        int pick = (int)(seed % 100);
+        const ObjectSizeBucket* b = object_size_histogram;
+        while (pick >= b->percent) {
+            pick -= b->percent;
+            b++;
+        }
+        sizes[i] = b->min_words + (seed >> 32) % (b->max_words - b->min_words + 1);
+        total_words += sizes[i];
+    }
+    HeapWord* from_space = new HeapWord[total_words];
+    HeapWord* to_space = new HeapWord[total_words];
+    memset(from_space, 1, total_words * HeapWordSize);
+    memset(to_space, 0, total_words * HeapWordSize);
+    printf("  %zu objects, %zuK, mean %.1f words\n", nobjs, total_words * HeapWordSize / 1024,
+           (double)total_words / nobjs);
+
+    auto evacuate = [&](const char* name, void (*copy)(const HeapWord*, HeapWord*, size_t)) {
+        double start = now_seconds();
+        for (int r = 0; r < rounds; r++) {
+            const HeapWord* from = from_space;
+            HeapWord* to = to_space;
+            for (size_t i = 0; i < nobjs; i++) {
+                copy(from, to, sizes[i]);
+                from += sizes[i];
+                to += sizes[i];
+            }
+        }
+        double t = now_seconds() - start;
+        printf("    %-24s %6.2f ns/object  %6.2f GB/s\n", name, t * 1e9 / ((double)nobjs * rounds),
+               (double)total_words * HeapWordSize * rounds / t / 1e9);
+    };
+    evacuate("memmove", [](const HeapWord* from, HeapWord* to, size_t count) {
+        Copy::conjoint_memory(from, to, count * HeapWordSize);
+    });
+    evacuate("memcpy", [](const HeapWord* from, HeapWord* to, size_t count) {
+        memcpy(to, from, count * HeapWordSize);
+    });
+    evacuate("aligned_disjoint_words", [](const HeapWord* from, HeapWord* to, size_t count) {
+        Copy::aligned_disjoint_words(from, to, count);
+    });
+    bench_sink = to_space[total_words - 1];
+    delete[] from_space;
+    delete[] to_space;
+}
+
+static void bench_object_copy() {
+    std::cout << "[object_copy] evacuation with a heap-histogram size mix (" << Copy::kernel_name()
+              << " kernels)" << std::endl;
+    object_copy_round(4000, 2500);      // 两个空间都在 L2 里
+    object_copy_round(200000, 50);      // 超过 L2
+
+    // 大小在编译期已知（例如复制固定布局的 3 字对象），和从数组里读出大小比较。
+    // 目标之间留一个字的空隙，编译器不能把整个循环合并成一次 memcpy
+    const size_t fixed = 10000;
+    const int rounds = 2000;
+    HeapWord* from_space = new HeapWord[fixed * 3];
+    HeapWord* to_space = new HeapWord[fixed * 4];
+    memset(from_space, 1, fixed * 3 * HeapWordSize);
+    std::vector<size_t> three(fixed, 3);
+    auto fixed_round = [&](const char* name, void (*copy)(const HeapWord*, HeapWord*, size_t)) {
+        double start = now_seconds();
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < fixed; i++) {
+                copy(from_space + i * 3, to_space + i * 4, three[i]);
+            }
+        }
+        double t = now_seconds() - start;
+        printf("    %-24s %6.2f ns/object\n", name, t * 1e9 / ((double)fixed * rounds));
+    };
+    printf("  3-word objects\n");
+    fixed_round("memcpy", [](const HeapWord* from, HeapWord* to, size_t count) {
+        memcpy(to, from, count * HeapWordSize);
+    });
+    fixed_round("runtime count", [](const HeapWord* from, HeapWord* to, size_t count) {
+        Copy::aligned_disjoint_words(from, to, count);
+    });
+    fixed_round("template", [](const HeapWord* from, HeapWord* to, size_t) {
+        Copy::aligned_disjoint_words<3>(from, to);
+    });
+    bench_sink = to_space[fixed * 4 - 2];
+    delete[] from_space;
+    delete[] to_space;
+}
+
+// ========== 基准注册表 ==========
+
+struct Benchmark {
+    const char* name;
+    void (*fn)();
+};
+
+static const Benchmark benchmarks[] = {
+    { "resource_area_mt", bench_resource_area_mt },
+    { "nmt_malloc",       bench_nmt_malloc       },
+    { "nmt_workload",     bench_nmt_workload     },
+    { "arena_queries",    bench_arena_queries    },
+    { "arena_growth",     bench_arena_growth     },
+    { "arena_huge_pages", bench_arena_huge_pages },
+    { "slab_allocator",   bench_slab_allocator   },
+    { "metaspace",        bench_metaspace        },
+    { "klass_decode",     bench_klass_decode     },
+    { "compressed_oops",  bench_compressed_oops  },
+    { "tlab_alloc",       bench_tlab_alloc       },
+    { "growable_array",   bench_growable_array   },
+    { "vector_search",    bench_vector_search    },
+    { "sorted_array",     bench_sorted_array     },
+    { "segmented_array",  bench_segmented_array  },
+    { "atomic_orderings", bench_atomic_orderings },
+    { "locks",            bench_locks            },
+    { "striped_counter",  bench_striped_counter  },
+    { "global_counter",   bench_global_counter   },
+    { "concurrent_hash_table", bench_concurrent_hash_table },
+    { "copy",             bench_copy             },
+    { "fill",             bench_fill             },
+    { "object_copy",      bench_object_copy      },
+};
+
+int main(int argc, char** argv) {
+    // -XX: 参数必须在第一次分配之前处理
+    int nselected = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "-XX:", 4) == 0) {
+            if (!process_vm_flag(argv[i])) {
+                fprintf(stderr, "unrecognized VM flag: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            nselected++;
+        }
+    }
+
+    for (const Benchmark& b : benchmarks) {
+        bool selected = (nselected == 0);
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], b.name) == 0) selected = true;
+        }
+        if (selected) {
+            b.fn();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * my_jvm - Compressed oops test
+ * 测试 narrowOop 的三种模式、ReservedHeapSpace 的选址和引用字段访问
+ *
+ * 注意：debug.hpp 会重定义 assert，这里统一用 guarantee（始终执行）
+ */
+
+#include <cstring>
+#include <iostream>
+#include "memory/virtualspace.hpp"
+#include "oops/compressedOops.hpp"
+#include "oops/oop.hpp"
+#include "runtime/globals.hpp"
+
+// ========== 编解码 ==========
+
+// 在 [begin, begin + size) 里挑几个地址检查模板版本和通用版本一致
+template <CompressedOops::Mode M>
+static void check_codec(address begin, size_t size) {
+    typedef NarrowOopCodec<M> Codec;
+    guarantee(CompressedOops::mode() == M, "unexpected mode %s",
+              CompressedOops::mode_to_string(CompressedOops::mode()));
+
+    const address samples[] = { begin, begin + 8, begin + size / 2, begin + size - 8 };
+    for (address a : samples) {
+        oop o = (oop)a;
+        narrowOop v = Codec::encode(o);
+        guarantee(v != 0, "non-null oop must not encode to 0");
+        guarantee(v == CompressedOops::encode(o), "template and generic encode differ");
+        guarantee(Codec::decode(v) == o && CompressedOops::decode(v) == o, "round trip");
+    }
+    guarantee(Codec::encode(nullptr) == 0, "null encodes to 0");
+    guarantee(Codec::decode(0) == nullptr, "0 decodes to null");
+}
+
+void test_modes() {
+    std::cout << "Testing narrowOop modes..." << std::endl;
+
+    const size_t G = (size_t)1024 * 1024 * 1024;
+
+    // 只做地址运算，不访问内存
+    CompressedOops::initialize((address)(2 * G), 1 * G);
+    check_codec<CompressedOops::UnscaledNarrowOop>((address)(2 * G), 1 * G);
+    guarantee(CompressedOops::shift() == 0 && CompressedOops::base() == 0, "unscaled");
+    std::cout << "  unscaled: OK" << std::endl;
+
+    CompressedOops::initialize((address)(28 * G), 4 * G);
+    check_codec<CompressedOops::ZeroBasedNarrowOop>((address)(28 * G), 4 * G);
+    guarantee(CompressedOops::shift() == 3 && CompressedOops::base() == 0, "zero based");
+    std::cout << "  zero based: OK" << std::endl;
+
+    address high = (address)0x7f0000000000ULL;
+    CompressedOops::initialize(high, 8 * G);
+    check_codec<CompressedOops::HeapBasedNarrowOop>(high, 8 * G);
+    guarantee(CompressedOops::shift() == 3 && CompressedOops::base() != 0, "heap based");
+    std::cout << "  heap based: OK" << std::endl;
+
+    // dispatch 选中和当前模式一致的实例
+    CompressedOops::Mode seen = CompressedOops::dispatch([](auto mode) {
+        return decltype(mode)::value;
+    });
+    guarantee(seen == CompressedOops::HeapBasedNarrowOop, "dispatch");
+    std::cout << "  dispatch: OK" << std::endl;
+}
+
+// ========== ReservedHeapSpace ==========
+
+void test_reserved_heap_space() {
+    std::cout << "Testing ReservedHeapSpace..." << std::endl;
+
+    const size_t heap_size = 64 * 1024 * 1024;
+    const size_t alignment = 2 * 1024 * 1024;
+    ReservedHeapSpace rs(heap_size, alignment);
+    guarantee(rs.is_reserved() && rs.size() == heap_size, "reserve heap");
+    guarantee(is_aligned((uintptr_t)rs.base(), alignment), "heap alignment");
+
+    std::cout << "  heap [" << (void*)rs.base() << ", " << (void*)rs.end() << ")";
+    if (UseCompressedOops) {
+        std::cout << " mode=" << CompressedOops::mode_to_string(CompressedOops::mode());
+        // 模式和位置一致
+        uint64_t end = (uint64_t)(uintptr_t)rs.end();
+        switch (CompressedOops::mode()) {
+            case CompressedOops::UnscaledNarrowOop:
+                guarantee(end <= CompressedOops::UnscaledOopHeapMax, "unscaled heap above 4G");
+                break;
+            case CompressedOops::ZeroBasedNarrowOop:
+                guarantee(end <= CompressedOops::OopEncodingHeapMax, "zero based heap above 32G");
+                break;
+            default:
+                guarantee(end > CompressedOops::OopEncodingHeapMax, "heap based mode below 32G");
+                break;
+        }
+        // 能放在低地址就不应该退到 HeapBased
+        guarantee((uint64_t)(uintptr_t)rs.base() >= HeapBaseMinAddress ||
+                  CompressedOops::mode() == CompressedOops::HeapBasedNarrowOop,
+                  "heap below HeapBaseMinAddress");
+    }
+    std::cout << std::endl;
+
+    // 在堆里摆两个对象：a 的第一个引用字段指向 b
+    const int field = instanceOopDesc::base_offset_in_bytes();
+    oop a = (oop)rs.base();
+    oop b = (oop)(rs.base() + 64);
+    a->obj_field_put(field, b);
+    guarantee(a->obj_field(field) == b, "obj_field round trip");
+    if (UseCompressedOops) {
+        narrowOop raw;
+        memcpy(&raw, (char*)a + field, sizeof(raw));
+        guarantee(raw == CompressedOops::encode(b), "field holds a narrowOop");
+        // 紧跟的 4 字节没被写
+        jint next;
+        memcpy(&next, (char*)a + field + 4, sizeof(next));
+        guarantee(next == 0, "narrowOop field is 4 bytes");
+
+        oop via_template = CompressedOops::dispatch([&](auto mode) {
+            return a->obj_field_narrow<decltype(mode)::value>(field);
+        });
+        guarantee(via_template == b, "obj_field_narrow");
+    }
+    a->obj_field_put(field, nullptr);
+    guarantee(a->obj_field(field) == nullptr, "null field");
+    guarantee(heap_oop_size() == (UseCompressedOops ? 4 : 8), "heap_oop_size");
+    std::cout << "  fields: OK" << std::endl;
+
+    // 对象数组扫描：跳过空元素
+    if (UseCompressedOops) {
+        narrowOop* elems = (narrowOop*)(rs.base() + 4096);
+        for (int i = 0; i < 100; i++) {
+            elems[i] = (i % 3 == 0) ? 0 : CompressedOops::encode((oop)(rs.base() + 8192 + i * 16));
+        }
+        int count = 0;
+        CompressedOops::dispatch([&](auto mode) {
+            NarrowOopCodec<decltype(mode)::value>::iterate(elems, elems + 100, [&](oop o) {
+                guarantee(CompressedOops::is_in(o), "decoded oop outside heap");
+                count++;
+            });
+        });
+        guarantee(count == 66, "iterate should skip nulls");
+        std::cout << "  iterate: OK" << std::endl;
+    }
+
+    rs.release();
+    guarantee(!rs.is_reserved(), "release");
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        guarantee(process_vm_flag(argv[i]), "unrecognized VM flag: %s", argv[i]);
+    }
+
+    std::cout << "=== my_jvm Compressed Oops Test ===" << std::endl;
+
+    test_modes();
+    test_reserved_heap_space();
+
+    std::cout << std::endl;
+    std::cout << "=== All Tests Passed! ===" << std::endl;
+    return 0;
+}
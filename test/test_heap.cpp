@@ -0,0 +1,309 @@
+/*
+ * my_jvm - Java heap test
+ * 测试 region 划分、TLAB 的快速/慢速路径和大小调整、humongous 分配、
+ * 多线程分配、对象头初始化和按 layout helper 计算对象大小
+ *
+ * 注意：debug.hpp 会重定义 assert，这里统一用 guarantee（始终执行）
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "classfile/classLoaderData.hpp"
+#include "gc/g1/g1CollectedHeap.hpp"
+#include "oops/instanceKlass.hpp"
+#include "oops/oop.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/thread.hpp"
+#include "utilities/ostream.hpp"
+
+static const size_t M = 1024 * 1024;
+
+// ========== region ==========
+
+void test_regions() {
+    std::cout << "Testing heap regions..." << std::endl;
+
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    HeapRegionManager* hrm = g1h->hrm();
+    guarantee(HeapRegion::GrainBytes == 1 * M, "64M heap uses the 1M minimum region size");
+    guarantee(hrm->num_regions() == 64, "64 regions");
+    guarantee(hrm->num_free_regions() == 64, "all regions free at start");
+    guarantee(is_aligned((uintptr_t)g1h->reserved_base(), HeapRegion::GrainBytes), "region aligned");
+
+    HeapWord* base = g1h->reserved_base();
+    guarantee(g1h->heap_region_containing(base) == hrm->at(0), "first region");
+    guarantee(g1h->heap_region_containing(base + HeapRegion::GrainWords * 5 + 17) == hrm->at(5),
+              "addr_to_region");
+    guarantee(!g1h->is_in(base + HeapRegion::GrainWords * 64), "end is outside");
+    std::cout << "  layout: OK" << std::endl;
+
+    // region 大小的计算：heap / 2048，取 2 的幂，夹在 [1M, 32M]
+    auto region_size = [](size_t heap_size, size_t requested) {
+        HeapRegion::setup_heap_region_size(heap_size, requested);
+        return HeapRegion::GrainBytes;
+    };
+    guarantee(region_size(64 * M, 0) == 1 * M, "min region size");
+    guarantee(region_size((size_t)8 * 1024 * M, 0) == 4 * M, "8G heap");
+    guarantee(region_size((size_t)1024 * 1024 * M, 0) == 32 * M, "max region size");
+    guarantee(region_size(64 * M, 3 * M) == 2 * M, "explicit size rounds down");
+    region_size(64 * M, 0);
+    std::cout << "  region size: OK" << std::endl;
+}
+
+// ========== TLAB ==========
+
+void test_tlab() {
+    std::cout << "Testing TLAB..." << std::endl;
+
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    ThreadLocalAllocBuffer& tlab = Thread::current()->tlab();
+
+    // 第一次分配走慢速路径，refill 之后连续的对象地址相邻
+    HeapWord* a = G1CollectedHeap::allocate(4);
+    guarantee(a != nullptr && g1h->is_in(a), "first allocation");
+    guarantee(tlab.number_of_refills() == 1, "first allocation refills");
+    guarantee(tlab.start() == a, "object at TLAB start");
+    HeapWord* b = G1CollectedHeap::allocate(6);
+    guarantee(b == a + 4, "bump pointer");
+    guarantee(tlab.top() == b + 6, "top advanced");
+    guarantee(g1h->heap_region_containing(a)->is_eden(), "TLAB in eden");
+    std::cout << "  fast path: OK (desired=" << tlab.desired_size() << " words)" << std::endl;
+
+    // 剩余空间多于 refill waste limit 时，放不下的对象在 TLAB 外分配，TLAB 保留
+    size_t refills = tlab.number_of_refills();
+    HeapWord* top = tlab.top();
+    size_t big = tlab.free() + 1;
+    guarantee(big < g1h->humongous_threshold_words(), "test object is not humongous");
+    HeapWord* c = G1CollectedHeap::allocate(big);
+    guarantee(c != nullptr && (c < tlab.start() || c >= tlab.end()), "allocated outside TLAB");
+    guarantee(tlab.top() == top && tlab.number_of_refills() == refills, "TLAB kept");
+    guarantee(tlab.slow_allocations() == 1, "counted as slow allocation");
+    std::cout << "  outside TLAB: OK" << std::endl;
+
+    // 用完 TLAB 后 refill
+    while (tlab.free() > tlab.refill_waste_limit()) {
+        guarantee(G1CollectedHeap::allocate(2) != nullptr, "fill TLAB");
+    }
+    HeapWord* d = G1CollectedHeap::allocate(tlab.free() + 2);
+    guarantee(d != nullptr && d == tlab.start(), "refilled");
+    guarantee(tlab.number_of_refills() == refills + 1, "refill count");
+    std::cout << "  refill: OK" << std::endl;
+
+    // 一直由这一个线程分配，比例采样之后 TLAB 变大
+    size_t initial_desired = tlab.desired_size();
+    size_t words = g1h->tlab_capacity_words() * 3;
+    for (size_t done = 0; done < words; done += 8) {
+        guarantee(G1CollectedHeap::allocate(8) != nullptr, "allocate");
+    }
+    guarantee(tlab.allocation_fraction() > 0.5f, "single thread owns most of eden");
+    guarantee(tlab.desired_size() > initial_desired, "TLAB grew");
+    guarantee(tlab.desired_size() <= ThreadLocalAllocBuffer::max_size(), "TLAB capped");
+    fileStream out(stdout);
+    tlab.print_stats(&out, "main");
+    std::cout << "  resize: OK" << std::endl;
+}
+
+// ========== humongous ==========
+
+void test_humongous() {
+    std::cout << "Testing humongous allocation..." << std::endl;
+
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    uint free_before = g1h->hrm()->num_free_regions();
+    size_t size = HeapRegion::GrainWords * 2 + 10;     // 占 3 个 region
+    HeapWord* h = G1CollectedHeap::allocate(size);
+    guarantee(h != nullptr, "humongous allocation");
+    HeapRegion* first = g1h->heap_region_containing(h);
+    guarantee(first->bottom() == h && first->is_starts_humongous(), "starts humongous");
+    guarantee(g1h->heap_region_containing(h + HeapRegion::GrainWords)->is_continues_humongous(), "continues");
+    guarantee(g1h->heap_region_containing(h + size - 1)->is_continues_humongous(), "last continues");
+    guarantee(g1h->hrm()->num_free_regions() == free_before - 3, "3 regions used");
+
+    // 正好等于阈值的对象不是 humongous，开不开 TLAB 都在 eden 里；多一个字才是
+    size_t threshold = g1h->humongous_threshold_words();
+    guarantee(threshold == ThreadLocalAllocBuffer::max_size(), "TLAB limit must match threshold");
+    HeapWord* at = G1CollectedHeap::allocate(threshold);
+    guarantee(at != nullptr && g1h->heap_region_containing(at)->is_eden(), "threshold-sized object in eden");
+    HeapWord* above = G1CollectedHeap::allocate(threshold + 1);
+    guarantee(above != nullptr && g1h->heap_region_containing(above)->is_starts_humongous(),
+              "object above threshold is humongous");
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== 多线程 ==========
+
+void test_multi_thread() {
+    std::cout << "Testing multi-thread allocation..." << std::endl;
+
+    const int num_threads = 4;
+    const int per_thread = 20000;
+    std::vector<std::vector<HeapWord*>> results(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&results, t]() {
+            for (int i = 0; i < per_thread; i++) {
+                size_t size = 2 + (i % 5);
+                HeapWord* p = G1CollectedHeap::allocate(size);
+                guarantee(p != nullptr, "allocate");
+                // 写满对象，之后检查没有被别的线程覆盖
+                for (size_t w = 0; w < size; w++) {
+                    p[w] = ((HeapWord)t << 32) | (HeapWord)i;
+                }
+                results[t].push_back(p);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    for (int t = 0; t < num_threads; t++) {
+        for (int i = 0; i < per_thread; i++) {
+            HeapWord* p = results[t][i];
+            size_t size = 2 + (i % 5);
+            for (size_t w = 0; w < size; w++) {
+                guarantee(p[w] == (((HeapWord)t << 32) | (HeapWord)i), "objects overlap");
+            }
+        }
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== 对象初始化 ==========
+
+void test_obj_allocate() {
+    std::cout << "Testing object allocation..." << std::endl;
+
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    ClassLoaderData* cld = new ClassLoaderData();
+    InstanceKlass* k = new (cld) InstanceKlass();
+
+    oop obj = g1h->obj_allocate(k, 4);
+    guarantee(obj != nullptr && g1h->is_in(obj), "obj_allocate");
+    guarantee(obj->klass() == k, "klass set");
+    guarantee(obj->mark() == markWord_unlocked(), "mark initialized");
+    for (int off = instanceOopDesc::base_offset_in_bytes(); off < 4 * HeapWordSize; off += 4) {
+        guarantee(*(jint*)((char*)obj + off) == 0, "fields zeroed");
+    }
+
+    int length = 10;
+    size_t array_words = align_up(arrayOopDesc::header_size_in_bytes() + length * sizeof(jint),
+                                  (size_t)HeapWordSize) / HeapWordSize;
+    arrayOop arr = (arrayOop)g1h->array_allocate(k, array_words, length);
+    guarantee(arr != nullptr && arr->length() == length, "array length");
+    guarantee(arr->klass() == k, "array klass");
+    std::cout << "  OK" << std::endl;
+
+    cld->unload();
+    delete cld;
+}
+
+// ========== layout helper ==========
+
+void test_layout_helper() {
+    std::cout << "Testing layout helper..." << std::endl;
+
+    // 实例：字节数 + 慢速路径位
+    jint lh = Klass::instance_layout_helper(3, false);
+    guarantee(lh == 24 && Klass::layout_helper_is_instance(lh), "instance lh");
+    guarantee(Klass::layout_helper_to_size_helper(lh) == 3, "instance size");
+    guarantee(!Klass::layout_helper_needs_slow_path(lh), "fast path");
+    jint slow = Klass::instance_layout_helper(3, true);
+    guarantee(Klass::layout_helper_needs_slow_path(slow) &&
+              Klass::layout_helper_size_in_bytes(slow) == 24, "slow path bit");
+    guarantee(!Klass::layout_helper_is_instance(Klass::_lh_neutral_value) &&
+              !Klass::layout_helper_is_array(Klass::_lh_neutral_value), "neutral");
+
+    // 数组：tag / 头大小 / 元素类型 / log2(元素大小)
+    const BasicType types[] = { T_BOOLEAN, T_CHAR, T_FLOAT, T_DOUBLE, T_BYTE, T_SHORT, T_INT, T_LONG, T_OBJECT };
+    for (BasicType t : types) {
+        jint alh = Klass::array_layout_helper(t);
+        int esize = is_reference_type(t) ? heap_oop_size() : type2aelembytes(t);
+        guarantee(Klass::layout_helper_is_array(alh) && !Klass::layout_helper_is_instance(alh), "array lh");
+        guarantee(Klass::layout_helper_is_objArray(alh) == is_reference_type(t), "objArray tag");
+        guarantee(Klass::layout_helper_is_typeArray(alh) == !is_reference_type(t), "typeArray tag");
+        guarantee(Klass::layout_helper_element_type(alh) == t, "element type");
+        guarantee((1 << Klass::layout_helper_log2_element_size(alh)) == esize, "element size");
+        guarantee(Klass::layout_helper_header_size(alh) == arrayOopDesc::base_offset_in_bytes(esize), "header");
+    }
+    // int[] 的元素从 16（压缩类指针）或 24 开始
+    jint int_lh = Klass::array_layout_helper(T_INT);
+    guarantee(arrayOopDesc::object_size(int_lh, 0) == (UseCompressedClassPointers ? 2 : 3), "empty int[]");
+    guarantee(arrayOopDesc::object_size(int_lh, 3) == (UseCompressedClassPointers ? 4 : 5), "int[3]");
+    std::cout << "  encoding: OK" << std::endl;
+
+    // 按 layout helper 分配，oopDesc::size() 取回同样的大小
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    ClassLoaderData* cld = new ClassLoaderData();
+    InstanceKlass* ik = new (cld) InstanceKlass();
+    ik->set_layout_helper(Klass::instance_layout_helper(5, false));
+    guarantee(ik->size_helper() == 5, "size_helper");
+    oop obj = g1h->instance_allocate(ik);
+    guarantee(obj != nullptr && obj->size() == 5, "instance size");
+    guarantee(obj->is_instance() && !obj->is_array(), "instance type");
+    oop next = g1h->instance_allocate(ik);
+    if (UseTLAB) {
+        guarantee((HeapWord*)next == (HeapWord*)obj + 5, "instances are adjacent in the TLAB");
+    }
+
+    Klass* ak = new (cld) InstanceKlass();
+    ak->set_layout_helper(Klass::array_layout_helper(T_OBJECT));
+    arrayOop arr = (arrayOop)g1h->array_allocate(ak, 7);
+    guarantee(arr != nullptr && arr->length() == 7, "array length");
+    guarantee(arr->is_objArray() && !arr->is_instance(), "objArray type");
+    int expected = (int)(align_up((size_t)arrayOopDesc::base_offset_in_bytes(heap_oop_size()) + 7 * heap_oop_size(),
+                                  (size_t)HeapWordSize) / HeapWordSize);
+    guarantee(arr->size() == expected, "array size");
+    guarantee(g1h->array_allocate(ak, -1) == nullptr, "negative length");
+
+    ik->set_layout_helper(Klass::instance_layout_helper(5, true));
+    guarantee(g1h->instance_allocate(ik) == nullptr, "slow path class is not allocated from lh");
+    std::cout << "  allocation: OK" << std::endl;
+
+    cld->unload();
+    delete cld;
+}
+
+// ========== 堆满 ==========
+
+void test_exhaustion() {
+    std::cout << "Testing heap exhaustion..." << std::endl;
+
+    G1CollectedHeap* g1h = G1CollectedHeap::heap();
+    // humongous 请求超过剩余 region 数时直接失败
+    guarantee(G1CollectedHeap::allocate(HeapRegion::GrainWords * 65) == nullptr, "too large");
+
+    size_t allocated = 0;
+    while (G1CollectedHeap::allocate(64) != nullptr) {
+        allocated += 64;
+    }
+    guarantee(g1h->hrm()->num_free_regions() == 0, "all regions used");
+    guarantee(g1h->obj_allocate(nullptr, 4) == nullptr, "obj_allocate returns null when full");
+    fileStream out(stdout);
+    g1h->print_on(&out);
+    std::cout << "  OK (" << allocated * HeapWordSize / M << "M before exhaustion)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        guarantee(process_vm_flag(argv[i]), "unrecognized VM flag: %s", argv[i]);
+    }
+
+    std::cout << "=== my_jvm Heap Test ===" << std::endl;
+
+    guarantee(G1CollectedHeap::initialize(64 * M), "heap initialization");
+
+    test_regions();
+    if (UseTLAB) {
+        test_tlab();
+    }
+    test_humongous();
+    test_multi_thread();
+    test_obj_allocate();
+    test_layout_helper();
+    test_exhaustion();
+
+    std::cout << std::endl;
+    std::cout << "=== All Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,461 @@
+/*
+ * my_jvm - Memory subsystem test
+ * 测试 Arena / ChunkPool / ResourceArea 的基本行为
+ *
+ * 注意：debug.hpp 会重定义 assert，这里统一用 guarantee（始终执行）
+ */
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "memory/allocation.hpp"
+#include "memory/arena.hpp"
+#include "memory/resourceArea.hpp"
+#include "memory/slabAllocator.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/os.hpp"
+#include "runtime/thread.hpp"
+#include "services/memTracker.hpp"
+#include "utilities/ostream.hpp"
+
+// ========== ChunkPool ==========
+
+void test_chunk_pool() {
+    std::cout << "Testing ChunkPool..." << std::endl;
+
+    ChunkPool* pool = ChunkPool::large_pool();
+    size_t hits_before = pool->hits();
+
+    // 第一个 Arena 释放后，其 Chunk 回到池中
+    {
+        Arena arena(mtTest);
+        arena.Amalloc(100);
+        guarantee(arena.size_in_bytes() == Chunk::size + Chunk::aligned_overhead_size(),
+                  "first chunk should be a standard chunk");
+    }
+    guarantee(pool->num_chunks() >= 1, "chunk should be cached in pool");
+
+    // 第二个 Arena 应该直接命中池
+    {
+        Arena arena(mtTest);
+        arena.Amalloc(100);
+    }
+    guarantee(pool->hits() > hits_before, "second arena should hit the pool");
+    std::cout << "  pool reuse: OK" << std::endl;
+
+    // 非标准大小的 Chunk 不进池
+    size_t cached = pool->num_chunks();
+    {
+        Arena arena(mtTest);
+        arena.Amalloc(Chunk::size * 2);
+    }
+    guarantee(pool->num_chunks() == cached, "odd-sized chunk must bypass the pool");
+    std::cout << "  odd-sized bypass: OK" << std::endl;
+
+    // 修剪后每个池最多保留 BlocksToKeep 个
+    ChunkPool::clean();
+    guarantee(pool->num_chunks() <= (size_t)ChunkPoolCleaner::BlocksToKeep, "clean should trim");
+    std::cout << "  clean: OK" << std::endl;
+}
+
+// ========== ResourceMark ==========
+
+void test_resource_mark() {
+    std::cout << "Testing ResourceMark..." << std::endl;
+
+    ResourceArea area(mtTest);
+    area.Amalloc(64);
+    {
+        ResourceMark rm(&area);
+        // 分配足够多的内存，迫使 Arena 扩展出多个 Chunk
+        for (int i = 0; i < 100; i++) {
+            area.Amalloc(1024);
+        }
+        guarantee(area.size_in_bytes() > Chunk::size, "should have grown");
+    }
+    guarantee(area.size_in_bytes() == Chunk::size + Chunk::aligned_overhead_size(),
+              "mark should release chunks");
+    guarantee(area.used() == ARENA_ALIGN(64), "mark should restore hwm");
+
+    // 在空 Arena 上打标记
+    ResourceArea empty_area(mtTest);
+    {
+        ResourceMark rm(&empty_area);
+        empty_area.Amalloc(Chunk::size);
+    }
+    empty_area.Amalloc(16);
+    guarantee(empty_area.used() == 16, "empty mark should reset the arena");
+    std::cout << "  reset_to_mark: OK" << std::endl;
+}
+
+// ========== Arena::used / Arena::contains ==========
+
+void test_arena_used_contains() {
+    std::cout << "Testing Arena::used/contains..." << std::endl;
+
+    ResourceArea area(mtTest);
+    const int nallocs = 200;
+    char* ptrs[nallocs];
+    for (int i = 0; i < nallocs; i++) {
+        // 超过 large_threshold，每次分配独占一个 Chunk，得到 200 个 Chunk
+        ptrs[i] = (char*)area.Amalloc(16000);
+    }
+    for (int i = 0; i < nallocs; i++) {
+        guarantee(area.contains(ptrs[i]), "allocation not found");
+        guarantee(area.contains(ptrs[i] + 15999), "allocation end not found");
+    }
+    int on_stack = 0;
+    guarantee(!area.contains(&on_stack), "stack address must not be contained");
+    guarantee(area.used() >= (size_t)nallocs * 16000, "used too small");
+    std::cout << "  contains over many chunks: OK" << std::endl;
+
+    size_t used_before = area.used();
+    char* last = ptrs[nallocs - 1];
+    {
+        ResourceMark rm(&area);
+        char* tmp[20];
+        for (int i = 0; i < 20; i++) {
+            tmp[i] = (char*)area.Amalloc(16000);
+        }
+        guarantee(area.contains(tmp[19]), "new allocation not found");
+        guarantee(area.used() > used_before, "used should grow");
+    }
+    guarantee(area.used() == used_before, "mark should restore used");
+    guarantee(area.contains(last), "mark must keep older chunks");
+
+    // Afree 回退 hwm，used 同步减少
+    void* p = area.Amalloc(64);
+    guarantee(area.used() == used_before + 64, "used after Amalloc");
+    area.Afree(p, 64);
+    guarantee(area.used() == used_before, "used after Afree");
+    std::cout << "  used with mark/Afree: OK" << std::endl;
+
+    // 空 Arena 上的 mark 释放全部 Chunk（线程的 ResourceArea 就是这样开始的），
+    // 之后新的第一个 Chunk 也要能找到
+    ResourceArea empty(mtTest);
+    {
+        ResourceMark rm(&empty);
+        for (int i = 0; i < 40; i++) {
+            empty.Amalloc(5000);
+        }
+    }
+    char* p1 = (char*)empty.Amalloc(100);
+    char* more[40];
+    for (int i = 0; i < 40; i++) {
+        more[i] = (char*)empty.Amalloc(5000);
+    }
+    guarantee(empty.contains(p1), "allocation in first chunk not found after mark on empty arena");
+    for (int i = 0; i < 40; i++) {
+        guarantee(empty.contains(more[i]), "allocation not found after mark on empty arena");
+    }
+    std::cout << "  contains after mark on empty arena: OK" << std::endl;
+}
+
+// ========== Arena 增长策略 ==========
+
+void test_arena_growth_policy() {
+    std::cout << "Testing Arena growth policy..." << std::endl;
+
+    const ArenaGrowthPolicy saved = Arena::growth_policy(mtTest);
+    const size_t cap = 256 * 1024 - Chunk::slack;
+    Arena::set_growth_policy(mtTest, { Chunk::size, cap, Chunk::medium_size, false });
+
+    // 翻倍增长：32K, 64K, 128K, 256K, 256K ...
+    {
+        Arena arena(mtTest);
+        const size_t total = 2 * 1024 * 1024;
+        for (size_t i = 0; i < total / 128; i++) {
+            arena.Amalloc(128);
+        }
+        ArenaStatistics st;
+        arena.statistics(&st);
+        guarantee(st.largest_chunk == cap, "chunk size should be capped");
+        guarantee(st.chunks <= 4 + total / cap, "chunks should grow geometrically");
+        guarantee(st.used == total, "used must be exact");
+        guarantee(st.wasted() < cap, "waste bounded by the last chunk");
+    }
+    std::cout << "  geometric growth: OK" << std::endl;
+
+    // 大请求独占 Chunk，当前 Chunk 继续分配
+    {
+        ResourceArea arena(mtTest);
+        char* p = (char*)arena.Amalloc(100);
+        size_t used_before = arena.used();
+        char* big;
+        {
+            ResourceMark rm(&arena);
+            big = (char*)arena.Amalloc(Chunk::size * 3);
+            char* q = (char*)arena.Amalloc(100);
+            guarantee(q == p + ARENA_ALIGN(100), "current chunk must be kept");
+            guarantee(arena.contains(big) && arena.contains(big + Chunk::size * 3 - 1),
+                      "dedicated chunk not found");
+            guarantee(arena.used() == used_before + ARENA_ALIGN(Chunk::size * 3) + ARENA_ALIGN(100),
+                      "used must count the dedicated chunk");
+            // 普通扩展出的 Chunk 链在独立 Chunk 之后
+            for (int i = 0; i < 1000; i++) {
+                arena.Amalloc(1000);
+            }
+        }
+        guarantee(!arena.contains(big), "mark should free the dedicated chunk");
+        guarantee(arena.used() == used_before, "mark should restore used");
+        guarantee(arena.size_in_bytes() == Chunk::size + Chunk::aligned_overhead_size(),
+                  "mark should restore size");
+        ArenaStatistics st;
+        arena.statistics(&st);
+        guarantee(st.chunks == 1, "mark should leave one chunk");
+    }
+    std::cout << "  large allocation bypass: OK" << std::endl;
+
+    Arena::set_growth_policy(mtTest, saved);
+}
+
+// ========== 大页 Chunk ==========
+
+void test_arena_huge_pages() {
+    std::cout << "Testing huge-page arena chunks..." << std::endl;
+
+    const ArenaGrowthPolicy saved = Arena::growth_policy(mtTest);
+    const bool saved_flag = UseTransparentHugePages;
+    UseTransparentHugePages = true;
+    Arena::set_growth_policy(mtTest, { Chunk::size, Chunk::size, Chunk::medium_size, true });
+
+    const size_t page = os::large_page_size();
+    {
+        ResourceArea arena(mtTest);
+        char* first = (char*)arena.Amalloc(64);
+        {
+            ResourceMark rm(&arena);
+            char* p = nullptr;
+            for (int i = 0; i < 3000; i++) {
+                p = (char*)arena.Amalloc(4096);
+                memset(p, i, 4096);
+            }
+            guarantee(arena.contains(p) && arena.contains(first), "contains over mapped chunks");
+            ArenaStatistics st;
+            arena.statistics(&st);
+            if (os::can_use_transparent_huge_pages()) {
+                guarantee(st.mapped_chunks == st.chunks, "all chunks should be mapped");
+                guarantee(is_aligned((uintptr_t)first - Chunk::aligned_overhead_size(), page),
+                          "mapped chunk must be large-page aligned");
+                guarantee(st.size_in_bytes == st.chunks * page, "mapped chunks are whole large pages");
+            } else {
+                guarantee(st.mapped_chunks == 0, "must fall back to malloc without THP");
+            }
+            fileStream out(stdout);
+            st.print_on(&out);
+        }
+        guarantee(arena.used() == ARENA_ALIGN(64), "mark should release mapped chunks");
+    }
+    std::cout << "  mapped chunks: OK" << std::endl;
+
+    // 关闭 flag 时不映射
+    UseTransparentHugePages = false;
+    {
+        Arena arena(mtTest);
+        arena.Amalloc(Chunk::size);
+        arena.Amalloc(Chunk::size);
+        ArenaStatistics st;
+        arena.statistics(&st);
+        guarantee(st.mapped_chunks == 0, "flag off must not map chunks");
+    }
+    std::cout << "  flag off fallback: OK" << std::endl;
+
+    UseTransparentHugePages = saved_flag;
+    Arena::set_growth_policy(mtTest, saved);
+}
+
+// ========== SlabAllocator ==========
+
+void test_slab_allocator() {
+    std::cout << "Testing SlabAllocator ("
+              << (UseSlabAllocator ? "on" : "off") << ")..." << std::endl;
+
+    const size_t header = MemTracker::slab_header_size(MemTracker::tracking_level());
+    char* small = AllocateHeap(100, mtTest);
+    char* large = AllocateHeap(4096, mtTest);
+    guarantee(SlabAllocator::contains(small - header) == UseSlabAllocator, "small block backing");
+    guarantee(!SlabAllocator::contains(large), "large block must use malloc");
+    guarantee(((uintptr_t)small & 15) == 0, "slab blocks must be 16-byte aligned");
+    memset(small, 0x5a, 100);
+    FreeHeap(large);
+
+    if (!UseSlabAllocator) {
+        FreeHeap(small);
+        std::cout << "  malloc only: OK" << std::endl;
+        return;
+    }
+
+    guarantee(SlabAllocator::block_flags(small - header) == mtTest, "slab must record MEMFLAGS");
+    guarantee(SlabAllocator::block_size(small - header) >= 100 + header, "block too small");
+    // magazine 是 LIFO，刚释放的块马上被复用
+    FreeHeap(small);
+    char* again = AllocateHeap(100, mtTest);
+    guarantee(again == small, "magazine should hand back the last freed block");
+    FreeHeap(again);
+
+    // 不同 MEMFLAGS 不共用 Slab
+    char* other = AllocateHeap(100, mtInternal);
+    guarantee(SlabAllocator::slab_of(other - header) != SlabAllocator::slab_of(small - header),
+              "different MEMFLAGS must use different slabs");
+    FreeHeap(other);
+
+    // 跨线程分配/释放，线程退出时 magazine 还给中心链表
+    const int n = 10000;
+    static char* blocks[n];
+    std::thread([]() {
+        for (int i = 0; i < n; i++) {
+            blocks[i] = AllocateHeap(16 + (i % 500), mtTest);
+            blocks[i][0] = (char)i;
+        }
+    }).join();
+    size_t slabs = SlabAllocator::slabs_in_use();
+    std::thread([]() {
+        for (int i = 0; i < n; i++) {
+            guarantee(blocks[i][0] == (char)i, "block corrupted");
+            FreeHeap(blocks[i]);
+        }
+    }).join();
+    guarantee(SlabAllocator::slabs_in_use() < slabs, "empty slabs should be released");
+    std::cout << "  magazines and slabs: OK" << std::endl;
+
+    fileStream out(stdout);
+    SlabAllocator::print_statistics(&out);
+}
+
+// ========== 线程私有 ResourceArea ==========
+
+void test_thread_resource_area() {
+    std::cout << "Testing per-thread ResourceArea..." << std::endl;
+
+    ResourceArea* main_area = current_resource_area();
+    guarantee(main_area == Thread::current()->resource_area(), "current area mismatch");
+
+    const int nthreads = 4;
+    ResourceArea* areas[nthreads];
+    std::thread threads[nthreads];
+    std::atomic<int> arrived(0);
+    for (int t = 0; t < nthreads; t++) {
+        threads[t] = std::thread([&areas, &arrived, t]() {
+            areas[t] = current_resource_area();
+            // 等所有线程都拿到各自的 area 后再退出，避免地址被复用
+            arrived++;
+            while (arrived.load() < nthreads) {
+                std::this_thread::yield();
+            }
+            ResourceMark rm;
+            for (int i = 0; i < 1000; i++) {
+                int* p = NEW_RESOURCE_ARRAY(int, 64);
+                p[0] = i;
+                p[63] = t;
+            }
+            guarantee(areas[t]->size_in_bytes() > 0, "should have allocated");
+        });
+    }
+    for (int t = 0; t < nthreads; t++) {
+        threads[t].join();
+    }
+    for (int t = 0; t < nthreads; t++) {
+        guarantee(areas[t] != main_area, "threads must not share the main area");
+        for (int u = t + 1; u < nthreads; u++) {
+            guarantee(areas[t] != areas[u], "threads must not share areas");
+        }
+    }
+    std::cout << "  distinct areas per thread: OK" << std::endl;
+}
+
+// ========== Native Memory Tracking ==========
+// 默认 summary；-XX:NativeMemoryTracking=off 时跳过
+
+// summary 模式下 slab 块按大小类统计
+static size_t nmt_accounted_size(const char* p, size_t size) {
+    if (MemTracker::tracking_level() == NMT_summary && SlabAllocator::contains(p)) {
+        return SlabAllocator::block_size(p);
+    }
+    return size;
+}
+
+void test_native_memory_tracking() {
+    std::cout << "Testing Native Memory Tracking ("
+              << NMTUtil::tracking_level_to_string(MemTracker::tracking_level()) << ")..." << std::endl;
+    if (!MemTracker::enabled()) {
+        std::cout << "  skipped (tracking is off)" << std::endl;
+        return;
+    }
+
+    MallocMemory before = MallocMemorySummary::snapshot(mtTest);
+
+    char* p = AllocateHeap(1000, mtTest);
+    MallocMemory after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.malloc_size() == before.malloc_size() + nmt_accounted_size(p, 1000), "malloc size not recorded");
+    guarantee(after.malloc_count() == before.malloc_count() + 1, "malloc count not recorded");
+    FreeHeap(p);
+    after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.malloc_size() == before.malloc_size(), "free size not recorded");
+    guarantee(after.malloc_count() == before.malloc_count(), "free count not recorded");
+
+    // 走 malloc 的大块按请求的字节数统计
+    char* large = AllocateHeap(4096, mtTest);
+    after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.malloc_size() == before.malloc_size() + 4096, "large malloc size not recorded");
+    guarantee(after.malloc_count() == before.malloc_count() + 1, "large malloc count not recorded");
+    FreeHeap(large);
+
+    // 其他线程的分配（线程退出后折叠进全局计数，magazine 里的块还给中心链表）
+    char* q = nullptr;
+    std::thread([&q]() {
+        FreeHeap(AllocateHeap(500, mtTest));
+        q = AllocateHeap(300, mtTest);
+    }).join();
+    after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.malloc_size() == before.malloc_size() + nmt_accounted_size(q, 300),
+              "thread counters not retired");
+    guarantee(after.malloc_count() == before.malloc_count() + 1, "thread count not retired");
+    FreeHeap(q);
+    after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.malloc_size() == before.malloc_size(), "cross-thread free not recorded");
+    std::cout << "  malloc/free accounting: OK" << std::endl;
+
+    {
+        Arena arena(mtTest);
+        arena.Amalloc(100);
+        after = MallocMemorySummary::snapshot(mtTest);
+        guarantee(after.arena_count() == before.arena_count() + 1, "arena count not recorded");
+        guarantee(after.arena_size() == arena.size_in_bytes(), "arena size not recorded");
+    }
+    after = MallocMemorySummary::snapshot(mtTest);
+    guarantee(after.arena_count() == before.arena_count(), "arena free not recorded");
+    guarantee(after.arena_size() == 0, "arena size not released");
+    std::cout << "  arena accounting: OK" << std::endl;
+
+    // 报告：detail 模式下应包含本函数的调用点
+    char* held = AllocateHeap(64 * 1024, mtTest);
+    fileStream out(stdout);
+    MemTracker::report(false, &out);
+    FreeHeap(held);
+}
+
+int main(int argc, char** argv) {
+    // VM flag 必须在第一次分配之前处理
+    for (int i = 1; i < argc; i++) {
+        guarantee(process_vm_flag(argv[i]), "unrecognized VM flag: %s", argv[i]);
+    }
+
+    std::cout << "=== my_jvm Memory Test ===" << std::endl;
+
+    test_chunk_pool();
+    test_resource_mark();
+    test_arena_used_contains();
+    test_arena_growth_policy();
+    test_arena_huge_pages();
+    test_slab_allocator();
+    test_thread_resource_area();
+    test_native_memory_tracking();
+
+    fileStream out(stdout);
+    ChunkPool::print_statistics(&out);
+
+    std::cout << std::endl;
+    std::cout << "=== All Tests Passed! ===" << std::endl;
+    return 0;
+}
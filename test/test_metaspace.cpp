@@ -0,0 +1,159 @@
+/*
+ * my_jvm - Metaspace test
+ * 测试 ChunkManager / ClassLoaderMetaspace / MetadataFactory 的基本行为
+ *
+ * 注意：debug.hpp 会重定义 assert，这里统一用 guarantee（始终执行）
+ */
+
+#include <cstring>
+#include <iostream>
+#include "classfile/classLoaderData.hpp"
+#include "memory/metadataFactory.hpp"
+#include "memory/metaspace.hpp"
+#include "memory/metaspace/chunkManager.hpp"
+#include "oops/compressedOops.hpp"
+#include "oops/instanceKlass.hpp"
+#include "runtime/globals.hpp"
+#include "utilities/ostream.hpp"
+
+using metaspace::ChunkManager;
+using metaspace::Metachunk;
+
+// ========== ChunkManager ==========
+
+void test_chunk_manager() {
+    std::cout << "Testing ChunkManager..." << std::endl;
+
+    ChunkManager cm(metaspace::MAX_CHUNK_WORD_SIZE * 2);
+
+    // 切一个 root chunk 到最小 level，沿途每级留下一个空闲的 buddy
+    Metachunk* c = cm.get_chunk(metaspace::HIGHEST_CHUNK_LEVEL);
+    guarantee(c != nullptr, "get_chunk failed");
+    guarantee(c->word_size() == metaspace::MIN_CHUNK_WORD_SIZE, "wrong chunk size");
+    guarantee(is_aligned((uintptr_t)c->base(), metaspace::MAX_CHUNK_BYTE_SIZE), "root chunk alignment");
+    for (int l = 1; l <= metaspace::HIGHEST_CHUNK_LEVEL; l++) {
+        guarantee(cm.num_free_chunks(l) == 1, "one free buddy per level");
+    }
+    guarantee(cm.in_use_words() + cm.free_words() == metaspace::MAX_CHUNK_WORD_SIZE, "accounting");
+    std::cout << "  split: OK" << std::endl;
+
+    // 下一个同级 chunk 直接取空闲的 buddy，就在后面
+    Metachunk* d = cm.get_chunk(metaspace::HIGHEST_CHUNK_LEVEL);
+    guarantee(d->base() == c->end(), "buddy should be reused");
+    guarantee(cm.carved_words() == metaspace::MAX_CHUNK_WORD_SIZE, "no new root chunk");
+
+    // 全部归还后合并回一个 root chunk
+    cm.return_chunk(c);
+    cm.return_chunk(d);
+    guarantee(cm.in_use_words() == 0, "all returned");
+    guarantee(cm.num_free_chunks(metaspace::ROOT_CHUNK_LEVEL) == 1, "merged back to root");
+    for (int l = 1; l <= metaspace::HIGHEST_CHUNK_LEVEL; l++) {
+        guarantee(cm.num_free_chunks(l) == 0, "no fragments left");
+    }
+    std::cout << "  merge: OK" << std::endl;
+
+    // 归还的内存已经交还 OS，重新取出来读到的是 0
+    Metachunk* e = cm.get_chunk(metaspace::ROOT_CHUNK_LEVEL);
+    MetaWord* p = e->allocate(16);
+    guarantee(p[0] == 0 && p[15] == 0, "uncommitted memory should read as zero");
+    p[0] = 1;
+    cm.return_chunk(e);
+    std::cout << "  uncommit: OK" << std::endl;
+}
+
+// ========== ClassLoaderMetaspace ==========
+
+void test_class_loader_metaspace() {
+    std::cout << "Testing ClassLoaderMetaspace..." << std::endl;
+
+    ClassLoaderData* cld = new ClassLoaderData();
+    ChunkManager* cm = Metaspace::chunk_manager();
+    size_t in_use_before = cm->in_use_words();
+
+    // Array<T>
+    Array<u2>* a = MetadataFactory::new_array<u2>(cld, 100);
+    guarantee(a->length() == 100, "length");
+    for (int i = 0; i < 100; i++) {
+        guarantee(a->at(i) == 0, "array should be zeroed");
+        a->at_put(i, (u2)i);
+    }
+    guarantee(a->at(99) == 99 && Metaspace::contains(a), "array in metaspace");
+    guarantee(a->size() * BytesPerWord >= (int)(sizeof(Array<u2>) + 99 * sizeof(u2)), "array size");
+
+    Array<int>* b = MetadataFactory::new_array<int>(cld, 10, 7);
+    guarantee(b->at(0) == 7 && b->at(9) == 7, "filled array");
+
+    // 提前释放的块被同一 loader 的下一次同样大小的分配复用
+    MetadataFactory::free_array(cld, a);
+    Array<u2>* c = MetadataFactory::new_array<u2>(cld, 100);
+    guarantee((void*)c == (void*)a, "freed block should be reused");
+    guarantee(c->at(50) == 0, "reused block should be zeroed");
+    std::cout << "  arrays: OK" << std::endl;
+
+    // Klass
+    InstanceKlass* k = new (cld) InstanceKlass();
+    guarantee(Metaspace::contains(k), "klass in metaspace");
+    guarantee(Metaspace::is_in_class_space(k) == UseCompressedClassPointers,
+              "klass should be in class space iff compressed class pointers are on");
+    guarantee(!Metaspace::is_in_class_space(c), "arrays never go to class space");
+    if (UseCompressedClassPointers) {
+        narrowKlass nk = CompressedKlassPointers::encode(k);
+        guarantee(nk != 0 && CompressedKlassPointers::decode(nk) == k, "encode/decode round trip");
+    }
+    guarantee(is_aligned((uintptr_t)k, BytesPerWord), "klass alignment");
+    cld->add_class(k);
+    guarantee(cld->klasses() == k && k->class_loader_data() == cld, "add_class");
+    std::cout << "  klass: OK" << std::endl;
+
+    // 第一个 chunk 4K，之后逐步变大
+    ClassLoaderMetaspace* ms = cld->metaspace_non_null();
+    for (int i = 0; i < 1000; i++) {
+        MetadataFactory::new_array<u1>(cld, 200);
+    }
+    guarantee(ms->num_chunks() > 1, "should have grown");
+    guarantee(ms->capacity_words() >= ms->used_words(), "capacity");
+    guarantee(ms->num_chunks() < 1000 * 200 / 4096, "chunks should grow geometrically");
+
+    fileStream out(stdout);
+    ms->print_on(&out);
+    Metaspace::print_on(&out);
+
+    // 卸载一次归还所有 chunk
+    delete cld;
+    guarantee(cm->in_use_words() == in_use_before, "unload should return all chunks");
+    std::cout << "  unload: OK" << std::endl;
+
+    // 超过 root chunk 的请求失败
+    ClassLoaderData big;
+    guarantee(big.metaspace_non_null()->allocate(metaspace::MAX_CHUNK_WORD_SIZE + 1) == nullptr,
+              "oversized request should fail");
+    std::cout << "  oversized: OK" << std::endl;
+}
+
+void test_boot_metaspace() {
+    std::cout << "Testing boot metaspace..." << std::endl;
+
+    ClassLoaderData* boot = ClassLoaderData::the_null_class_loader_data();
+    guarantee(boot == ClassLoaderData::the_null_class_loader_data(), "singleton");
+    guarantee(boot->is_the_null_class_loader_data(), "boot flag");
+    MetadataFactory::new_array<u1>(boot, 16);
+    guarantee(boot->metaspace_non_null()->capacity_words() == metaspace::word_size_for_level(4),
+              "boot loader starts with a 256K chunk");
+    std::cout << "  boot: OK" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        guarantee(process_vm_flag(argv[i]), "unrecognized VM flag: %s", argv[i]);
+    }
+
+    std::cout << "=== my_jvm Metaspace Test ===" << std::endl;
+
+    test_chunk_manager();
+    test_class_loader_metaspace();
+    test_boot_metaspace();
+
+    std::cout << std::endl;
+    std::cout << "=== All Tests Passed! ===" << std::endl;
+    return 0;
+}
@@ -4,10 +4,10 @@
  */
 
 #include <iostream>
-#include <cassert>
 #include "utilities/macros.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include "utilities/align.hpp"
+#include "utilities/debug.hpp"
 #include "runtime/atomic.hpp"
 #include "oops/oop.hpp"
 #include "oops/klass.hpp"
@@ -112,13 +112,13 @@ int main() {
     intptr_t atomic_val = 0;
     atomic_store(&atomic_val, (intptr_t)42);
     intptr_t loaded = atomic_load(&atomic_val);
-    assert(loaded == 42);
+    guarantee(loaded == 42, "atomic_store/load");
     std::cout << "  atomic_store/load: OK" << std::endl;
     
     // Add 测试
     atomic_store(&atomic_val, (intptr_t)50);
     intptr_t add_result = atomic_add(&atomic_val, (intptr_t)50);
-    assert(atomic_load(&atomic_val) == 100);
+    guarantee(add_result == 50 && atomic_load(&atomic_val) == 100, "atomic_add");
     std::cout << "  atomic_add: OK" << std::endl;
     
     // 测试对齐宏
@@ -128,8 +128,8 @@ int main() {
     size_t aligned8 = align_up(addr1, 8);
     size_t aligned16 = align_up(addr1, 16);
     
-    assert(aligned8 == 104);
-    assert(aligned16 == 112);
+    guarantee(aligned8 == 104, "align_up 8");
+    guarantee(aligned16 == 112, "align_up 16");
     
     std::cout << "  align_up(100, 8) = " << aligned8 << std::endl;
     std::cout << "  align_up(100, 16) = " << aligned16 << std::endl;
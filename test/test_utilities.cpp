@@ -0,0 +1,1144 @@
+/*
+ * my_jvm - Utilities test
+ * 测试 utilities 下的容器和算法，以及它们依赖的 Atomic / OrderAccess / VM 内部锁
+ *
+ * 注意：debug.hpp 会重定义 assert，这里统一用 guarantee（始终执行）
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "memory/arena.hpp"
+#include "memory/resourceArea.hpp"
+#include "oops/array.hpp"
+#include "runtime/atomic.hpp"
+#include "runtime/globals.hpp"
+#include "runtime/mutex.hpp"
+#include "runtime/orderAccess.hpp"
+#include "runtime/thread.hpp"
+#include "runtime/vm_version.hpp"
+#include "utilities/concurrentHashTable.hpp"
+#include "utilities/copy.hpp"
+#include "utilities/globalCounter.hpp"
+#include "utilities/growableArray.hpp"
+#include "utilities/ostream.hpp"
+#include "utilities/quickSort.hpp"
+#include "utilities/segmentedArray.hpp"
+#include "utilities/stripedCounter.hpp"
+#include "utilities/vectorSearch.hpp"
+
+// ========== Atomic / OrderAccess ==========
+
+enum TestState { state_a = 1, state_b = 2 };
+
+// 各种宽度的整数都走同一套模板：返回值语义与回绕
+template <typename T>
+static void check_atomic_integer() {
+    volatile T v = 0;
+    guarantee(Atomic::fetch_and_add(&v, 5) == 0 && v == 5, "fetch_and_add");
+    guarantee(Atomic::add_and_fetch(&v, 3, memory_order_relaxed) == 8, "add_and_fetch");
+    guarantee(Atomic::sub_and_fetch(&v, 8, memory_order_acq_rel) == 0, "sub_and_fetch");
+    Atomic::dec(&v);
+    guarantee(v == (T)-1, "dec wraps");
+    Atomic::inc(&v, memory_order_relaxed);
+    guarantee(Atomic::load(&v) == 0, "inc");
+
+    guarantee(Atomic::fetch_and_or(&v, (T)0x41) == 0 && v == 0x41, "fetch_and_or");
+    guarantee(Atomic::fetch_and_and(&v, (T)0x0f, memory_order_release) == 0x41 && v == 0x01, "fetch_and_and");
+    guarantee(Atomic::fetch_and_xor(&v, (T)0x03, memory_order_acquire) == 0x01 && v == 0x02, "fetch_and_xor");
+
+    guarantee(Atomic::cmpxchg(&v, (T)7, (T)9) == 0x02 && v == 0x02, "failed cmpxchg returns old value");
+    guarantee(Atomic::cmpxchg(&v, (T)2, (T)9, memory_order_relaxed) == 2 && v == 9, "cmpxchg");
+    guarantee(Atomic::xchg(&v, (T)4, memory_order_acquire) == 9 && v == 4, "xchg");
+    Atomic::store(&v, (T)-2, memory_order_release);
+    guarantee(Atomic::load(&v, memory_order_acquire) == (T)-2, "store/load");
+}
+
+void test_atomic() {
+    std::cout << "Testing Atomic..." << std::endl;
+
+    check_atomic_integer<jbyte>();
+    check_atomic_integer<u1>();
+    check_atomic_integer<jshort>();
+    check_atomic_integer<u2>();
+    check_atomic_integer<jint>();
+    check_atomic_integer<juint>();
+    check_atomic_integer<jlong>();
+    check_atomic_integer<julong>();
+
+    // 指针按元素个数移动
+    jlong buf[8];
+    jlong* volatile p = &buf[0];
+    guarantee(Atomic::add_and_fetch(&p, 3) == &buf[3], "pointer add_and_fetch");
+    guarantee(Atomic::fetch_and_add(&p, -1) == &buf[3] && p == &buf[2], "pointer fetch_and_add");
+    guarantee(Atomic::sub_and_fetch(&p, 2) == &buf[0], "pointer sub_and_fetch");
+    guarantee(Atomic::cmpxchg(&p, &buf[0], &buf[5]) == &buf[0] && p == &buf[5], "pointer cmpxchg");
+
+    // 枚举可以读写和交换
+    volatile TestState st = state_a;
+    guarantee(Atomic::cmpxchg(&st, state_a, state_b) == state_a && Atomic::load(&st) == state_b, "enum cmpxchg");
+    guarantee(Atomic::xchg(&st, state_a) == state_b, "enum xchg");
+
+    // 早期的自由函数接口行为不变
+    jint legacy = 1;
+    guarantee(atomic_add(&legacy, 2) == 1 && atomic_load(&legacy) == 3, "atomic_add returns old value");
+    guarantee(atomic_cas(&legacy, 10, 3) == 3 && legacy == 10, "atomic_cas");
+
+    // relaxed 计数：并发累加不丢失
+    {
+        volatile size_t counter = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([&counter]() {
+                for (int i = 0; i < 100000; i++) {
+                    Atomic::inc(&counter, memory_order_relaxed);
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        guarantee(Atomic::load(&counter) == 400000, "relaxed increments are not lost");
+    }
+
+    // 消息传递：release 发布的数据，acquire 读到标记后一定能看到
+    {
+        const int rounds = 2000;
+        volatile jint data[4] = { 0, 0, 0, 0 };
+        volatile jint flag = 0;
+        std::thread consumer([&]() {
+            for (int r = 1; r <= rounds; r++) {
+                while (OrderAccess::load_acquire(&flag) != r) {
+                    std::this_thread::yield();
+                }
+                for (int k = 0; k < 4; k++) {
+                    guarantee(data[k] == r * 4 + k, "acquire sees released data");
+                }
+                OrderAccess::release_store(&flag, -r);
+            }
+        });
+        for (int r = 1; r <= rounds; r++) {
+            for (int k = 0; k < 4; k++) {
+                data[k] = r * 4 + k;
+            }
+            OrderAccess::release_store(&flag, r);
+            while (OrderAccess::load_acquire(&flag) != -r) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    }
+
+    // 屏障本身只需要能调用
+    OrderAccess::loadload();
+    OrderAccess::storestore();
+    OrderAccess::loadstore();
+    OrderAccess::storeload();
+    OrderAccess::fence();
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== SpinLock / Mutex / Monitor ==========
+
+// nthreads 个线程各自加锁做 iters 次非原子的自增，结果不能丢
+template <typename Lock>
+static void check_mutual_exclusion(Lock* lock, int nthreads, int iters) {
+    static volatile jlong counter;
+    counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; t++) {
+        threads.emplace_back([lock, iters]() {
+            for (int i = 0; i < iters; i++) {
+                lock->lock();
+                counter = counter + 1;
+                lock->unlock();
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    guarantee(counter == (jlong)nthreads * iters, "lost update under %s", lock->name());
+    guarantee(!lock->is_locked(), "unlocked at the end");
+}
+
+void test_locks() {
+    std::cout << "Testing SpinLock / Mutex / Monitor..." << std::endl;
+
+    LockContentionStatistics = true;
+
+    SpinLock spin(SpinLock::leaf, "test spin lock");
+    guarantee(spin.try_lock() && spin.is_locked() && !spin.try_lock(), "spin try_lock");
+    spin.unlock();
+    check_mutual_exclusion(&spin, 4, 20000);
+
+    Mutex mutex(Mutex::leaf, "test mutex");
+    guarantee(mutex.try_lock() && !mutex.try_lock(), "mutex try_lock");
+    mutex.unlock();
+    {
+        MutexLocker ml(&mutex);
+        guarantee(mutex.is_locked(), "MutexLocker locks");
+    }
+    guarantee(!mutex.is_locked(), "MutexLocker unlocks");
+    check_mutual_exclusion(&mutex, 4, 20000);
+
+    // 持锁期间另一个线程来抢：走慢速路径，计数器记下来
+    {
+        Mutex m(Mutex::leaf, "contended mutex");
+        m.lock();
+        std::thread other([&m]() {
+            m.lock();
+            m.unlock();
+        });
+        // 自旋不会成功，最后一定会 park
+        while (m.blocked_count() == 0) {
+            std::this_thread::yield();
+        }
+        m.unlock();
+        other.join();
+        guarantee(m.contended_count() == 1 && m.blocked_count() >= 1, "contention statistics");
+    }
+    LockContentionStatistics = false;
+
+    // 按 rank 从高到低嵌套加锁
+    {
+        Mutex outer(Mutex::nonleaf, "outer");
+        SpinLock inner(SpinLock::special, "inner");
+        MutexLocker ml(&outer);
+        SpinLocker sl(&inner);
+        guarantee(outer.is_locked() && inner.is_locked(), "nested locking");
+    }
+
+    // Monitor：生产者/消费者，队列满了或空了就 wait
+    {
+        Monitor monitor(Mutex::leaf, "test monitor");
+        const int items = 20000;
+        const int capacity = 8;
+        int queue[capacity];
+        int head = 0, count = 0;
+        jlong consumed_sum = 0;
+
+        std::thread consumer([&]() {
+            for (int i = 0; i < items; i++) {
+                MonitorLocker ml(&monitor);
+                while (count == 0) {
+                    ml.wait();
+                }
+                consumed_sum += queue[head];
+                head = (head + 1) % capacity;
+                count--;
+                ml.notify_all();
+            }
+        });
+        for (int i = 1; i <= items; i++) {
+            MonitorLocker ml(&monitor);
+            while (count == capacity) {
+                ml.wait();
+            }
+            queue[(head + count) % capacity] = i;
+            count++;
+            ml.notify();
+        }
+        consumer.join();
+        guarantee(consumed_sum == (jlong)items * (items + 1) / 2, "every item consumed once");
+
+        // 没有人 notify 时按超时返回
+        MonitorLocker ml(&monitor);
+        guarantee(ml.wait(10), "wait times out");
+        guarantee(monitor.is_locked(), "lock reacquired after wait");
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== GrowableArray ==========
+
+// 统计构造/析构次数的元素类型
+struct Counted {
+    static int live;
+    static int copies;
+    static int moves;
+    int value;
+
+    Counted() : value(-1) { live++; }
+    explicit Counted(int v) : value(v) { live++; }
+    Counted(const Counted& o) : value(o.value) { live++; copies++; }
+    Counted(Counted&& o) : value(o.value) { o.value = -2; live++; moves++; }
+    Counted& operator=(const Counted& o) { value = o.value; copies++; return *this; }
+    Counted& operator=(Counted&& o) { value = o.value; o.value = -2; moves++; return *this; }
+    ~Counted() { live--; }
+    bool operator==(const Counted& o) const { return value == o.value; }
+};
+
+int Counted::live = 0;
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+void test_growable_array_lifecycle() {
+    std::cout << "Testing GrowableArray element lifecycle..." << std::endl;
+
+    Counted::live = Counted::copies = Counted::moves = 0;
+    {
+        GrowableArray<Counted> a(100, true, mtTest);
+        // 只构造 [0, _len)
+        guarantee(Counted::live == 0, "initial capacity is not constructed");
+        for (int i = 0; i < 1000; i++) {
+            a.append(Counted(i));
+        }
+        guarantee(Counted::live == 1000, "only live elements are constructed");
+        guarantee(Counted::copies == 0, "growth moves instead of copying");
+        for (int i = 0; i < 1000; i++) {
+            guarantee(a.at(i).value == i, "element survives growth");
+        }
+
+        // 追加数组里的元素本身，扩容时不能读到已移走的值
+        while (a.length() < a.max_length()) {
+            a.append(Counted(0));
+        }
+        a.append(a.at(5));
+        guarantee(a.top().value == 5, "self append across growth");
+
+        a.trunc_to(10);
+        guarantee(Counted::live == 10, "trunc_to destroys the tail");
+        Counted last = a.pop();
+        guarantee(last.value == 9 && Counted::live == 10, "pop moves out and destroys");
+        a.remove_at(0);
+        guarantee(a.length() == 8 && a.at(0).value == 1 && Counted::live == 9, "remove_at");
+
+        a.at_put_grow(20, Counted(42), Counted(7));
+        guarantee(a.length() == 21 && a.at(20).value == 42 && a.at(8).value == 7, "at_put_grow");
+        guarantee(Counted::live == 22, "at_put_grow constructs the gap");
+    }
+    guarantee(Counted::live == 0, "C heap array destroys its elements");
+    std::cout << "  OK" << std::endl;
+}
+
+void test_growable_array_arena() {
+    std::cout << "Testing GrowableArray in arenas..." << std::endl;
+
+    // 数组是 Arena 里最后分配的块：原地扩展
+    Arena arena(mtTest);
+    GrowableArray<int> a(&arena, 4, 0, 0);
+    int* first = a.begin();
+    size_t used = arena.used();
+    for (int i = 0; i < 64; i++) {
+        a.append(i);
+    }
+    guarantee(a.begin() == first, "grown in place");
+    guarantee(arena.used() == used + 60 * sizeof(int), "no garbage left behind");
+
+    // 中间插入了别的分配：搬到新地址
+    arena.Amalloc(8);
+    for (int i = 64; i < 200; i++) {
+        a.append(i);
+    }
+    guarantee(a.begin() != first, "relocated");
+    for (int i = 0; i < 200; i++) {
+        guarantee(a.at(i) == i, "arena elements");
+    }
+
+    // 非平凡类型：原地扩展不移动元素
+    GrowableArray<std::string> s(&arena, 2, 1, std::string("filler"));
+    std::string* sfirst = s.begin();
+    for (int i = 0; i < 50; i++) {
+        s.append(std::to_string(i));
+    }
+    guarantee(s.begin() == sfirst && s.at(0) == "filler" && s.at(50) == "49", "string in place");
+    s.clear();
+
+    // ResourceArea
+    {
+        ResourceMark rm;
+        GrowableArray<jlong> r(2);
+        for (int i = 0; i < 10000; i++) {
+            r.append(i);
+        }
+        guarantee(r.length() == 10000 && r.at(9999) == 9999, "resource area array");
+        r.reserve(20000);
+        guarantee(r.max_length() >= 20000, "reserve");
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== VectorSearch ==========
+
+// 每种长度、每个命中位置（含多个相等元素）都和标量版本对比
+template <typename T>
+static void check_search(T (*make)(int)) {
+    const int max_len = 80;
+    T* data = (T*)malloc((max_len + 1) * sizeof(T));
+    for (int len = 0; len <= max_len; len++) {
+        // 从非对齐的地址开始，核心不能假设对齐
+        T* p = data + (len & 1);
+        for (int i = 0; i < len; i++) {
+            p[i] = make(i);
+        }
+        guarantee(VectorSearch::find_first(p, len, make(-1)) == -1, "miss");
+        guarantee(VectorSearch::find_last(p, len, make(-1)) == -1, "miss backwards");
+        for (int hit = 0; hit < len; hit++) {
+            T key = p[hit];
+            guarantee(VectorSearch::find_first(p, len, key) == hit, "find_first");
+            guarantee(VectorSearch::find_last(p, len, key) == hit, "find_last");
+            // 再放一个相同的值，分别找到最前 / 最后的
+            int dup = (hit * 7 + 3) % len;
+            T saved = p[dup];
+            p[dup] = key;
+            guarantee(VectorSearch::find_first(p, len, key) ==
+                      VectorSearch::find_first_scalar(p, len, key), "find_first with duplicate");
+            guarantee(VectorSearch::find_last(p, len, key) ==
+                      VectorSearch::find_last_scalar(p, len, key), "find_last with duplicate");
+            p[dup] = saved;
+        }
+    }
+    free(data);
+}
+
+static jint make_int(int i)     { return i < 0 ? -7 : i * 3 + 1; }
+static jlong make_long(int i)   { return i < 0 ? 0x100000000LL : ((jlong)i << 32) | (jlong)(i + 1); }
+static void* make_ptr(int i)    { return (void*)(uintptr_t)(i < 0 ? 8 : 0x7f0000001000ULL + i * 16); }
+// 低 32 位相同、高 32 位不同：64 位比较必须看两半
+static julong make_halves(int i) { return i < 0 ? 5 : ((julong)(i + 1) << 32) | 5; }
+
+void test_vector_search() {
+    std::cout << "Testing VectorSearch (" << VectorSearch::kernel_name() << ")..." << std::endl;
+
+    check_search<jint>(make_int);
+    check_search<jlong>(make_long);
+    check_search<void*>(make_ptr);
+    check_search<julong>(make_halves);
+    std::cout << "  kernels: OK" << std::endl;
+
+    // GrowableArray::find / find_from / remove_at
+    GrowableArray<jint> a(0, true, mtTest);
+    for (int i = 0; i < 100; i++) {
+        a.append(i % 50);
+    }
+    guarantee(a.find(49) == 49 && a.find_from(50, 49) == 99, "find_from");
+    guarantee(a.find_from(100, 0) == -1 && !a.contains(50), "find miss");
+    a.remove_at(10);
+    guarantee(a.length() == 99 && a.at(10) == 11 && a.at(98) == 49, "remove_at memmove");
+
+    // Array<T>::index_of 返回最后一个
+    const int n = 40;
+    void* buf = malloc(Array<Klass*>::size(n) * BytesPerWord);
+    Array<Klass*>* arr = ::new (buf) Array<Klass*>(n);
+    for (int i = 0; i < n; i++) {
+        arr->at_put(i, (Klass*)(uintptr_t)(0x1000 + (i % 20) * 8));
+    }
+    guarantee(arr->index_of((Klass*)(uintptr_t)0x1000) == 20, "index_of finds the last match");
+    guarantee(!arr->contains((Klass*)(uintptr_t)0x2000), "contains miss");
+    free(buf);
+    std::cout << "  containers: OK" << std::endl;
+}
+
+// ========== 排序与二分查找 ==========
+
+static int compare_int(const jint& a, const jint& b) {
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+// 各种输入形状下和 std::sort 的结果一致
+void test_sort() {
+    std::cout << "Testing QuickSort..." << std::endl;
+
+    uint32_t seed = 42;
+    auto next = [&seed]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+    const int lens[] = { 0, 1, 2, 3, 15, 16, 17, 100, 1000, 20000 };
+    for (int len : lens) {
+        for (int shape = 0; shape < 6; shape++) {
+            std::vector<jint> v(len);
+            for (int i = 0; i < len; i++) {
+                switch (shape) {
+                    case 0: v[i] = (jint)next(); break;                // 随机
+                    case 1: v[i] = i; break;                           // 已排序
+                    case 2: v[i] = len - i; break;                     // 逆序
+                    case 3: v[i] = (jint)(next() % 4); break;          // 大量重复
+                    case 4: v[i] = i < len / 2 ? i : len - i; break;   // 山峰
+                    default: v[i] = 7; break;                          // 全部相等
+                }
+            }
+            std::vector<jint> expected = v;
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<jint> a = v;
+            QuickSort::sort(a.data(), a.size(), compare_int);
+            guarantee(a == expected, "introsort len=%d shape=%d", len, shape);
+
+            std::vector<jint> h = v;
+            QuickSort::heap_sort(h.data(), h.size(), [](jint x, jint y) { return x < y ? -1 : (x > y ? 1 : 0); });
+            guarantee(h == expected, "heap sort len=%d shape=%d", len, shape);
+        }
+    }
+
+    // 非平凡元素类型
+    GrowableArray<std::string> strs(0, true, mtTest);
+    for (int i = 0; i < 500; i++) {
+        strs.append(std::to_string((i * 7919) % 500));
+    }
+    strs.sort([](const std::string& x, const std::string& y) { return x.compare(y); });
+    for (int i = 1; i < strs.length(); i++) {
+        guarantee(strs.at(i - 1) < strs.at(i), "strings sorted");
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+void test_sorted_growable_array() {
+    std::cout << "Testing sorted GrowableArray..." << std::endl;
+
+    GrowableArray<jint> a(0, true, mtTest);
+    bool found;
+    guarantee((a.find_sorted<jint, compare_int>(5, found)) == 0 && !found, "empty");
+
+    // 乱序插入，结果有序且没有重复
+    for (int i = 0; i < 1000; i++) {
+        jint v = (jint)((i * 37) % 500) * 2;     // 0, 2, ... 998，每个出现两次
+        guarantee(a.insert_sorted<compare_int>(v) == v, "insert_sorted returns the element");
+    }
+    guarantee(a.length() == 500, "duplicates are not inserted");
+    for (int i = 0; i < a.length(); i++) {
+        guarantee(a.at(i) == i * 2, "sorted");
+    }
+
+    // 命中返回下标，不命中返回插入点
+    guarantee((a.find_sorted<jint, compare_int>(10, found)) == 5 && found, "hit");
+    guarantee((a.find_sorted<jint, compare_int>(11, found)) == 6 && !found, "insertion point");
+    guarantee((a.find_sorted<jint, compare_int>(-1, found)) == 0 && !found, "before first");
+    guarantee((a.find_sorted<jint, compare_int>(5000, found)) == 500 && !found, "after last");
+
+    // delete_at 用最后一个元素填补
+    a.delete_at(0);
+    guarantee(a.length() == 499 && a.at(0) == 998, "delete_at swaps in the last element");
+    a.delete_at(a.length() - 1);
+    guarantee(a.length() == 498 && a.at(a.length() - 1) == 994, "delete_at last");
+    a.sort<compare_int>();
+    guarantee(a.at(0) == 2 && a.at(496) == 994 && a.at(497) == 998, "sort after delete_at");
+
+    GrowableArray<std::string> s(2, true, mtTest);
+    s.append("a");
+    s.append("c");
+    s.insert_before(1, "b");
+    s.insert_before(0, "0");
+    guarantee(s.length() == 4 && s.at(0) == "0" && s.at(1) == "a" && s.at(2) == "b" && s.at(3) == "c",
+              "insert_before");
+    s.delete_at(1);
+    guarantee(s.length() == 3 && s.at(1) == "c", "delete_at string");
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== SegmentedArray ==========
+
+void test_segmented_array() {
+    std::cout << "Testing SegmentedArray..." << std::endl;
+
+    // 单线程：下标连续，段边界前后的元素都能读到，地址不随追加移动
+    {
+        SegmentedArray<jlong, mtTest> a;
+        guarantee(a.length() == 0, "empty");
+        const jlong* first = nullptr;
+        for (int i = 0; i < 5000; i++) {
+            guarantee(a.append((jlong)i * 3) == i, "append returns the index");
+            if (i == 0) first = a.adr_at(0);
+        }
+        guarantee(a.length() == 5000 && a.adr_at(0) == first, "segments never move");
+        for (int i = 0; i < 5000; i++) {
+            guarantee(a.is_published(i) && a.at(i) == (jlong)i * 3, "at");
+        }
+        int visited = 0;
+        a.iterate([&](int i, const jlong& v) {
+            guarantee(i == visited && v == (jlong)i * 3, "iterate order");
+            visited++;
+        });
+        guarantee(visited == 5000, "iterate count");
+    }
+
+    // 多个写者并发追加，同时有读者遍历：每个值恰好出现一次，读到的都是完整的元素
+    {
+        SegmentedArray<std::string, mtTest> a;
+        const int writers = 4;
+        const int per_writer = 20000;
+        volatile bool done = false;
+        std::thread reader([&]() {
+            while (!done) {
+                a.iterate([](int, const std::string& s) {
+                    guarantee(s.size() > 8 && s.compare(0, 2, "w-") == 0, "torn element");
+                });
+            }
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < writers; t++) {
+            threads.emplace_back([&a, t]() {
+                for (int i = 0; i < per_writer; i++) {
+                    a.append("w-" + std::to_string(t) + "-" + std::to_string(i) + "-padding");
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        done = true;
+        reader.join();
+
+        guarantee(a.length() == writers * per_writer, "length");
+        std::vector<int> seen(writers * per_writer, 0);
+        int count = 0;
+        a.iterate([&](int, const std::string& s) {
+            int t, i;
+            guarantee(sscanf(s.c_str(), "w-%d-%d-", &t, &i) == 2, "parse");
+            seen[t * per_writer + i]++;
+            count++;
+        });
+        guarantee(count == writers * per_writer, "all published");
+        for (int v : seen) {
+            guarantee(v == 1, "each value exactly once");
+        }
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== GlobalCounter ==========
+
+void test_global_counter() {
+    std::cout << "Testing GlobalCounter..." << std::endl;
+    Thread* thread = Thread::current();
+
+    // 没有读者时 write_synchronize 立即返回；临界区可以嵌套
+    GlobalCounter::write_synchronize();
+    {
+        GlobalCounter::CriticalSection outer(thread);
+        guarantee((*thread->get_rcu_counter() & 1) != 0, "active in critical section");
+        {
+            GlobalCounter::CriticalSection inner(thread);
+        }
+        guarantee((*thread->get_rcu_counter() & 1) != 0, "still active after nested section");
+    }
+    guarantee((*thread->get_rcu_counter() & 1) == 0, "inactive after critical section");
+
+    // write_synchronize 要等调用之前进入的读者离开
+    volatile jint reader_state = 0;   // 1：已进入临界区；2：写者已开始等待
+    volatile bool left = false;
+    std::thread reader([&]() {
+        Thread* t = Thread::current();
+        GlobalCounter::CriticalSection cs(t);
+        OrderAccess::release_store(&reader_state, 1);
+        while (OrderAccess::load_acquire(&reader_state) != 2) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < 50; i++) {
+            std::this_thread::yield();
+        }
+        OrderAccess::release_store(&left, true);
+    });
+    while (OrderAccess::load_acquire(&reader_state) != 1) {
+        std::this_thread::yield();
+    }
+    OrderAccess::release_store(&reader_state, 2);
+    GlobalCounter::write_synchronize();
+    guarantee(OrderAccess::load_acquire(&left), "write_synchronize returned while a reader was inside");
+    reader.join();
+
+    // DeferredFree：读者还在临界区时封批的内存不能释放，读者离开后 poll 释放整批
+    {
+        static volatile jint freed = 0;
+        auto free_func = [](void* p) {
+            Atomic::inc(&freed);
+            FreeHeap(p);
+        };
+        volatile jint state = 0;   // 1：读者已进入；2：可以离开
+        std::thread slow_reader([&]() {
+            GlobalCounter::CriticalSection cs(Thread::current());
+            OrderAccess::release_store(&state, 1);
+            while (OrderAccess::load_acquire(&state) != 2) {
+                std::this_thread::yield();
+            }
+        });
+        while (OrderAccess::load_acquire(&state) != 1) {
+            std::this_thread::yield();
+        }
+        DeferredFree* df = new DeferredFree();
+        for (int i = 0; i < 100; i++) {
+            df->defer(AllocateHeap(16, mtTest), free_func);
+        }
+        guarantee(df->pending_count() == 100, "nothing freed yet");
+        guarantee(df->poll() == 0 && Atomic::load(&freed) == 0, "freed while a reader was inside");
+        OrderAccess::release_store(&state, 2);
+        slow_reader.join();
+        guarantee(df->poll() == 64 && Atomic::load(&freed) == 64, "sealed batch freed after reader left");
+        delete df;
+        guarantee(Atomic::load(&freed) == 100, "destructor flushes the rest");
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== ConcurrentHashTable ==========
+
+// 值就是键本身（非 0 整数）。节点分配计数，用来检查删除和析构不漏不重
+static volatile jlong cht_live_nodes = 0;
+
+struct TestTableConfig {
+    static uintx get_hash(const uintx& value) {
+        return value * 0x9E3779B97F4A7C15ULL;
+    }
+    static void* allocate_node(size_t size, const uintx&) {
+        Atomic::inc(&cht_live_nodes);
+        return AllocateHeap(size, mtTest);
+    }
+    static void free_node(void* memory, const uintx& value) {
+        // 释放前写坏节点，被读者看到会在 equals 里报错
+        ((uintx*)memory)[1] = 0;
+        (void)value;
+        Atomic::dec(&cht_live_nodes);
+        FreeHeap(memory);
+    }
+};
+
+typedef ConcurrentHashTable<uintx, TestTableConfig, mtTest> TestTable;
+
+struct TestLookup {
+    uintx _key;
+    explicit TestLookup(uintx key) : _key(key) {}
+    uintx get_hash() const { return TestTableConfig::get_hash(_key); }
+    bool equals(const uintx* value) {
+        guarantee(*value != 0, "reader saw a freed node");
+        return *value == _key;
+    }
+};
+
+static bool cht_contains(TestTable* table, Thread* thread, uintx key) {
+    uintx found = 0;
+    bool ok = table->get(thread, TestLookup(key), [&](uintx* v) { found = *v; });
+    guarantee(!ok || found == key, "found wrong value");
+    return ok;
+}
+
+void test_concurrent_hash_table() {
+    std::cout << "Testing ConcurrentHashTable..." << std::endl;
+    Thread* thread = Thread::current();
+
+    // 单线程：插入、重复插入、查找、删除，扩容缩容前后内容不变
+    {
+        TestTable* table = new TestTable(2, 12);
+        const uintx n = 2000;
+        for (uintx k = 1; k <= n; k++) {
+            guarantee(table->insert(thread, TestLookup(k), k), "insert");
+        }
+        guarantee(!table->insert(thread, TestLookup(7), (uintx)7), "duplicate insert");
+        uintx seen = 0;
+        guarantee(!table->insert_get(thread, TestLookup(7), (uintx)7, [&](uintx* v) { seen = *v; }),
+                  "insert_get on existing");
+        guarantee(seen == 7, "insert_get reports the existing value");
+
+        bool grow_hint = false;
+        table->get(thread, TestLookup(1), [](uintx*) {}, &grow_hint);
+        guarantee(grow_hint, "2000 entries in 4 buckets should ask for a grow");
+        while (table->grow()) {
+        }
+        guarantee(table->get_size_log2(thread) == 12 && table->is_max_size_reached(), "grew to limit");
+        for (uintx k = 1; k <= n; k++) {
+            guarantee(cht_contains(table, thread, k), "lost entry after grow");
+        }
+        guarantee(!cht_contains(table, thread, n + 1), "phantom entry");
+
+        for (uintx k = 1; k <= n; k += 2) {
+            guarantee(table->remove(thread, TestLookup(k)), "remove");
+        }
+        guarantee(!table->remove(thread, TestLookup(1)), "remove twice");
+        while (table->shrink()) {
+        }
+        guarantee(table->get_size_log2(thread) == 2, "shrank to start size");
+        uintx count = 0;
+        table->do_scan(thread, [&](uintx* v) {
+            guarantee(*v % 2 == 0, "removed entry still present");
+            count++;
+            return true;
+        });
+        guarantee(count == n / 2, "scan count");
+        delete table;
+        guarantee(Atomic::load(&cht_live_nodes) == 0, "all nodes freed");
+    }
+
+    // 读者、插入/删除的写者和反复扩容缩容的线程同时运行。
+    // 0 < k <= stable 的键一直在表里，读者每次都必须找到
+    {
+        TestTable* table = new TestTable(3, 14);
+        const uintx stable = 500;
+        const uintx churn_base = 1000000;
+        for (uintx k = 1; k <= stable; k++) {
+            table->insert(thread, TestLookup(k), k);
+        }
+        volatile bool done = false;
+        std::vector<std::thread> threads;
+        for (int r = 0; r < 2; r++) {
+            threads.emplace_back([&, r]() {
+                Thread* t = Thread::current();
+                uintx k = 1 + r;
+                while (!Atomic::load(&done)) {
+                    guarantee(cht_contains(table, t, k), "stable key missing during resize");
+                    k = k % stable + 1;
+                }
+            });
+        }
+        for (int w = 0; w < 2; w++) {
+            threads.emplace_back([&, w]() {
+                Thread* t = Thread::current();
+                for (uintx i = 0; i < 1000; i++) {
+                    uintx k = churn_base + (uintx)w * 100000 + i;
+                    guarantee(table->insert(t, TestLookup(k), k), "churn insert");
+                    guarantee(cht_contains(table, t, k), "churn key visible to its writer");
+                    if (i % 3 != 0) {
+                        guarantee(table->remove(t, TestLookup(k)), "churn remove");
+                    }
+                }
+            });
+        }
+        std::thread resizer([&]() {
+            for (int round = 0; round < 4; round++) {
+                while (table->grow(10)) {
+                }
+                while (table->shrink()) {
+                }
+            }
+        });
+        resizer.join();
+        for (size_t i = 2; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        Atomic::store(&done, true);
+        threads[0].join();
+        threads[1].join();
+
+        uintx count = 0;
+        table->do_scan(thread, [&](uintx*) { count++; return true; });
+        guarantee(count == stable + 2 * ((1000 + 2) / 3), "entries after concurrent churn");
+        delete table;
+        guarantee(Atomic::load(&cht_live_nodes) == 0, "all nodes freed");
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// ========== StripedCounter / PerThreadCounter ==========
+
+void test_striped_counters() {
+    std::cout << "Testing StripedCounter and PerThreadCounter..." << std::endl;
+
+    // 单线程：没有竞争就不分配 cell
+    {
+        StripedCounter c;
+        for (int i = 0; i < 1000; i++) {
+            c.inc();
+        }
+        c.add(-10);
+        guarantee(c.sum() == 990 && c.cells() == 0, "uncontended counter stays on the base");
+        c.reset();
+        guarantee(c.sum() == 0, "reset");
+    }
+
+    // 多线程：不管落在 _base 还是 cell 上，总和都准确
+    {
+        static StripedCounter c;
+        const int nthreads = 8;
+        const int per_thread = 100000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nthreads; t++) {
+            threads.emplace_back([]() {
+                for (int i = 0; i < per_thread; i++) {
+                    c.add(3);
+                    c.dec();
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        guarantee(c.sum() == (jlong)nthreads * per_thread * 2, "striped sum");
+    }
+
+    // PerThreadCounter：退出线程的计数折叠进 _retired，活动线程的计数在 sum() 时读取
+    {
+        PerThreadCounter* c = new PerThreadCounter();
+        const int nthreads = 4;
+        const int per_thread = 50000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nthreads; t++) {
+            threads.emplace_back([c]() {
+                for (int i = 0; i < per_thread; i++) {
+                    c->inc();
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        c->add(7);   // 主线程仍然活着
+        guarantee(c->sum() == (jlong)nthreads * per_thread + 7, "per-thread sum");
+
+        // 槽位释放后重新分配给新计数器，旧值已清零
+        delete c;
+        PerThreadCounter* d = new PerThreadCounter();
+        guarantee(d->sum() == 0, "reused slot starts at zero");
+        d->inc();
+        guarantee(d->sum() == 1, "reused slot counts");
+        delete d;
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+// 用 memmove 的结果做参照：src 和 dst 在同一个缓冲区里，覆盖重叠的两个方向
+template <typename COPY>
+static void check_copy_against_memmove(size_t unit, size_t from_off, size_t to_off,
+                                       size_t bytes, COPY copy) {
+    const size_t buf_size = 1024;
+    alignas(64) jubyte buf[buf_size];
+    alignas(64) jubyte expect[buf_size];
+    for (size_t i = 0; i < buf_size; i++) {
+        buf[i] = (jubyte)(i * 7 + 3);
+    }
+    memcpy(expect, buf, buf_size);
+    memmove(expect + to_off, expect + from_off, bytes);
+    copy(buf + from_off, buf + to_off, bytes / unit);
+    guarantee(memcmp(buf, expect, buf_size) == 0,
+              "copy mismatch: unit=" SIZE_FORMAT " from=" SIZE_FORMAT " to=" SIZE_FORMAT " bytes=" SIZE_FORMAT,
+              unit, from_off, to_off, bytes);
+}
+
+void test_copy() {
+    std::cout << "Testing Copy (" << Copy::kernel_name() << ")..." << std::endl;
+
+    // 元素原子的复制：各种长度、元素对齐的各种偏移，前向、后向、不重叠
+    {
+        const size_t offsets[] = { 0, 8, 16, 24, 40, 64, 72, 200, 400 };
+        for (size_t bytes = 0; bytes <= 320; bytes += 8) {
+            for (size_t from_off : offsets) {
+                for (size_t to_off : offsets) {
+                    for (size_t skew = 0; skew < 8; skew += 2) {
+                        check_copy_against_memmove(sizeof(jshort), from_off + skew, to_off + skew, bytes,
+                            [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_jshorts_atomic((jshort*)f, (jshort*)t, n); });
+                        check_copy_against_memmove(sizeof(jshort), from_off + skew, to_off, bytes + skew,
+                            [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_jshorts_atomic((jshort*)f, (jshort*)t, n); });
+                    }
+                    check_copy_against_memmove(sizeof(jint), from_off + 4, to_off, bytes + 4,
+                        [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_jints_atomic((jint*)f, (jint*)t, n); });
+                    check_copy_against_memmove(sizeof(jint), from_off, to_off + 4, bytes,
+                        [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_jints_atomic((jint*)f, (jint*)t, n); });
+                    check_copy_against_memmove(sizeof(jlong), from_off, to_off, bytes,
+                        [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_jlongs_atomic((jlong*)f, (jlong*)t, n); });
+                    check_copy_against_memmove(1, from_off + 3, to_off + 5, bytes + 1,
+                        [](jubyte* f, jubyte* t, size_t n) { Copy::conjoint_memory_atomic(f, t, n); });
+                }
+            }
+        }
+    }
+
+    // HeapWord 对齐的数组：长度不必是 8 的倍数
+    {
+        const size_t offsets[] = { 0, 8, 16, 24, 32, 56, 64, 136, 400 };
+        for (size_t bytes = 0; bytes <= 300; bytes++) {
+            for (size_t from_off : offsets) {
+                for (size_t to_off : offsets) {
+                    check_copy_against_memmove(1, from_off, to_off, bytes,
+                        [](jubyte* f, jubyte* t, size_t n) {
+                            Copy::arrayof_conjoint_jbytes((HeapWord*)f, (HeapWord*)t, n);
+                        });
+                    if (bytes % sizeof(jint) == 0) {
+                        check_copy_against_memmove(sizeof(jint), from_off, to_off, bytes,
+                            [](jubyte* f, jubyte* t, size_t n) {
+                                Copy::arrayof_conjoint_jints((HeapWord*)f, (HeapWord*)t, n);
+                            });
+                    }
+                }
+            }
+        }
+    }
+
+    // 不重叠的按字复制：展开的小对象、向量核心，以及编译期字数的版本
+    {
+        const size_t max_words = 300;
+        HeapWord* src = new HeapWord[max_words];
+        HeapWord* dst = new HeapWord[max_words + 2];
+        for (size_t i = 0; i < max_words; i++) {
+            src[i] = (HeapWord)(0x1000 + i);
+        }
+        for (size_t count = 0; count < max_words; count++) {
+            for (size_t i = 0; i < max_words + 2; i++) {
+                dst[i] = 0;
+            }
+            Copy::aligned_disjoint_words(src, dst + 1, count);
+            guarantee(dst[0] == 0 && dst[count + 1] == 0, "disjoint copy out of range: " SIZE_FORMAT, count);
+            guarantee(memcmp(src, dst + 1, count * HeapWordSize) == 0, "disjoint copy mismatch: " SIZE_FORMAT, count);
+        }
+        HeapWord small[3] = { 0, 0, 0 };
+        Copy::aligned_disjoint_words<2>(src + 5, small);
+        guarantee(small[0] == src[5] && small[1] == src[6] && small[2] == 0, "templated small copy");
+        memset(dst, 0, (max_words + 2) * HeapWordSize);
+        Copy::aligned_disjoint_words<37>(src, dst);
+        guarantee(memcmp(src, dst, 37 * HeapWordSize) == 0 && dst[37] == 0, "templated vector copy");
+        delete[] src;
+        delete[] dst;
+    }
+
+    // 填充：每种写法、各种长度和对齐，不能写出范围
+    {
+        const size_t max_words = 700;
+        julong* buf = new julong[max_words + 32];
+        const julong values[] = { 0, 0x0101010101010101ULL, 0x0102030405060708ULL };
+        const Copy::FillMethod methods[] = { Copy::fill_stores, Copy::fill_rep_stos, Copy::fill_nontemporal };
+        for (julong value : values) {
+            for (size_t words = 0; words <= max_words; words += (words < 80 ? 1 : 37)) {
+                for (size_t off = 1; off <= 8; off++) {
+                    for (int m = -1; m < 3; m++) {
+                        for (size_t i = 0; i < max_words + 32; i++) {
+                            buf[i] = 0xdeadbeefcafebabeULL;
+                        }
+                        HeapWord* to = (HeapWord*)(buf + off);
+                        if (m < 0) {
+                            Copy::fill_to_words(to, words, value);
+                        } else {
+                            Copy::fill_words_using(methods[m], to, words, value);
+                        }
+                        for (size_t i = 0; i < max_words + 32; i++) {
+                            julong expect = (i >= off && i < off + words) ? value : 0xdeadbeefcafebabeULL;
+                            guarantee(buf[i] == expect, "fill mismatch: method=%d words=" SIZE_FORMAT " off=" SIZE_FORMAT,
+                                      m, words, off);
+                        }
+                    }
+                }
+            }
+        }
+        delete[] buf;
+
+        // 超过阈值的大块走 rep stos / 非临时写
+        size_t big = (Copy::nontemporal_fill_limit() + 4096) / HeapWordSize;
+        if (big <= 64 * 1024 * 1024 / HeapWordSize) {
+            julong* region = new julong[big + 2];
+            region[0] = region[big + 1] = 1;
+            Copy::zero_to_words((HeapWord*)(region + 1), big);
+            guarantee(region[0] == 1 && region[big + 1] == 1, "zeroed out of range");
+            for (size_t i = 1; i <= big; i++) {
+                guarantee(region[i] == 0, "large region not zeroed");
+            }
+            delete[] region;
+        }
+        guarantee(Copy::block_zeroing_low_limit() <= Copy::nontemporal_fill_limit(), "fill limits out of order");
+    }
+
+    // 元素不能被撕裂：每个值的 8 个字节都相同，读者看到字节不一致就是读到了半个元素
+    {
+        const size_t n = 1000;
+        jlong* a = new jlong[n];
+        jlong* b = new jlong[n];
+        jlong* dst = new jlong[n + 1];
+        for (size_t i = 0; i < n; i++) {
+            a[i] = (jlong)0x0101010101010101LL * (jlong)(1 + i % 100);
+            b[i] = (jlong)0x0101010101010101LL * (jlong)(101 + i % 100);
+        }
+        memcpy(dst, a, n * sizeof(jlong));
+        dst[n] = a[0];
+        volatile bool done = false;
+        volatile jint torn = 0;
+        std::thread reader([&]() {
+            while (!Atomic::load(&done)) {
+                for (size_t i = 0; i <= n; i++) {
+                    julong v = (julong)Atomic::load((volatile jlong*)&dst[i]);
+                    if (v != (v & 0xff) * 0x0101010101010101ULL) {
+                        Atomic::store(&torn, 1);
+                    }
+                }
+            }
+        });
+        for (int round = 0; round < 2000; round++) {
+            Copy::conjoint_jlongs_atomic((round & 1) ? a : b, dst, n);
+            // 向前、向后的重叠复制
+            Copy::conjoint_jlongs_atomic(dst, dst + 1, n);
+            Copy::conjoint_jlongs_atomic(dst + 1, dst, n);
+            Copy::arrayof_conjoint_jlongs((HeapWord*)((round & 1) ? b : a), (HeapWord*)dst, n);
+        }
+        Atomic::store(&done, true);
+        reader.join();
+        guarantee(torn == 0, "torn element observed");
+        delete[] a;
+        delete[] b;
+        delete[] dst;
+    }
+    std::cout << "  OK" << std::endl;
+}
+
+void test_vm_version() {
+    std::cout << "Testing VM_Version..." << std::endl;
+
+    uint64_t cpu = VM_Version::cpu_features();
+    uint64_t f = VM_Version::features();
+    guarantee((f & ~cpu) == 0, "enabled features must be supported by the CPU");
+#if defined(__x86_64__)
+    guarantee(VM_Version::supports_sse2(), "x86_64 always has SSE2");
+#endif
+    // flag 已经按 CPU 调低
+    guarantee(VM_Version::supports_avx2() == (UseAVX >= 2 && (cpu & VM_Version::CPU_AVX2) != 0),
+              "AVX2 must follow UseAVX");
+    guarantee(!VM_Version::supports_avx() || UseSSE >= 4, "AVX requires UseSSE >= 4");
+    guarantee(!UseFastStosb || (cpu & VM_Version::CPU_ERMS) != 0, "UseFastStosb without ERMS");
+    guarantee(!UsePopCountInstruction || VM_Version::supports_popcnt(), "UsePopCountInstruction without POPCNT");
+
+    int line = VM_Version::cache_line_size();
+    guarantee(line > 0 && is_power_of_2(line), "bad cache line size: %d", line);
+    size_t l1 = VM_Version::L1_data_cache_size();
+    size_t l2 = VM_Version::L2_cache_size();
+    size_t l3 = VM_Version::L3_cache_size();
+    guarantee(l1 == 0 || l2 == 0 || l1 <= l2, "L1 larger than L2");
+    guarantee(l2 == 0 || l3 == 0 || l2 <= l3, "L2 larger than L3");
+    std::cout << "  detection: OK" << std::endl;
+
+    // select 返回第一项支持的，都不支持时返回最后一项
+    typedef int (*Fn)();
+    static const VM_Version::Kernel<Fn> table[] = {
+        { (uint64_t)1 << 63,    "never",    nullptr },
+        { VM_Version::CPU_AVX2, "avx2",     nullptr },
+        { 0,                    "baseline", nullptr },
+    };
+    const char* expected = VM_Version::supports_avx2() ? "avx2" : "baseline";
+    guarantee(strcmp(VM_Version::select(table).name, expected) == 0, "wrong kernel selected");
+#if defined(__x86_64__)
+    guarantee(strcmp(Copy::kernel_name(), VM_Version::supports_avx2() ? "avx2" : "sse2") == 0,
+              "Copy kernel does not follow VM_Version");
+    guarantee(strcmp(VectorSearch::kernel_name(), Copy::kernel_name()) == 0,
+              "VectorSearch kernel does not follow VM_Version");
+#endif
+    std::cout << "  select: OK" << std::endl;
+
+    stringStream ss;
+    VM_Version::print_on(&ss);
+    guarantee(strstr(ss.base(), "CPU features: ") != nullptr, "missing features line");
+#if defined(__x86_64__)
+    guarantee(strstr(VM_Version::features_string(), "sse2") != nullptr, "missing sse2");
+#endif
+    fdStream out(1);
+    std::cout.flush();
+    VM_Version::print_on(&out);
+    std::cout << "  OK" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        guarantee(process_vm_flag(argv[i]), "unrecognized VM flag: %s", argv[i]);
+    }
+
+    std::cout << "=== my_jvm Utilities Test ===" << std::endl;
+
+    test_atomic();
+    test_locks();
+    test_growable_array_lifecycle();
+    test_growable_array_arena();
+    test_vector_search();
+    test_sort();
+    test_sorted_growable_array();
+    test_segmented_array();
+    test_global_counter();
+    test_concurrent_hash_table();
+    test_striped_counters();
+    test_copy();
+    test_vm_version();
+
+    std::cout << std::endl;
+    std::cout << "=== All Tests Passed! ===" << std::endl;
+    return 0;
+}
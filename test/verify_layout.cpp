@@ -14,6 +14,9 @@
 #include <cstring>
 
 #include "utilities/globalDefinitions.hpp"
+#include "classfile/classLoaderData.hpp"
+#include "memory/metaspace.hpp"
+#include "oops/compressedOops.hpp"
 #include "oops/markOop.hpp"
 #include "oops/metadata.hpp"
 #include "oops/oop.hpp"
@@ -22,6 +25,7 @@
 #include "oops/constMethod.hpp"
 #include "oops/instanceKlass.hpp"
 #include "oops/array.hpp"
+#include "runtime/globals.hpp"
 
 // ========== 辅助宏 ==========
 
@@ -56,6 +60,10 @@ void verify_oopDesc() {
     std::cout << "\n[oopDesc]" << std::endl;
     PRINT_SIZEOF(oopDesc);
 
+    // 这里按未压缩布局扫描 8 字节的 Klass*
+    const bool saved = UseCompressedClassPointers;
+    UseCompressedClassPointers = false;
+
     // 通过 mark_addr_raw() 获取 _mark 的地址
     oopDesc obj;
     size_t mark_off   = (size_t)((char*)obj.mark_addr_raw() - (char*)&obj);
@@ -77,6 +85,8 @@ void verify_oopDesc() {
         }
     }
 
+    UseCompressedClassPointers = saved;
+
     std::cout << "  offsetof(_mark)     = " << mark_off << std::endl;
     std::cout << "  offsetof(_metadata) = " << metadata_off << std::endl;
 
@@ -86,6 +96,69 @@ void verify_oopDesc() {
     std::cout << "  offsetof(_metadata) = 8" << std::endl;
 }
 
+// 压缩类指针：narrowKlass 占 [8, 12)，之后的 4 字节（klass gap）放数组长度或第一个字段
+// 和上面不同，这里的偏移用 guarantee 检查，不对时直接失败
+void verify_compressed_klass_layout() {
+    std::cout << "\n[oopDesc, UseCompressedClassPointers]" << std::endl;
+
+    const bool saved = UseCompressedClassPointers;
+    UseCompressedClassPointers = true;
+
+    // Klass 必须在压缩类空间里
+    ClassLoaderData cld;
+    Klass* k = new (&cld) Klass();
+    guarantee(Metaspace::is_in_class_space(k), "klass should be in compressed class space");
+
+    // 用一块 32 字节的内存模拟堆上的对象
+    alignas(8) char storage[32];
+    memset(storage, 0xAB, sizeof(storage));
+    oopDesc* obj = (oopDesc*)storage;
+    obj->set_klass(k);
+    obj->set_klass_gap(0x11223344);
+
+    narrowKlass nk = 0;
+    memcpy(&nk, storage + 8, sizeof(nk));
+    int gap = 0;
+    memcpy(&gap, storage + 12, sizeof(gap));
+    guarantee(nk == CompressedKlassPointers::encode(k), "narrowKlass should be stored at offset 8");
+    guarantee(gap == 0x11223344, "klass gap should be at offset 12");
+    guarantee(obj->klass() == k, "decode(encode(k)) == k");
+
+    arrayOopDesc* array = (arrayOopDesc*)storage;
+    array->set_length(42);
+    guarantee(array->length() == 42 && obj->klass() == k, "array length lives in the klass gap");
+
+    std::cout << "  narrowKlass base  = " << (void*)CompressedKlassPointers::base()
+              << "  shift = " << CompressedKlassPointers::shift() << std::endl;
+    std::cout << "  klass_offset_in_bytes          = " << oopDesc::klass_offset_in_bytes() << std::endl;
+    std::cout << "  klass_gap_offset_in_bytes      = " << oopDesc::klass_gap_offset_in_bytes() << std::endl;
+    std::cout << "  instance base_offset_in_bytes  = " << instanceOopDesc::base_offset_in_bytes() << std::endl;
+    std::cout << "  array length_offset_in_bytes   = " << arrayOopDesc::length_offset_in_bytes() << std::endl;
+    std::cout << "  array header_size_in_bytes     = " << arrayOopDesc::header_size_in_bytes() << std::endl;
+    std::cout << "  int[] base_offset_in_bytes     = " << arrayOopDesc::base_offset_in_bytes(4) << std::endl;
+    std::cout << "  long[] base_offset_in_bytes    = " << arrayOopDesc::base_offset_in_bytes(8) << std::endl;
+
+    guarantee(oopDesc::klass_offset_in_bytes() == 8, "klass offset");
+    guarantee(oopDesc::klass_gap_offset_in_bytes() == 12, "klass gap offset");
+    guarantee(instanceOopDesc::base_offset_in_bytes() == 12, "instance header is 12 bytes");
+    guarantee(arrayOopDesc::length_offset_in_bytes() == 12, "array length offset");
+    guarantee(arrayOopDesc::header_size_in_bytes() == 16, "array header size");
+    guarantee(arrayOopDesc::base_offset_in_bytes(4) == 16, "int[] base offset");
+    guarantee(arrayOopDesc::base_offset_in_bytes(8) == 16, "long[] base offset");
+
+    UseCompressedClassPointers = false;
+    guarantee(instanceOopDesc::base_offset_in_bytes() == 16, "uncompressed instance header is 16 bytes");
+    guarantee(arrayOopDesc::length_offset_in_bytes() == 16, "uncompressed array length offset");
+    guarantee(arrayOopDesc::header_size_in_bytes() == 24, "uncompressed array header size");
+    guarantee(arrayOopDesc::base_offset_in_bytes(4) == 24, "uncompressed int[] base offset");
+    guarantee(arrayOopDesc::base_offset_in_bytes(8) == 24, "uncompressed long[] base offset");
+    UseCompressedClassPointers = saved;
+
+    std::cout << "  --- Expected (OpenJDK 11, 64-bit, -XX:+UseCompressedClassPointers) ---" << std::endl;
+    std::cout << "  klass=8 gap=12 instance fields=12 array length=12 array header=16" << std::endl;
+    std::cout << "  (-XX:-UseCompressedClassPointers: instance fields=16 array length=16 array header=24)" << std::endl;
+}
+
 void verify_Metadata() {
     std::cout << "\n[Metadata]" << std::endl;
     PRINT_SIZEOF(Metadata);
@@ -270,6 +343,7 @@ int main() {
 
     verify_markOopDesc();
     verify_oopDesc();
+    verify_compressed_klass_layout();
     verify_Metadata();
     verify_Klass();
     verify_Method();